@@ -0,0 +1,141 @@
+/// @file
+/// @brief Measures the cost of moving entities between archetypes and of accessing them randomly.
+///
+/// Repeatedly adds and removes components from many entities, which moves them between dense tables, and then
+/// accesses their components in a random order, both through the world and through a query.
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include <cubos/core/ecs/query/data.hpp>
+#include <cubos/core/ecs/reflection.hpp>
+#include <cubos/core/ecs/world.hpp>
+#include <cubos/core/memory/stream.hpp>
+#include <cubos/core/reflection/external/primitives.hpp>
+#include <cubos/core/tel/level.hpp>
+
+using cubos::core::ecs::Entity;
+using cubos::core::ecs::QueryData;
+using cubos::core::ecs::World;
+using cubos::core::memory::Stream;
+using cubos::core::tel::Level;
+
+static constexpr int EntityCount = 100000;
+static constexpr int RoundCount = 10;
+
+struct Position
+{
+    CUBOS_REFLECT;
+
+    float x{0.0F};
+    float y{0.0F};
+    float z{0.0F};
+};
+
+struct Velocity
+{
+    CUBOS_REFLECT;
+
+    float x{1.0F};
+    float y{2.0F};
+    float z{3.0F};
+};
+
+/// @brief Used only to split the entities into different archetypes.
+struct Tag
+{
+    CUBOS_REFLECT;
+};
+
+CUBOS_REFLECT_IMPL(Position)
+{
+    return cubos::core::ecs::TypeBuilder<Position>("Position")
+        .withField("x", &Position::x)
+        .withField("y", &Position::y)
+        .withField("z", &Position::z)
+        .build();
+}
+
+CUBOS_REFLECT_IMPL(Velocity)
+{
+    return cubos::core::ecs::TypeBuilder<Velocity>("Velocity")
+        .withField("x", &Velocity::x)
+        .withField("y", &Velocity::y)
+        .withField("z", &Velocity::z)
+        .build();
+}
+
+CUBOS_REFLECT_IMPL(Tag)
+{
+    return cubos::core::ecs::TypeBuilder<Tag>("Tag").build();
+}
+
+template <typename F>
+static void measure(const char* name, int operations, F function)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < RoundCount; ++i)
+    {
+        function();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    auto ns = std::chrono::duration<double, std::nano>(elapsed).count() / (RoundCount * operations);
+    Stream::stdOut.printf("{}: {} ns/op\n", name, ns);
+}
+
+int main()
+{
+    // Otherwise we'd be measuring the cost of logging each entity creation.
+    cubos::core::tel::level(Level::Warn);
+
+    World world{};
+    world.registerComponent<Position>();
+    world.registerComponent<Velocity>();
+    world.registerComponent<Tag>();
+
+    std::vector<Entity> entities;
+    for (int i = 0; i < EntityCount; ++i)
+    {
+        auto entity = world.create();
+        world.components(entity).add(Position{});
+        if (i % 4 == 0)
+        {
+            world.components(entity).add(Tag{});
+        }
+        entities.push_back(entity);
+    }
+
+    // Access entities in a random order, so that consecutive accesses hit unrelated rows.
+    std::shuffle(entities.begin(), entities.end(), std::mt19937{42});
+
+    measure("add/remove component", 2 * EntityCount, [&]() {
+        for (auto entity : entities)
+        {
+            world.components(entity).add(Velocity{});
+        }
+
+        for (auto entity : entities)
+        {
+            world.components(entity).remove<Velocity>();
+        }
+    });
+
+    measure("random world access", EntityCount, [&]() {
+        for (auto entity : entities)
+        {
+            world.components(entity).get<Position>().x += 1.0F;
+        }
+    });
+
+    QueryData<Position&> query{world, {}};
+    measure("random query access", EntityCount, [&]() {
+        for (auto entity : entities)
+        {
+            std::get<0>(*query.at(entity)).x += 1.0F;
+        }
+    });
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+/// @file
+/// @brief Compares the cost of iterating over a query row by row with iterating over it in chunks.
+///
+/// Integrates the position of many entities with a velocity, spread over a few archetypes, first through the regular
+/// query iterators and then through @ref cubos::core::ecs::QueryData::View::eachChunk.
+
+#include <chrono>
+#include <span>
+
+#include <cubos/core/ecs/query/data.hpp>
+#include <cubos/core/ecs/reflection.hpp>
+#include <cubos/core/ecs/world.hpp>
+#include <cubos/core/memory/stream.hpp>
+#include <cubos/core/reflection/external/primitives.hpp>
+
+using cubos::core::ecs::QueryData;
+using cubos::core::ecs::World;
+using cubos::core::memory::Stream;
+
+static constexpr int EntityCount = 1000000;
+static constexpr int FrameCount = 50;
+static constexpr float DeltaTime = 1.0F / 60.0F;
+
+struct Position
+{
+    CUBOS_REFLECT;
+
+    float x{0.0F};
+    float y{0.0F};
+    float z{0.0F};
+};
+
+struct Velocity
+{
+    CUBOS_REFLECT;
+
+    float x{1.0F};
+    float y{2.0F};
+    float z{3.0F};
+};
+
+/// @brief Used only to split the entities into different archetypes.
+struct Tag
+{
+    CUBOS_REFLECT;
+};
+
+CUBOS_REFLECT_IMPL(Position)
+{
+    return cubos::core::ecs::TypeBuilder<Position>("Position")
+        .withField("x", &Position::x)
+        .withField("y", &Position::y)
+        .withField("z", &Position::z)
+        .build();
+}
+
+CUBOS_REFLECT_IMPL(Velocity)
+{
+    return cubos::core::ecs::TypeBuilder<Velocity>("Velocity")
+        .withField("x", &Velocity::x)
+        .withField("y", &Velocity::y)
+        .withField("z", &Velocity::z)
+        .build();
+}
+
+CUBOS_REFLECT_IMPL(Tag)
+{
+    return cubos::core::ecs::TypeBuilder<Tag>("Tag").build();
+}
+
+template <typename F>
+static void measure(const char* name, F function)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FrameCount; ++i)
+    {
+        function();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    auto ns = std::chrono::duration<double, std::nano>(elapsed).count() / (FrameCount * EntityCount);
+    Stream::stdOut.printf("{}: {} ns/entity\n", name, ns);
+}
+
+int main()
+{
+    World world{};
+    world.registerComponent<Position>();
+    world.registerComponent<Velocity>();
+    world.registerComponent<Tag>();
+
+    for (int i = 0; i < EntityCount; ++i)
+    {
+        auto entity = world.create();
+        world.components(entity).add(Position{}).add(Velocity{});
+        if (i % 4 == 0)
+        {
+            world.components(entity).add(Tag{});
+        }
+    }
+
+    QueryData<Position&, const Velocity&> query{world, {}};
+
+    measure("per row", [&]() {
+        for (auto [position, velocity] : query.view())
+        {
+            position.x += velocity.x * DeltaTime;
+            position.y += velocity.y * DeltaTime;
+            position.z += velocity.z * DeltaTime;
+        }
+    });
+
+    auto integrate = [](std::span<Position> positions, std::span<const Velocity> velocities) {
+        for (std::size_t i = 0; i < positions.size(); ++i)
+        {
+            positions[i].x += velocities[i].x * DeltaTime;
+            positions[i].y += velocities[i].y * DeltaTime;
+            positions[i].z += velocities[i].z * DeltaTime;
+        }
+    };
+    measure("per chunk", [&]() { query.view().eachChunk(integrate); });
+
+    return 0;
+}
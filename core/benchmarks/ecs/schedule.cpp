@@ -0,0 +1,113 @@
+/// @file
+/// @brief Measures how much the main schedule benefits from running independent systems concurrently.
+///
+/// Spawns a number of entities with several components and registers one system per component, each doing some
+/// arithmetic over its component. Since no two systems access the same data, they can all run at the same time.
+
+#include <chrono>
+#include <string>
+#include <utility>
+
+#include <cubos/core/ecs/command_buffer.hpp>
+#include <cubos/core/ecs/reflection.hpp>
+#include <cubos/core/ecs/system/arguments/query.hpp>
+#include <cubos/core/ecs/system/registry.hpp>
+#include <cubos/core/ecs/system/schedule.hpp>
+#include <cubos/core/ecs/system/system.hpp>
+#include <cubos/core/ecs/world.hpp>
+#include <cubos/core/memory/stream.hpp>
+#include <cubos/core/reflection/external/primitives.hpp>
+#include <cubos/core/thread/pool.hpp>
+
+using cubos::core::ecs::CommandBuffer;
+using cubos::core::ecs::Query;
+using cubos::core::ecs::Schedule;
+using cubos::core::ecs::System;
+using cubos::core::ecs::SystemContext;
+using cubos::core::ecs::SystemRegistry;
+using cubos::core::ecs::World;
+using cubos::core::memory::Stream;
+using cubos::core::thread::ThreadPool;
+
+static constexpr int EntityCount = 10000;
+static constexpr int FrameCount = 100;
+static constexpr int WorkPerComponent = 64;
+
+template <int I>
+struct Counter
+{
+    CUBOS_REFLECT;
+
+    float value{0.0F};
+};
+
+CUBOS_REFLECT_TEMPLATE_IMPL((int I), (Counter<I>))
+{
+    return cubos::core::ecs::TypeBuilder<Counter<I>>("Counter<" + std::to_string(I) + ">")
+        .withField("value", &Counter<I>::value)
+        .build();
+}
+
+template <int I>
+static void setup(World& world, SystemRegistry& registry, Schedule& schedule)
+{
+    world.registerComponent<Counter<I>>();
+    schedule.system(registry.add("counter " + std::to_string(I),
+                                 System<void>::make(world, [](Query<Counter<I>&> query) {
+                                     for (auto [counter] : query)
+                                     {
+                                         for (int i = 0; i < WorkPerComponent; ++i)
+                                         {
+                                             counter.value = counter.value * 0.99F + 1.0F;
+                                         }
+                                     }
+                                 })));
+}
+
+template <int... Is>
+static void setupAll(World& world, SystemRegistry& registry, Schedule& schedule, std::integer_sequence<int, Is...>)
+{
+    (setup<Is>(world, registry, schedule), ...);
+    for (int i = 0; i < EntityCount; ++i)
+    {
+        auto entity = world.create();
+        (world.components(entity).add(Counter<Is>{}), ...);
+    }
+}
+
+static void report(const char* name, std::chrono::steady_clock::duration elapsed)
+{
+    auto ms = std::chrono::duration<double, std::milli>(elapsed).count() / FrameCount;
+    Stream::stdOut.printf("{}: {} ms/frame\n", name, ms);
+}
+
+int main()
+{
+    World world{};
+    SystemRegistry registry{};
+    Schedule schedule{};
+    setupAll(world, registry, schedule, std::make_integer_sequence<int, 8>{});
+
+    CommandBuffer cmdBuffer{world};
+    SystemContext context{.cmdBuffer = cmdBuffer};
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FrameCount; ++i)
+    {
+        schedule.run(registry, context);
+    }
+    report("sequential", std::chrono::steady_clock::now() - start);
+
+    for (std::size_t threads : {2, 4, 8})
+    {
+        ThreadPool pool{threads};
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < FrameCount; ++i)
+        {
+            schedule.run(registry, context, pool);
+        }
+        report(("pool (" + std::to_string(threads) + " threads)").c_str(), std::chrono::steady_clock::now() - start);
+    }
+
+    return 0;
+}
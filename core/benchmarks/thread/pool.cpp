@@ -0,0 +1,83 @@
+/// @file
+/// @brief Measures the overhead of submitting many small tasks to a thread pool.
+///
+/// Runs two workloads: many independent tasks submitted from the main thread, and a recursive fork/join computation
+/// where tasks are submitted from within other tasks. Prints per-worker statistics for each run.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include <cubos/core/memory/stream.hpp>
+#include <cubos/core/reflection/external/primitives.hpp>
+#include <cubos/core/thread/pool.hpp>
+
+using cubos::core::memory::Stream;
+using cubos::core::thread::TaskGroup;
+using cubos::core::thread::ThreadPool;
+
+static constexpr int TaskCount = 1000000;
+static constexpr std::uint64_t SumEnd = 1 << 24;
+static constexpr std::uint64_t SumGrain = 1 << 10;
+
+static std::uint64_t sum(ThreadPool& pool, std::uint64_t begin, std::uint64_t end)
+{
+    if (end - begin <= SumGrain)
+    {
+        std::uint64_t result = 0;
+        for (auto i = begin; i < end; ++i)
+        {
+            result += i * i;
+        }
+        return result;
+    }
+
+    auto middle = begin + (end - begin) / 2;
+    std::uint64_t left = 0;
+    TaskGroup group{pool};
+    group.run([&]() { left = sum(pool, begin, middle); });
+    auto right = sum(pool, middle, end);
+    group.wait();
+    return left + right;
+}
+
+static void report(const char* name, const ThreadPool& pool, std::chrono::steady_clock::duration elapsed)
+{
+    Stream::stdOut.printf("{} ({} threads): {} ms\n", name, pool.threadCount(),
+                          std::chrono::duration<double, std::milli>(elapsed).count());
+    for (std::size_t i = 0; i < pool.threadCount(); ++i)
+    {
+        auto stats = pool.stats(i);
+        Stream::stdOut.printf("    worker {}: {} executed, {} stolen, {} sleeps\n", i, stats.executed, stats.stolen,
+                              stats.sleeps);
+    }
+}
+
+int main()
+{
+    for (std::size_t threads : {1, 2, 4, 8, 16})
+    {
+        {
+            ThreadPool pool{threads};
+            std::atomic<int> counter{0};
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < TaskCount; ++i)
+            {
+                pool.addTask([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); });
+            }
+            pool.wait();
+            report("independent tasks", pool, std::chrono::steady_clock::now() - start);
+        }
+
+        {
+            ThreadPool pool{threads};
+            std::uint64_t result = 0;
+            auto start = std::chrono::steady_clock::now();
+            pool.addTask([&]() { result = sum(pool, 0, SumEnd); });
+            pool.wait();
+            report("fork/join", pool, std::chrono::steady_clock::now() - start);
+        }
+    }
+
+    return 0;
+}
@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
 #include <vector>
@@ -27,6 +30,13 @@ namespace cubos::core::ecs
     class Blueprint;
 
     /// @brief Stores commands to execute them later.
+    ///
+    /// Each thread records its commands into its own lane, without taking any locks, except when first recording or
+    /// when reserving entities. Commands are stored as small records whose values are kept in a per-lane arena, which
+    /// starts small and is reused after each commit instead of being freed. Nothing is allocated until the first
+    /// command is recorded. On commit, the lanes are merged so that commands are applied in the order in which they
+    /// were recorded, which needs no merging at all when a single thread recorded commands.
+    ///
     /// @ingroup core-ecs
     class CUBOS_CORE_API CommandBuffer final
     {
@@ -35,6 +45,9 @@ namespace cubos::core::ecs
         /// @param world World to which the commands will be applied.
         CommandBuffer(World& world);
 
+        /// @brief Destructs, discarding any commands which weren't committed.
+        ~CommandBuffer();
+
         /// @brief Inserts a resource into the world.
         /// @param value Resource value.
         void insertResource(memory::AnyValue value);
@@ -87,12 +100,27 @@ namespace cubos::core::ecs
         /// @param command Command function.
         void push(memory::Function<void(World&)> command);
 
+        /// @brief Checks whether there are any commands waiting to be committed.
+        /// @return Whether the buffer is empty.
+        bool empty();
+
         /// @brief Commits the commands to the world.
+        ///
+        /// Must not be called while other threads are recording commands into this buffer.
         void commit();
 
     private:
-        std::mutex mMutex;                                     ///< Protects the commands buffer.
-        World& mWorld;                                         ///< World to which the commands will be applied.
-        std::vector<memory::Function<void(World&)>> mCommands; ///< Commands to be executed.
+        struct Lane;
+
+        /// @brief Gets the lane of the calling thread, creating it if it doesn't exist yet.
+        /// @return Lane.
+        Lane& lane();
+
+        std::mutex mMutex;                         ///< Protects the lanes vector.
+        World& mWorld;                             ///< World to which the commands will be applied.
+        uint64_t mId;                              ///< Unique identifier, used by threads to cache their lane.
+        std::atomic<uint64_t> mSequence{0};        ///< Number of commands recorded since the last commit.
+        std::vector<std::unique_ptr<Lane>> mLanes; ///< Lanes of the threads which recorded commands.
+        std::atomic<Lane*> mFirstLane{nullptr};    ///< First lane created, checked before any other.
     };
 } // namespace cubos::core::ecs
@@ -65,6 +65,21 @@ namespace cubos::core::ecs
         std::vector<std::string> value; ///< Command-line arguments.
     };
 
+    /// @brief Resource which stores how many threads should be used to run the main systems.
+    ///
+    /// This resource is added by the @ref Cubos class, initially set to 1, which runs all systems sequentially on the
+    /// main thread. If set to a higher value, systems whose accesses don't conflict are run concurrently on a thread
+    /// pool with this many threads, which is also used by @ref Query::parEach. Changes take effect on the next call to
+    /// @ref Cubos::update().
+    ///
+    /// @ingroup core-ecs
+    struct CUBOS_CORE_API SystemThreads
+    {
+        CUBOS_REFLECT;
+
+        std::size_t value{1}; ///< Number of threads.
+    };
+
     /// @brief Represents the engine itself, and exposes the interface with which the game
     /// developer interacts with. Ties up all the different parts of the engine together.
     /// @ingroup core-ecs
@@ -500,6 +515,102 @@ namespace cubos::core::ecs
             return std::move(*this).with(reflection::reflect<T>(), target);
         }
 
+        /// @brief Forces the given target of the next query argument to have the following component, and for it to
+        /// have been changed since the system last ran.
+        ///
+        /// Components are considered changed when they're added, or accessed mutably through a query or the world.
+        /// Changes made through the query itself are not taken into account.
+        ///
+        /// @param type Component type.
+        /// @param target Target index. By default, the last specified target or 0.
+        /// @return Builder.
+        SystemBuilder&& changed(const reflection::Type& type, int target = -1) &&;
+
+        /// @copydoc changed(const reflection::Type&, int)
+        /// @tparam T Component type.
+        template <typename T>
+        SystemBuilder&& changed(int target = -1) &&
+        {
+            return std::move(*this).changed(reflection::reflect<T>(), target);
+        }
+
+        /// @brief Forces the given target of the next query argument to have the following component, and for it to
+        /// have been added since the system last ran.
+        /// @param type Component type.
+        /// @param target Target index. By default, the last specified target or 0.
+        /// @return Builder.
+        SystemBuilder&& added(const reflection::Type& type, int target = -1) &&;
+
+        /// @copydoc added(const reflection::Type&, int)
+        /// @tparam T Component type.
+        template <typename T>
+        SystemBuilder&& added(int target = -1) &&
+        {
+            return std::move(*this).added(reflection::reflect<T>(), target);
+        }
+
+        /// @brief Forces the given target of the next query argument to have the following component, and for it, or
+        /// for any other component required with @ref anyChanged or @ref anyAdded, to have been changed since the
+        /// system last ran.
+        ///
+        /// Useful for systems which must process entities when any of their components changed, such as:
+        ///
+        /// @code{.cpp}
+        ///     cubos.system("update transforms")
+        ///         .anyChanged<Position>()
+        ///         .anyChanged<Rotation>()
+        ///         .call([](Query<Transform&, const Position&, const Rotation&> query) { ... });
+        /// @endcode
+        ///
+        /// @param type Component type.
+        /// @param target Target index. By default, the last specified target or 0.
+        /// @return Builder.
+        SystemBuilder&& anyChanged(const reflection::Type& type, int target = -1) &&;
+
+        /// @copydoc anyChanged(const reflection::Type&, int)
+        /// @tparam T Component type.
+        template <typename T>
+        SystemBuilder&& anyChanged(int target = -1) &&
+        {
+            return std::move(*this).anyChanged(reflection::reflect<T>(), target);
+        }
+
+        /// @brief Forces the given target of the next query argument to have the following component, and for it to
+        /// have been added since the system last ran, unless any other component required with @ref anyChanged or
+        /// @ref anyAdded was changed or added.
+        /// @param type Component type.
+        /// @param target Target index. By default, the last specified target or 0.
+        /// @return Builder.
+        SystemBuilder&& anyAdded(const reflection::Type& type, int target = -1) &&;
+
+        /// @copydoc anyAdded(const reflection::Type&, int)
+        /// @tparam T Component type.
+        template <typename T>
+        SystemBuilder&& anyAdded(int target = -1) &&
+        {
+            return std::move(*this).anyAdded(reflection::reflect<T>(), target);
+        }
+
+        /// @brief Forces the given target of the next query argument to have the following component, and makes the
+        /// query only mark it as changed, when accessed mutably, if its value was actually written to.
+        ///
+        /// By default, components accessed mutably through a query are marked as changed as soon as they're fetched.
+        /// Useful for systems which access many components mutably but only write to a few of them, at the cost of
+        /// copying the components when they're fetched and comparing them once the iteration ends.
+        ///
+        /// @param type Component type, which must be trivially copyable.
+        /// @param target Target index. By default, the last specified target or 0.
+        /// @return Builder.
+        SystemBuilder&& compareWrites(const reflection::Type& type, int target = -1) &&;
+
+        /// @copydoc compareWrites(const reflection::Type&, int)
+        /// @tparam T Component type.
+        template <typename T>
+        SystemBuilder&& compareWrites(int target = -1) &&
+        {
+            return std::move(*this).compareWrites(reflection::reflect<T>(), target);
+        }
+
         /// @brief Forces the given target of the next query argument to not have the following component.
         /// @param type Component type.
         /// @param target Target. By default, the last specified target or 0.
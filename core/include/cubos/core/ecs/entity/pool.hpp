@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <mutex>
 #include <queue>
 #include <vector>
 
@@ -15,6 +16,10 @@ namespace cubos::core::ecs
 {
     /// @brief Manages the creation and destruction of entity identifiers, as well as storing their
     /// archetype identifiers.
+    ///
+    /// Identifiers can be reserved with @ref reserve concurrently with any const method, as reserving never changes
+    /// the stored entries. Reserved identifiers only get an entry once @ref flush is called.
+    ///
     /// @ingroup core-ecs-entity
     class CUBOS_CORE_API EntityPool final
     {
@@ -29,6 +34,19 @@ namespace cubos::core::ecs
         /// @return Entity.
         Entity create(ArchetypeId archetype);
 
+        /// @brief Reserves an entity identifier, whose archetype is @ref ArchetypeId::Invalid.
+        ///
+        /// Thread-safe, and may be called while other threads read the pool. The identifier is only contained in the
+        /// pool after the next call to @ref flush.
+        ///
+        /// @return Entity.
+        Entity reserve();
+
+        /// @brief Adds entries for the identifiers reserved since the last call.
+        ///
+        /// Must not be called concurrently with any other method.
+        void flush();
+
         /// @brief Removes an entity from the world.
         /// @param index Entity index to remove.
         void destroy(uint32_t index);
@@ -67,5 +85,7 @@ namespace cubos::core::ecs
 
         std::vector<Entry> mEntries; ///< Pool of entities.
         std::queue<uint32_t> mFree;  ///< Queue with free entity indices.
+        uint32_t mReserved{0};       ///< Number of indices reserved past the end of @ref mEntries.
+        std::mutex mMutex;           ///< Protects @ref mFree and @ref mReserved.
     };
 } // namespace cubos::core::ecs
@@ -4,14 +4,17 @@
 
 #pragma once
 
+#include <algorithm>
 #include <tuple>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include <cubos/core/ecs/query/fetcher.hpp>
 #include <cubos/core/ecs/query/filter.hpp>
 #include <cubos/core/reflection/external/primitives.hpp>
 #include <cubos/core/tel/logging.hpp>
+#include <cubos/core/thread/pool.hpp>
 
 namespace cubos::core::ecs
 {
@@ -24,6 +27,10 @@ namespace cubos::core::ecs
     /// If an argument type is present which requires a certain column to be present, then that column is automatically
     /// added to the query properties, if it isn't there already.
     ///
+    /// Components fetched mutably are marked as changed as soon as they're fetched. Components whose terms are
+    /// compared on write are instead only marked if they were written to, which is checked once the last view of the
+    /// query is destroyed. Data accessed through @ref at() outlives the views, and thus is always marked.
+    ///
     /// @tparam Ts Argument types.
     /// @ingroup core-ecs-query
     template <typename... Ts>
@@ -148,6 +155,8 @@ namespace cubos::core::ecs
         /// @brief Fetches any new matching archetypes that have been added since the last call to this function.
         void update()
         {
+            this->flush();
+
             for (auto& archetype : mPreparedArchetypes)
             {
                 archetype = ArchetypeId::Invalid;
@@ -175,14 +184,12 @@ namespace cubos::core::ecs
         {
             CUBOS_ASSERT(mFilter->targetCount() == 1);
 
-            auto view = this->view().pin(0, entity);
-
-            if (view.begin() == view.end())
-            {
-                return {};
-            }
-
-            return *view.begin();
+            // The fetched data may be written to after the view is destroyed, so it can't be compared then.
+            mViews += 1;
+            auto match = first(this->view().pin(0, entity));
+            mViews -= 1;
+            this->mark();
+            return match;
         }
 
         /// @brief Accesses the match for the given entities, if there is one.
@@ -193,8 +200,20 @@ namespace cubos::core::ecs
         {
             CUBOS_ASSERT(mFilter->targetCount() == 2);
 
-            auto view = this->view().pin(0, firstEntity).pin(1, secondEntity);
+            // The fetched data may be written to after the view is destroyed, so it can't be compared then.
+            mViews += 1;
+            auto match = first(this->view().pin(0, firstEntity).pin(1, secondEntity));
+            mViews -= 1;
+            this->mark();
+            return match;
+        }
 
+    private:
+        /// @brief Gets the first match of the given view, if there's any.
+        /// @param view View.
+        /// @return Match, or nothing if there are no matches.
+        static memory::Opt<std::tuple<Ts...>> first(View view)
+        {
             if (view.begin() == view.end())
             {
                 return {};
@@ -203,7 +222,18 @@ namespace cubos::core::ecs
             return *view.begin();
         }
 
-    private:
+        /// @brief Marks the components written through the fetchers since the last call as changed.
+        void flush()
+        {
+            std::apply([](auto&... fetcher) { (fetcher.flush(), ...); }, *mFetchers);
+        }
+
+        /// @brief Marks the components fetched mutably since the last call as changed, whether written to or not.
+        void mark()
+        {
+            std::apply([](auto&... fetcher) { (fetcher.mark(), ...); }, *mFetchers);
+        }
+
         /// @brief If necessary, prepares the fetchers for iteration over the given archetypes.
         /// @param archetypes Target archetypes.
         /// @param cursorDepths Cursor depths.
@@ -237,10 +267,13 @@ namespace cubos::core::ecs
 
             if (changed && !empty)
             {
+                // Changes made through the fetchers are stamped with the query's tick.
+                auto tick = mFilter->tick();
+
                 // Templated functor which receives a sequence of indices (at compile time) and prepares the
                 // corresponding fetcher with each cursor depth.
                 auto prepareAll = [&]<std::size_t... Is>(std::index_sequence<Is...>) {
-                    (std::get<Is>(*mFetchers).prepare(archetypes, cursorDepths[mFetcherCursors[Is]]), ...);
+                    (std::get<Is>(*mFetchers).prepare(archetypes, cursorDepths[mFetcherCursors[Is]], tick), ...);
                 };
 
                 // Call the above functor with a sequence of indices from 0 to the number of fetchers.
@@ -257,6 +290,7 @@ namespace cubos::core::ecs
         std::vector<size_t> mFetcherCursors;
         ArchetypeId mPreparedArchetypes[QueryNode::MaxTargetCount];
         int mPreparedDepths[QueryNode::MaxCursorCount];
+        std::size_t mViews{0}; ///< Number of views alive, which may still be accessing fetched data.
     };
 
     template <typename... Ts>
@@ -273,11 +307,27 @@ namespace cubos::core::ecs
             : mData{data}
             , mView{view}
         {
+            mData.mViews += 1;
         }
 
         /// @brief Copy constructs.
         /// @param view Other view.
-        View(const View& view) = default;
+        View(const View& view)
+            : mData{view.mData}
+            , mView{view.mView}
+        {
+            mData.mViews += 1;
+        }
+
+        /// @brief Destructs, marking the components written through the query as changed if this is the last view.
+        ~View()
+        {
+            mData.mViews -= 1;
+            if (mData.mViews == 0)
+            {
+                mData.flush();
+            }
+        }
 
         /// @brief Returns a new view equal to this one but with the given target pinned to the given entity.
         ///
@@ -312,6 +362,133 @@ namespace cubos::core::ecs
             return mData;
         }
 
+        /// @brief Calls the given function once for each dense table with matches, with spans over its rows.
+        ///
+        /// Only supported by unpinned views over queries with a single target and without relation, change or addition
+        /// terms.
+        ///
+        /// @tparam F Function type.
+        /// @param function Function called with the result of @ref QueryFetcher::chunk for each argument.
+        template <typename F>
+        void eachChunk(F& function)
+        {
+            const auto* archetypes = mData.mFilter->denseArchetypes();
+            CUBOS_ASSERT(archetypes != nullptr && !mView.pinned(),
+                         "Chunks are only supported on unpinned queries with a single target and no row filters");
+
+            auto& dense = mData.mWorld.tables().dense();
+            for (auto archetype : *archetypes)
+            {
+                if (!dense.contains(archetype) || dense.at(archetype).size() == 0)
+                {
+                    continue;
+                }
+
+                auto size = dense.at(archetype).size();
+                auto tick = mData.mFilter->tick();
+                auto& fetchers = *mData.mFetchers;
+                std::apply([&](auto&... fetcher) { (fetcher.prepare(&archetype, -1, tick), ...); }, fetchers);
+                std::apply([&](auto&... fetcher) { function(fetcher.chunk(0, size)...); }, fetchers);
+            }
+
+            // The fetchers were prepared behind the iterators' back, so they must prepare them again.
+            for (auto& prepared : mData.mPreparedArchetypes)
+            {
+                prepared = ArchetypeId::Invalid;
+            }
+        }
+
+        /// @brief Calls the given function for each match, splitting the matches into chunks which run in parallel.
+        ///
+        /// If every match is a row of a dense table, each table is split into ranges of rows, which are fetched
+        /// directly by the tasks. Otherwise, the calling thread iterates over the matches and hands them out in chunks.
+        ///
+        /// The tasks only access the data fetched by the query, and no two tasks receive the same match, so the
+        /// function may be called concurrently as long as it doesn't access any other data unsafely.
+        ///
+        /// @tparam F Function type.
+        /// @param pool Pool to run the chunks on. If null, or if the view is pinned, runs on the calling thread.
+        /// @param chunkSize Maximum number of matches per chunk.
+        /// @param function Function called with the arguments of each match.
+        template <typename F>
+        void parEach(thread::ThreadPool* pool, std::size_t chunkSize, F& function)
+        {
+            CUBOS_ASSERT(chunkSize > 0, "Chunk size must be greater than zero");
+
+            if (pool == nullptr || mView.pinned())
+            {
+                for (auto match : *this)
+                {
+                    std::apply(function, match);
+                }
+                return;
+            }
+
+            thread::TaskGroup group{*pool};
+
+            if (const auto* archetypes = mData.mFilter->denseArchetypes())
+            {
+                // The tasks copy the fetchers, which must not take rows fetched previously with them.
+                mData.flush();
+
+                auto& dense = mData.mWorld.tables().dense();
+                for (auto archetype : *archetypes)
+                {
+                    if (!dense.contains(archetype))
+                    {
+                        continue;
+                    }
+
+                    auto size = dense.at(archetype).size();
+                    for (std::size_t begin = 0; begin < size; begin += chunkSize)
+                    {
+                        auto end = std::min(size, begin + chunkSize);
+                        group.run([this, &function, archetype, begin, end]() {
+                            // Each task needs its own fetchers, as preparing them changes their state.
+                            auto fetchers = *mData.mFetchers;
+                            auto tick = mData.mFilter->tick();
+                            std::apply([&](auto&... fetcher) { (fetcher.prepare(&archetype, -1, tick), ...); },
+                                       fetchers);
+                            for (auto row = begin; row < end; ++row)
+                            {
+                                std::apply([&](auto&... fetcher) { function(fetcher.fetch(row)...); }, fetchers);
+                            }
+                            std::apply([](auto&... fetcher) { (fetcher.flush(), ...); }, fetchers);
+                        });
+                    }
+                }
+            }
+            else
+            {
+                std::vector<std::tuple<Ts...>> chunk;
+                auto flush = [&]() {
+                    group.run([&function, matches = std::move(chunk)]() {
+                        for (const auto& match : matches)
+                        {
+                            std::apply(function, match);
+                        }
+                    });
+                    chunk.clear();
+                };
+
+                for (auto match : *this)
+                {
+                    chunk.emplace_back(match);
+                    if (chunk.size() == chunkSize)
+                    {
+                        flush();
+                    }
+                }
+
+                if (!chunk.empty())
+                {
+                    flush();
+                }
+            }
+
+            group.wait();
+        }
+
     private:
         QueryData& mData;
         QueryFilter::View mView;
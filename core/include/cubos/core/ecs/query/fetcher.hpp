@@ -4,6 +4,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
 #include <cubos/core/ecs/query/term.hpp>
 #include <cubos/core/ecs/world.hpp>
 #include <cubos/core/memory/opt.hpp>
@@ -47,10 +54,12 @@ namespace cubos::core::ecs
         /// may be called multiple times after this.
         /// @param targetArchetypes Pointer to array with the archetype identifiers for the targets.
         /// @param depth Depth of the sparse relation table, if applicable.
-        void prepare(const ArchetypeId* targetArchetypes, int depth)
+        /// @param tick Tick with which components accessed mutably should be marked as changed.
+        void prepare(const ArchetypeId* targetArchetypes, int depth, uint64_t tick)
         {
             (void)targetArchetypes;
             (void)depth;
+            (void)tick;
 
             // This should never be instantiated. This method is only defined for documentation purposes.
             static_assert(AlwaysFalse<T>, "Invalid query argument type");
@@ -67,6 +76,39 @@ namespace cubos::core::ecs
             static_assert(AlwaysFalse<T>, "Invalid query argument type");
         }
 
+        /// @brief Called once the data fetched since the last call is no longer being accessed, so that the components
+        /// which are compared on write can be marked as changed if they were written to.
+        void flush()
+        {
+            // This should never be instantiated. This method is only defined for documentation purposes.
+            static_assert(AlwaysFalse<T>, "Invalid query argument type");
+        }
+
+        /// @brief Called when the data fetched since the last call may still be written to after the next @ref flush,
+        /// so that the components fetched mutably are marked as changed right away, even if compared on write.
+        void mark()
+        {
+            // This should never be instantiated. This method is only defined for documentation purposes.
+            static_assert(AlwaysFalse<T>, "Invalid query argument type");
+        }
+
+        /// @brief Called to get the data for a range of rows of a dense table at once. Always called after
+        /// @ref prepare() has been called at least once, and only for queries without relations.
+        ///
+        /// Components are returned as spans over their columns, while entities are returned as a span of indices.
+        ///
+        /// @param begin First row.
+        /// @param end Row after the last row.
+        /// @return Span with the data of each row.
+        auto chunk(std::size_t begin, std::size_t end)
+        {
+            (void)begin;
+            (void)end;
+
+            // This should never be instantiated. This method is only defined for documentation purposes.
+            static_assert(AlwaysFalse<T>, "Invalid query argument type");
+        }
+
     private:
         // Looks dumb, but this is necessary to make the static_assert's only trigger when the template is instantiated.
         // Reference: https://stackoverflow.com/questions/44059557/whats-the-right-way-to-call-static-assertfalse
@@ -74,6 +116,137 @@ namespace cubos::core::ecs
         static constexpr bool AlwaysFalse = false;
     };
 
+    /// @brief Marks the components fetched mutably by a query as changed.
+    ///
+    /// By default, rows are marked as soon as they're fetched. If the term of the component asks for it (see @ref
+    /// QueryTerm::Component::compare), a copy of each fetched row is kept instead, and the row is only marked on @ref
+    /// flush if its value differs from the copy.
+    ///
+    /// @tparam T Component type.
+    /// @ingroup core-ecs-query
+    template <typename T>
+    class QueryChangeTracker
+    {
+    public:
+        /// @brief Constructs.
+        /// @param world World being queried.
+        /// @param compare Whether rows are only marked as changed if their value was actually written to.
+        QueryChangeTracker(World& world, bool compare)
+            : mWorld{world}
+            , mCompare{compare}
+        {
+            CUBOS_ASSERT(!compare || std::is_trivially_copyable_v<T>,
+                         "Only trivially copyable components can be compared on write");
+        }
+
+        /// @brief Called when the given rows are fetched mutably.
+        /// @param archetype Archetype of the table which holds the rows.
+        /// @param values Values of the column.
+        /// @param ticks Changed ticks of the column.
+        /// @param tick Tick with which the rows are marked.
+        /// @param begin First row.
+        /// @param end Row after the last row.
+        void track(ArchetypeId archetype, const T* values, uint64_t* ticks, uint64_t tick, std::size_t begin,
+                   std::size_t end)
+        {
+            if (!mCompare)
+            {
+                std::fill(ticks + begin, ticks + end, tick);
+                return;
+            }
+
+            if constexpr (std::is_trivially_copyable_v<T>)
+            {
+                // Consecutive rows of the same table, such as those fetched while iterating, share a range.
+                if (mRanges.empty() || mRanges.back().archetype != archetype || mRanges.back().tick != tick ||
+                    mRanges.back().begin + mRanges.back().count != begin)
+                {
+                    mRanges.push_back(
+                        {.archetype = archetype, .tick = tick, .begin = begin, .count = 0, .offset = mCopies.size()});
+                }
+
+                mRanges.back().count += end - begin;
+                mCopies.insert(mCopies.end(), values + begin, values + end);
+            }
+        }
+
+        /// @brief Marks the tracked rows whose values differ from when they were fetched as changed.
+        /// @param column Column of the component.
+        void flush(ColumnId column)
+        {
+            this->stamp(column, true);
+        }
+
+        /// @brief Marks all tracked rows as changed, whether they were written to or not.
+        ///
+        /// Used when the fetched data outlives the query's views, and thus may be written to after any flush.
+        ///
+        /// @param column Column of the component.
+        void mark(ColumnId column)
+        {
+            this->stamp(column, false);
+        }
+
+    private:
+        /// @brief Consecutive rows of a table which were fetched.
+        struct Range
+        {
+            ArchetypeId archetype; ///< Archetype of the table.
+            uint64_t tick;         ///< Tick with which written rows are marked.
+            std::size_t begin;     ///< First row.
+            std::size_t count;     ///< Number of rows.
+            std::size_t offset;    ///< Index of the copy of the first row.
+        };
+
+        /// @brief Marks the tracked rows as changed and stops tracking them.
+        /// @param column Column of the component.
+        /// @param compare Whether only rows whose values differ from their copies are marked.
+        void stamp(ColumnId column, bool compare)
+        {
+            if constexpr (std::is_trivially_copyable_v<T>)
+            {
+                // The tables are looked up again, as their columns may have been reallocated since the rows were
+                // fetched. Rows which were moved around meanwhile are simply compared with the wrong copy, which at
+                // worst marks them as changed when they weren't.
+                auto& dense = mWorld.tables().dense();
+                for (const auto& range : mRanges)
+                {
+                    if (!dense.contains(range.archetype))
+                    {
+                        continue;
+                    }
+
+                    auto& table = dense.at(range.archetype);
+                    const auto* values = static_cast<const T*>(table.column(column).data());
+                    auto ticks = table.changedTicks(column);
+                    auto end = std::min(range.begin + range.count, table.size());
+                    for (auto row = range.begin; row < end; ++row)
+                    {
+                        // Copied out of the vector first, as std::vector<bool> doesn't store its elements directly.
+                        T copy = mCopies[range.offset + row - range.begin];
+                        if (!compare || std::memcmp(&values[row], &copy, sizeof(T)) != 0)
+                        {
+                            ticks[row] = range.tick;
+                        }
+                    }
+                }
+
+                mRanges.clear();
+                mCopies.clear();
+            }
+            else
+            {
+                (void)column;
+                (void)compare;
+            }
+        }
+
+        World& mWorld;              ///< World being queried.
+        bool mCompare;              ///< Whether rows are only marked if they were written to.
+        std::vector<Range> mRanges; ///< Rows fetched since the last flush.
+        std::vector<T> mCopies;     ///< Values of the rows when they were fetched.
+    };
+
     template <>
     class QueryFetcher<Entity>
     {
@@ -89,7 +262,7 @@ namespace cubos::core::ecs
             return QueryTerm::makeEntity(-1);
         }
 
-        void prepare(const ArchetypeId* targetArchetypes, int /*depth*/)
+        void prepare(const ArchetypeId* targetArchetypes, int /*depth*/, uint64_t /*tick*/)
         {
             mTable = &mWorld.tables().dense().at(targetArchetypes[mTarget]);
         }
@@ -101,6 +274,19 @@ namespace cubos::core::ecs
             return {index, generation};
         }
 
+        std::span<const uint32_t> chunk(std::size_t begin, std::size_t end)
+        {
+            return mTable->entities().subspan(begin, end - begin);
+        }
+
+        void flush()
+        {
+        }
+
+        void mark()
+        {
+        }
+
     private:
         World& mWorld;
         DenseTable* mTable{nullptr};
@@ -114,6 +300,7 @@ namespace cubos::core::ecs
         QueryFetcher(World& world, const QueryTerm& term)
             : mWorld{world}
             , mDataType{world.types().id(reflection::reflect<T>())}
+            , mTracker{world, world.types().isComponent(mDataType) && term.component.compare}
             , mIsComponent{world.types().isComponent(mDataType)}
             , mIsSymmetric{world.types().isSymmetricRelation(mDataType)}
         {
@@ -145,12 +332,16 @@ namespace cubos::core::ecs
             CUBOS_FAIL("Query arguments of the form T& must be components or relations");
         }
 
-        void prepare(const ArchetypeId* targetArchetypes, int depth)
+        void prepare(const ArchetypeId* targetArchetypes, int depth, uint64_t tick)
         {
             if (mIsComponent)
             {
                 auto id = ColumnId::make(mDataType);
-                mColumn = &mWorld.tables().dense().at(targetArchetypes[mTargets[0]]).column(id);
+                mArchetype = targetArchetypes[mTargets[0]];
+                auto& table = mWorld.tables().dense().at(mArchetype);
+                mColumn = &table.column(id);
+                mChangedTicks = table.changedTicks(id).data();
+                mTick = tick;
             }
             else
             {
@@ -171,16 +362,38 @@ namespace cubos::core::ecs
         {
             if (mColumn != nullptr)
             {
+                mTracker.track(mArchetype, static_cast<const T*>(mColumn->data()), mChangedTicks, mTick, row, row + 1);
                 return *static_cast<T*>(mColumn->at(row));
             }
 
             return *static_cast<T*>(mSparseRelationTable->at(row));
         }
 
+        std::span<T> chunk(std::size_t begin, std::size_t end)
+        {
+            CUBOS_ASSERT(mColumn != nullptr, "Only components can be accessed in chunks");
+            mTracker.track(mArchetype, static_cast<const T*>(mColumn->data()), mChangedTicks, mTick, begin, end);
+            return {static_cast<T*>(mColumn->data()) + begin, end - begin};
+        }
+
+        void flush()
+        {
+            mTracker.flush(ColumnId::make(mDataType));
+        }
+
+        void mark()
+        {
+            mTracker.mark(ColumnId::make(mDataType));
+        }
+
     private:
         World& mWorld;
         DataTypeId mDataType;
+        ArchetypeId mArchetype{ArchetypeId::Invalid};
         memory::AnyVector* mColumn{nullptr};
+        uint64_t* mChangedTicks{nullptr};
+        uint64_t mTick{0};
+        QueryChangeTracker<T> mTracker;
         SparseRelationTable* mSparseRelationTable{nullptr};
         int mTargets[2];
         bool mIsComponent;
@@ -225,7 +438,7 @@ namespace cubos::core::ecs
             CUBOS_FAIL("Query arguments of the form const T& must be components or relations");
         }
 
-        void prepare(const ArchetypeId* targetArchetypes, int depth)
+        void prepare(const ArchetypeId* targetArchetypes, int depth, uint64_t /*tick*/)
         {
             if (mIsComponent)
             {
@@ -257,6 +470,20 @@ namespace cubos::core::ecs
             return *static_cast<const T*>(mSparseRelationTable->at(row));
         }
 
+        std::span<const T> chunk(std::size_t begin, std::size_t end)
+        {
+            CUBOS_ASSERT(mColumn != nullptr, "Only components can be accessed in chunks");
+            return {static_cast<const T*>(mColumn->data()) + begin, end - begin};
+        }
+
+        void flush()
+        {
+        }
+
+        void mark()
+        {
+        }
+
     private:
         World& mWorld;
         DataTypeId mDataType;
@@ -274,6 +501,7 @@ namespace cubos::core::ecs
         QueryFetcher(World& world, const QueryTerm& term)
             : mWorld{world}
             , mColumnId{ColumnId::make(world.types().id(reflection::reflect<T>()))}
+            , mTracker{world, term.component.compare}
             , mTarget{term.component.target}
         {
         }
@@ -287,11 +515,15 @@ namespace cubos::core::ecs
             return QueryTerm::makeOptComponent(type, -1);
         }
 
-        void prepare(const ArchetypeId* targetArchetypes, int /*depth*/)
+        void prepare(const ArchetypeId* targetArchetypes, int /*depth*/, uint64_t tick)
         {
-            if (mWorld.tables().dense().at(targetArchetypes[mTarget]).contains(mColumnId))
+            mArchetype = targetArchetypes[mTarget];
+            auto& table = mWorld.tables().dense().at(mArchetype);
+            if (table.contains(mColumnId))
             {
-                mColumn = &mWorld.tables().dense().at(targetArchetypes[mTarget]).column(mColumnId);
+                mColumn = &table.column(mColumnId);
+                mChangedTicks = table.changedTicks(mColumnId).data();
+                mTick = tick;
             }
             else
             {
@@ -306,13 +538,39 @@ namespace cubos::core::ecs
                 return {};
             }
 
+            mTracker.track(mArchetype, static_cast<const T*>(mColumn->data()), mChangedTicks, mTick, row, row + 1);
             return {*static_cast<T*>(mColumn->at(row))};
         }
 
+        std::span<T> chunk(std::size_t begin, std::size_t end)
+        {
+            if (mColumn == nullptr)
+            {
+                return {};
+            }
+
+            mTracker.track(mArchetype, static_cast<const T*>(mColumn->data()), mChangedTicks, mTick, begin, end);
+            return {static_cast<T*>(mColumn->data()) + begin, end - begin};
+        }
+
+        void flush()
+        {
+            mTracker.flush(mColumnId);
+        }
+
+        void mark()
+        {
+            mTracker.mark(mColumnId);
+        }
+
     private:
         World& mWorld;
         ColumnId mColumnId;
+        ArchetypeId mArchetype{ArchetypeId::Invalid};
         memory::AnyVector* mColumn{nullptr};
+        uint64_t* mChangedTicks{nullptr};
+        uint64_t mTick{0};
+        QueryChangeTracker<T> mTracker;
         int mTarget;
     };
 
@@ -337,7 +595,7 @@ namespace cubos::core::ecs
             return QueryTerm::makeOptComponent(type, -1);
         }
 
-        void prepare(const ArchetypeId* targetArchetypes, int /*depth*/)
+        void prepare(const ArchetypeId* targetArchetypes, int /*depth*/, uint64_t /*tick*/)
         {
             if (mWorld.tables().dense().at(targetArchetypes[mTarget]).contains(mColumnId))
             {
@@ -359,6 +617,24 @@ namespace cubos::core::ecs
             return {*static_cast<const T*>(mColumn->at(row))};
         }
 
+        std::span<const T> chunk(std::size_t begin, std::size_t end)
+        {
+            if (mColumn == nullptr)
+            {
+                return {};
+            }
+
+            return {static_cast<const T*>(mColumn->data()) + begin, end - begin};
+        }
+
+        void flush()
+        {
+        }
+
+        void mark()
+        {
+        }
+
     private:
         World& mWorld;
         ColumnId mColumnId;
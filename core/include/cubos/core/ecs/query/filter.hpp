@@ -35,8 +35,16 @@ namespace cubos::core::ecs
         std::size_t cursorIndex(std::size_t termIndex) const;
 
         /// @brief Fetches any new matching archetypes that have been added since the last call to this function.
+        ///
+        /// Also advances the query's change tick. From then on, only components which were added or changed since the
+        /// previous call to this function are matched by change and addition terms. Until the first call after
+        /// construction, every component is considered new.
         void update();
 
+        /// @brief Gets the tick with which changes made through the query should be stamped.
+        /// @return Change tick.
+        uint64_t tick() const;
+
         /// @brief Returns a view which can be used to iterate over the matches.
         /// @return View.
         View view();
@@ -45,6 +53,15 @@ namespace cubos::core::ecs
         /// @return Target count.
         int targetCount() const;
 
+        /// @brief Gets the archetypes matched by the query, if every match is a row of a dense table.
+        ///
+        /// This is the case when there's a single target, no relation terms and no change or addition terms. Then,
+        /// every row of the dense tables of the returned archetypes is a match, and there are no other matches.
+        ///
+        /// @return Matching archetypes, or null if the query has more than one target, or any relation, change or
+        /// addition term.
+        const std::vector<ArchetypeId>* denseArchetypes() const;
+
     private:
         World& mWorld;
 
@@ -57,6 +74,12 @@ namespace cubos::core::ecs
         /// @brief Number of nodes we have, limited to @ref QueryNode::MaxCursorCount.
         int mNodeCount{0};
 
+        /// @brief Tick of the previous call to @ref update. Changes made at or before it aren't matched.
+        uint64_t mLastTick{0};
+
+        /// @brief Tick of the last call to @ref update.
+        uint64_t mThisTick{0};
+
         /// @brief Nodes for each cursor. Order is not guaranteed and may change between calls to @ref update.
         QueryNode* mNodes[QueryNode::MaxCursorCount];
 
@@ -94,6 +117,10 @@ namespace cubos::core::ecs
         /// @return View.
         View pin(int target, Entity entity);
 
+        /// @brief Checks whether any target has been pinned.
+        /// @return Whether any target has been pinned.
+        bool pinned() const;
+
         /// @brief Returns an iterator pointing to the first query match.
         /// @return Iterator.
         Iterator begin();
@@ -25,6 +25,26 @@ namespace cubos::core::ecs
         /// @brief Forces the node to match only archetypes without the given column.
         void without(ColumnId column);
 
+        /// @brief Forces the node to match only rows whose value in the given column was changed recently.
+        ///
+        /// Must be used together with @ref with() for the same column.
+        ///
+        /// @param column Column.
+        /// @param any Whether it's enough for this or any other requirement added with @p any set to hold.
+        void changed(ColumnId column, bool any = false);
+
+        /// @brief Forces the node to match only rows whose value in the given column was added recently.
+        ///
+        /// Must be used together with @ref with() for the same column.
+        ///
+        /// @param column Column.
+        /// @param any Whether it's enough for this or any other requirement added with @p any set to hold.
+        void added(ColumnId column, bool any = false);
+
+        /// @brief Checks whether the node filters out rows, and not only archetypes.
+        /// @return Whether there are any change or addition requirements.
+        bool filtersRows() const;
+
         /// @brief Returns whether two nodes are equivalent.
         /// @param other Other node.
         bool equivalent(const QueryArchetypeNode& other) const;
@@ -40,8 +60,20 @@ namespace cubos::core::ecs
         bool next(World& world, TargetMask pins, Iterator& iterator) const override;
 
     private:
+        /// @brief Checks if the given row matches the change and addition requirements.
+        /// @param world World.
+        /// @param archetype Archetype of the row.
+        /// @param row Row index.
+        /// @param sinceTick Changes at or before this tick are ignored.
+        /// @return Whether the row matches.
+        bool recent(World& world, ArchetypeId archetype, std::size_t row, uint64_t sinceTick) const;
+
         std::vector<ColumnId> mWith;
         std::vector<ColumnId> mWithout;
+        std::vector<ColumnId> mChanged;
+        std::vector<ColumnId> mAdded;
+        std::vector<ColumnId> mAnyChanged;
+        std::vector<ColumnId> mAnyAdded;
 
         /// @brief Archetype which only and all of the columns in mWith.
         ArchetypeId mBaseArchetype{ArchetypeId::Invalid};
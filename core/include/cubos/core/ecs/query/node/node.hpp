@@ -5,6 +5,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 
 #include <cubos/core/ecs/entity/archetype_id.hpp>
 
@@ -96,5 +97,8 @@ namespace cubos::core::ecs
 
         /// @brief Row number of each cursor. The first 'target count' rows are reserved for the target rows.
         std::size_t cursorRows[MaxCursorCount];
+
+        /// @brief Components added or changed at or before this tick aren't considered added or changed.
+        uint64_t sinceTick;
     };
 } // namespace cubos::core::ecs
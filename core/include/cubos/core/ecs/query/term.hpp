@@ -41,6 +41,10 @@ namespace cubos::core::ecs
             int target;    ///< Index of the target accessed by this term.
             bool without;  ///< If true, requires the target to not have the component.
             bool optional; ///< If true, the term accesses the component but does not require it to be present.
+            bool changed;  ///< If true, requires the component to have changed since the query was last updated.
+            bool added;    ///< If true, requires the component to have been added since the query was last updated.
+            bool any;      ///< If true, the change or addition is one of many alternatives, of which one must hold.
+            bool compare;  ///< If true, mutable accesses only mark the component as changed if it was written to.
         };
 
         /// @brief Stores relation term data.
@@ -82,6 +86,36 @@ namespace cubos::core::ecs
         /// @return Component term.
         static QueryTerm makeWithoutComponent(DataTypeId type, int target);
 
+        /// @brief Returns a new component term for the given component and target, which only matches if the component
+        /// was changed since the query was last updated.
+        /// @warning Undefined behaviour will occur if @p type isn't registered as a component.
+        /// @param type Component type.
+        /// @param target Index of the target which must have the component.
+        /// @param any Whether it's enough for any of the change or addition terms of the target marked as such to hold.
+        /// @return Component term.
+        static QueryTerm makeChangedComponent(DataTypeId type, int target, bool any = false);
+
+        /// @brief Returns a new component term for the given component and target, which only matches if the component
+        /// was added since the query was last updated.
+        /// @warning Undefined behaviour will occur if @p type isn't registered as a component.
+        /// @param type Component type.
+        /// @param target Index of the target which must have the component.
+        /// @param any Whether it's enough for any of the change or addition terms of the target marked as such to hold.
+        /// @return Component term.
+        static QueryTerm makeAddedComponent(DataTypeId type, int target, bool any = false);
+
+        /// @brief Returns a new component term for the given component and target, which, when accessed mutably, is
+        /// only marked as changed if its value was actually written to.
+        ///
+        /// Instead of marking the component as changed as soon as it's fetched, a copy of it is kept and compared
+        /// once the query's iteration ends. Only supported for trivially copyable components.
+        ///
+        /// @warning Undefined behaviour will occur if @p type isn't registered as a component.
+        /// @param type Component type.
+        /// @param target Index of the target which must have the component.
+        /// @return Component term.
+        static QueryTerm makeComparedComponent(DataTypeId type, int target);
+
         /// @brief Returns a new optional component term for the given component and target.
         /// @warning Undefined behaviour will occur if @p type isn't registered as a component.
         /// @param type Component type.
@@ -40,6 +40,17 @@ namespace cubos::core::ecs
         CUBOS_REFLECT;
     };
 
+    /// @brief Trait used to identify resources which may only be accessed from the main thread.
+    ///
+    /// Systems which access resources with this trait are never dispatched to worker threads by the @ref Schedule.
+    /// Should be used, for example, by resources which wrap graphics contexts bound to the main thread.
+    ///
+    /// @ingroup core-ecs
+    struct CUBOS_CORE_API MainThreadTrait
+    {
+        CUBOS_REFLECT;
+    };
+
     /// @brief Builder for @ref reflection::Type objects which represent ECS types.
     ///
     /// Used to reduce the amount of boilerplate code required to define a ECS types.
@@ -84,6 +95,14 @@ namespace cubos::core::ecs
             return std::move(*this);
         }
 
+        /// @brief Makes the type only accessible from the main thread. Only used by resource types.
+        /// @return Builder.
+        TypeBuilder&& mainThread() &&
+        {
+            mType.with(MainThreadTrait{});
+            return std::move(*this);
+        }
+
         /// @brief Adds a field to the type.
         /// @tparam F Field type.
         /// @param name Field name.
@@ -20,6 +20,11 @@ namespace cubos::core::ecs
         /// @brief Whether the system accesses the world directly.
         bool usesWorld{false};
 
+        /// @brief Whether the system must run on the main thread.
+        ///
+        /// Set when the system accesses the world directly or a resource with the @ref MainThreadTrait.
+        bool mainThread{false};
+
         /// @brief Set of data types accessed by the system.
         std::unordered_set<DataTypeId, DataTypeIdHash> dataTypes;
 
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cubos/core/ecs/system/access.hpp>
 #include <cubos/core/ecs/system/arguments/event/pipe.hpp>
 #include <cubos/core/ecs/system/fetcher.hpp>
 #include <cubos/core/ecs/world.hpp>
@@ -160,13 +161,13 @@ namespace cubos::core::ecs
 
         SystemFetcher(World& world, const SystemOptions& /*options*/)
             : mPipe{world.resource<EventPipe<T>>()}
+            , mTypeId{world.types().id(reflection::reflect<EventPipe<T>>())}
         {
         }
 
-        void analyze(SystemAccess& /*access*/) const
+        void analyze(SystemAccess& access) const
         {
-            // FIXME: when we add resources to the world type registry, we should the event type id to the access
-            // object.
+            access.dataTypes.insert(mTypeId);
         }
 
         EventReader<T> fetch(const SystemContext& /*ctx*/)
@@ -176,6 +177,7 @@ namespace cubos::core::ecs
 
     private:
         const EventPipe<T>& mPipe;
+        DataTypeId mTypeId;
         std::size_t mIndex{0};
     };
 } // namespace cubos::core::ecs
@@ -0,0 +1,88 @@
+/// @file
+/// @brief Class @ref cubos::core::ecs::Parallel and its fetcher.
+/// @ingroup core-ecs-system-arguments
+
+#pragma once
+
+#include <cstddef>
+
+#include <cubos/core/ecs/system/access.hpp>
+#include <cubos/core/ecs/system/fetcher.hpp>
+#include <cubos/core/thread/pool.hpp>
+
+namespace cubos::core::ecs
+{
+    /// @brief System argument which allows splitting work which isn't tied to a query into parallel tasks.
+    ///
+    /// Tasks run on the pool the system was given. If there's no pool, they're simply run sequentially.
+    ///
+    /// @code{.cpp}
+    ///     parallel.forEach(3, [&](std::size_t axis) {
+    ///         sortAxis(axis);
+    ///     });
+    /// @endcode
+    ///
+    /// @ingroup core-ecs-system-arguments
+    class Parallel
+    {
+    public:
+        /// @brief Constructs.
+        /// @param pool Pool used to run the tasks, or null.
+        Parallel(thread::ThreadPool* pool)
+            : mPool{pool}
+        {
+        }
+
+        /// @brief Calls the given function for each index in the range `[0, count)`, possibly concurrently.
+        ///
+        /// Blocks until all calls return.
+        ///
+        /// @tparam F Function type.
+        /// @param count Number of calls.
+        /// @param function Function, which receives the index of the call.
+        template <typename F>
+        void forEach(std::size_t count, F function)
+        {
+            if (mPool == nullptr || count <= 1)
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    function(i);
+                }
+                return;
+            }
+
+            // The first call runs on the current thread, which would otherwise be waiting for the others.
+            thread::TaskGroup group{*mPool};
+            for (std::size_t i = 1; i < count; ++i)
+            {
+                group.run([&function, i]() { function(i); });
+            }
+            function(0);
+            group.wait();
+        }
+
+    private:
+        thread::ThreadPool* mPool;
+    };
+
+    template <>
+    class SystemFetcher<Parallel>
+    {
+    public:
+        static inline constexpr bool ConsumesOptions = false;
+
+        SystemFetcher(World& /*world*/, const SystemOptions& /*options*/)
+        {
+        }
+
+        void analyze(SystemAccess& /*access*/) const
+        {
+        }
+
+        Parallel fetch(const SystemContext& ctx) // NOLINT(readability-convert-member-functions-to-static)
+        {
+            return {ctx.pool};
+        }
+    };
+} // namespace cubos::core::ecs
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <cubos/core/ecs/plugin_queue.hpp>
+#include <cubos/core/ecs/system/access.hpp>
 #include <cubos/core/ecs/system/fetcher.hpp>
 
 namespace cubos::core::ecs
@@ -47,8 +48,10 @@ namespace cubos::core::ecs
         {
         }
 
-        void analyze(SystemAccess& /*access*/) const
+        void analyze(SystemAccess& access) const // NOLINT(readability-convert-member-functions-to-static)
         {
+            // Plugin changes affect the whole application, so they must never happen concurrently with other systems.
+            access.usesWorld = true;
         }
 
         static Plugins fetch(const SystemContext& ctx)
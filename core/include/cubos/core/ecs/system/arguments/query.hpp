@@ -24,6 +24,9 @@ namespace cubos::core::ecs
     /// to `Rotation` and `Scale` components are also passed but may be null if the component is
     /// not present in the entity. Whenever mutability is not needed, `const` should be used.
     ///
+    /// Queries over many entities can be iterated in parallel through @ref parEach, as long as the system is being run
+    /// with a thread pool available.
+    ///
     /// @tparam Ts Argument types.
     /// @ingroup core-ecs-system-arguments
     template <typename... Ts>
@@ -32,10 +35,15 @@ namespace cubos::core::ecs
     public:
         using Iterator = typename QueryData<Ts...>::View::Iterator;
 
+        /// @brief Default maximum number of matches processed by each task in @ref parEach.
+        static constexpr std::size_t DefaultChunkSize = 1024;
+
         /// @brief Constructs.
         /// @param view Query data view.
-        Query(typename QueryData<Ts...>::View view)
+        /// @param pool Pool used to iterate in parallel, or null.
+        Query(typename QueryData<Ts...>::View view, thread::ThreadPool* pool = nullptr)
             : mView{view}
+            , mPool{pool}
         {
         }
 
@@ -62,7 +70,7 @@ namespace cubos::core::ecs
         /// @return Query.
         Query pin(int target, Entity entity)
         {
-            return {mView.pin(target, entity)};
+            return {mView.pin(target, entity), mPool};
         }
 
         /// @brief Accesses the match for the given entity, if there is one.
@@ -113,8 +121,54 @@ namespace cubos::core::ecs
             return count;
         }
 
+        /// @brief Calls the given function once for each table of matches, with spans over the table's rows.
+        ///
+        /// Each component argument is passed as a span over its column, each `Opt` argument as a span which is empty
+        /// if the table doesn't have the component, and `Entity` arguments as spans of entity indices. All non-empty
+        /// spans passed in a call have the same size. This allows writing tight loops over raw arrays:
+        ///
+        /// @code{.cpp}
+        ///     query.eachChunk([&](std::span<Position> positions, std::span<const Velocity> velocities) {
+        ///         for (std::size_t i = 0; i < positions.size(); ++i)
+        ///         {
+        ///             positions[i].vec += velocities[i].vec * deltaTime.value;
+        ///         }
+        ///     });
+        /// @endcode
+        ///
+        /// Only supported by unpinned queries with a single target and without relation, change or addition terms.
+        ///
+        /// @tparam F Function type.
+        /// @param function Function.
+        template <typename F>
+        void eachChunk(F function)
+        {
+            mView.eachChunk(function);
+        }
+
+        /// @brief Calls the given function for each match, in parallel, with the match's arguments.
+        ///
+        /// The matches are split into chunks which run on the pool the system was given. If there's no pool, or the
+        /// query is pinned, the function is simply called sequentially. Blocks until all matches are processed.
+        ///
+        /// @code{.cpp}
+        ///     query.parEach([&](Position& position, const Velocity& velocity) {
+        ///         position.vec += velocity.vec * deltaTime.value;
+        ///     });
+        /// @endcode
+        ///
+        /// @tparam F Function type.
+        /// @param function Function, which may be called concurrently from multiple threads.
+        /// @param chunkSize Maximum number of matches processed by each task.
+        template <typename F>
+        void parEach(F function, std::size_t chunkSize = DefaultChunkSize)
+        {
+            mView.parEach(mPool, chunkSize, function);
+        }
+
     private:
         typename QueryData<Ts...>::View mView;
+        thread::ThreadPool* mPool;
     };
 
     template <typename... Ts>
@@ -143,10 +197,10 @@ namespace cubos::core::ecs
 
             if (mObservedTarget != -1)
             {
-                return {mData.view().pin(mObservedTarget, ctx.observedEntity)};
+                return {mData.view().pin(mObservedTarget, ctx.observedEntity), ctx.pool};
             }
 
-            return {mData.view()};
+            return {mData.view(), ctx.pool};
         }
 
     private:
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cubos/core/ecs/reflection.hpp>
 #include <cubos/core/ecs/system/access.hpp>
 #include <cubos/core/ecs/system/fetcher.hpp>
 #include <cubos/core/ecs/world.hpp>
@@ -24,6 +25,11 @@ namespace cubos::core::ecs
         void analyze(SystemAccess& access) const
         {
             access.dataTypes.insert(mWorld.types().id(reflection::reflect<T>()));
+
+            if (reflection::reflect<T>().template has<MainThreadTrait>())
+            {
+                access.mainThread = true;
+            }
         }
 
         T& fetch(const SystemContext& /*ctx*/)
@@ -49,6 +55,11 @@ namespace cubos::core::ecs
         void analyze(SystemAccess& access) const
         {
             access.dataTypes.insert(mWorld.types().id(reflection::reflect<T>()));
+
+            if (reflection::reflect<T>().template has<MainThreadTrait>())
+            {
+                access.mainThread = true;
+            }
         }
 
         const T& fetch(const SystemContext& /*ctx*/)
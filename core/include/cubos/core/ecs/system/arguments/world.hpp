@@ -23,6 +23,7 @@ namespace cubos::core::ecs
         void analyze(SystemAccess& access) const // NOLINT(readability-convert-member-functions-to-static)
         {
             access.usesWorld = true;
+            access.mainThread = true;
         }
 
         World& fetch(const SystemContext& /*ctx*/)
@@ -48,6 +49,7 @@ namespace cubos::core::ecs
         void analyze(SystemAccess& access) const // NOLINT(readability-convert-member-functions-to-static)
         {
             access.usesWorld = true;
+            access.mainThread = true;
         }
 
         const World& fetch(const SystemContext& /*ctx*/)
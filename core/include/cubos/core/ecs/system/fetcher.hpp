@@ -6,6 +6,11 @@
 
 #include <cubos/core/ecs/entity/entity.hpp>
 
+namespace cubos::core::thread
+{
+    class ThreadPool;
+} // namespace cubos::core::thread
+
 namespace cubos::core::ecs
 {
     class Cubos;
@@ -26,6 +31,9 @@ namespace cubos::core::ecs
 
         /// @brief Entity which triggered the system, if it's an observer.
         Entity observedEntity{};
+
+        /// @brief Pool which the system may use to run work in parallel, if any.
+        thread::ThreadPool* pool = nullptr;
     };
 
     /// @brief Type meant to be specialized which implements for each argument type the necessary logic to extract it
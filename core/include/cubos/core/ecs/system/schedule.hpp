@@ -10,6 +10,11 @@
 #include <cubos/core/ecs/system/registry.hpp>
 #include <cubos/core/memory/opt.hpp>
 
+namespace cubos::core::thread
+{
+    class ThreadPool;
+} // namespace cubos::core::thread
+
 namespace cubos::core::ecs
 {
     /// @brief Stores schedule nodes and the restrictions that must be met for them to run.
@@ -65,10 +70,16 @@ namespace cubos::core::ecs
     ///
     /// # Concurrency
     ///
-    /// This algorithm makes it easy to run systems concurrently. To do this, we just have to distribute the work
-    /// between threads each time a node is popped from the queue. One thing to keep in mind is that this class by
-    /// itself doesn't solve node conflicts. If two nodes write to the same resource, for example, and if they aren't
-    /// ordered, an arbitrary order constraint should be added between them, to ensure that they won't run concurrently.
+    /// This algorithm makes it easy to run systems concurrently. When a thread pool is passed to @ref run, instead of
+    /// executing the nodes one by one, every satisfied node whose @ref SystemAccess doesn't intersect with the accesses
+    /// of the nodes currently running is dispatched to the pool. Nodes which conflict with running nodes are kept in
+    /// the queue until the conflicting nodes finish. Nodes which must run on the main thread, such as those which
+    /// access the world directly, are executed by the calling thread.
+    ///
+    /// The schedule state itself is only ever updated by the calling thread. Commands issued by systems are committed
+    /// only when no other node is running, and the nodes which depend on a node with pending commands are only
+    /// satisfied after those commands have been committed. Thus, from the point of view of each system, the effects of
+    /// the nodes ordered before it are always visible, just like in the sequential execution.
     ///
     /// @ingroup core-ecs-system
     class CUBOS_CORE_API Schedule
@@ -133,6 +144,15 @@ namespace cubos::core::ecs
         /// @param context Context to run the systems with.
         void run(SystemRegistry& registry, SystemContext& context);
 
+        /// @brief Runs the systems in the schedule, executing non-conflicting nodes concurrently on the given pool.
+        ///
+        /// Blocks until all nodes have finished. The pool must have at least one thread.
+        ///
+        /// @param registry Registry containing the systems.
+        /// @param context Context to run the systems with.
+        /// @param pool Thread pool to dispatch nodes to.
+        void run(SystemRegistry& registry, SystemContext& context, thread::ThreadPool& pool);
+
         /// @brief Generates a multi-line string which represents the order in which the nodes will run.
         ///
         /// The obtained order is not necessarily the one in which the nodes will run.
@@ -202,11 +222,29 @@ namespace cubos::core::ecs
         /// @return Node identifier, or nothing if the given repeat node is not a repeat node.
         memory::Opt<NodeId> node(memory::Opt<NodeId> repeatId);
 
-        /// @brief Runs a specific node.
+        /// @brief Resets the state of all nodes and pushes the initially satisfied ones to the queue.
+        void reset();
+
+        /// @brief Gets the access patterns of the system or condition associated to the given node.
+        /// @param registry Registry containing the systems.
+        /// @param nodeId Node identifier.
+        /// @return Access patterns.
+        const SystemAccess& access(SystemRegistry& registry, NodeId nodeId) const;
+
+        /// @brief Executes the system or condition associated to the given node, without updating any node state.
+        ///
+        /// Safe to call concurrently for nodes whose access patterns don't intersect.
+        ///
         /// @param registry Registry containing the systems.
         /// @param context Context to run the systems with.
         /// @param nodeId Node identifier.
-        void run(SystemRegistry& registry, SystemContext& context, NodeId nodeId);
+        /// @return Condition result, or true if the node is a system node.
+        bool execute(SystemRegistry& registry, SystemContext& context, NodeId nodeId) const;
+
+        /// @brief Updates the state of the schedule after a node has been executed and its commands committed.
+        /// @param nodeId Node identifier.
+        /// @param result Value returned by @ref execute for the node.
+        void finish(NodeId nodeId, bool result);
 
         /// @brief Checks if there is an ordering restriction between the given nodes in the given direction.
         /// @param before Before node identifier.
@@ -10,6 +10,7 @@
 #include <cubos/core/ecs/system/arguments/commands.hpp>
 #include <cubos/core/ecs/system/arguments/event/reader.hpp>
 #include <cubos/core/ecs/system/arguments/event/writer.hpp>
+#include <cubos/core/ecs/system/arguments/parallel.hpp>
 #include <cubos/core/ecs/system/arguments/query.hpp>
 #include <cubos/core/ecs/system/arguments/resources.hpp>
 #include <cubos/core/ecs/system/arguments/world.hpp>
@@ -4,7 +4,7 @@
 
 #pragma once
 
-#include <unordered_map>
+#include <memory>
 #include <vector>
 
 #include <cubos/core/ecs/entity/archetype_graph.hpp>
@@ -58,6 +58,7 @@ namespace cubos::core::ecs
         const DenseTable& at(ArchetypeId archetype) const;
 
     private:
-        std::unordered_map<std::size_t, DenseTable> mTables;
+        /// @brief Tables indexed by archetype identifier, null for archetypes without a table.
+        std::vector<std::unique_ptr<DenseTable>> mTables;
     };
 } // namespace cubos::core::ecs
@@ -4,7 +4,9 @@
 
 #pragma once
 
-#include <unordered_map>
+#include <cstdint>
+#include <memory>
+#include <span>
 #include <vector>
 
 #include <cubos/core/ecs/table/column.hpp>
@@ -13,6 +15,14 @@
 namespace cubos::core::ecs
 {
     /// @brief Stores the dense data associated to entities of a given archetype.
+    ///
+    /// Besides the data itself, each column stores, for each row, the ticks at which the value was added and last
+    /// changed. These are used by queries to filter out components which haven't been added or changed recently.
+    ///
+    /// Avoids hashing and searching on every access: columns are kept in a flat array sorted by their identifiers,
+    /// alongside a direct map from data type identifiers to their positions, and the row of each entity is stored in a
+    /// paged array indexed by entity index, whose pages are only allocated when needed and freed once empty.
+    ///
     /// @ingroup core-ecs-table
     class CUBOS_CORE_API DenseTable final
     {
@@ -67,6 +77,10 @@ namespace cubos::core::ecs
         /// @return Entity index.
         uint32_t entity(std::size_t row) const;
 
+        /// @brief Gets the indices of the entities stored in each row, in row order.
+        /// @return Entity indices.
+        std::span<const uint32_t> entities() const;
+
         /// @brief Gets the number of rows in the table.
         /// @return Number of rows.
         std::size_t size() const;
@@ -82,14 +96,90 @@ namespace cubos::core::ecs
         /// @copydoc column(ColumnId)
         const memory::AnyVector& column(ColumnId id) const;
 
+        /// @brief Gets the ticks at which the values of the column with the given @p id were added, one per row.
+        ///
+        /// Aborts if the column does not exist in the table.
+        ///
+        /// @param id Column identifier.
+        /// @return Added ticks.
+        std::span<uint64_t> addedTicks(ColumnId id);
+
+        /// @copydoc addedTicks(ColumnId)
+        std::span<const uint64_t> addedTicks(ColumnId id) const;
+
+        /// @brief Gets the ticks at which the values of the column with the given @p id were last changed, one per
+        /// row.
+        ///
+        /// Aborts if the column does not exist in the table.
+        ///
+        /// @param id Column identifier.
+        /// @return Changed ticks.
+        std::span<uint64_t> changedTicks(ColumnId id);
+
+        /// @copydoc changedTicks(ColumnId)
+        std::span<const uint64_t> changedTicks(ColumnId id) const;
+
         /// @brief Checks if the table has a column with the given @p id.
         /// @param id Column identifier.
         /// @return Whether the table contains the given column.
         bool contains(ColumnId id) const;
 
     private:
-        std::vector<uint32_t> mEntities;
-        std::unordered_map<uint32_t, std::size_t> mEntityToRow;
-        std::unordered_map<uint64_t, memory::AnyVector> mColumns;
+        /// @brief Data and change ticks of a column.
+        struct Column
+        {
+            memory::AnyVector data;             ///< Value of each row.
+            std::vector<uint64_t> addedTicks;   ///< Tick at which the value of each row was added.
+            std::vector<uint64_t> changedTicks; ///< Tick at which the value of each row was last changed.
+        };
+
+        /// @brief Row value which indicates that an entity isn't in the table.
+        static constexpr uint32_t NoRow = UINT32_MAX;
+
+        /// @brief Number of entity indices covered by each page of @ref mRowPages.
+        static constexpr std::size_t RowPageSize = 1024;
+
+        /// @brief Position value which indicates that a data type has no column in the table.
+        static constexpr uint32_t NoColumn = UINT32_MAX;
+
+        /// @brief Gets the column with the given @p id, aborting if it doesn't exist.
+        /// @param id Column identifier.
+        /// @return Column.
+        Column& find(ColumnId id);
+
+        /// @copydoc find(ColumnId)
+        const Column& find(ColumnId id) const;
+
+        /// @brief Gets the position of the column with the given @p id in @ref mColumns.
+        /// @param id Column identifier.
+        /// @return Column position, or the number of columns if it doesn't exist.
+        std::size_t position(ColumnId id) const;
+
+        /// @brief Gets a reference to where the row of the given entity is stored, allocating its page if necessary.
+        /// @param index Entity index.
+        /// @return Row reference, set to @ref NoRow if the entity isn't in the table.
+        uint32_t& rowSlot(uint32_t index);
+
+        /// @brief Sets the row of the given entity, which must not be in the table yet.
+        /// @param index Entity index.
+        /// @param row Row.
+        void insertRow(uint32_t index, uint32_t row);
+
+        /// @brief Forgets the row of the given entity, which must be in the table, freeing its page if it's left empty.
+        /// @param index Entity index.
+        /// @return Row the entity was stored in.
+        std::size_t eraseRow(uint32_t index);
+
+        /// @brief Gets the row of the given entity.
+        /// @param index Entity index.
+        /// @return Row, or @ref NoRow if the entity isn't in the table.
+        uint32_t findRow(uint32_t index) const;
+
+        std::vector<uint32_t> mEntities;                    ///< Index of the entity in each row.
+        std::vector<std::unique_ptr<uint32_t[]>> mRowPages; ///< Pages with the row of each entity, or null.
+        std::vector<uint32_t> mRowPageSizes;                ///< Number of entities in each page of @ref mRowPages.
+        std::vector<uint64_t> mColumnIds;                   ///< Sorted identifiers of the columns.
+        std::vector<Column> mColumns;                       ///< Columns, in the same order as @ref mColumnIds.
+        std::vector<uint32_t> mColumnPositions; ///< Position of the column of each data type, or @ref NoColumn.
     };
 } // namespace cubos::core::ecs
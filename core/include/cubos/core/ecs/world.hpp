@@ -4,8 +4,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <span>
 
 #include <cubos/core/ecs/entity/archetype_graph.hpp>
 #include <cubos/core/ecs/entity/pool.hpp>
@@ -213,7 +216,8 @@ namespace cubos::core::ecs
 
         /// @brief Reserves an entity identifier, without actually creating an entity.
         ///
-        /// The entity can be later created with a call to @ref createAt().
+        /// The entity can be later created with a call to @ref createAt(). Thread-safe, and can be called while other
+        /// threads read from the world, as the identifier is only added to the world on @ref createAt().
         ///
         /// @return Entity identifier.
         Entity reserve();
@@ -369,6 +373,21 @@ namespace cubos::core::ecs
         /// @return Number of alive entities.
         std::size_t entityCount() const;
 
+        /// @brief Gets the current change tick of the world.
+        ///
+        /// Component additions and changes are stamped with change ticks, which queries use to find out which
+        /// components were added or changed since they were last updated.
+        ///
+        /// @return Change tick.
+        uint64_t tick() const;
+
+        /// @brief Increments the change tick of the world.
+        ///
+        /// Thread-safe, as queries of systems running concurrently may advance the tick at the same time.
+        ///
+        /// @return New change tick, greater than any previously returned tick.
+        uint64_t advanceTick();
+
     private:
         /// @brief Called when an entity's depth changes. Propagates the change to incoming relations.
         /// @param index To entity index.
@@ -395,6 +414,7 @@ namespace cubos::core::ecs
         Tables mTables;
         Observers* mObservers;
         memory::TypeMap<memory::AnyValue> mResources;
+        std::atomic<uint64_t> mTick{0};
     };
 
     class CUBOS_CORE_API World::Components final
@@ -473,6 +493,16 @@ namespace cubos::core::ecs
             return this->add(reflection::reflect<T>(), &value);
         }
 
+        /// @brief Adds multiple components to the entity at once.
+        ///
+        /// Equivalent to calling @ref add(const reflection::Type&, void*) for each component, but the entity is moved
+        /// directly to its final archetype, instead of once per component. Observers are only notified after all
+        /// components have been added.
+        ///
+        /// @param components Component values to move.
+        /// @return Reference to this.
+        Components& addMany(std::span<memory::AnyValue> components);
+
         /// @brief Removes a component from the entity.
         ///
         /// If the entity doesn't have the component, nothing happens.
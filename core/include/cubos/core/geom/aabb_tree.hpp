@@ -0,0 +1,155 @@
+/// @file
+/// @brief Class @ref cubos::core::geom::AABBTree.
+/// @ingroup core-geom
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include <cubos/core/api.hpp>
+#include <cubos/core/geom/aabb.hpp>
+#include <cubos/core/geom/frustum.hpp>
+
+namespace cubos::core::geom
+{
+    /// @brief Bounding volume hierarchy of axis-aligned bounding boxes, which can be updated incrementally.
+    ///
+    /// Each leaf stores a box and a user value, and is identified by a proxy returned on insertion. Leaf boxes are
+    /// enlarged by a margin, so that moving them only changes the tree once they leave their enlarged box. Insertions
+    /// pick the sibling which least increases the surface area of the tree, and rotations keep it balanced, so that
+    /// queries visit a logarithmic number of nodes for well distributed boxes.
+    ///
+    /// Queries return the values of all leaves whose enlarged box touches the queried volume, and thus may include
+    /// values a bit outside of it.
+    ///
+    /// @ingroup core-geom
+    class CUBOS_CORE_API AABBTree
+    {
+    public:
+        /// @brief Identifier of an invalid proxy.
+        static constexpr std::size_t Null = SIZE_MAX;
+
+        /// @brief Constructs an empty tree.
+        /// @param margin Distance by which leaf boxes are enlarged on each side.
+        AABBTree(float margin = 1.0F);
+
+        /// @brief Removes all leaves.
+        void clear();
+
+        /// @brief Gets the number of leaves in the tree.
+        /// @return Number of leaves.
+        std::size_t size() const;
+
+        /// @brief Gets the height of the tree, which is zero for trees with at most one leaf.
+        /// @return Height of the tree.
+        int height() const;
+
+        /// @brief Inserts a new leaf.
+        /// @param aabb Box of the leaf.
+        /// @param value Value stored in the leaf.
+        /// @return Proxy which identifies the leaf.
+        std::size_t insert(const AABB& aabb, std::size_t value);
+
+        /// @brief Removes a leaf.
+        /// @param proxy Proxy of the leaf.
+        void remove(std::size_t proxy);
+
+        /// @brief Updates the box of a leaf, only changing the tree if the box left the enlarged box of the leaf.
+        /// @param proxy Proxy of the leaf.
+        /// @param aabb New box of the leaf.
+        /// @return Whether the tree changed.
+        bool move(std::size_t proxy, const AABB& aabb);
+
+        /// @brief Gets the value stored in a leaf.
+        /// @param proxy Proxy of the leaf.
+        /// @return Value.
+        std::size_t value(std::size_t proxy) const;
+
+        /// @brief Sets the value stored in a leaf.
+        /// @param proxy Proxy of the leaf.
+        /// @param value Value.
+        void value(std::size_t proxy, std::size_t value);
+
+        /// @brief Gets the enlarged box of a leaf.
+        /// @param proxy Proxy of the leaf.
+        /// @return Enlarged box.
+        const AABB& bounds(std::size_t proxy) const;
+
+        /// @brief Finds the leaves which are at least partially inside the given frustum.
+        /// @param frustum Frustum.
+        /// @param[out] values Values of the leaves found, appended in no particular order.
+        void query(const Frustum& frustum, std::vector<std::size_t>& values) const;
+
+        /// @brief Finds the leaves which overlap the given box.
+        /// @param aabb Box.
+        /// @param[out] values Values of the leaves found, appended in no particular order.
+        void query(const AABB& aabb, std::vector<std::size_t>& values) const;
+
+        /// @brief Finds the leaves which overlap the given sphere.
+        /// @param center Center of the sphere.
+        /// @param radius Radius of the sphere.
+        /// @param[out] values Values of the leaves found, appended in no particular order.
+        void query(const glm::vec3& center, float radius, std::vector<std::size_t>& values) const;
+
+    private:
+        /// @brief Node of the tree, which is either a leaf, an internal node with two children, or free.
+        struct Node
+        {
+            AABB bounds;                         ///< Box which contains the node's leaves.
+            std::size_t parent{Null};            ///< Parent node, or next free node if the node is free.
+            std::size_t children[2]{Null, Null}; ///< Children nodes, which are null for leaves.
+            std::size_t value{0};                ///< Value stored in the node, if it's a leaf.
+            int height{-1};                      ///< Zero for leaves, larger for internal nodes, -1 for free nodes.
+        };
+
+        /// @brief Gets a free node, growing the node pool if needed.
+        /// @return Node index.
+        std::size_t allocate();
+
+        /// @brief Returns a node to the free list.
+        /// @param node Node index.
+        void release(std::size_t node);
+
+        /// @brief Links a leaf into the tree.
+        /// @param leaf Leaf index.
+        void insertLeaf(std::size_t leaf);
+
+        /// @brief Unlinks a leaf from the tree, without freeing it.
+        /// @param leaf Leaf index.
+        void removeLeaf(std::size_t leaf);
+
+        /// @brief Recomputes the boxes and heights of a node and its ancestors, balancing them on the way up.
+        /// @param node Node index.
+        void refit(std::size_t node);
+
+        /// @brief Rotates the subtree of the given node if it's unbalanced.
+        /// @param a Node index.
+        /// @return Index of the node which is now the root of the subtree.
+        std::size_t balance(std::size_t a);
+
+        /// @brief How much of a box is inside a queried volume.
+        enum class Overlap
+        {
+            None,    ///< The box is outside the volume.
+            Partial, ///< The box is partially inside the volume.
+            Full,    ///< The box is completely inside the volume, and thus so are all of its leaves.
+        };
+
+        /// @brief Visits the tree, appending the values of the leaves whose boxes overlap a volume.
+        /// @tparam F Classifier type.
+        /// @param classify Function which returns how much of a given box is inside the volume.
+        /// @param[out] values Values of the leaves found.
+        template <typename F>
+        void visit(F classify, std::vector<std::size_t>& values) const;
+
+        float mMargin;             ///< Distance by which leaf boxes are enlarged.
+        std::vector<Node> mNodes;  ///< Node pool.
+        std::size_t mRoot{Null};   ///< Root node.
+        std::size_t mFree{Null};   ///< First free node.
+        std::size_t mLeafCount{0}; ///< Number of leaves.
+    };
+} // namespace cubos::core::geom
@@ -0,0 +1,96 @@
+/// @file
+/// @brief Class @ref cubos::core::gl::NullRenderDevice.
+/// @ingroup core-gl
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include <cubos/core/gl/render_device.hpp>
+
+namespace cubos::core::gl
+{
+    /// @brief Render device which doesn't render anything, and instead only counts the work it is asked to do.
+    ///
+    /// Every resource it creates is valid but empty, and every operation is a no-op, which makes it usable without a
+    /// GPU or a display. Useful for dedicated servers, which don't need to render, and for measuring the CPU cost of
+    /// submitting work to the render device.
+    ///
+    /// @see @ref io::openHeadlessWindow() creates a window with one of these.
+    /// @ingroup core-gl
+    class CUBOS_CORE_API NullRenderDevice : public RenderDevice
+    {
+    public:
+        /// @brief Work submitted to the render device since the counters were last reset.
+        struct Counters
+        {
+            std::size_t drawCalls = 0;        ///< Number of draw calls.
+            std::size_t vertices = 0;         ///< Number of vertices drawn, counting every instance.
+            std::size_t instances = 0;        ///< Number of instances drawn.
+            std::size_t dispatches = 0;       ///< Number of compute dispatches.
+            std::size_t clears = 0;           ///< Number of clears of any kind.
+            std::size_t stateChanges = 0;     ///< Number of state, resource and constant binds.
+            std::size_t bufferBytes = 0;      ///< Bytes uploaded to buffers, on creation and through fills.
+            std::size_t textureUpdates = 0;   ///< Number of texture updates, including initial data.
+            std::size_t resourcesCreated = 0; ///< Number of resources created.
+        };
+
+        NullRenderDevice();
+
+        /// @brief Gets the counters of the work submitted since the last reset.
+        /// @return Counters.
+        const Counters& counters() const;
+
+        /// @brief Resets all counters to zero.
+        void resetCounters();
+
+        Framebuffer createFramebuffer(const FramebufferDesc& desc) override;
+        void setFramebuffer(Framebuffer fb) override;
+        RasterState createRasterState(const RasterStateDesc& desc) override;
+        void setRasterState(RasterState rs) override;
+        DepthStencilState createDepthStencilState(const DepthStencilStateDesc& desc) override;
+        void setDepthStencilState(DepthStencilState dss) override;
+        BlendState createBlendState(const BlendStateDesc& desc) override;
+        void setBlendState(BlendState bs) override;
+        Sampler createSampler(const SamplerDesc& desc) override;
+        Texture2D createTexture2D(const Texture2DDesc& desc) override;
+        Texture2DArray createTexture2DArray(const Texture2DArrayDesc& desc) override;
+        Texture3D createTexture3D(const Texture3DDesc& desc) override;
+        CubeMap createCubeMap(const CubeMapDesc& desc) override;
+        PixelPackBuffer createPixelPackBuffer(std::size_t size) override;
+        ConstantBuffer createConstantBuffer(std::size_t size, const void* data, Usage usage) override;
+        IndexBuffer createIndexBuffer(std::size_t size, const void* data, IndexFormat format, Usage usage) override;
+        void setIndexBuffer(IndexBuffer ib) override;
+        VertexBuffer createVertexBuffer(std::size_t size, const void* data, Usage usage) override;
+        VertexArray createVertexArray(const VertexArrayDesc& desc) override;
+        void setVertexArray(VertexArray va) override;
+        ShaderStage createShaderStage(Stage stage, const char* src) override;
+        ShaderPipeline createShaderPipeline(ShaderStage vs, ShaderStage ps) override;
+        ShaderPipeline createShaderPipeline(ShaderStage vs, ShaderStage gs, ShaderStage ps) override;
+        ShaderPipeline createShaderPipeline(ShaderStage cs) override;
+        Timer createTimer() override;
+        void setShaderPipeline(ShaderPipeline pipeline) override;
+        void clearColor(float r, float g, float b, float a) override;
+        void clearTargetColor(std::size_t target, float r, float g, float b, float a) override;
+        void clearTargetColor(std::size_t target, int r, int g, int b, int a) override;
+        void clearTargetColor(std::size_t target, unsigned int r, unsigned int g, unsigned int b,
+                              unsigned int a) override;
+        void clearDepth(float depth) override;
+        void clearStencil(int stencil) override;
+        void drawLines(std::size_t offset, std::size_t count) override;
+        void drawTriangles(std::size_t offset, std::size_t count) override;
+        void drawTrianglesIndexed(std::size_t offset, std::size_t count) override;
+        void drawTrianglesInstanced(std::size_t offset, std::size_t count, std::size_t instanceCount) override;
+        void drawTrianglesIndexedInstanced(std::size_t offset, std::size_t count, std::size_t instanceCount) override;
+        void dispatchCompute(std::size_t x, std::size_t y, std::size_t z) override;
+        void memoryBarrier(MemoryBarriers barriers) override;
+        void setViewport(int x, int y, int w, int h) override;
+        void setScissor(int x, int y, int w, int h) override;
+        int getProperty(Property prop) override;
+
+    private:
+        /// @brief Shared with the created resources, which may outlive the device and also update the counters.
+        std::shared_ptr<Counters> mCounters;
+    };
+} // namespace cubos::core::gl
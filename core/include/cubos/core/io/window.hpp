@@ -142,6 +142,16 @@ namespace cubos::core::io
     CUBOS_CORE_API Window openWindow(const std::string& title = "Cubos", const glm::ivec2& size = {800, 600},
                                      bool vSync = true);
 
+    /// @brief Opens a window which isn't displayed and doesn't need a display or a GPU.
+    ///
+    /// It never receives input, and its render device is a @ref gl::NullRenderDevice, which only counts the work
+    /// submitted to it. Useful for dedicated servers and for benchmarking.
+    ///
+    /// @param size Window size, in screen coordinates.
+    /// @return New window.
+    /// @ingroup core-io
+    CUBOS_CORE_API Window openHeadlessWindow(const glm::ivec2& size = {800, 600});
+
     /// @brief Converts a @ref MouseButton enum to a string.
     /// @param button MouseButton to convert.
     /// @return String representation.
@@ -143,6 +143,17 @@ namespace cubos::core::memory
         /// @copydoc at(std::size_t)
         const void* at(std::size_t index) const;
 
+        /// @brief Gets a pointer to the first element of the vector.
+        ///
+        /// Elements are stored contiguously, each taking as many bytes as the size of the element type, and thus the
+        /// result can be cast to a pointer to an array of the element type.
+        ///
+        /// @return Pointer to the first element, or null if the vector has never allocated memory.
+        void* data();
+
+        /// @copydoc data()
+        const void* data() const;
+
         /// @brief Get the number of elements in the vector.
         /// @return Element count.
         std::size_t size() const;
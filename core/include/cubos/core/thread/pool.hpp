@@ -1,29 +1,62 @@
 /// @file
-/// @brief Class @ref cubos::core::thread::ThreadPool.
+/// @brief Classes @ref cubos::core::thread::ThreadPool and @ref cubos::core::thread::TaskGroup.
 /// @ingroup core-thread
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <deque>
-#include <functional>
+#include <memory>
 #include <mutex>
+#include <new>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include <cubos/core/api.hpp>
 
 namespace cubos::core::thread
 {
+    class TaskGroup;
+
     /// @brief Manages a pool of threads, to which tasks can be submitted.
+    ///
+    /// Each worker thread owns a lock-free deque of tasks. Tasks submitted from within a worker are pushed to its own
+    /// deque, while tasks submitted from other threads are pushed to a queue shared by all workers. Workers first pick
+    /// tasks from their own deque, then from the shared queue and, when both are empty, steal from other workers.
+    ///
+    /// Tasks whose captures fit in @ref InlineSize bytes are stored without any additional allocation. The memory of
+    /// finished tasks is kept in per-worker free lists, so that submitting tasks doesn't allocate once the pool has
+    /// warmed up.
+    ///
     /// @note Blocks on tasks to finish on destruction.
     /// @ingroup core-thread
     class CUBOS_CORE_API ThreadPool final
     {
     public:
+        /// @brief Maximum size of the captures of a task for it to be stored inline.
+        static constexpr std::size_t InlineSize = 48;
+
+        /// @brief Maximum number of finished tasks whose memory is kept by each worker for reuse.
+        static constexpr std::size_t FreeListSize = 256;
+
+        /// @brief Statistics of a single worker thread.
+        struct Stats
+        {
+            std::size_t executed{0}; ///< Number of tasks executed by the worker.
+            std::size_t stolen{0};   ///< How many of the executed tasks were stolen from other workers.
+            std::size_t sleeps{0};   ///< Number of times the worker went to sleep due to lack of tasks.
+        };
+
         ~ThreadPool();
 
         /// @brief Constructs a pool with @p numThreads, starting them immediately.
+        ///
+        /// A pool without any threads is valid - its tasks are executed by whoever waits for them.
+        ///
         /// @param numThreads Number of threads to create.
         ThreadPool(std::size_t numThreads);
 
@@ -34,21 +67,184 @@ namespace cubos::core::thread
         /// @}
 
         /// @brief Adds a task to the thread pool. Starts when a thread becomes available.
+        /// @tparam F Task type.
         /// @param task Task to add.
-        void addTask(std::function<void()> task);
+        template <typename F>
+        void addTask(F task)
+        {
+            this->submit(new (this->allocate()) Job(std::move(task), nullptr));
+        }
 
-        /// @brief Blocks until all tasks finish.
+        /// @brief Blocks until all tasks finish, executing pending tasks in the meantime.
+        /// @note Must not be called from within a task of this pool - use a @ref TaskGroup instead.
         void wait();
 
+        /// @brief Gets the number of worker threads in the pool.
+        /// @return Number of worker threads.
+        std::size_t threadCount() const;
+
+        /// @brief Gets the statistics of the given worker thread.
+        /// @param worker Worker index, smaller than @ref threadCount().
+        /// @return Worker statistics.
+        Stats stats(std::size_t worker) const;
+
     private:
-        std::vector<std::thread> mThreads;        ///< Threads in the pool.
-        std::deque<std::function<void()>> mTasks; ///< Queue of tasks to execute.
+        friend TaskGroup;
+
+        /// @brief Type-erased task, which stores small callables inline.
+        class Job final
+        {
+        public:
+            ~Job() = default;
+
+            /// @brief Constructs.
+            /// @tparam F Callable type.
+            /// @param function Callable.
+            /// @param group Group the job belongs to, or null.
+            template <typename F>
+            Job(F function, TaskGroup* group)
+                : mGroup{group}
+            {
+                if constexpr (sizeof(F) <= InlineSize && alignof(F) <= alignof(std::max_align_t))
+                {
+                    mFunction = new (mStorage) F(std::move(function));
+                    mRun = [](void* callable) {
+                        (*static_cast<F*>(callable))();
+                        static_cast<F*>(callable)->~F();
+                    };
+                }
+                else
+                {
+                    mFunction = new F(std::move(function));
+                    mRun = [](void* callable) {
+                        (*static_cast<F*>(callable))();
+                        delete static_cast<F*>(callable);
+                    };
+                }
+            }
+
+            /// @name Forbid any kind of copying.
+            /// @{
+            Job(const Job&) = delete;
+            Job& operator=(const Job&) = delete;
+            /// @}
+
+            /// @brief Runs and destroys the stored callable. Must be called exactly once.
+            void run()
+            {
+                mRun(mFunction);
+            }
+
+            /// @brief Gets the group the job belongs to.
+            /// @return Group, or null.
+            TaskGroup* group() const
+            {
+                return mGroup;
+            }
+
+        private:
+            alignas(std::max_align_t) unsigned char mStorage[InlineSize]; ///< Inline storage for small callables.
+            void* mFunction;                                             ///< Stored callable.
+            void (*mRun)(void*);                                         ///< Runs and destroys the callable.
+            TaskGroup* mGroup;                                           ///< Group the job belongs to.
+        };
+
+        struct Worker;
+
+        /// @brief Gets memory for a job, reusing the memory of a finished job if possible.
+        /// @return Uninitialized memory with the size of a job.
+        void* allocate();
+
+        /// @brief Destroys a finished job and keeps its memory for reuse, or frees it if there's enough kept already.
+        /// @param job Job.
+        void release(Job* job);
+
+        /// @brief Queues a job for execution.
+        /// @param job Job.
+        void submit(Job* job);
+
+        /// @brief Runs jobs until the given counter reaches zero, sleeping when there's nothing to do.
+        /// @param pending Counter.
+        void help(const std::atomic<std::size_t>& pending);
+
+        /// @brief Tries to take a pending job.
+        /// @param worker Worker of this pool running on the current thread, or null.
+        /// @param stolen Set to true if the job was stolen from another worker.
+        /// @return Job, or null if none was found.
+        Job* take(Worker* worker, bool& stolen);
+
+        /// @brief Runs and releases a job, updating its counters.
+        /// @param job Job.
+        void execute(Job* job);
+
+        /// @brief Wakes up sleeping threads, if there are any.
+        /// @param all Whether all threads should be woken up, or just one.
+        void wake(bool all);
 
-        std::mutex mMutex;                 ///< Protects the tasks vector.
-        std::condition_variable mNewTask;  ///< Notifies threads when new tasks may be available.
-        std::condition_variable mTaskDone; ///< Notifies threads when a task has finished executing.
+        /// @brief Gets the worker of this pool running on the current thread.
+        /// @return Worker, or null if the current thread isn't a worker of this pool.
+        Worker* currentWorker() const;
+
+        /// @brief Function run by each worker thread.
+        /// @param index Worker index.
+        void work(std::size_t index);
+
+        std::vector<std::unique_ptr<Worker>> mWorkers; ///< Per-worker state.
+        std::vector<std::thread> mThreads;             ///< Threads in the pool.
+
+        std::mutex mSharedMutex;                 ///< Protects the shared queue and the shared free list.
+        std::deque<Job*> mShared;                ///< Jobs submitted from outside the workers.
+        std::vector<void*> mSharedFree;          ///< Memory of finished jobs, for threads outside of the pool.
+        std::atomic<std::size_t> mSharedSize{0}; ///< Size of the shared queue, checked before locking it.
+
+        std::mutex mMutex;                       ///< Used by threads to sleep.
+        std::condition_variable mWake;           ///< Notifies threads when jobs are queued or counters reach zero.
+        std::atomic<std::int64_t> mQueued{0};    ///< Number of jobs queued but not yet taken.
+        std::atomic<std::size_t> mActive{0};     ///< Number of jobs submitted but not yet finished.
+        std::atomic<std::size_t> mSleeping{0};   ///< Number of threads sleeping or about to sleep.
+        std::atomic<std::size_t> mNextVictim{0}; ///< Where non-worker threads start looking for jobs to steal.
+        bool mStop{false};                       ///< Set to true when the thread pool is being destroyed.
+    };
+
+    /// @brief Tracks a set of tasks submitted to a @ref ThreadPool, so that they can be waited for.
+    ///
+    /// Instead of simply blocking, waiting on a group executes pending tasks of the pool until the group's tasks are
+    /// done. This makes it safe to fork tasks and join them from within another task.
+    ///
+    /// @ingroup core-thread
+    class CUBOS_CORE_API TaskGroup final
+    {
+    public:
+        /// @brief Waits for the tasks of the group to finish.
+        ~TaskGroup();
+
+        /// @brief Constructs.
+        /// @param pool Pool to which the tasks will be submitted.
+        TaskGroup(ThreadPool& pool);
+
+        /// @name Forbid any kind of copying.
+        /// @{
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+        /// @}
+
+        /// @brief Adds a task to the group and submits it to the pool.
+        /// @tparam F Task type.
+        /// @param task Task to add.
+        template <typename F>
+        void run(F task)
+        {
+            mPending.fetch_add(1, std::memory_order_relaxed);
+            mPool.submit(new (mPool.allocate()) ThreadPool::Job(std::move(task), this));
+        }
+
+        /// @brief Executes pending tasks until all tasks of the group finish.
+        void wait();
+
+    private:
+        friend ThreadPool;
 
-        std::size_t mNumTasks; ///< Number of tasks currently being executed.
-        bool mStop;            ///< Set to true when the thread pool is being destroyed.
+        ThreadPool& mPool;                    ///< Pool to which the tasks are submitted.
+        std::atomic<std::size_t> mPending{0}; ///< Number of tasks of the group which haven't finished yet.
     };
 } // namespace cubos::core::thread
@@ -1,129 +1,456 @@
+#include <algorithm>
+#include <functional>
+#include <new>
+#include <thread>
+
 #include <cubos/core/ecs/blueprint.hpp>
 #include <cubos/core/ecs/command_buffer.hpp>
+#include <cubos/core/ecs/entity/hash.hpp>
 #include <cubos/core/ecs/world.hpp>
 #include <cubos/core/memory/any_value.hpp>
+#include <cubos/core/reflection/traits/constructible.hpp>
+#include <cubos/core/reflection/type.hpp>
 
 using cubos::core::ecs::CommandBuffer;
 using cubos::core::ecs::Entity;
+using cubos::core::ecs::World;
+using cubos::core::reflection::ConstructibleTrait;
+using cubos::core::reflection::Type;
+
+namespace
+{
+    using Command = cubos::core::memory::Function<void(World&)>;
+
+    /// @brief Identifies the operation performed by a recorded command.
+    enum class Opcode : uint8_t
+    {
+        InsertResource,
+        EraseResource,
+        Create,
+        Destroy,
+        Add,
+        Remove,
+        Relate,
+        Unrelate,
+        Custom,
+    };
+
+    /// @brief Command recorded in a lane.
+    struct Record
+    {
+        uint64_t sequence;    ///< Global order of the command in the buffer.
+        Opcode opcode;        ///< Operation to perform.
+        Entity entity;        ///< Entity the command operates on, or the origin of a relation.
+        Entity other;         ///< Destination of a relation.
+        const Type* type;     ///< Type of the component, relation or resource, if any.
+        void* value{nullptr}; ///< Value stored in the arena of the lane. For custom commands, a @ref Command.
+    };
+
+    /// @brief Size of the first block allocated by a lane's arena. Short-lived buffers rarely need more.
+    constexpr std::size_t MinBlockSize = 512;
+
+    /// @brief Maximum size of the blocks allocated by a lane's arena, which double in size until reaching it.
+    constexpr std::size_t MaxBlockSize = 64 * 1024;
+
+    /// @brief Used to give each buffer a unique identifier, which is never reused.
+    std::atomic<uint64_t> nextBufferId{0};
+
+    /// @brief Buffer whose lane was last used on the current thread.
+    thread_local uint64_t cachedBufferId = UINT64_MAX;
+
+    /// @brief Lane of @ref cachedBufferId for the current thread.
+    thread_local void* cachedLane = nullptr;
+} // namespace
+
+struct CommandBuffer::Lane
+{
+    /// @brief Contiguous memory region of the arena.
+    struct Block
+    {
+        std::unique_ptr<unsigned char[]> data;
+        std::size_t capacity;
+        std::size_t size;
+    };
+
+    std::thread::id thread;      ///< Thread which records into this lane.
+    std::vector<Record> records; ///< Recorded commands, in order.
+    std::vector<Block> blocks;   ///< Arena blocks, kept between commits.
+    std::size_t current{0};      ///< Block currently being allocated from.
+
+    /// @brief Allocates memory from the arena.
+    /// @param size Size in bytes.
+    /// @param alignment Alignment in bytes.
+    /// @return Pointer to the allocated memory.
+    void* allocate(std::size_t size, std::size_t alignment)
+    {
+        for (; current < blocks.size(); ++current)
+        {
+            auto& block = blocks[current];
+            auto base = reinterpret_cast<std::uintptr_t>(block.data.get());
+            auto offset = ((base + block.size + alignment - 1) & ~(alignment - 1)) - base;
+            if (offset + size <= block.capacity)
+            {
+                block.size = offset + size;
+                return block.data.get() + offset;
+            }
+        }
+
+        // No block has enough space left, thus we must allocate a new one.
+        auto blockSize = blocks.empty() ? MinBlockSize : std::min(blocks.back().capacity * 2, MaxBlockSize);
+        auto capacity = std::max(blockSize, size + alignment);
+        blocks.push_back({.data = std::make_unique_for_overwrite<unsigned char[]>(capacity),
+                          .capacity = capacity,
+                          .size = 0});
+        return this->allocate(size, alignment);
+    }
+
+    /// @brief Moves a value into the arena.
+    /// @param type Value type.
+    /// @param value Value to move.
+    /// @return Pointer to the stored value.
+    void* store(const Type& type, void* value)
+    {
+        const auto& constructible = type.get<ConstructibleTrait>();
+        auto* stored = this->allocate(constructible.size(), constructible.alignment());
+        constructible.moveConstruct(stored, value);
+        return stored;
+    }
+
+    /// @brief Destructs the values of all records and clears them, keeping the arena memory for later use.
+    void clear()
+    {
+        for (auto& record : records)
+        {
+            if (record.opcode == Opcode::Custom)
+            {
+                static_cast<Command*>(record.value)->~Command();
+            }
+            else if (record.value != nullptr)
+            {
+                record.type->get<ConstructibleTrait>().destruct(record.value);
+            }
+        }
+
+        records.clear();
+        for (auto& block : blocks)
+        {
+            block.size = 0;
+        }
+        current = 0;
+    }
+};
+
+/// @brief Applies a recorded command to the world.
+/// @param world World.
+/// @param record Command.
+static void execute(World& world, Record& record)
+{
+    switch (record.opcode)
+    {
+    case Opcode::InsertResource:
+        world.insertResource(cubos::core::memory::AnyValue::moveConstruct(*record.type, record.value));
+        break;
+    case Opcode::EraseResource:
+        world.eraseResource(*record.type);
+        break;
+    case Opcode::Create:
+        world.createAt(record.entity);
+        break;
+    case Opcode::Destroy:
+        world.destroy(record.entity);
+        break;
+    case Opcode::Add:
+        if (world.isAlive(record.entity))
+        {
+            world.components(record.entity).add(*record.type, record.value);
+        }
+        break;
+    case Opcode::Remove:
+        if (world.isAlive(record.entity))
+        {
+            world.components(record.entity).remove(*record.type);
+        }
+        break;
+    case Opcode::Relate:
+        if (world.isAlive(record.entity) && world.isAlive(record.other))
+        {
+            world.relate(record.entity, record.other, *record.type, record.value);
+        }
+        break;
+    case Opcode::Unrelate:
+        if (world.isAlive(record.entity) && world.isAlive(record.other))
+        {
+            world.unrelate(record.entity, record.other, *record.type);
+        }
+        break;
+    case Opcode::Custom:
+        (*static_cast<Command*>(record.value))(world);
+        break;
+    }
+}
 
 CommandBuffer::CommandBuffer(World& world)
     : mWorld(world)
+    , mId(nextBufferId.fetch_add(1, std::memory_order_relaxed))
 {
     // Do nothing.
 }
 
-void CommandBuffer::insertResource(memory::AnyValue value)
+CommandBuffer::~CommandBuffer()
 {
-    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto& lane : mLanes)
+    {
+        lane->clear();
+    }
+}
 
-    mCommands.emplace_back(
-        [value = memory::move(value)](World& world) mutable { world.insertResource(memory::move(value)); });
+void CommandBuffer::insertResource(memory::AnyValue value)
+{
+    auto& lane = this->lane();
+    lane.records.push_back({.sequence = mSequence.fetch_add(1, std::memory_order_relaxed),
+                            .opcode = Opcode::InsertResource,
+                            .entity = {},
+                            .other = {},
+                            .type = &value.type(),
+                            .value = lane.store(value.type(), value.get())});
 }
 
 void CommandBuffer::eraseResource(const reflection::Type& type)
 {
-    std::lock_guard<std::mutex> lock(mMutex);
-
-    mCommands.emplace_back([&type](World& world) { world.eraseResource(type); });
+    this->lane().records.push_back({.sequence = mSequence.fetch_add(1, std::memory_order_relaxed),
+                                    .opcode = Opcode::EraseResource,
+                                    .entity = {},
+                                    .other = {},
+                                    .type = &type});
 }
 
 Entity CommandBuffer::create()
 {
-    std::lock_guard<std::mutex> lock(mMutex);
-
     auto entity = mWorld.reserve();
-    mCommands.emplace_back([entity](World& world) { world.createAt(entity); });
+    this->lane().records.push_back({.sequence = mSequence.fetch_add(1, std::memory_order_relaxed),
+                                    .opcode = Opcode::Create,
+                                    .entity = entity,
+                                    .other = {},
+                                    .type = nullptr});
     return entity;
 }
 
 void CommandBuffer::destroy(Entity entity)
 {
-    std::lock_guard<std::mutex> lock(mMutex);
-
-    mCommands.emplace_back([entity](World& world) { world.destroy(entity); });
+    this->lane().records.push_back({.sequence = mSequence.fetch_add(1, std::memory_order_relaxed),
+                                    .opcode = Opcode::Destroy,
+                                    .entity = entity,
+                                    .other = {},
+                                    .type = nullptr});
 }
 
 std::unordered_map<std::string, Entity> CommandBuffer::spawn(const Blueprint& blueprint)
 {
+    // Relation to be inserted between two spawned entities.
+    struct Relation
+    {
+        Entity from;
+        Entity to;
+        memory::AnyValue value;
+    };
+
     std::unordered_map<std::string, Entity> nameToEntity{};
+    std::vector<Entity> entities{};
+    std::unordered_map<Entity, std::vector<memory::AnyValue>, EntityHash> components{};
+    std::vector<Relation> relations{};
 
+    // Gather everything first, so that each entity can be given all of its components at once.
     blueprint.instantiate(
         [&](const std::string& name) -> Entity {
-            auto entity = this->create();
+            auto entity = mWorld.reserve();
             nameToEntity.emplace(name, entity);
+            entities.push_back(entity);
             return entity;
         },
-        [&](Entity entity, memory::AnyValue component) { this->add(entity, component.type(), component.get()); },
+        [&](Entity entity, memory::AnyValue component) { components[entity].push_back(memory::move(component)); },
         [&](Entity fromEntity, Entity toEntity, memory::AnyValue relation) {
-            this->relate(fromEntity, toEntity, relation.type(), relation.get());
+            relations.push_back({fromEntity, toEntity, memory::move(relation)});
         });
 
-    return nameToEntity;
-}
+    this->push([entities = std::move(entities), components = std::move(components),
+                            relations = std::move(relations)](World& world) mutable {
+        for (auto entity : entities)
+        {
+            world.createAt(entity);
+        }
 
-void CommandBuffer::add(Entity entity, const reflection::Type& type, void* value)
-{
-    std::lock_guard<std::mutex> lock(mMutex);
+        for (auto entity : entities)
+        {
+            if (auto it = components.find(entity); it != components.end() && world.isAlive(entity))
+            {
+                world.components(entity).addMany(it->second);
+            }
+        }
 
-    mCommands.emplace_back([entity, value = memory::AnyValue::moveConstruct(type, value)](World& world) mutable {
-        if (world.isAlive(entity))
+        for (auto& relation : relations)
         {
-            world.components(entity).add(value.type(), value.get());
+            if (world.isAlive(relation.from) && world.isAlive(relation.to))
+            {
+                world.relate(relation.from, relation.to, relation.value.type(), relation.value.get());
+            }
         }
     });
+
+    return nameToEntity;
 }
 
-void CommandBuffer::remove(Entity entity, const reflection::Type& type)
+void CommandBuffer::add(Entity entity, const reflection::Type& type, void* value)
 {
-    std::lock_guard<std::mutex> lock(mMutex);
+    auto& lane = this->lane();
+    lane.records.push_back({.sequence = mSequence.fetch_add(1, std::memory_order_relaxed),
+                            .opcode = Opcode::Add,
+                            .entity = entity,
+                            .other = {},
+                            .type = &type,
+                            .value = lane.store(type, value)});
+}
 
-    mCommands.emplace_back([entity, &type](World& world) {
-        if (world.isAlive(entity))
-        {
-            world.components(entity).remove(type);
-        }
-    });
+void CommandBuffer::remove(Entity entity, const reflection::Type& type)
+{
+    this->lane().records.push_back({.sequence = mSequence.fetch_add(1, std::memory_order_relaxed),
+                                    .opcode = Opcode::Remove,
+                                    .entity = entity,
+                                    .other = {},
+                                    .type = &type});
 }
 
 void CommandBuffer::relate(Entity from, Entity to, const reflection::Type& type, void* value)
 {
-    std::lock_guard<std::mutex> lock(mMutex);
-
-    mCommands.emplace_back([from, to, value = memory::AnyValue::moveConstruct(type, value)](World& world) mutable {
-        if (world.isAlive(from) && world.isAlive(to))
-        {
-            world.relate(from, to, value.type(), value.get());
-        }
-    });
+    auto& lane = this->lane();
+    lane.records.push_back({.sequence = mSequence.fetch_add(1, std::memory_order_relaxed),
+                            .opcode = Opcode::Relate,
+                            .entity = from,
+                            .other = to,
+                            .type = &type,
+                            .value = lane.store(type, value)});
 }
 
 void CommandBuffer::unrelate(Entity from, Entity to, const reflection::Type& type)
 {
-    std::lock_guard<std::mutex> lock(mMutex);
-
-    mCommands.emplace_back([from, to, &type](World& world) {
-        if (world.isAlive(from) && world.isAlive(to))
-        {
-            world.unrelate(from, to, type);
-        }
-    });
+    this->lane().records.push_back({.sequence = mSequence.fetch_add(1, std::memory_order_relaxed),
+                                    .opcode = Opcode::Unrelate,
+                                    .entity = from,
+                                    .other = to,
+                                    .type = &type});
 }
 
 void CommandBuffer::push(memory::Function<void(World&)> command)
 {
-    std::lock_guard<std::mutex> lock(mMutex);
+    auto& lane = this->lane();
+    auto* stored = new (lane.allocate(sizeof(Command), alignof(Command))) Command(memory::move(command));
+    lane.records.push_back({.sequence = mSequence.fetch_add(1, std::memory_order_relaxed),
+                            .opcode = Opcode::Custom,
+                            .entity = {},
+                            .other = {},
+                            .type = nullptr,
+                            .value = stored});
+}
 
-    mCommands.emplace_back(memory::move(command));
+bool CommandBuffer::empty()
+{
+    return mSequence.load(std::memory_order_relaxed) == 0;
 }
 
 void CommandBuffer::commit()
 {
+    if (mSequence.load(std::memory_order_relaxed) == 0)
+    {
+        return;
+    }
+
+    // Most buffers are only recorded into by a single thread, in which case the commands are already in order.
+    auto nonEmpty =
+        std::count_if(mLanes.begin(), mLanes.end(), [](const auto& lane) { return !lane->records.empty(); });
+    if (nonEmpty == 1)
+    {
+        for (auto& lane : mLanes)
+        {
+            for (std::size_t i = 0; i < lane->records.size(); ++i)
+            {
+                execute(mWorld, lane->records[i]);
+            }
+        }
+    }
+    else
+    {
+        // Merge the lanes, always executing the command with the lowest sequence number next, so that commands are
+        // applied in the order in which they were recorded, even if they were recorded by different threads.
+        using Cursor = std::pair<uint64_t, std::size_t>; // Sequence number of the next command and lane index.
+        std::vector<Cursor> heap{};
+        std::vector<std::size_t> cursors(mLanes.size(), 0);
+        for (std::size_t i = 0; i < mLanes.size(); ++i)
+        {
+            if (!mLanes[i]->records.empty())
+            {
+                heap.emplace_back(mLanes[i]->records.front().sequence, i);
+            }
+        }
+        std::make_heap(heap.begin(), heap.end(), std::greater<>{});
+
+        while (!heap.empty())
+        {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<>{});
+            auto laneIndex = heap.back().second;
+            auto& records = mLanes[laneIndex]->records;
+            execute(mWorld, records[cursors[laneIndex]++]);
+
+            if (cursors[laneIndex] < records.size())
+            {
+                heap.back().first = records[cursors[laneIndex]].sequence;
+                std::push_heap(heap.begin(), heap.end(), std::greater<>{});
+            }
+            else
+            {
+                heap.pop_back();
+            }
+        }
+    }
+
+    for (auto& lane : mLanes)
+    {
+        lane->clear();
+    }
+
+    mSequence.store(0, std::memory_order_relaxed);
+}
+
+auto CommandBuffer::lane() -> Lane&
+{
+    // The first lane is checked before the thread-local cache, so that buffers used by a single thread, such as
+    // short-lived ones, don't evict the cached lanes of other buffers.
+    auto thread = std::this_thread::get_id();
+    if (auto* first = mFirstLane.load(std::memory_order_acquire); first != nullptr && first->thread == thread)
+    {
+        return *first;
+    }
+
+    if (cachedBufferId == mId)
+    {
+        return *static_cast<Lane*>(cachedLane);
+    }
+
     std::lock_guard<std::mutex> lock(mMutex);
 
-    for (auto& cmd : mCommands)
+    auto it = std::find_if(mLanes.begin(), mLanes.end(), [&](const auto& lane) { return lane->thread == thread; });
+    if (it == mLanes.end())
     {
-        cmd(mWorld);
+        mLanes.push_back(std::make_unique<Lane>());
+        mLanes.back()->thread = thread;
+        it = mLanes.end() - 1;
+
+        if (mLanes.size() == 1)
+        {
+            mFirstLane.store(it->get(), std::memory_order_release);
+            return **it;
+        }
     }
 
-    mCommands.clear();
+    cachedBufferId = mId;
+    cachedLane = it->get();
+    return **it;
 }
@@ -1,3 +1,4 @@
+#include <memory>
 #include <utility>
 
 #ifdef __EMSCRIPTEN__
@@ -15,6 +16,7 @@
 #include <cubos/core/reflection/external/string.hpp>
 #include <cubos/core/reflection/external/vector.hpp>
 #include <cubos/core/tel/logging.hpp>
+#include <cubos/core/thread/pool.hpp>
 
 #include "debugger.hpp"
 
@@ -23,10 +25,12 @@ using cubos::core::ecs::Cubos;
 using cubos::core::ecs::DeltaTime;
 using cubos::core::ecs::Name;
 using cubos::core::ecs::ShouldQuit;
+using cubos::core::ecs::SystemThreads;
 using cubos::core::memory::Opt;
 using cubos::core::net::Address;
 using cubos::core::net::TcpListener;
 using cubos::core::net::TcpStream;
+using cubos::core::thread::ThreadPool;
 
 CUBOS_REFLECT_IMPL(DeltaTime)
 {
@@ -46,6 +50,11 @@ CUBOS_REFLECT_IMPL(Arguments)
     return TypeBuilder<Arguments>("cubos::core::ecs::Arguments").wrap(&Arguments::value);
 }
 
+CUBOS_REFLECT_IMPL(SystemThreads)
+{
+    return TypeBuilder<SystemThreads>("cubos::core::ecs::SystemThreads").wrap(&SystemThreads::value);
+}
+
 struct Cubos::State
 {
     CommandBuffer cmdBuffer;
@@ -53,6 +62,8 @@ struct Cubos::State
     Opt<Schedule> startupSchedule;
     Opt<Schedule> mainSchedule;
     std::chrono::steady_clock::time_point lastUpdateTime;
+    std::unique_ptr<ThreadPool> threadPool; ///< Only used when more than one system thread is requested.
+    std::size_t threadCount;                ///< Number of system threads currently in use.
 };
 
 Cubos::~Cubos()
@@ -103,6 +114,7 @@ Cubos::Cubos(int argc, char** argv)
 
     this->resource<DeltaTime>();
     this->resource<ShouldQuit>();
+    this->resource<SystemThreads>();
     this->resource<Arguments>(Arguments{.value = arguments});
 }
 
@@ -284,6 +296,7 @@ void Cubos::reset()
 
     this->resource<DeltaTime>();
     this->resource<ShouldQuit>();
+    this->resource<SystemThreads>();
 }
 
 void Cubos::start()
@@ -295,6 +308,8 @@ void Cubos::start()
         .startupSchedule = {},
         .mainSchedule = {},
         .lastUpdateTime = {},
+        .threadPool = nullptr,
+        .threadCount = 1,
     };
 
     // Generate schedules.
@@ -364,8 +379,29 @@ bool Cubos::update()
         mState->startupSchedule->run(mSystemRegistry, ctx);
     }
 
+    // Recreate the thread pool if the requested number of system threads changed.
+    auto threadCount = mWorld->resource<SystemThreads>().value;
+    if (threadCount != mState->threadCount)
+    {
+        mState->threadPool.reset();
+        mState->threadCount = threadCount;
+        if (threadCount > 1)
+        {
+            mState->threadPool = std::make_unique<ThreadPool>(threadCount);
+        }
+        CUBOS_INFO("Running main systems on {} thread(s)", threadCount);
+    }
+
     // Run main systems.
-    mState->mainSchedule->run(mSystemRegistry, ctx);
+    ctx.pool = mState->threadPool.get();
+    if (mState->threadPool != nullptr)
+    {
+        mState->mainSchedule->run(mSystemRegistry, ctx, *mState->threadPool);
+    }
+    else
+    {
+        mState->mainSchedule->run(mSystemRegistry, ctx);
+    }
 
     // Update delta time.
     auto currentTime = std::chrono::steady_clock::now();
@@ -745,6 +781,131 @@ auto Cubos::SystemBuilder::withOpt(const reflection::Type& type, int target) &&
     return std::move(*this);
 }
 
+auto Cubos::SystemBuilder::changed(const reflection::Type& type, int target) && -> SystemBuilder&&
+{
+    CUBOS_ASSERT(mCubos.isRegistered(type), "No such component type {} was registered", type.name());
+    auto dataTypeId = mCubos.mWorld->types().id(type);
+    CUBOS_ASSERT(mCubos.mWorld->types().isComponent(dataTypeId), "Type {} isn't registered as a component",
+                 type.name());
+
+    if (mOptions.empty())
+    {
+        mOptions.emplace_back();
+    }
+
+    if (target == -1)
+    {
+        target = mDefaultTarget;
+    }
+    else
+    {
+        mDefaultTarget = target;
+    }
+
+    mOptions.back().queryTerms.emplace_back(QueryTerm::makeChangedComponent(dataTypeId, target));
+    return std::move(*this);
+}
+
+auto Cubos::SystemBuilder::added(const reflection::Type& type, int target) && -> SystemBuilder&&
+{
+    CUBOS_ASSERT(mCubos.isRegistered(type), "No such component type {} was registered", type.name());
+    auto dataTypeId = mCubos.mWorld->types().id(type);
+    CUBOS_ASSERT(mCubos.mWorld->types().isComponent(dataTypeId), "Type {} isn't registered as a component",
+                 type.name());
+
+    if (mOptions.empty())
+    {
+        mOptions.emplace_back();
+    }
+
+    if (target == -1)
+    {
+        target = mDefaultTarget;
+    }
+    else
+    {
+        mDefaultTarget = target;
+    }
+
+    mOptions.back().queryTerms.emplace_back(QueryTerm::makeAddedComponent(dataTypeId, target));
+    return std::move(*this);
+}
+
+auto Cubos::SystemBuilder::anyChanged(const reflection::Type& type, int target) && -> SystemBuilder&&
+{
+    CUBOS_ASSERT(mCubos.isRegistered(type), "No such component type {} was registered", type.name());
+    auto dataTypeId = mCubos.mWorld->types().id(type);
+    CUBOS_ASSERT(mCubos.mWorld->types().isComponent(dataTypeId), "Type {} isn't registered as a component",
+                 type.name());
+
+    if (mOptions.empty())
+    {
+        mOptions.emplace_back();
+    }
+
+    if (target == -1)
+    {
+        target = mDefaultTarget;
+    }
+    else
+    {
+        mDefaultTarget = target;
+    }
+
+    mOptions.back().queryTerms.emplace_back(QueryTerm::makeChangedComponent(dataTypeId, target, true));
+    return std::move(*this);
+}
+
+auto Cubos::SystemBuilder::anyAdded(const reflection::Type& type, int target) && -> SystemBuilder&&
+{
+    CUBOS_ASSERT(mCubos.isRegistered(type), "No such component type {} was registered", type.name());
+    auto dataTypeId = mCubos.mWorld->types().id(type);
+    CUBOS_ASSERT(mCubos.mWorld->types().isComponent(dataTypeId), "Type {} isn't registered as a component",
+                 type.name());
+
+    if (mOptions.empty())
+    {
+        mOptions.emplace_back();
+    }
+
+    if (target == -1)
+    {
+        target = mDefaultTarget;
+    }
+    else
+    {
+        mDefaultTarget = target;
+    }
+
+    mOptions.back().queryTerms.emplace_back(QueryTerm::makeAddedComponent(dataTypeId, target, true));
+    return std::move(*this);
+}
+
+auto Cubos::SystemBuilder::compareWrites(const reflection::Type& type, int target) && -> SystemBuilder&&
+{
+    CUBOS_ASSERT(mCubos.isRegistered(type), "No such component type {} was registered", type.name());
+    auto dataTypeId = mCubos.mWorld->types().id(type);
+    CUBOS_ASSERT(mCubos.mWorld->types().isComponent(dataTypeId), "Type {} isn't registered as a component",
+                 type.name());
+
+    if (mOptions.empty())
+    {
+        mOptions.emplace_back();
+    }
+
+    if (target == -1)
+    {
+        target = mDefaultTarget;
+    }
+    else
+    {
+        mDefaultTarget = target;
+    }
+
+    mOptions.back().queryTerms.emplace_back(QueryTerm::makeComparedComponent(dataTypeId, target));
+    return std::move(*this);
+}
+
 auto Cubos::SystemBuilder::without(const reflection::Type& type, int target) && -> SystemBuilder&&
 {
     CUBOS_ASSERT(mCubos.isRegistered(type), "No such component type {} was registered", type.name());
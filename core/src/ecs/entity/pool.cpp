@@ -8,29 +8,47 @@ void EntityPool::reset()
 {
     mEntries.clear();
     mFree = std::queue<uint32_t>();
+    mReserved = 0;
 }
 
 Entity EntityPool::create(ArchetypeId archetype)
 {
-    uint32_t index;
+    auto entity = this->reserve();
+    this->flush();
+    mEntries[entity.index].archetype = archetype;
+    return entity;
+}
+
+Entity EntityPool::reserve()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
     if (mFree.empty())
     {
-        index = static_cast<uint32_t>(mEntries.size());
-        mEntries.emplace_back();
-    }
-    else
-    {
-        index = mFree.front();
-        mFree.pop();
+        // New indices are handed out past the end of the entries, which are only grown on the next flush.
+        auto index = static_cast<uint32_t>(mEntries.size()) + mReserved;
+        mReserved += 1;
+        return {index, 0};
     }
 
-    mEntries[index].archetype = archetype;
+    // Free entries already have an invalid archetype, so nothing needs to be written.
+    auto index = mFree.front();
+    mFree.pop();
     return {index, mEntries[index].generation};
 }
 
+void EntityPool::flush()
+{
+    mEntries.resize(mEntries.size() + mReserved, Entry{.generation = 0, .archetype = ArchetypeId::Invalid});
+    mReserved = 0;
+}
+
 void EntityPool::destroy(uint32_t index)
 {
+    std::lock_guard<std::mutex> lock(mMutex);
+
     mEntries[index].generation += 1;
+    mEntries[index].archetype = ArchetypeId::Invalid;
     mFree.push(index);
 }
 
@@ -70,11 +70,23 @@ QueryFilter::QueryFilter(World& world, const std::vector<QueryTerm>& terms)
         auto columnId = ColumnId::make(term.type);
         if (term.component.without)
         {
+            CUBOS_ASSERT(!term.component.changed && !term.component.added,
+                         "Negated component terms can't require changes or additions");
             node.without(columnId);
         }
         else
         {
             node.with(columnId);
+
+            if (term.component.changed)
+            {
+                node.changed(columnId, term.component.any);
+            }
+
+            if (term.component.added)
+            {
+                node.added(columnId, term.component.any);
+            }
         }
     }
 
@@ -122,6 +134,9 @@ std::size_t QueryFilter::cursorIndex(std::size_t termIndex) const
 
 void QueryFilter::update()
 {
+    mLastTick = mThisTick;
+    mThisTick = mWorld.advanceTick();
+
     // Update the cache of each node.
     for (int i = 0; i < mNodeCount; ++i)
     {
@@ -143,6 +158,11 @@ void QueryFilter::update()
     }
 }
 
+uint64_t QueryFilter::tick() const
+{
+    return mThisTick;
+}
+
 auto QueryFilter::view() -> View
 {
     return {*this};
@@ -153,6 +173,23 @@ int QueryFilter::targetCount() const
     return mTargetCount;
 }
 
+const std::vector<ArchetypeId>* QueryFilter::denseArchetypes() const
+{
+    if (mNodeCount != 1)
+    {
+        return nullptr;
+    }
+
+    // With a single node, it must be the archetype node of the only target.
+    const auto* node = static_cast<const QueryArchetypeNode*>(mNodes[0]);
+    if (node->filtersRows())
+    {
+        return nullptr;
+    }
+
+    return &node->archetypes();
+}
+
 QueryFilter::View::View(QueryFilter& filter, QueryNode::TargetMask pinMask)
     : mFilter{filter}
     , mPinMask{pinMask}
@@ -207,6 +244,11 @@ auto QueryFilter::View::pin(int target, Entity entity) -> View
     return view;
 }
 
+bool QueryFilter::View::pinned() const
+{
+    return mPinMask != 0;
+}
+
 auto QueryFilter::View::begin() -> Iterator
 {
     return {*this, mDead};
@@ -227,6 +269,7 @@ QueryFilter::View::Iterator::Iterator(View& view, bool end)
     else
     {
         mNodeIndex = 0;
+        mIterator.sinceTick = mView.mFilter.mLastTick;
 
         // Reset all cursors.
         for (int i = 0; i < mView.mFilter.mNodeCount; ++i)
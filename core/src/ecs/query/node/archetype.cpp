@@ -2,6 +2,7 @@
 #include <cubos/core/ecs/world.hpp>
 
 using cubos::core::ecs::ArchetypeId;
+using cubos::core::ecs::ColumnId;
 using cubos::core::ecs::QueryArchetypeNode;
 
 QueryArchetypeNode::QueryArchetypeNode(int target)
@@ -22,37 +23,39 @@ void QueryArchetypeNode::without(ColumnId column)
     mWithout.emplace_back(column);
 }
 
-bool QueryArchetypeNode::equivalent(const QueryArchetypeNode& other) const
+void QueryArchetypeNode::changed(ColumnId column, bool any)
 {
-    if (mWith.size() != other.mWith.size() || mWithout.size() != other.mWithout.size())
-    {
-        return false;
-    }
+    CUBOS_ASSERT(mBaseArchetype == ArchetypeId::Invalid, "Method can only be called before the first call to update");
+    (any ? mAnyChanged : mChanged).emplace_back(column);
+}
 
-    for (const auto& col1 : mWith)
-    {
-        bool found = false;
+void QueryArchetypeNode::added(ColumnId column, bool any)
+{
+    CUBOS_ASSERT(mBaseArchetype == ArchetypeId::Invalid, "Method can only be called before the first call to update");
+    (any ? mAnyAdded : mAdded).emplace_back(column);
+}
 
-        for (const auto& col2 : other.mWith)
-        {
-            if (col1 == col2)
-            {
-                found = true;
-                break;
-            }
-        }
+bool QueryArchetypeNode::filtersRows() const
+{
+    return !mChanged.empty() || !mAdded.empty() || !mAnyChanged.empty() || !mAnyAdded.empty();
+}
 
-        if (!found)
-        {
-            return false;
-        }
+/// @brief Checks if two column vectors contain the same columns, ignoring order.
+/// @param lhs Columns.
+/// @param rhs Other columns.
+/// @return Whether they're equivalent.
+static bool sameColumns(const std::vector<ColumnId>& lhs, const std::vector<ColumnId>& rhs)
+{
+    if (lhs.size() != rhs.size())
+    {
+        return false;
     }
 
-    for (const auto& col1 : mWithout)
+    for (const auto& col1 : lhs)
     {
         bool found = false;
 
-        for (const auto& col2 : other.mWithout)
+        for (const auto& col2 : rhs)
         {
             if (col1 == col2)
             {
@@ -70,6 +73,13 @@ bool QueryArchetypeNode::equivalent(const QueryArchetypeNode& other) const
     return true;
 }
 
+bool QueryArchetypeNode::equivalent(const QueryArchetypeNode& other) const
+{
+    return sameColumns(mWith, other.mWith) && sameColumns(mWithout, other.mWithout) &&
+           sameColumns(mChanged, other.mChanged) && sameColumns(mAdded, other.mAdded) &&
+           sameColumns(mAnyChanged, other.mAnyChanged) && sameColumns(mAnyAdded, other.mAnyAdded);
+}
+
 const std::vector<ArchetypeId>& QueryArchetypeNode::archetypes() const
 {
     return mArchetypes;
@@ -149,7 +159,7 @@ bool QueryArchetypeNode::next(World& world, TargetMask pins, Iterator& iterator)
             }
         }
 
-        return true;
+        return this->recent(world, archetype, iterator.cursorRows[cursor], iterator.sinceTick);
     }
 
     // If we get here, then the target is not pinned and we need to iterate.
@@ -170,19 +180,28 @@ bool QueryArchetypeNode::next(World& world, TargetMask pins, Iterator& iterator)
         ++row;
     }
 
-    // Advance to the next archetype as long as the current one is empty or we're out of rows.
-    while (archetypeIndex < mArchetypes.size() &&
-           (!world.tables().dense().contains(mArchetypes[archetypeIndex]) ||
-            row >= world.tables().dense().at(mArchetypes[archetypeIndex]).size()))
+    for (;; ++row)
     {
-        ++archetypeIndex;
-        row = 0;
-    }
+        // Advance to the next archetype as long as the current one is empty or we're out of rows.
+        while (archetypeIndex < mArchetypes.size() &&
+               (!world.tables().dense().contains(mArchetypes[archetypeIndex]) ||
+                row >= world.tables().dense().at(mArchetypes[archetypeIndex]).size()))
+        {
+            ++archetypeIndex;
+            row = 0;
+        }
 
-    // If there are no more archetypes, we're done.
-    if (archetypeIndex == mArchetypes.size())
-    {
-        return false;
+        // If there are no more archetypes, we're done.
+        if (archetypeIndex == mArchetypes.size())
+        {
+            return false;
+        }
+
+        // Skip rows which weren't changed or added recently enough.
+        if (this->recent(world, mArchetypes[archetypeIndex], row, iterator.sinceTick))
+        {
+            break;
+        }
     }
 
     // Update the target's archetype.
@@ -190,3 +209,53 @@ bool QueryArchetypeNode::next(World& world, TargetMask pins, Iterator& iterator)
     iterator.cursorDepths[cursor] = -1;
     return true;
 }
+
+bool QueryArchetypeNode::recent(World& world, ArchetypeId archetype, std::size_t row, uint64_t sinceTick) const
+{
+    if (!this->filtersRows())
+    {
+        return true;
+    }
+
+    const auto& table = world.tables().dense().at(archetype);
+
+    for (auto column : mChanged)
+    {
+        if (table.changedTicks(column)[row] <= sinceTick)
+        {
+            return false;
+        }
+    }
+
+    for (auto column : mAdded)
+    {
+        if (table.addedTicks(column)[row] <= sinceTick)
+        {
+            return false;
+        }
+    }
+
+    if (mAnyChanged.empty() && mAnyAdded.empty())
+    {
+        return true;
+    }
+
+    // Of the alternative requirements, only one has to hold.
+    for (auto column : mAnyChanged)
+    {
+        if (table.changedTicks(column)[row] > sinceTick)
+        {
+            return true;
+        }
+    }
+
+    for (auto column : mAnyAdded)
+    {
+        if (table.addedTicks(column)[row] > sinceTick)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
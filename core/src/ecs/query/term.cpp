@@ -16,7 +16,13 @@ QueryTerm QueryTerm::makeWithComponent(DataTypeId type, int target)
 {
     return {
         .type = type,
-        .component = {.target = target, .without = false, .optional = false},
+        .component = {.target = target,
+                      .without = false,
+                      .optional = false,
+                      .changed = false,
+                      .added = false,
+                      .any = false,
+                      .compare = false},
     };
 }
 
@@ -24,7 +30,55 @@ QueryTerm QueryTerm::makeWithoutComponent(DataTypeId type, int target)
 {
     return {
         .type = type,
-        .component = {.target = target, .without = true, .optional = false},
+        .component = {.target = target,
+                      .without = true,
+                      .optional = false,
+                      .changed = false,
+                      .added = false,
+                      .any = false,
+                      .compare = false},
+    };
+}
+
+QueryTerm QueryTerm::makeChangedComponent(DataTypeId type, int target, bool any)
+{
+    return {
+        .type = type,
+        .component = {.target = target,
+                      .without = false,
+                      .optional = false,
+                      .changed = true,
+                      .added = false,
+                      .any = any,
+                      .compare = false},
+    };
+}
+
+QueryTerm QueryTerm::makeAddedComponent(DataTypeId type, int target, bool any)
+{
+    return {
+        .type = type,
+        .component = {.target = target,
+                      .without = false,
+                      .optional = false,
+                      .changed = false,
+                      .added = true,
+                      .any = any,
+                      .compare = false},
+    };
+}
+
+QueryTerm QueryTerm::makeComparedComponent(DataTypeId type, int target)
+{
+    return {
+        .type = type,
+        .component = {.target = target,
+                      .without = false,
+                      .optional = false,
+                      .changed = false,
+                      .added = false,
+                      .any = false,
+                      .compare = true},
     };
 }
 
@@ -32,7 +86,13 @@ QueryTerm QueryTerm::makeOptComponent(DataTypeId type, int target)
 {
     return {
         .type = type,
-        .component = {.target = target, .without = false, .optional = true},
+        .component = {.target = target,
+                      .without = false,
+                      .optional = true,
+                      .changed = false,
+                      .added = false,
+                      .any = false,
+                      .compare = false},
     };
 }
 
@@ -74,7 +134,9 @@ bool QueryTerm::compare(const Types& types, const QueryTerm& other) const
     if (this->isComponent(types))
     {
         return component.target == other.component.target && component.without == other.component.without &&
-               component.optional == other.component.optional;
+               component.optional == other.component.optional && component.changed == other.component.changed &&
+               component.added == other.component.added && component.any == other.component.any &&
+               component.compare == other.component.compare;
     }
 
     if (this->isRelation(types))
@@ -178,8 +240,22 @@ std::vector<QueryTerm> QueryTerm::resolve(const Types& types, const std::vector<
                     baseTerm.entity.target = defaultTarget;
                 }
 
-                baseTerm.component.optional = otherTerm.component.optional;
+                // Terms which require changes or additions must stay required, otherwise the filter would skip
+                // them and match entities whose component hasn't changed, or doesn't even exist.
+                if (baseTerm.component.changed || baseTerm.component.added)
+                {
+                    otherTerm.component.optional = false;
+                }
+                else
+                {
+                    baseTerm.component.optional = otherTerm.component.optional;
+                }
+
                 otherTerm.entity.target = baseTerm.entity.target;
+                otherTerm.component.changed = baseTerm.component.changed;
+                otherTerm.component.added = baseTerm.component.added;
+                otherTerm.component.any = baseTerm.component.any;
+                otherTerm.component.compare = baseTerm.component.compare;
             }
             else if (baseTerm.isRelation(types))
             {
@@ -315,6 +391,18 @@ std::string QueryTerm::toString(const Types& types, const std::vector<QueryTerm>
             {
                 result += '!';
             }
+            else if (term.component.changed)
+            {
+                result += term.component.any ? "|~" : "~";
+            }
+            else if (term.component.added)
+            {
+                result += term.component.any ? "|+" : "+";
+            }
+            else if (term.component.compare)
+            {
+                result += '=';
+            }
 
             result += types.type(term.type).name() + "(" + std::to_string(term.component.target) + ")";
         }
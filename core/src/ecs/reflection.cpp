@@ -14,3 +14,8 @@ CUBOS_REFLECT_IMPL(cubos::core::ecs::EphemeralTrait)
 {
     return reflection::Type::create("cubos::core::ecs::EphemeralTrait");
 }
+
+CUBOS_REFLECT_IMPL(cubos::core::ecs::MainThreadTrait)
+{
+    return reflection::Type::create("cubos::core::ecs::MainThreadTrait");
+}
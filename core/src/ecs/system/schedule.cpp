@@ -1,9 +1,14 @@
+#include <condition_variable>
+#include <mutex>
+
 #include <cubos/core/ecs/command_buffer.hpp>
 #include <cubos/core/ecs/system/schedule.hpp>
 #include <cubos/core/reflection/external/primitives.hpp>
+#include <cubos/core/thread/pool.hpp>
 
 using cubos::core::ecs::Schedule;
 using cubos::core::memory::Opt;
+using cubos::core::thread::ThreadPool;
 
 void Schedule::clear()
 {
@@ -134,6 +139,134 @@ bool Schedule::order(NodeId before, NodeId after)
 }
 
 void Schedule::run(SystemRegistry& registry, SystemContext& context)
+{
+    this->reset();
+
+    // As long as there are satisfied nodes, execute them.
+    while (!mSatisfied.empty())
+    {
+        auto nodeId = mSatisfied.front();
+        mSatisfied.pop();
+
+        auto result = this->execute(registry, context, nodeId);
+        context.cmdBuffer.commit();
+        this->finish(nodeId, result);
+    }
+}
+
+void Schedule::run(SystemRegistry& registry, SystemContext& context, ThreadPool& pool)
+{
+    this->reset();
+
+    // Nodes which have finished executing on the pool, along with their results. Protected by the mutex.
+    std::mutex mutex;
+    std::condition_variable nodeFinished;
+    std::vector<std::pair<NodeId, bool>> finished{};
+
+    // Nodes which are currently executing, and nodes which have finished executing but whose dependants can only be
+    // satisfied after the pending commands are committed.
+    std::vector<NodeId> running{};
+    std::vector<std::pair<NodeId, bool>> uncommitted{};
+
+    while (true)
+    {
+        // Dispatch every satisfied node which doesn't conflict with the running ones. While there are finished nodes
+        // waiting for a commit, we don't dispatch anything, so that the commit can happen as soon as possible.
+        std::vector<NodeId> mainThread{};
+        for (std::size_t i = mSatisfied.size(); uncommitted.empty() && i > 0; --i)
+        {
+            auto nodeId = mSatisfied.front();
+            mSatisfied.pop();
+
+            const auto& access = this->access(registry, nodeId);
+            bool conflicts = false;
+            for (const auto& runningId : running)
+            {
+                if (access.intersects(this->access(registry, runningId)))
+                {
+                    conflicts = true;
+                    break;
+                }
+            }
+
+            if (conflicts)
+            {
+                // Push it back to the queue, preserving the relative order of the nodes which are kept waiting.
+                mSatisfied.push(nodeId);
+                continue;
+            }
+
+            running.push_back(nodeId);
+
+            if (access.mainThread)
+            {
+                mainThread.push_back(nodeId);
+                continue;
+            }
+
+            pool.addTask([&, nodeId]() {
+                auto result = this->execute(registry, context, nodeId);
+
+                std::unique_lock<std::mutex> lock(mutex);
+                finished.emplace_back(nodeId, result);
+                nodeFinished.notify_one();
+            });
+        }
+
+        // Execute the nodes which must run on the main thread, while the pool is busy with the others.
+        for (auto nodeId : mainThread)
+        {
+            auto result = this->execute(registry, context, nodeId);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.emplace_back(nodeId, result);
+        }
+
+        if (running.empty())
+        {
+            // Nothing was dispatched and nothing is running, thus there are no more satisfied nodes.
+            CUBOS_DEBUG_ASSERT(mSatisfied.empty() && uncommitted.empty());
+            break;
+        }
+
+        // Wait for at least one node to finish.
+        std::vector<std::pair<NodeId, bool>> justFinished{};
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            nodeFinished.wait(lock, [&]() { return !finished.empty(); });
+            std::swap(justFinished, finished);
+        }
+
+        for (auto [nodeId, result] : justFinished)
+        {
+            std::erase(running, nodeId);
+
+            // A node which finished can only issue commands while it is running, so if the buffer is empty, the node
+            // didn't issue any, and its dependants may be satisfied right away.
+            if (uncommitted.empty() && context.cmdBuffer.empty())
+            {
+                this->finish(nodeId, result);
+            }
+            else
+            {
+                uncommitted.emplace_back(nodeId, result);
+            }
+        }
+
+        if (running.empty() && !uncommitted.empty())
+        {
+            // No node is running anymore, so we can safely apply the pending commands to the world.
+            context.cmdBuffer.commit();
+            for (auto [nodeId, result] : uncommitted)
+            {
+                this->finish(nodeId, result);
+            }
+            uncommitted.clear();
+        }
+    }
+}
+
+void Schedule::reset()
 {
     CUBOS_DEBUG_ASSERT(mSatisfied.empty()); // Should have been cleared up by previous calls to this method.
 
@@ -152,35 +285,47 @@ void Schedule::run(SystemRegistry& registry, SystemContext& context)
             mSatisfied.push({i});
         }
     }
+}
 
-    // As long as there are satisfied nodes, execute them.
-    while (!mSatisfied.empty())
+auto Schedule::access(SystemRegistry& registry, NodeId nodeId) const -> const SystemAccess&
+{
+    const auto& node = mNodes[nodeId.inner];
+
+    if (node.systemId.contains())
     {
-        this->run(registry, context, mSatisfied.front());
-        mSatisfied.pop();
+        return registry.system(node.systemId.value()).access();
     }
+
+    return registry.condition(node.conditionId.value()).access();
 }
 
-void Schedule::run(SystemRegistry& registry, SystemContext& context, NodeId nodeId)
+bool Schedule::execute(SystemRegistry& registry, SystemContext& context, NodeId nodeId) const
 {
-    auto& node = mNodes[nodeId.inner];
+    const auto& node = mNodes[nodeId.inner];
 
     if (node.systemId.contains())
     {
-        // If the node is a system node, then we just run it and increment the satisfaction of dependant nodes.
         registry.system(node.systemId.value()).run(context);
-        context.cmdBuffer.commit();
+        return true;
+    }
+
+    return registry.condition(node.conditionId.value()).run(context);
+}
+
+void Schedule::finish(NodeId nodeId, bool result)
+{
+    auto& node = mNodes[nodeId.inner];
+
+    if (node.systemId.contains())
+    {
+        // If the node is a system node, then we just increment the satisfaction of dependant nodes.
         this->incrementSatisfaction(node.repeatId);
         this->incrementSatisfaction(node.satisfyOnFinish);
         node.alreadyFinished = true;
         return;
     }
 
-    // Then the node must either be a condition or repeat node. In either case, we must evaluate its associated
-    // condition.
-    auto result = registry.condition(node.conditionId.value()).run(context);
-    context.cmdBuffer.commit();
-
+    // Then the node must either be a condition or repeat node.
     if (!node.isRepeat)
     {
         // If the node is a condition node, then independently of its result, we should increment the satisfaction for
@@ -6,28 +6,34 @@ using cubos::core::ecs::DenseTableRegistry;
 
 DenseTableRegistry::DenseTableRegistry()
 {
-    mTables.emplace(std::piecewise_construct, std::forward_as_tuple(0), std::forward_as_tuple());
+    mTables.emplace_back(std::make_unique<DenseTable>());
 }
 
 void DenseTableRegistry::reset()
 {
     mTables.clear();
-    mTables.emplace(std::piecewise_construct, std::forward_as_tuple(0), std::forward_as_tuple());
+    mTables.emplace_back(std::make_unique<DenseTable>());
 }
 
 bool DenseTableRegistry::contains(ArchetypeId archetype) const
 {
-    return mTables.contains(archetype.inner);
+    return archetype.inner < mTables.size() && mTables[archetype.inner] != nullptr;
 }
 
 DenseTable& DenseTableRegistry::create(ArchetypeId archetype, ArchetypeGraph& graph, Types& types)
 {
-    if (mTables.contains(archetype.inner))
+    if (this->contains(archetype))
     {
-        return mTables.at(archetype.inner);
+        return *mTables[archetype.inner];
     }
 
-    auto& table = mTables[archetype.inner];
+    if (archetype.inner >= mTables.size())
+    {
+        mTables.resize(archetype.inner + 1);
+    }
+
+    mTables[archetype.inner] = std::make_unique<DenseTable>();
+    auto& table = *mTables[archetype.inner];
 
     // Add each dense column associated to the archetype to the table.
     for (auto id = graph.first(archetype); id != ColumnId::Invalid; id = graph.next(archetype, id))
@@ -40,12 +46,12 @@ DenseTable& DenseTableRegistry::create(ArchetypeId archetype, ArchetypeGraph& gr
 
 DenseTable& DenseTableRegistry::at(ArchetypeId archetype)
 {
-    CUBOS_ASSERT(mTables.contains(archetype.inner), "Archetype does not have a dense table");
-    return mTables.at(archetype.inner);
+    CUBOS_ASSERT(this->contains(archetype), "Archetype does not have a dense table");
+    return *mTables[archetype.inner];
 }
 
 const DenseTable& DenseTableRegistry::at(ArchetypeId archetype) const
 {
-    CUBOS_ASSERT(mTables.contains(archetype.inner), "Archetype does not have a dense table");
-    return mTables.at(archetype.inner);
+    CUBOS_ASSERT(this->contains(archetype), "Archetype does not have a dense table");
+    return *mTables[archetype.inner];
 }
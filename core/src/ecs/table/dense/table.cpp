@@ -1,58 +1,110 @@
+#include <algorithm>
+
 #include <cubos/core/ecs/table/dense/table.hpp>
 #include <cubos/core/tel/logging.hpp>
 
+using cubos::core::ecs::ColumnId;
+using cubos::core::ecs::DataTypeId;
 using cubos::core::ecs::DenseTable;
 using cubos::core::memory::AnyVector;
 
+/// @brief Removes the tick at the given row, replacing it with the last tick.
+/// @param ticks Ticks.
+/// @param row Row.
+static void swapEraseTick(std::vector<uint64_t>& ticks, std::size_t row)
+{
+    ticks[row] = ticks.back();
+    ticks.pop_back();
+}
+
 void DenseTable::addColumn(ColumnId id, const reflection::Type& type)
 {
     CUBOS_ASSERT(mEntities.empty());
-    mColumns.emplace(id.inner, type);
+
+    // Keep the columns sorted by identifier, so that common columns of two tables can be walked through in order.
+    CUBOS_ASSERT(!this->contains(id), "Column already exists in table");
+    auto position = static_cast<std::size_t>(std::lower_bound(mColumnIds.begin(), mColumnIds.end(), id.inner) -
+                                             mColumnIds.begin());
+    mColumnIds.insert(mColumnIds.begin() + static_cast<std::ptrdiff_t>(position), id.inner);
+
+    // Columns can't be move assigned, and thus we must rebuild the vector instead of inserting into it.
+    std::vector<Column> columns;
+    columns.reserve(mColumns.size() + 1);
+    for (std::size_t i = 0; i <= mColumns.size(); ++i)
+    {
+        if (i == position)
+        {
+            columns.push_back(Column{.data = AnyVector{type}, .addedTicks = {}, .changedTicks = {}});
+        }
+
+        if (i < mColumns.size())
+        {
+            columns.push_back(std::move(mColumns[i]));
+        }
+    }
+    mColumns = std::move(columns);
+
+    // Columns after the inserted one were shifted, so the direct map must be rebuilt.
+    std::fill(mColumnPositions.begin(), mColumnPositions.end(), NoColumn);
+    for (std::size_t i = 0; i < mColumnIds.size(); ++i)
+    {
+        auto columnId = ColumnId{.inner = mColumnIds[i]};
+        if (columnId.index() == DataTypeId::Invalid.inner)
+        {
+            auto dataType = columnId.dataType().inner;
+            if (dataType >= mColumnPositions.size())
+            {
+                mColumnPositions.resize(dataType + 1, NoColumn);
+            }
+            mColumnPositions[dataType] = static_cast<uint32_t>(i);
+        }
+    }
 }
 
 void DenseTable::pushBack(uint32_t index)
 {
-    bool inserted = mEntityToRow.emplace(index, mEntities.size()).second;
-    CUBOS_ASSERT(inserted, "Entity already exists in table");
+    this->insertRow(index, static_cast<uint32_t>(mEntities.size()));
     mEntities.push_back(index);
+
+    for (auto& column : mColumns)
+    {
+        column.addedTicks.push_back(0);
+        column.changedTicks.push_back(0);
+    }
 }
 
 void DenseTable::swapErase(uint32_t index)
 {
     // Get the row of the entity to remove.
-    auto it = mEntityToRow.find(index);
-    CUBOS_ASSERT(it != mEntityToRow.end(), "Entity doesn't exist in table");
-    auto row = it->second;
-    mEntityToRow.erase(it);
+    auto row = this->eraseRow(index);
 
     if (row + 1 != mEntities.size())
     {
         // If the entity isn't the last one in the table, first swap it with the last one.
         mEntities[row] = mEntities.back();
-        mEntityToRow[mEntities[row]] = row;
+        this->rowSlot(mEntities[row]) = static_cast<uint32_t>(row);
     }
 
     mEntities.pop_back();
 
-    for (auto& [id, column] : mColumns)
+    for (auto& column : mColumns)
     {
-        column.swapErase(row);
+        column.data.swapErase(row);
+        swapEraseTick(column.addedTicks, row);
+        swapEraseTick(column.changedTicks, row);
     }
 }
 
 void DenseTable::swapMove(uint32_t index, DenseTable& other)
 {
     // Get the row of the entity to move.
-    auto it = mEntityToRow.find(index);
-    CUBOS_ASSERT(it != mEntityToRow.end(), "Entity doesn't exist in table");
-    auto row = it->second;
-    mEntityToRow.erase(it);
+    auto row = this->eraseRow(index);
 
     if (row + 1 != mEntities.size())
     {
         // If the entity isn't the last one in the table, first swap it with the last one.
         mEntities[row] = mEntities.back();
-        mEntityToRow[mEntities[row]] = row;
+        this->rowSlot(mEntities[row]) = static_cast<uint32_t>(row);
     }
 
     mEntities.pop_back();
@@ -61,26 +113,42 @@ void DenseTable::swapMove(uint32_t index, DenseTable& other)
     other.pushBack(index);
 
     // Move the data in columns common to both tables, and remove the data from columns unique to this table.
-    for (auto& [id, column] : mColumns)
+    // As both column arrays are sorted, the common columns can be found by walking through both at the same time.
+    std::size_t otherPosition = 0;
+    for (std::size_t position = 0; position < mColumns.size(); ++position)
     {
-        if (auto it = other.mColumns.find(id); it != other.mColumns.end())
+        auto& column = mColumns[position];
+
+        while (otherPosition < other.mColumns.size() && other.mColumnIds[otherPosition] < mColumnIds[position])
+        {
+            ++otherPosition;
+        }
+
+        if (otherPosition < other.mColumns.size() && other.mColumnIds[otherPosition] == mColumnIds[position])
         {
-            auto& otherColumn = it->second;
-            otherColumn.pushUninit();
-            column.swapMove(row, otherColumn.at(otherColumn.size() - 1));
+            auto& otherColumn = other.mColumns[otherPosition];
+            otherColumn.data.pushUninit();
+            column.data.swapMove(row, otherColumn.data.at(otherColumn.data.size() - 1));
+
+            // Keep the ticks, as the values themselves weren't added or changed by the move.
+            otherColumn.addedTicks.back() = column.addedTicks[row];
+            otherColumn.changedTicks.back() = column.changedTicks[row];
         }
         else
         {
-            column.swapErase(row);
+            column.data.swapErase(row);
         }
+
+        swapEraseTick(column.addedTicks, row);
+        swapEraseTick(column.changedTicks, row);
     }
 }
 
 std::size_t DenseTable::row(uint32_t index) const
 {
-    auto it = mEntityToRow.find(index);
-    CUBOS_ASSERT(it != mEntityToRow.end(), "Entity doesn't exist in table");
-    return it->second;
+    auto row = this->findRow(index);
+    CUBOS_ASSERT(row != NoRow, "Entity doesn't exist in table");
+    return static_cast<std::size_t>(row);
 }
 
 uint32_t DenseTable::entity(std::size_t row) const
@@ -89,30 +157,142 @@ uint32_t DenseTable::entity(std::size_t row) const
     return mEntities[row];
 }
 
+std::span<const uint32_t> DenseTable::entities() const
+{
+    return mEntities;
+}
+
 std::size_t DenseTable::size() const
 {
-    for (const auto& [id, col] : mColumns)
+    for (const auto& column : mColumns)
     {
-        CUBOS_ASSERT(mEntities.size() == col.size());
+        CUBOS_ASSERT(mEntities.size() == column.data.size());
     }
     return mEntities.size();
 }
 
 AnyVector& DenseTable::column(ColumnId id)
 {
-    auto it = mColumns.find(id.inner);
-    CUBOS_ASSERT(it != mColumns.end(), "Column doesn't exist in table");
-    return it->second;
+    return this->find(id).data;
 }
 
 const AnyVector& DenseTable::column(ColumnId id) const
 {
-    auto it = mColumns.find(id.inner);
-    CUBOS_ASSERT(it != mColumns.end(), "Column doesn't exist in table");
-    return it->second;
+    return this->find(id).data;
+}
+
+std::span<uint64_t> DenseTable::addedTicks(ColumnId id)
+{
+    return this->find(id).addedTicks;
+}
+
+std::span<const uint64_t> DenseTable::addedTicks(ColumnId id) const
+{
+    return this->find(id).addedTicks;
+}
+
+std::span<uint64_t> DenseTable::changedTicks(ColumnId id)
+{
+    return this->find(id).changedTicks;
+}
+
+std::span<const uint64_t> DenseTable::changedTicks(ColumnId id) const
+{
+    return this->find(id).changedTicks;
 }
 
 bool DenseTable::contains(ColumnId id) const
 {
-    return mColumns.contains(id.inner);
+    auto position = this->position(id);
+    return position != mColumns.size() && mColumnIds[position] == id.inner;
+}
+
+auto DenseTable::find(ColumnId id) -> Column&
+{
+    auto position = this->position(id);
+    CUBOS_ASSERT(position != mColumns.size() && mColumnIds[position] == id.inner, "Column doesn't exist in table");
+    return mColumns[position];
+}
+
+auto DenseTable::find(ColumnId id) const -> const Column&
+{
+    auto position = this->position(id);
+    CUBOS_ASSERT(position != mColumns.size() && mColumnIds[position] == id.inner, "Column doesn't exist in table");
+    return mColumns[position];
+}
+
+std::size_t DenseTable::position(ColumnId id) const
+{
+    // Columns of plain data types, which are the vast majority, are found without searching.
+    if (id.index() == DataTypeId::Invalid.inner)
+    {
+        auto dataType = id.dataType().inner;
+        if (dataType >= mColumnPositions.size() || mColumnPositions[dataType] == NoColumn)
+        {
+            return mColumns.size();
+        }
+        return static_cast<std::size_t>(mColumnPositions[dataType]);
+    }
+
+    auto it = std::lower_bound(mColumnIds.begin(), mColumnIds.end(), id.inner);
+    return static_cast<std::size_t>(it - mColumnIds.begin());
+}
+
+uint32_t& DenseTable::rowSlot(uint32_t index)
+{
+    auto page = index / RowPageSize;
+    if (page >= mRowPages.size())
+    {
+        mRowPages.resize(page + 1);
+        mRowPageSizes.resize(page + 1, 0);
+    }
+
+    if (mRowPages[page] == nullptr)
+    {
+        mRowPages[page] = std::make_unique<uint32_t[]>(RowPageSize);
+        std::fill_n(mRowPages[page].get(), RowPageSize, NoRow);
+    }
+
+    return mRowPages[page][index % RowPageSize];
+}
+
+void DenseTable::insertRow(uint32_t index, uint32_t row)
+{
+    auto& slot = this->rowSlot(index);
+    CUBOS_ASSERT(slot == NoRow, "Entity already exists in table");
+    slot = row;
+    mRowPageSizes[index / RowPageSize] += 1;
+}
+
+std::size_t DenseTable::eraseRow(uint32_t index)
+{
+    auto row = this->findRow(index);
+    CUBOS_ASSERT(row != NoRow, "Entity doesn't exist in table");
+
+    auto page = index / RowPageSize;
+    mRowPages[page][index % RowPageSize] = NoRow;
+    if (--mRowPageSizes[page] == 0)
+    {
+        // Free the page, and shrink the page array if it was the last one, so that tables which shrink don't keep
+        // the memory of their largest size.
+        mRowPages[page].reset();
+        while (!mRowPages.empty() && mRowPages.back() == nullptr)
+        {
+            mRowPages.pop_back();
+            mRowPageSizes.pop_back();
+        }
+    }
+
+    return static_cast<std::size_t>(row);
+}
+
+uint32_t DenseTable::findRow(uint32_t index) const
+{
+    auto page = index / RowPageSize;
+    if (page >= mRowPages.size() || mRowPages[page] == nullptr)
+    {
+        return NoRow;
+    }
+
+    return mRowPages[page][index % RowPageSize];
 }
@@ -137,6 +137,9 @@ Entity World::create()
 
 void World::createAt(Entity entity)
 {
+    // Give an entry to the identifiers reserved since the last creation, including this one.
+    mEntityPool.flush();
+
     // Check if the entity handle is valid.
     CUBOS_ASSERT(mEntityPool.contains(entity), "Entity is not reserved");
 
@@ -151,7 +154,7 @@ void World::createAt(Entity entity)
 
 Entity World::reserve()
 {
-    return mEntityPool.create(ArchetypeId::Invalid);
+    return mEntityPool.reserve();
 }
 
 void World::destroy(Entity entity)
@@ -579,6 +582,16 @@ std::size_t World::entityCount() const
     return mEntityPool.size();
 }
 
+uint64_t World::tick() const
+{
+    return mTick.load(std::memory_order_relaxed);
+}
+
+uint64_t World::advanceTick()
+{
+    return mTick.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
 void World::propagateDepth(uint32_t index, DataTypeId dataType, int depth)
 {
     auto archetype = mEntityPool.archetype(index);
@@ -769,7 +782,11 @@ void* World::Components::get(const reflection::Type& type)
     auto archetype = mWorld.mEntityPool.archetype(mEntity.index);
     auto& table = mWorld.mTables.dense().at(archetype);
     auto columnId = ColumnId::make(mWorld.mTypes.id(type));
-    return table.column(columnId).at(table.row(mEntity.index));
+    auto row = table.row(mEntity.index);
+
+    // The component is accessed mutably, so we must assume it will be changed.
+    table.changedTicks(columnId)[row] = mWorld.advanceTick();
+    return table.column(columnId).at(row);
 }
 
 auto World::Components::begin() -> Iterator
@@ -795,7 +812,9 @@ auto World::Components::add(const reflection::Type& type, void* value) -> Compon
     // its existing entry in the table.
     if (mWorld.mArchetypeGraph.contains(oldArchetype, columnId))
     {
-        oldTable.column(columnId).setMove(oldTable.row(mEntity.index), value);
+        auto row = oldTable.row(mEntity.index);
+        oldTable.column(columnId).setMove(row, value);
+        oldTable.changedTicks(columnId)[row] = mWorld.advanceTick();
         return *this;
     }
 
@@ -809,6 +828,10 @@ auto World::Components::add(const reflection::Type& type, void* value) -> Compon
     // Move the entity from the old table to the new one and add the new component.
     oldTable.swapMove(mEntity.index, newTable);
     newTable.column(columnId).pushMove(value);
+    auto tick = mWorld.advanceTick();
+    auto row = newTable.row(mEntity.index);
+    newTable.addedTicks(columnId)[row] = tick;
+    newTable.changedTicks(columnId)[row] = tick;
 
     // Move sparse data to the new tables.
     mWorld.moveSparse(mEntity, oldArchetype, newArchetype);
@@ -825,6 +848,84 @@ auto World::Components::add(const reflection::Type& type, void* value) -> Compon
     return *this;
 }
 
+auto World::Components::addMany(std::span<memory::AnyValue> components) -> Components&
+{
+    auto oldArchetype = mWorld.mEntityPool.archetype(mEntity.index);
+    auto& oldTable = mWorld.mTables.dense().at(oldArchetype);
+
+    // Find the archetype the entity will end up in, and which columns it doesn't have yet.
+    std::vector<ColumnId> newColumns;
+    auto newArchetype = oldArchetype;
+    for (auto& component : components)
+    {
+        auto typeId = mWorld.mTypes.id(component.type());
+        CUBOS_ASSERT(mWorld.mTypes.isComponent(typeId), "Type {} is not registered as a component",
+                     component.type().name());
+        auto columnId = ColumnId::make(typeId);
+
+        if (!mWorld.mArchetypeGraph.contains(newArchetype, columnId))
+        {
+            newArchetype = mWorld.mArchetypeGraph.with(newArchetype, columnId);
+            newColumns.push_back(columnId);
+        }
+    }
+
+    // Move the entity only once, directly to its final table.
+    auto& newTable = mWorld.mTables.dense().create(newArchetype, mWorld.mArchetypeGraph, mWorld.mTypes);
+    if (newArchetype != oldArchetype)
+    {
+        mWorld.mEntityPool.archetype(mEntity.index, newArchetype);
+        oldTable.swapMove(mEntity.index, newTable);
+    }
+
+    auto tick = mWorld.advanceTick();
+    auto row = newTable.row(mEntity.index);
+    for (auto& component : components)
+    {
+        auto columnId = ColumnId::make(mWorld.mTypes.id(component.type()));
+        auto& column = newTable.column(columnId);
+
+        // New columns still have one row less than the table, until their value is pushed. If the same component
+        // appears more than once, or the entity already had it, the value is overwritten instead.
+        if (column.size() == row)
+        {
+            column.pushMove(component.get());
+            newTable.addedTicks(columnId)[row] = tick;
+        }
+        else
+        {
+            column.setMove(row, component.get());
+        }
+
+        newTable.changedTicks(columnId)[row] = tick;
+    }
+
+    if (newArchetype == oldArchetype)
+    {
+        return *this;
+    }
+
+    // Move sparse data to the new tables.
+    mWorld.moveSparse(mEntity, oldArchetype, newArchetype);
+
+    CUBOS_TRACE("Added {} components to entity {}", newColumns.size(), mEntity);
+
+    // Trigger any observers that are interested in the new components, now that all of them have been added.
+    CommandBuffer cmdBuffer{mWorld};
+    bool observed = false;
+    for (auto columnId : newColumns)
+    {
+        observed |= mWorld.mObservers->notifyAdd(cmdBuffer, mEntity, columnId);
+    }
+
+    if (observed)
+    {
+        cmdBuffer.commit();
+    }
+
+    return *this;
+}
+
 auto World::Components::remove(const reflection::Type& type) -> Components&
 {
     auto typeId = mWorld.mTypes.id(type);
@@ -0,0 +1,402 @@
+#include <algorithm>
+#include <utility>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vector_relational.hpp>
+
+#include <cubos/core/geom/aabb_tree.hpp>
+#include <cubos/core/tel/logging.hpp>
+
+using cubos::core::geom::AABB;
+using cubos::core::geom::AABBTree;
+using cubos::core::geom::Frustum;
+using cubos::core::geom::Plane;
+
+/// @brief Computes the smallest box which contains both given boxes.
+/// @param a First box.
+/// @param b Second box.
+/// @return Merged box.
+static AABB merge(const AABB& a, const AABB& b)
+{
+    AABB aabb{};
+    aabb.min(glm::min(a.min(), b.min()));
+    aabb.max(glm::max(a.max(), b.max()));
+    return aabb;
+}
+
+/// @brief Computes the surface area of a box, which is proportional to the chance of it being hit by a query.
+/// @param aabb Box.
+/// @return Surface area.
+static float area(const AABB& aabb)
+{
+    auto size = aabb.max() - aabb.min();
+    return 2.0F * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+/// @brief Checks whether a box completely contains another.
+/// @param outer Outer box.
+/// @param inner Inner box.
+/// @return Whether the outer box contains the inner box.
+static bool contains(const AABB& outer, const AABB& inner)
+{
+    return glm::all(glm::lessThanEqual(outer.min(), inner.min())) &&
+           glm::all(glm::greaterThanEqual(outer.max(), inner.max()));
+}
+
+AABBTree::AABBTree(float margin)
+    : mMargin{margin}
+{
+}
+
+void AABBTree::clear()
+{
+    mNodes.clear();
+    mRoot = Null;
+    mFree = Null;
+    mLeafCount = 0;
+}
+
+std::size_t AABBTree::size() const
+{
+    return mLeafCount;
+}
+
+int AABBTree::height() const
+{
+    return mRoot == Null ? 0 : mNodes[mRoot].height;
+}
+
+std::size_t AABBTree::insert(const AABB& aabb, std::size_t value)
+{
+    auto leaf = this->allocate();
+    mNodes[leaf].bounds.min(aabb.min() - mMargin);
+    mNodes[leaf].bounds.max(aabb.max() + mMargin);
+    mNodes[leaf].value = value;
+    mNodes[leaf].height = 0;
+    this->insertLeaf(leaf);
+    mLeafCount += 1;
+    return leaf;
+}
+
+void AABBTree::remove(std::size_t proxy)
+{
+    CUBOS_ASSERT(proxy < mNodes.size() && mNodes[proxy].height == 0, "Invalid proxy");
+    this->removeLeaf(proxy);
+    this->release(proxy);
+    mLeafCount -= 1;
+}
+
+bool AABBTree::move(std::size_t proxy, const AABB& aabb)
+{
+    CUBOS_ASSERT(proxy < mNodes.size() && mNodes[proxy].height == 0, "Invalid proxy");
+    if (contains(mNodes[proxy].bounds, aabb))
+    {
+        return false;
+    }
+
+    this->removeLeaf(proxy);
+    mNodes[proxy].bounds.min(aabb.min() - mMargin);
+    mNodes[proxy].bounds.max(aabb.max() + mMargin);
+    this->insertLeaf(proxy);
+    return true;
+}
+
+std::size_t AABBTree::value(std::size_t proxy) const
+{
+    CUBOS_ASSERT(proxy < mNodes.size() && mNodes[proxy].height == 0, "Invalid proxy");
+    return mNodes[proxy].value;
+}
+
+void AABBTree::value(std::size_t proxy, std::size_t value)
+{
+    CUBOS_ASSERT(proxy < mNodes.size() && mNodes[proxy].height == 0, "Invalid proxy");
+    mNodes[proxy].value = value;
+}
+
+const AABB& AABBTree::bounds(std::size_t proxy) const
+{
+    CUBOS_ASSERT(proxy < mNodes.size() && mNodes[proxy].height == 0, "Invalid proxy");
+    return mNodes[proxy].bounds;
+}
+
+void AABBTree::query(const Frustum& frustum, std::vector<std::size_t>& values) const
+{
+    const Plane planes[] = {frustum.top, frustum.right, frustum.bottom, frustum.left, frustum.near, frustum.far};
+    this->visit(
+        [&](const AABB& aabb) {
+            auto center = aabb.center();
+            auto extent = (aabb.max() - aabb.min()) * 0.5F;
+
+            auto overlap = Overlap::Full;
+            for (const auto& plane : planes)
+            {
+                // Compare the distance of the center to the plane with the box's extent along the plane's normal.
+                float distance = glm::dot(plane.normal, center) + plane.d;
+                float radius = glm::dot(glm::abs(plane.normal), extent);
+                if (distance + radius < 0.0F)
+                {
+                    return Overlap::None;
+                }
+
+                if (distance - radius < 0.0F)
+                {
+                    overlap = Overlap::Partial;
+                }
+            }
+            return overlap;
+        },
+        values);
+}
+
+void AABBTree::query(const AABB& aabb, std::vector<std::size_t>& values) const
+{
+    this->visit(
+        [&](const AABB& other) {
+            if (!aabb.overlaps(other))
+            {
+                return Overlap::None;
+            }
+            return contains(aabb, other) ? Overlap::Full : Overlap::Partial;
+        },
+        values);
+}
+
+void AABBTree::query(const glm::vec3& center, float radius, std::vector<std::size_t>& values) const
+{
+    this->visit(
+        [&](const AABB& aabb) {
+            // The closest point of the box must be inside the sphere, and its farthest corner for all of it to be.
+            auto closest = glm::clamp(center, aabb.min(), aabb.max());
+            if (glm::dot(closest - center, closest - center) > radius * radius)
+            {
+                return Overlap::None;
+            }
+
+            auto farthest = glm::max(glm::abs(aabb.min() - center), glm::abs(aabb.max() - center));
+            return glm::dot(farthest, farthest) <= radius * radius ? Overlap::Full : Overlap::Partial;
+        },
+        values);
+}
+
+std::size_t AABBTree::allocate()
+{
+    if (mFree == Null)
+    {
+        mNodes.emplace_back();
+        return mNodes.size() - 1;
+    }
+
+    auto node = mFree;
+    mFree = mNodes[node].parent;
+    mNodes[node] = Node{};
+    return node;
+}
+
+void AABBTree::release(std::size_t node)
+{
+    mNodes[node].parent = mFree;
+    mNodes[node].height = -1;
+    mFree = node;
+}
+
+void AABBTree::insertLeaf(std::size_t leaf)
+{
+    if (mRoot == Null)
+    {
+        mRoot = leaf;
+        mNodes[leaf].parent = Null;
+        return;
+    }
+
+    // Descend the tree, towards the child whose box grows the least, until it's cheaper to pair the leaf with the
+    // current node than to push it further down.
+    auto bounds = mNodes[leaf].bounds;
+    auto sibling = mRoot;
+    while (mNodes[sibling].height > 0)
+    {
+        const auto& node = mNodes[sibling];
+        float nodeArea = area(node.bounds);
+        float mergedArea = area(merge(node.bounds, bounds));
+
+        // Pairing with this node creates a parent with the merged box, and grows all of the node's ancestors.
+        float cost = 2.0F * mergedArea;
+        float inheritedCost = 2.0F * (mergedArea - nodeArea);
+
+        float childCosts[2];
+        for (int i = 0; i < 2; ++i)
+        {
+            const auto& child = mNodes[node.children[i]];
+            float growth = area(merge(child.bounds, bounds));
+            if (child.height > 0)
+            {
+                growth -= area(child.bounds);
+            }
+            childCosts[i] = growth + inheritedCost;
+        }
+
+        if (cost < childCosts[0] && cost < childCosts[1])
+        {
+            break;
+        }
+
+        sibling = childCosts[0] < childCosts[1] ? node.children[0] : node.children[1];
+    }
+
+    // Create a new parent for the leaf and its sibling, in the place of the sibling.
+    auto oldParent = mNodes[sibling].parent;
+    auto newParent = this->allocate();
+    mNodes[newParent].parent = oldParent;
+    mNodes[newParent].bounds = merge(bounds, mNodes[sibling].bounds);
+    mNodes[newParent].height = mNodes[sibling].height + 1;
+    mNodes[newParent].children[0] = sibling;
+    mNodes[newParent].children[1] = leaf;
+    mNodes[sibling].parent = newParent;
+    mNodes[leaf].parent = newParent;
+
+    if (oldParent == Null)
+    {
+        mRoot = newParent;
+    }
+    else
+    {
+        auto& children = mNodes[oldParent].children;
+        children[children[0] == sibling ? 0 : 1] = newParent;
+    }
+
+    this->refit(newParent);
+}
+
+void AABBTree::removeLeaf(std::size_t leaf)
+{
+    if (leaf == mRoot)
+    {
+        mRoot = Null;
+        return;
+    }
+
+    // Replace the leaf's parent with the leaf's sibling.
+    auto parent = mNodes[leaf].parent;
+    auto grandParent = mNodes[parent].parent;
+    const auto& children = mNodes[parent].children;
+    auto sibling = children[0] == leaf ? children[1] : children[0];
+
+    mNodes[sibling].parent = grandParent;
+    if (grandParent == Null)
+    {
+        mRoot = sibling;
+    }
+    else
+    {
+        auto& grandChildren = mNodes[grandParent].children;
+        grandChildren[grandChildren[0] == parent ? 0 : 1] = sibling;
+    }
+
+    this->release(parent);
+    this->refit(grandParent);
+}
+
+void AABBTree::refit(std::size_t node)
+{
+    while (node != Null)
+    {
+        node = this->balance(node);
+
+        auto& current = mNodes[node];
+        const auto& first = mNodes[current.children[0]];
+        const auto& second = mNodes[current.children[1]];
+        current.bounds = merge(first.bounds, second.bounds);
+        current.height = 1 + std::max(first.height, second.height);
+
+        node = current.parent;
+    }
+}
+
+std::size_t AABBTree::balance(std::size_t a)
+{
+    if (mNodes[a].height < 2)
+    {
+        return a;
+    }
+
+    // If one child is more than one level taller than the other, it takes the place of the node, and the node takes
+    // the place of the shorter of the taller child's children.
+    auto b = mNodes[a].children[0];
+    auto c = mNodes[a].children[1];
+    int difference = mNodes[c].height - mNodes[b].height;
+    if (difference >= -1 && difference <= 1)
+    {
+        return a;
+    }
+
+    int tallSide = difference > 1 ? 1 : 0;
+    auto tall = mNodes[a].children[tallSide];
+    auto shortChild = mNodes[a].children[1 - tallSide];
+    auto f = mNodes[tall].children[0];
+    auto g = mNodes[tall].children[1];
+
+    // Move the taller child up.
+    mNodes[tall].children[0] = a;
+    mNodes[tall].parent = mNodes[a].parent;
+    mNodes[a].parent = tall;
+    if (mNodes[tall].parent == Null)
+    {
+        mRoot = tall;
+    }
+    else
+    {
+        auto& children = mNodes[mNodes[tall].parent].children;
+        children[children[0] == a ? 0 : 1] = tall;
+    }
+
+    // Keep the taller grandchild next to the moved child, and give the shorter one to the node.
+    auto kept = mNodes[f].height > mNodes[g].height ? f : g;
+    auto given = kept == f ? g : f;
+    mNodes[tall].children[1] = kept;
+    mNodes[a].children[tallSide] = given;
+    mNodes[given].parent = a;
+
+    mNodes[a].bounds = merge(mNodes[shortChild].bounds, mNodes[given].bounds);
+    mNodes[a].height = 1 + std::max(mNodes[shortChild].height, mNodes[given].height);
+    mNodes[tall].bounds = merge(mNodes[a].bounds, mNodes[kept].bounds);
+    mNodes[tall].height = 1 + std::max(mNodes[a].height, mNodes[kept].height);
+    return tall;
+}
+
+template <typename F>
+void AABBTree::visit(F classify, std::vector<std::size_t>& values) const
+{
+    if (mRoot == Null)
+    {
+        return;
+    }
+
+    // Each entry holds a node and whether its box is already known to be completely inside the volume.
+    std::vector<std::pair<std::size_t, bool>> stack{{mRoot, false}};
+    while (!stack.empty())
+    {
+        auto [index, inside] = stack.back();
+        stack.pop_back();
+
+        const auto& node = mNodes[index];
+        if (!inside)
+        {
+            auto overlap = classify(node.bounds);
+            if (overlap == Overlap::None)
+            {
+                continue;
+            }
+            inside = overlap == Overlap::Full;
+        }
+
+        if (node.height == 0)
+        {
+            values.push_back(node.value);
+        }
+        else
+        {
+            stack.emplace_back(node.children[0], inside);
+            stack.emplace_back(node.children[1], inside);
+        }
+    }
+}
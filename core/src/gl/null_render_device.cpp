@@ -0,0 +1,645 @@
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include <cubos/core/gl/null_render_device.hpp>
+
+using namespace cubos::core;
+using namespace cubos::core::gl;
+
+using Counters = NullRenderDevice::Counters;
+
+/// @brief Counts how many of the given initial data pointers are set.
+/// @param data Array of data pointers.
+/// @param count Number of pointers.
+/// @return Number of non-null pointers.
+static std::size_t countData(const void* const* data, std::size_t count)
+{
+    std::size_t set = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        set += data[i] != nullptr ? 1 : 0;
+    }
+    return set;
+}
+
+class NullFramebuffer : public impl::Framebuffer
+{
+};
+
+class NullRasterState : public impl::RasterState
+{
+};
+
+class NullDepthStencilState : public impl::DepthStencilState
+{
+};
+
+class NullBlendState : public impl::BlendState
+{
+};
+
+class NullSampler : public impl::Sampler
+{
+};
+
+class NullVertexArray : public impl::VertexArray
+{
+};
+
+class NullPixelPackBuffer : public impl::PixelPackBuffer
+{
+public:
+    void copyTo(void* data, std::size_t /*offset*/, std::size_t size) override
+    {
+        // Nothing was ever rendered, so the buffer is always read as zeros.
+        std::memset(data, 0, size);
+    }
+};
+
+class NullTexture2D : public impl::Texture2D
+{
+public:
+    NullTexture2D(std::shared_ptr<Counters> counters)
+        : counters(std::move(counters))
+    {
+    }
+
+    void update(std::size_t /*x*/, std::size_t /*y*/, std::size_t /*width*/, std::size_t /*height*/,
+                const void* /*data*/, std::size_t /*level*/) override
+    {
+        counters->textureUpdates += 1;
+    }
+
+    void read(void* /*outputBuffer*/) override
+    {
+    }
+
+    void copyTo(std::size_t /*x*/, std::size_t /*y*/, std::size_t /*width*/, std::size_t /*height*/,
+                gl::PixelPackBuffer /*buffer*/) override
+    {
+    }
+
+    void generateMipmaps() override
+    {
+    }
+
+    std::shared_ptr<Counters> counters;
+};
+
+class NullTexture2DArray : public impl::Texture2DArray
+{
+public:
+    NullTexture2DArray(std::shared_ptr<Counters> counters)
+        : counters(std::move(counters))
+    {
+    }
+
+    void update(std::size_t /*x*/, std::size_t /*y*/, std::size_t /*i*/, std::size_t /*width*/,
+                std::size_t /*height*/, const void* /*data*/, std::size_t /*level*/) override
+    {
+        counters->textureUpdates += 1;
+    }
+
+    void generateMipmaps() override
+    {
+    }
+
+    std::shared_ptr<Counters> counters;
+};
+
+class NullTexture3D : public impl::Texture3D
+{
+public:
+    NullTexture3D(std::shared_ptr<Counters> counters)
+        : counters(std::move(counters))
+    {
+    }
+
+    void update(std::size_t /*x*/, std::size_t /*y*/, std::size_t /*z*/, std::size_t /*width*/,
+                std::size_t /*height*/, std::size_t /*depth*/, const void* /*data*/, std::size_t /*level*/) override
+    {
+        counters->textureUpdates += 1;
+    }
+
+    void generateMipmaps() override
+    {
+    }
+
+    std::shared_ptr<Counters> counters;
+};
+
+class NullCubeMap : public impl::CubeMap
+{
+public:
+    NullCubeMap(std::shared_ptr<Counters> counters)
+        : counters(std::move(counters))
+    {
+    }
+
+    void update(std::size_t /*x*/, std::size_t /*y*/, std::size_t /*width*/, std::size_t /*height*/,
+                const void* /*data*/, CubeFace /*face*/, std::size_t /*level*/) override
+    {
+        counters->textureUpdates += 1;
+    }
+
+    void generateMipmaps() override
+    {
+    }
+
+    std::shared_ptr<Counters> counters;
+};
+
+class NullConstantBuffer : public impl::ConstantBuffer
+{
+public:
+    NullConstantBuffer(std::shared_ptr<Counters> counters)
+        : counters(std::move(counters))
+    {
+    }
+
+    void fill(const void* /*data*/, std::size_t size) override
+    {
+        counters->bufferBytes += size;
+    }
+
+    std::shared_ptr<Counters> counters;
+};
+
+class NullIndexBuffer : public impl::IndexBuffer
+{
+public:
+    NullIndexBuffer(std::shared_ptr<Counters> counters)
+        : counters(std::move(counters))
+    {
+    }
+
+    void fill(const void* /*data*/, std::size_t size) override
+    {
+        counters->bufferBytes += size;
+    }
+
+    std::shared_ptr<Counters> counters;
+};
+
+class NullVertexBuffer : public impl::VertexBuffer
+{
+public:
+    NullVertexBuffer(std::shared_ptr<Counters> counters)
+        : counters(std::move(counters))
+    {
+    }
+
+    void fill(const void* /*data*/, std::size_t size) override
+    {
+        counters->bufferBytes += size;
+    }
+
+    void fill(const void* /*data*/, std::size_t /*offset*/, std::size_t size, bool /*synchronized*/) override
+    {
+        counters->bufferBytes += size;
+    }
+
+    std::shared_ptr<Counters> counters;
+};
+
+class NullShaderStage : public impl::ShaderStage
+{
+public:
+    NullShaderStage(Stage stage)
+        : stage(stage)
+    {
+    }
+
+    Stage getType() override
+    {
+        return this->stage;
+    }
+
+    Stage stage;
+};
+
+class NullShaderBindingPoint : public impl::ShaderBindingPoint
+{
+public:
+    NullShaderBindingPoint(std::shared_ptr<Counters> counters)
+        : counters(std::move(counters))
+    {
+    }
+
+    void bind(gl::Sampler /*sampler*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void bind(gl::Texture2D /*tex*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void bind(gl::Texture2DArray /*tex*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void bind(gl::Texture3D /*tex*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void bind(gl::CubeMap /*cubeMap*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void bind(gl::ConstantBuffer /*cb*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void bind(gl::Texture2D /*tex*/, int /*level*/, Access /*access*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void setConstant(glm::vec2 /*val*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void setConstant(glm::vec3 /*val*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void setConstant(glm::vec4 /*val*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void setConstant(glm::ivec2 /*val*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void setConstant(glm::ivec3 /*val*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void setConstant(glm::ivec4 /*val*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void setConstant(glm::uvec2 /*val*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void setConstant(glm::uvec3 /*val*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void setConstant(glm::uvec4 /*val*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void setConstant(glm::mat4 /*val*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void setConstant(float /*val*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void setConstant(int /*val*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    void setConstant(unsigned int /*val*/) override
+    {
+        counters->stateChanges += 1;
+    }
+
+    bool queryConstantBufferStructure(ConstantBufferStructure* /*structure*/) override
+    {
+        // There is no shader to query the layout from.
+        return false;
+    }
+
+    std::shared_ptr<Counters> counters;
+};
+
+class NullShaderPipeline : public impl::ShaderPipeline
+{
+public:
+    NullShaderPipeline(std::shared_ptr<Counters> counters)
+        : bindingPoint(std::move(counters))
+    {
+    }
+
+    gl::ShaderBindingPoint getBindingPoint(const char* /*name*/) override
+    {
+        // Shaders are never compiled, so every name is accepted and they all share the same binding point.
+        return &this->bindingPoint;
+    }
+
+    NullShaderBindingPoint bindingPoint;
+};
+
+class NullTimer : public impl::Timer
+{
+public:
+    void begin() override
+    {
+    }
+
+    void end() override
+    {
+    }
+
+    bool done() override
+    {
+        return true;
+    }
+
+    int result() override
+    {
+        return 0;
+    }
+};
+
+NullRenderDevice::NullRenderDevice()
+    : mCounters(std::make_shared<Counters>())
+{
+}
+
+const Counters& NullRenderDevice::counters() const
+{
+    return *mCounters;
+}
+
+void NullRenderDevice::resetCounters()
+{
+    *mCounters = Counters{};
+}
+
+Framebuffer NullRenderDevice::createFramebuffer(const FramebufferDesc& /*desc*/)
+{
+    mCounters->resourcesCreated += 1;
+    return std::make_shared<NullFramebuffer>();
+}
+
+void NullRenderDevice::setFramebuffer(Framebuffer /*fb*/)
+{
+    mCounters->stateChanges += 1;
+}
+
+RasterState NullRenderDevice::createRasterState(const RasterStateDesc& /*desc*/)
+{
+    mCounters->resourcesCreated += 1;
+    return std::make_shared<NullRasterState>();
+}
+
+void NullRenderDevice::setRasterState(RasterState /*rs*/)
+{
+    mCounters->stateChanges += 1;
+}
+
+DepthStencilState NullRenderDevice::createDepthStencilState(const DepthStencilStateDesc& /*desc*/)
+{
+    mCounters->resourcesCreated += 1;
+    return std::make_shared<NullDepthStencilState>();
+}
+
+void NullRenderDevice::setDepthStencilState(DepthStencilState /*dss*/)
+{
+    mCounters->stateChanges += 1;
+}
+
+BlendState NullRenderDevice::createBlendState(const BlendStateDesc& /*desc*/)
+{
+    mCounters->resourcesCreated += 1;
+    return std::make_shared<NullBlendState>();
+}
+
+void NullRenderDevice::setBlendState(BlendState /*bs*/)
+{
+    mCounters->stateChanges += 1;
+}
+
+Sampler NullRenderDevice::createSampler(const SamplerDesc& /*desc*/)
+{
+    mCounters->resourcesCreated += 1;
+    return std::make_shared<NullSampler>();
+}
+
+Texture2D NullRenderDevice::createTexture2D(const Texture2DDesc& desc)
+{
+    mCounters->resourcesCreated += 1;
+    mCounters->textureUpdates += countData(desc.data, desc.mipLevelCount);
+    return std::make_shared<NullTexture2D>(mCounters);
+}
+
+Texture2DArray NullRenderDevice::createTexture2DArray(const Texture2DArrayDesc& desc)
+{
+    mCounters->resourcesCreated += 1;
+    for (std::size_t i = 0; i < desc.size && i < CUBOS_CORE_GL_MAX_TEXTURE_2D_ARRAY_SIZE; ++i)
+    {
+        mCounters->textureUpdates += countData(desc.data[i], desc.mipLevelCount);
+    }
+    return std::make_shared<NullTexture2DArray>(mCounters);
+}
+
+Texture3D NullRenderDevice::createTexture3D(const Texture3DDesc& desc)
+{
+    mCounters->resourcesCreated += 1;
+    mCounters->textureUpdates += countData(desc.data, desc.mipLevelCount);
+    return std::make_shared<NullTexture3D>(mCounters);
+}
+
+CubeMap NullRenderDevice::createCubeMap(const CubeMapDesc& desc)
+{
+    mCounters->resourcesCreated += 1;
+    for (const auto* faceData : desc.data)
+    {
+        mCounters->textureUpdates += countData(faceData, desc.mipLevelCount);
+    }
+    return std::make_shared<NullCubeMap>(mCounters);
+}
+
+PixelPackBuffer NullRenderDevice::createPixelPackBuffer(std::size_t /*size*/)
+{
+    mCounters->resourcesCreated += 1;
+    return std::make_shared<NullPixelPackBuffer>();
+}
+
+ConstantBuffer NullRenderDevice::createConstantBuffer(std::size_t size, const void* data, Usage /*usage*/)
+{
+    mCounters->resourcesCreated += 1;
+    mCounters->bufferBytes += data != nullptr ? size : 0;
+    return std::make_shared<NullConstantBuffer>(mCounters);
+}
+
+IndexBuffer NullRenderDevice::createIndexBuffer(std::size_t size, const void* data, IndexFormat /*format*/,
+                                                Usage /*usage*/)
+{
+    mCounters->resourcesCreated += 1;
+    mCounters->bufferBytes += data != nullptr ? size : 0;
+    return std::make_shared<NullIndexBuffer>(mCounters);
+}
+
+void NullRenderDevice::setIndexBuffer(IndexBuffer /*ib*/)
+{
+    mCounters->stateChanges += 1;
+}
+
+VertexBuffer NullRenderDevice::createVertexBuffer(std::size_t size, const void* data, Usage /*usage*/)
+{
+    mCounters->resourcesCreated += 1;
+    mCounters->bufferBytes += data != nullptr ? size : 0;
+    return std::make_shared<NullVertexBuffer>(mCounters);
+}
+
+VertexArray NullRenderDevice::createVertexArray(const VertexArrayDesc& /*desc*/)
+{
+    mCounters->resourcesCreated += 1;
+    return std::make_shared<NullVertexArray>();
+}
+
+void NullRenderDevice::setVertexArray(VertexArray /*va*/)
+{
+    mCounters->stateChanges += 1;
+}
+
+ShaderStage NullRenderDevice::createShaderStage(Stage stage, const char* /*src*/)
+{
+    mCounters->resourcesCreated += 1;
+    return std::make_shared<NullShaderStage>(stage);
+}
+
+ShaderPipeline NullRenderDevice::createShaderPipeline(ShaderStage /*vs*/, ShaderStage /*ps*/)
+{
+    mCounters->resourcesCreated += 1;
+    return std::make_shared<NullShaderPipeline>(mCounters);
+}
+
+ShaderPipeline NullRenderDevice::createShaderPipeline(ShaderStage /*vs*/, ShaderStage /*gs*/, ShaderStage /*ps*/)
+{
+    mCounters->resourcesCreated += 1;
+    return std::make_shared<NullShaderPipeline>(mCounters);
+}
+
+ShaderPipeline NullRenderDevice::createShaderPipeline(ShaderStage /*cs*/)
+{
+    mCounters->resourcesCreated += 1;
+    return std::make_shared<NullShaderPipeline>(mCounters);
+}
+
+Timer NullRenderDevice::createTimer()
+{
+    mCounters->resourcesCreated += 1;
+    return std::make_shared<NullTimer>();
+}
+
+void NullRenderDevice::setShaderPipeline(ShaderPipeline /*pipeline*/)
+{
+    mCounters->stateChanges += 1;
+}
+
+void NullRenderDevice::clearColor(float /*r*/, float /*g*/, float /*b*/, float /*a*/)
+{
+    mCounters->clears += 1;
+}
+
+void NullRenderDevice::clearTargetColor(std::size_t /*target*/, float /*r*/, float /*g*/, float /*b*/, float /*a*/)
+{
+    mCounters->clears += 1;
+}
+
+void NullRenderDevice::clearTargetColor(std::size_t /*target*/, int /*r*/, int /*g*/, int /*b*/, int /*a*/)
+{
+    mCounters->clears += 1;
+}
+
+void NullRenderDevice::clearTargetColor(std::size_t /*target*/, unsigned int /*r*/, unsigned int /*g*/,
+                                        unsigned int /*b*/, unsigned int /*a*/)
+{
+    mCounters->clears += 1;
+}
+
+void NullRenderDevice::clearDepth(float /*depth*/)
+{
+    mCounters->clears += 1;
+}
+
+void NullRenderDevice::clearStencil(int /*stencil*/)
+{
+    mCounters->clears += 1;
+}
+
+void NullRenderDevice::drawLines(std::size_t /*offset*/, std::size_t count)
+{
+    NullRenderDevice::drawTrianglesInstanced(0, count, 1);
+}
+
+void NullRenderDevice::drawTriangles(std::size_t /*offset*/, std::size_t count)
+{
+    NullRenderDevice::drawTrianglesInstanced(0, count, 1);
+}
+
+void NullRenderDevice::drawTrianglesIndexed(std::size_t /*offset*/, std::size_t count)
+{
+    NullRenderDevice::drawTrianglesInstanced(0, count, 1);
+}
+
+void NullRenderDevice::drawTrianglesInstanced(std::size_t /*offset*/, std::size_t count, std::size_t instanceCount)
+{
+    mCounters->drawCalls += 1;
+    mCounters->vertices += count * instanceCount;
+    mCounters->instances += instanceCount;
+}
+
+void NullRenderDevice::drawTrianglesIndexedInstanced(std::size_t /*offset*/, std::size_t count,
+                                                     std::size_t instanceCount)
+{
+    NullRenderDevice::drawTrianglesInstanced(0, count, instanceCount);
+}
+
+void NullRenderDevice::dispatchCompute(std::size_t /*x*/, std::size_t /*y*/, std::size_t /*z*/)
+{
+    mCounters->dispatches += 1;
+}
+
+void NullRenderDevice::memoryBarrier(MemoryBarriers /*barriers*/)
+{
+}
+
+void NullRenderDevice::setViewport(int /*x*/, int /*y*/, int /*w*/, int /*h*/)
+{
+    mCounters->stateChanges += 1;
+}
+
+void NullRenderDevice::setScissor(int /*x*/, int /*y*/, int /*w*/, int /*h*/)
+{
+    mCounters->stateChanges += 1;
+}
+
+int NullRenderDevice::getProperty(Property prop)
+{
+    switch (prop)
+    {
+    case Property::MaxAnisotropy:
+        return 1;
+    case Property::ComputeSupported:
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include "headless_window.hpp"
+
+using namespace cubos::core;
+using namespace cubos::core::io;
+
+HeadlessWindow::HeadlessWindow(const glm::ivec2& size)
+    : mSize(glm::uvec2(glm::max(size, glm::ivec2(1))))
+    , mCreationTime(std::chrono::steady_clock::now())
+{
+}
+
+void HeadlessWindow::pollEvents()
+{
+    // There is no input to poll, events can only be pushed manually.
+}
+
+void HeadlessWindow::swapBuffers()
+{
+}
+
+gl::RenderDevice& HeadlessWindow::renderDevice() const
+{
+    return mRenderDevice;
+}
+
+glm::uvec2 HeadlessWindow::size() const
+{
+    return mSize;
+}
+
+glm::uvec2 HeadlessWindow::framebufferSize() const
+{
+    return mSize;
+}
+
+float HeadlessWindow::contentScale() const
+{
+    return 1.0F;
+}
+
+bool HeadlessWindow::shouldClose() const
+{
+    return false;
+}
+
+double HeadlessWindow::time() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - mCreationTime).count();
+}
+
+void HeadlessWindow::mouseState(MouseState state)
+{
+    mMouseState = state;
+}
+
+MouseState HeadlessWindow::mouseState() const
+{
+    return mMouseState;
+}
+
+glm::ivec2 HeadlessWindow::getMousePosition()
+{
+    return mMousePosition;
+}
+
+void HeadlessWindow::setMousePosition(glm::ivec2 pos)
+{
+    mMousePosition = pos;
+}
+
+std::shared_ptr<Cursor> HeadlessWindow::createCursor(Cursor::Standard /*standard*/)
+{
+    return nullptr;
+}
+
+void HeadlessWindow::cursor(std::shared_ptr<Cursor> /*cursor*/)
+{
+}
+
+void HeadlessWindow::clipboard(const std::string& text)
+{
+    mClipboard = text;
+}
+
+const char* HeadlessWindow::clipboard() const
+{
+    return mClipboard.c_str();
+}
+
+Modifiers HeadlessWindow::modifiers() const
+{
+    return Modifiers::None;
+}
+
+bool HeadlessWindow::pressed(Key /*key*/, Modifiers /*modifiers*/) const
+{
+    return false;
+}
+
+bool HeadlessWindow::pressed(MouseButton /*button*/) const
+{
+    return false;
+}
+
+bool HeadlessWindow::gamepadState(int /*gamepad*/, GamepadState& /*state*/) const
+{
+    return false;
+}
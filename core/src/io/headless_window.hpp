@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include <cubos/core/gl/null_render_device.hpp>
+#include <cubos/core/io/window.hpp>
+
+namespace cubos::core::io
+{
+    /// Window which isn't shown anywhere and never receives input, and whose render device doesn't render anything.
+    class HeadlessWindow : public BaseWindow
+    {
+    public:
+        HeadlessWindow(const glm::ivec2& size);
+
+        // Interface implementation.
+
+        void pollEvents() override;
+        void swapBuffers() override;
+        gl::RenderDevice& renderDevice() const override;
+        glm::uvec2 size() const override;
+        glm::uvec2 framebufferSize() const override;
+        float contentScale() const override;
+        bool shouldClose() const override;
+        double time() const override;
+        void mouseState(MouseState state) override;
+        MouseState mouseState() const override;
+        glm::ivec2 getMousePosition() override;
+        void setMousePosition(glm::ivec2 pos) override;
+        std::shared_ptr<Cursor> createCursor(Cursor::Standard standard) override;
+        void cursor(std::shared_ptr<Cursor> cursor) override;
+        void clipboard(const std::string& text) override;
+        const char* clipboard() const override;
+        Modifiers modifiers() const override;
+        bool pressed(Key key, Modifiers modifiers = Modifiers::None) const override;
+        bool pressed(MouseButton button) const override;
+        bool gamepadState(int gamepad, GamepadState& state) const override;
+
+    private:
+        glm::uvec2 mSize;
+        std::chrono::steady_clock::time_point mCreationTime;
+        MouseState mMouseState{MouseState::Default};
+        glm::ivec2 mMousePosition{0, 0};
+        std::string mClipboard;
+        mutable gl::NullRenderDevice mRenderDevice;
+    };
+} // namespace cubos::core::io
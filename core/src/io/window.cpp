@@ -1,12 +1,15 @@
+#include <cubos/core/ecs/reflection.hpp>
 #include <cubos/core/io/window.hpp>
 #include <cubos/core/reflection/traits/constructible.hpp>
 #include <cubos/core/reflection/traits/enum.hpp>
 #include <cubos/core/reflection/type.hpp>
 
 #include "glfw_window.hpp"
+#include "headless_window.hpp"
 
 using namespace cubos::core::io;
 
+using cubos::core::ecs::MainThreadTrait;
 using cubos::core::io::MouseAxis;
 using cubos::core::io::MouseButton;
 using cubos::core::io::MouseState;
@@ -18,6 +21,11 @@ Window cubos::core::io::openWindow(const std::string& title, const glm::ivec2& s
     return std::make_shared<GLFWWindow>(title, size, vSync);
 }
 
+Window cubos::core::io::openHeadlessWindow(const glm::ivec2& size)
+{
+    return std::make_shared<HeadlessWindow>(size);
+}
+
 BaseWindow::BaseWindow()
 {
     mPolled = false;
@@ -85,6 +93,9 @@ CUBOS_REFLECT_EXTERNAL_IMPL(WindowEvent)
 
 CUBOS_REFLECT_EXTERNAL_IMPL(Window)
 {
+    // The window's render device is bound to the thread which created it, and thus systems which access it must
+    // always run on the main thread.
     return Type::create("cubos::core::io::Window")
-        .with(ConstructibleTrait::typed<Window>().withMoveConstructor().build());
+        .with(ConstructibleTrait::typed<Window>().withMoveConstructor().build())
+        .with(MainThreadTrait{});
 }
@@ -262,6 +262,16 @@ const void* AnyVector::at(std::size_t index) const
     return static_cast<char*>(mData) + mStride * index;
 }
 
+void* AnyVector::data()
+{
+    return mData;
+}
+
+const void* AnyVector::data() const
+{
+    return mData;
+}
+
 std::size_t AnyVector::size() const
 {
     return mSize;
@@ -1,65 +1,488 @@
+#include <cubos/core/reflection/external/primitives.hpp>
+#include <cubos/core/tel/logging.hpp>
 #include <cubos/core/thread/pool.hpp>
 
+using cubos::core::thread::TaskGroup;
 using cubos::core::thread::ThreadPool;
 
-ThreadPool::ThreadPool(std::size_t numThreads)
+namespace
 {
-    mThreads.reserve(numThreads);
-    mNumTasks = 0;
-    mStop = false;
-
-    for (std::size_t i = 0; i < numThreads; i++)
+    /// @brief Lock-free work-stealing deque (Chase-Lev), with formal memory orderings from Lê et al.
+    ///
+    /// Only the owner thread may push and pop items, from the bottom. Any thread may steal items, from the top.
+    ///
+    /// @tparam T Item type.
+    template <typename T>
+    class WorkStealingDeque final
     {
-        mThreads.emplace_back([this]() {
-            while (true)
+    public:
+        WorkStealingDeque()
+        {
+            mBuffers.emplace_back(std::make_unique<Buffer>(32));
+            mBuffer.store(mBuffers.back().get(), std::memory_order_relaxed);
+        }
+
+        /// @brief Pushes an item to the bottom of the deque. Must only be called by the owner.
+        /// @param item Item.
+        void push(T* item)
+        {
+            auto bottom = mBottom.load(std::memory_order_relaxed);
+            auto top = mTop.load(std::memory_order_acquire);
+            auto* buffer = mBuffer.load(std::memory_order_relaxed);
+
+            if (bottom - top > buffer->capacity - 1)
             {
-                std::function<void()> task;
+                buffer = this->grow(buffer, top, bottom);
+            }
+
+            buffer->at(bottom).store(item, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            mBottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        /// @brief Pops an item from the bottom of the deque. Must only be called by the owner.
+        /// @return Item, or null if the deque is empty.
+        T* pop()
+        {
+            auto bottom = mBottom.load(std::memory_order_relaxed) - 1;
+            auto* buffer = mBuffer.load(std::memory_order_relaxed);
+            mBottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto top = mTop.load(std::memory_order_relaxed);
+
+            if (top > bottom)
+            {
+                // The deque was empty.
+                mBottom.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
 
+            T* item = buffer->at(bottom).load(std::memory_order_relaxed);
+            if (top == bottom)
+            {
+                // This is the last item, race against thieves for it.
+                if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
                 {
-                    std::unique_lock<std::mutex> lock(mMutex);
-
-                    // Wait until a task is available, or the thread pool is being destroyed.
-                    mNewTask.wait(lock, [this]() { return mStop || !mTasks.empty(); });
-                    if (mStop && mTasks.empty())
-                    {
-                        return; // Thread pool is being destroyed, and there are no more tasks to execute.
-                    }
-                    task = std::move(mTasks.front());
-                    mTasks.pop_front();
-                    mNumTasks += 1; // A task is being executed.
+                    item = nullptr;
                 }
+                mBottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+
+            return item;
+        }
 
-                task();
+        /// @brief Steals an item from the top of the deque. May be called by any thread.
+        /// @return Item, or null if the deque is empty or another thread took the item first.
+        T* steal()
+        {
+            auto top = mTop.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto bottom = mBottom.load(std::memory_order_acquire);
 
-                std::unique_lock<std::mutex> lock(mMutex);
-                mNumTasks -= 1;         // Task has finished executing.
-                mTaskDone.notify_one(); // Signal that a thread has finished executing a task.
+            if (top >= bottom)
+            {
+                return nullptr;
             }
-        });
+
+            auto* buffer = mBuffer.load(std::memory_order_acquire);
+            T* item = buffer->at(top).load(std::memory_order_relaxed);
+            if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return nullptr;
+            }
+
+            return item;
+        }
+
+    private:
+        /// @brief Circular buffer with a power of two capacity.
+        struct Buffer
+        {
+            explicit Buffer(std::int64_t size)
+                : capacity{size}
+                , slots{new std::atomic<T*>[static_cast<std::size_t>(size)]}
+            {
+            }
+
+            std::atomic<T*>& at(std::int64_t index)
+            {
+                return slots[static_cast<std::size_t>(index & (capacity - 1))];
+            }
+
+            std::int64_t capacity;
+            std::unique_ptr<std::atomic<T*>[]> slots;
+        };
+
+        /// @brief Replaces the buffer with one twice as large.
+        ///
+        /// The old buffer is kept alive until the deque is destroyed, as thieves may still be reading from it.
+        ///
+        /// @param buffer Current buffer.
+        /// @param top Index of the top item.
+        /// @param bottom Index past the bottom item.
+        /// @return New buffer.
+        Buffer* grow(Buffer* buffer, std::int64_t top, std::int64_t bottom)
+        {
+            mBuffers.emplace_back(std::make_unique<Buffer>(buffer->capacity * 2));
+            auto* grown = mBuffers.back().get();
+            for (auto i = top; i < bottom; ++i)
+            {
+                grown->at(i).store(buffer->at(i).load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+            mBuffer.store(grown, std::memory_order_release);
+            return grown;
+        }
+
+        alignas(64) std::atomic<std::int64_t> mTop{0};
+        alignas(64) std::atomic<std::int64_t> mBottom{0};
+        std::atomic<Buffer*> mBuffer;
+        std::vector<std::unique_ptr<Buffer>> mBuffers; ///< Only accessed by the owner.
+    };
+
+    /// @brief Pool whose worker is running on the current thread, if any.
+    thread_local const ThreadPool* currentPool = nullptr;
+
+    /// @brief Index of the worker running on the current thread.
+    thread_local std::size_t currentIndex = 0;
+
+    /// @brief How many times a worker looks for jobs before going to sleep.
+    constexpr int SpinCount = 32;
+} // namespace
+
+struct ThreadPool::Worker
+{
+    WorkStealingDeque<Job> jobs;
+    std::atomic<std::size_t> executed{0};
+    std::atomic<std::size_t> stolen{0};
+    std::atomic<std::size_t> sleeps{0};
+    std::size_t nextVictim{0}; ///< Where the worker starts looking for jobs to steal.
+    std::vector<void*> free{}; ///< Memory of finished jobs, only accessed by the worker's thread.
+};
+
+ThreadPool::ThreadPool(std::size_t numThreads)
+{
+    mWorkers.reserve(numThreads);
+    for (std::size_t i = 0; i < numThreads; ++i)
+    {
+        mWorkers.emplace_back(std::make_unique<Worker>());
+        mWorkers.back()->nextVictim = i + 1;
+    }
+
+    // Only start the threads after all workers exist, as they steal from each other.
+    mThreads.reserve(numThreads);
+    for (std::size_t i = 0; i < numThreads; ++i)
+    {
+        mThreads.emplace_back([this, i]() { this->work(i); });
     }
 }
 
 ThreadPool::~ThreadPool()
 {
-    mStop = true;
-    mNewTask.notify_all();
+    this->wait();
+
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mWake.notify_all();
+
     for (auto& thread : mThreads)
     {
         thread.join();
     }
+
+    for (auto& worker : mWorkers)
+    {
+        for (auto* memory : worker->free)
+        {
+            ::operator delete(memory);
+        }
+    }
+
+    for (auto* memory : mSharedFree)
+    {
+        ::operator delete(memory);
+    }
+}
+
+void ThreadPool::wait()
+{
+    CUBOS_ASSERT(this->currentWorker() == nullptr, "Waiting for the whole pool from within one of its tasks");
+    this->help(mActive);
+}
+
+std::size_t ThreadPool::threadCount() const
+{
+    return mWorkers.size();
+}
+
+ThreadPool::Stats ThreadPool::stats(std::size_t worker) const
+{
+    CUBOS_ASSERT(worker < mWorkers.size(), "No such worker {}", worker);
+    const auto& state = *mWorkers[worker];
+    return {
+        .executed = state.executed.load(std::memory_order_relaxed),
+        .stolen = state.stolen.load(std::memory_order_relaxed),
+        .sleeps = state.sleeps.load(std::memory_order_relaxed),
+    };
+}
+
+void* ThreadPool::allocate()
+{
+    auto* worker = this->currentWorker();
+    if (worker != nullptr && !worker->free.empty())
+    {
+        auto* memory = worker->free.back();
+        worker->free.pop_back();
+        return memory;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mSharedMutex);
+        if (!mSharedFree.empty())
+        {
+            auto* memory = mSharedFree.back();
+            mSharedFree.pop_back();
+            return memory;
+        }
+    }
+
+    return ::operator new(sizeof(Job));
+}
+
+void ThreadPool::release(Job* job)
+{
+    job->~Job();
+
+    auto* worker = this->currentWorker();
+    if (worker != nullptr && worker->free.size() < FreeListSize)
+    {
+        worker->free.push_back(job);
+        return;
+    }
+
+    // Jobs submitted from outside the pool are mostly released by workers. Moving the excess of their lists to the
+    // shared list lets those threads reuse the memory too.
+    std::unique_lock<std::mutex> lock(mSharedMutex);
+    if (worker != nullptr)
+    {
+        auto half = worker->free.begin() + static_cast<std::ptrdiff_t>(FreeListSize / 2);
+        mSharedFree.insert(mSharedFree.end(), half, worker->free.end());
+        worker->free.erase(half, worker->free.end());
+        worker->free.push_back(job);
+    }
+    else
+    {
+        mSharedFree.push_back(job);
+    }
+
+    // Bound the shared list, so that bursts of tasks don't keep their memory around forever.
+    while (mSharedFree.size() > FreeListSize * (mWorkers.size() + 1))
+    {
+        ::operator delete(mSharedFree.back());
+        mSharedFree.pop_back();
+    }
 }
 
-void ThreadPool::addTask(std::function<void()> task)
+void ThreadPool::submit(Job* job)
 {
+    mActive.fetch_add(1, std::memory_order_relaxed);
+
+    if (auto* worker = this->currentWorker())
     {
+        worker->jobs.push(job);
+    }
+    else
+    {
+        std::unique_lock<std::mutex> lock(mSharedMutex);
+        mShared.push_back(job);
+        mSharedSize.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Must be incremented after the job is pushed, so that threads which see it can find the job.
+    mQueued.fetch_add(1, std::memory_order_seq_cst);
+    this->wake(false);
+}
+
+void ThreadPool::help(const std::atomic<std::size_t>& pending)
+{
+    auto* worker = this->currentWorker();
+    while (pending.load(std::memory_order_acquire) != 0)
+    {
+        bool stolen = false;
+        if (auto* job = this->take(worker, stolen))
+        {
+            if (worker != nullptr)
+            {
+                worker->executed.fetch_add(1, std::memory_order_relaxed);
+                worker->stolen.fetch_add(stolen ? 1 : 0, std::memory_order_relaxed);
+            }
+
+            this->execute(job);
+            continue;
+        }
+
+        // There's nothing to run, sleep until the counter reaches zero or more jobs are queued.
         std::unique_lock<std::mutex> lock(mMutex);
-        mTasks.push_back(std::move(task));
+        mSleeping.fetch_add(1, std::memory_order_seq_cst);
+        mWake.wait(lock, [&]() {
+            return pending.load(std::memory_order_seq_cst) == 0 || mQueued.load(std::memory_order_seq_cst) > 0;
+        });
+        mSleeping.fetch_sub(1, std::memory_order_relaxed);
     }
-    mNewTask.notify_one();
 }
 
-void ThreadPool::wait()
+ThreadPool::Job* ThreadPool::take(Worker* worker, bool& stolen)
+{
+    Job* job = nullptr;
+
+    if (worker != nullptr)
+    {
+        job = worker->jobs.pop();
+    }
+
+    if (job == nullptr && mSharedSize.load(std::memory_order_relaxed) != 0)
+    {
+        std::unique_lock<std::mutex> lock(mSharedMutex);
+        if (!mShared.empty())
+        {
+            job = mShared.front();
+            mShared.pop_front();
+            mSharedSize.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    if (job == nullptr && !mWorkers.empty())
+    {
+        // Rotate the starting victim so that thieves don't all hit the same worker.
+        auto start = worker != nullptr ? worker->nextVictim++ : mNextVictim.fetch_add(1, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < mWorkers.size() && job == nullptr; ++i)
+        {
+            auto& victim = *mWorkers[(start + i) % mWorkers.size()];
+            if (&victim != worker)
+            {
+                job = victim.jobs.steal();
+                stolen = job != nullptr;
+            }
+        }
+    }
+
+    if (job != nullptr)
+    {
+        mQueued.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    return job;
+}
+
+void ThreadPool::execute(Job* job)
+{
+    auto* group = job->group();
+    job->run();
+    this->release(job);
+
+    // The group may be destroyed as soon as its counter reaches zero, so it must not be accessed afterwards.
+    bool wakeAll = false;
+    if (group != nullptr && group->mPending.fetch_sub(1, std::memory_order_seq_cst) == 1)
+    {
+        wakeAll = true;
+    }
+
+    if (mActive.fetch_sub(1, std::memory_order_seq_cst) == 1)
+    {
+        wakeAll = true;
+    }
+
+    if (wakeAll)
+    {
+        this->wake(true);
+    }
+}
+
+void ThreadPool::wake(bool all)
+{
+    // Threads increment the sleeping counter while holding the mutex, before checking their wake condition. Thus, if
+    // no thread is sleeping, any thread which goes to sleep afterwards is guaranteed to see the updated counters.
+    if (mSleeping.load(std::memory_order_seq_cst) == 0)
+    {
+        return;
+    }
+
+    {
+        // Make sure that threads which have checked their condition are already waiting before notifying them.
+        std::unique_lock<std::mutex> lock(mMutex);
+    }
+
+    if (all)
+    {
+        mWake.notify_all();
+    }
+    else
+    {
+        mWake.notify_one();
+    }
+}
+
+ThreadPool::Worker* ThreadPool::currentWorker() const
+{
+    return currentPool == this ? mWorkers[currentIndex].get() : nullptr;
+}
+
+void ThreadPool::work(std::size_t index)
+{
+    currentPool = this;
+    currentIndex = index;
+    auto& worker = *mWorkers[index];
+
+    int spins = 0;
+    while (true)
+    {
+        bool stolen = false;
+        if (auto* job = this->take(&worker, stolen))
+        {
+            worker.executed.fetch_add(1, std::memory_order_relaxed);
+            worker.stolen.fetch_add(stolen ? 1 : 0, std::memory_order_relaxed);
+            this->execute(job);
+            spins = 0;
+            continue;
+        }
+
+        if (spins < SpinCount)
+        {
+            spins += 1;
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Wait until a job is available, or the thread pool is being destroyed.
+        std::unique_lock<std::mutex> lock(mMutex);
+        mSleeping.fetch_add(1, std::memory_order_seq_cst);
+        if (!mStop && mQueued.load(std::memory_order_seq_cst) <= 0)
+        {
+            worker.sleeps.fetch_add(1, std::memory_order_relaxed);
+            mWake.wait(lock, [this]() { return mStop || mQueued.load(std::memory_order_seq_cst) > 0; });
+        }
+        mSleeping.fetch_sub(1, std::memory_order_relaxed);
+        spins = 0;
+
+        if (mStop)
+        {
+            return; // Thread pool is being destroyed, and all tasks have already finished.
+        }
+    }
+}
+
+TaskGroup::~TaskGroup()
+{
+    this->wait();
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool)
+    : mPool{pool}
+{
+}
+
+void TaskGroup::wait()
 {
-    std::unique_lock<std::mutex> lock(mMutex);
-    mTaskDone.wait(lock, [this]() { return mNumTasks == 0 && mTasks.empty(); });
+    mPool.help(mPending);
 }
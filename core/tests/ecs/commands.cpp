@@ -1,3 +1,6 @@
+#include <thread>
+#include <vector>
+
 #include <doctest/doctest.h>
 
 #include <cubos/core/ecs/command_buffer.hpp>
@@ -53,4 +56,71 @@ TEST_CASE("ecs::Commands")
         cmdBuffer.commit();
         CHECK(world.components(foo).has<ParentComponent>());
     }
+
+    SUBCASE("commands from multiple threads are committed in the order they were recorded")
+    {
+        bool destroyed = false;
+
+        // The component is added on another thread, but only after the entity is created on this one.
+        auto bar = cmds.create().entity();
+        std::thread thread{[&]() { cmds.add(bar, DetectDestructorComponent{{&destroyed}}); }};
+        thread.join();
+        cmds.add(bar, IntegerComponent{1});
+        cmds.remove<IntegerComponent>(foo);
+
+        cmdBuffer.commit();
+        CHECK(world.components(bar).has<DetectDestructorComponent>());
+        CHECK(world.components(bar).get<IntegerComponent>().value == 1);
+        CHECK_FALSE(world.components(foo).has<IntegerComponent>());
+        CHECK_FALSE(destroyed);
+
+        // Values recorded but never committed are destructed with the buffer.
+        {
+            CommandBuffer other{world};
+            Commands{other}.add(bar, DetectDestructorComponent{{&destroyed}});
+        }
+        CHECK(destroyed);
+    }
+
+    SUBCASE("commands interleaved between many threads keep their order")
+    {
+        std::vector<int> order{};
+        for (int i = 0; i < 32; ++i)
+        {
+            auto record = [&, i]() {
+                cmds.add(foo, IntegerComponent{i});
+                cmdBuffer.push([&order, i](World&) { order.push_back(i); });
+            };
+
+            if (i % 4 == 0)
+            {
+                record();
+            }
+            else
+            {
+                std::thread thread{record};
+                thread.join();
+            }
+        }
+
+        cmdBuffer.commit();
+        CHECK(world.components(foo).get<IntegerComponent>().value == 31);
+        REQUIRE(order.size() == 32);
+        for (int i = 0; i < 32; ++i)
+        {
+            CHECK(order[static_cast<std::size_t>(i)] == i);
+        }
+    }
+
+    SUBCASE("values larger than the first arena block")
+    {
+        // Record many values on a single thread, so that the arena must grow past its first blocks.
+        for (int i = 0; i < 1000; ++i)
+        {
+            cmds.add(foo, IntegerComponent{i});
+        }
+        cmdBuffer.commit();
+        CHECK(world.components(foo).get<IntegerComponent>().value == 999);
+        CHECK(cmdBuffer.empty());
+    }
 }
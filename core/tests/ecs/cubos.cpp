@@ -142,6 +142,40 @@ TEST_CASE("ecs::Cubos")
         cubos.run();
     }
 
+    SUBCASE("changes written through Query::at are seen by systems which run later")
+    {
+        CUBOS_DEFINE_TAG(write);
+
+        cubos.resource<long>(0);
+        cubos.component<int>();
+        cubos.tag(write);
+
+        Entity entity{};
+        cubos.startupSystem("spawn stuff").call(
+            [&entity](Commands cmds) { entity = cmds.create().add<int>(1).entity(); });
+
+        cubos.system("write through at").tagged(write).call([&entity](Query<int&> query) {
+            auto match = query.at(entity);
+            REQUIRE(match.contains());
+            std::get<0>(*match) += 1;
+        });
+
+        cubos.system("count changes").after(write).changed<int>().call([](long& count, Query<const int&> query) {
+            for (auto [x] : query)
+            {
+                (void)x;
+                count += 1;
+            }
+        });
+
+        cubos.start();
+        for (long i = 1; i <= 3; ++i)
+        {
+            cubos.update();
+            CHECK(cubos.world().resource<long>() == i);
+        }
+    }
+
     SUBCASE("changing traversal direction for tree relations")
     {
         cubos.relation<TreeRelation>();
@@ -1,11 +1,19 @@
+#include <atomic>
+#include <span>
+#include <vector>
+
 #include <doctest/doctest.h>
 
 #include <cubos/core/ecs/entity/hash.hpp>
 #include <cubos/core/ecs/query/data.hpp>
+#include <cubos/core/thread/pool.hpp>
 
 #include "../utils.hpp"
 
+using cubos::core::memory::Opt;
+using cubos::core::reflection::reflect;
 using namespace cubos::core::ecs;
+using cubos::core::thread::ThreadPool;
 
 TEST_CASE("ecs::QueryData")
 {
@@ -72,4 +80,281 @@ TEST_CASE("ecs::QueryData")
         ++it;
         REQUIRE(it == view.end());
     }
+
+    SUBCASE("chunk iteration")
+    {
+        // Spread the entities over two archetypes, and leave a third archetype empty.
+        for (int i = 0; i < 100; ++i)
+        {
+            auto entity = world.create();
+            world.components(entity).add(IntegerComponent{i});
+            if (i % 2 == 0)
+            {
+                world.components(entity).add(ParentComponent{});
+            }
+        }
+        auto empty = world.create();
+        world.components(empty).add(IntegerComponent{0}).add(EntityArrayComponent{});
+        world.destroy(empty);
+
+        QueryData<Entity, IntegerComponent&, Opt<const ParentComponent&>> query{world, {}};
+
+        int chunks = 0;
+        int withParent = 0;
+        int sum = 0;
+        auto function = [&](std::span<const uint32_t> entities, std::span<IntegerComponent> integers,
+                            std::span<const ParentComponent> parents) {
+            chunks += 1;
+            REQUIRE(entities.size() == integers.size());
+            REQUIRE((parents.empty() || parents.size() == integers.size()));
+            withParent += static_cast<int>(parents.size());
+
+            for (std::size_t i = 0; i < integers.size(); ++i)
+            {
+                REQUIRE(&world.components({entities[i], world.generation(entities[i])}).get<IntegerComponent>() ==
+                        &integers[i]);
+                sum += integers[i].value;
+            }
+        };
+        query.view().eachChunk(function);
+
+        REQUIRE(chunks == 2);
+        REQUIRE(withParent == 50);
+        REQUIRE(sum == 99 * 100 / 2);
+
+        // Regular iteration must still work after chunk iteration.
+        sum = 0;
+        for (auto [entity, integer, parent] : query.view())
+        {
+            REQUIRE(parent.contains() == (integer.value % 2 == 0));
+            sum += integer.value;
+        }
+        REQUIRE(sum == 99 * 100 / 2);
+    }
+
+    SUBCASE("change and addition terms")
+    {
+        auto first = world.create();
+        auto second = world.create();
+        world.components(first).add(IntegerComponent{1});
+        world.components(second).add(IntegerComponent{2});
+
+        auto integerType = world.types().id(reflect<IntegerComponent>());
+        QueryData<Entity> changed{world, {QueryTerm::makeChangedComponent(integerType, -1)}};
+        QueryData<Entity> added{world, {QueryTerm::makeAddedComponent(integerType, -1)}};
+        QueryData<IntegerComponent&> writer{world, {}};
+
+        auto collect = [](auto& query) {
+            std::vector<Entity> entities;
+            for (auto [entity] : query.view())
+            {
+                entities.push_back(entity);
+            }
+            return entities;
+        };
+
+        // Before their first update, queries consider everything as new.
+        REQUIRE(collect(changed).size() == 2);
+        REQUIRE(collect(added).size() == 2);
+
+        // Nothing happened since the queries were constructed.
+        changed.update();
+        added.update();
+        REQUIRE(collect(changed).empty());
+        REQUIRE(collect(added).empty());
+
+        // Changes made through other queries are detected.
+        writer.update();
+        for (auto [integer] : writer.view().pin(0, second))
+        {
+            integer.value += 1;
+        }
+        changed.update();
+        added.update();
+        REQUIRE(collect(changed) == std::vector<Entity>{second});
+        REQUIRE(collect(added).empty());
+
+        // Changes made directly through the world are detected, and moving the entity keeps its ticks.
+        world.components(first).get<IntegerComponent>().value = 3;
+        world.components(first).add(ParentComponent{});
+        changed.update();
+        REQUIRE(collect(changed) == std::vector<Entity>{first});
+
+        // Newly added components are both added and changed.
+        auto third = world.create();
+        world.components(third).add(IntegerComponent{4});
+        changed.update();
+        added.update();
+        REQUIRE(collect(changed) == std::vector<Entity>{third});
+        REQUIRE(collect(added) == std::vector<Entity>{third});
+
+        // Changes are only reported once.
+        changed.update();
+        added.update();
+        REQUIRE(collect(changed).empty());
+        REQUIRE(collect(added).empty());
+
+        // Accessing a component mutably is a change, even if it isn't written to.
+        writer.update();
+        for (auto [integer] : writer.view().pin(0, first))
+        {
+            (void)integer;
+        }
+        changed.update();
+        REQUIRE(collect(changed) == std::vector<Entity>{first});
+
+        // Unless the query compares writes, in which case writing the value a component already had isn't a change.
+        QueryData<IntegerComponent&> comparer{world, {QueryTerm::makeComparedComponent(integerType, -1)}};
+        comparer.update();
+        for (auto [integer] : comparer.view())
+        {
+            integer.value = integer.value == 4 ? 5 : integer.value;
+        }
+        changed.update();
+        REQUIRE(collect(changed) == std::vector<Entity>{third});
+
+        // Data accessed through at() may be written to after the view is gone, so it's always a change.
+        comparer.update();
+        auto match = comparer.at(second);
+        REQUIRE(match.contains());
+        std::get<0>(*match).value = 6;
+        changed.update();
+        REQUIRE(collect(changed) == std::vector<Entity>{second});
+
+        // Optional arguments merged with change terms still require the component to have changed.
+        world.create();
+        QueryData<Entity, Opt<const IntegerComponent&>> optional{world,
+                                                                 {QueryTerm::makeChangedComponent(integerType, -1)}};
+        auto collectOptional = [&]() {
+            std::vector<Entity> entities;
+            for (auto [entity, integer] : optional.view())
+            {
+                REQUIRE(integer.contains());
+                entities.push_back(entity);
+            }
+            return entities;
+        };
+        optional.update();
+        REQUIRE(collectOptional().empty());
+        world.components(third).get<IntegerComponent>().value = 7;
+        optional.update();
+        REQUIRE(collectOptional() == std::vector<Entity>{third});
+    }
+
+    SUBCASE("any-of change terms")
+    {
+        auto first = world.create();
+        auto second = world.create();
+        auto third = world.create();
+        world.components(first).add(IntegerComponent{1}).add(ParentComponent{});
+        world.components(second).add(IntegerComponent{2}).add(ParentComponent{});
+        world.components(third).add(IntegerComponent{3}).add(ParentComponent{});
+
+        auto integerType = world.types().id(reflect<IntegerComponent>());
+        auto parentType = world.types().id(reflect<ParentComponent>());
+        QueryData<Entity> all{world,
+                              {QueryTerm::makeChangedComponent(integerType, -1),
+                               QueryTerm::makeChangedComponent(parentType, -1)}};
+        QueryData<Entity> any{world,
+                              {QueryTerm::makeChangedComponent(integerType, -1, true),
+                               QueryTerm::makeChangedComponent(parentType, -1, true)}};
+
+        auto collect = [](auto& query) {
+            std::vector<Entity> entities;
+            for (auto [entity] : query.view())
+            {
+                entities.push_back(entity);
+            }
+            return entities;
+        };
+
+        all.update();
+        any.update();
+        REQUIRE(collect(all).empty());
+        REQUIRE(collect(any).empty());
+
+        // Only the entities where both changed match the first query, while the second matches either.
+        world.components(first).get<IntegerComponent>().value = 4;
+        world.components(second).get<ParentComponent>();
+        world.components(third).get<IntegerComponent>().value = 5;
+        world.components(third).get<ParentComponent>();
+        all.update();
+        any.update();
+        REQUIRE(collect(all) == std::vector<Entity>{third});
+        REQUIRE(collect(any).size() == 3);
+    }
+
+    SUBCASE("parallel iteration")
+    {
+        // Spread the entities over two archetypes, so that chunks from multiple tables are used.
+        for (int i = 0; i < 1000; ++i)
+        {
+            auto entity = world.create();
+            world.components(entity).add(IntegerComponent{i});
+            if (i % 3 == 0)
+            {
+                world.components(entity).add(ParentComponent{});
+            }
+        }
+
+        ThreadPool pool{2};
+        std::atomic<int> sum{0};
+        std::atomic<int> count{0};
+        std::atomic<bool> mismatch{false};
+        auto function = [&](Entity entity, IntegerComponent& component) {
+            // Assertions aren't thread-safe, so we only store the result here.
+            if (&world.components(entity).get<IntegerComponent>() != &component)
+            {
+                mismatch = true;
+            }
+            component.value += 1;
+            sum.fetch_add(component.value);
+            count.fetch_add(1);
+        };
+
+        QueryData<Entity, IntegerComponent&> query{world, {}};
+
+        SUBCASE("without pool")
+        {
+            query.view().parEach(nullptr, 64, function);
+        }
+
+        SUBCASE("with pool")
+        {
+            query.view().parEach(&pool, 64, function);
+        }
+
+        SUBCASE("with pool and large chunks")
+        {
+            query.view().parEach(&pool, 4096, function);
+        }
+
+        REQUIRE_FALSE(mismatch.load());
+        REQUIRE(count.load() == 1000);
+        REQUIRE(sum.load() == 1000 * 1001 / 2);
+    }
+
+    SUBCASE("parallel iteration over relations")
+    {
+        auto root = world.create();
+        for (int i = 0; i < 100; ++i)
+        {
+            world.relate(world.create(), root, TreeRelation{.value = i});
+        }
+
+        ThreadPool pool{2};
+        std::atomic<int> sum{0};
+        std::atomic<int> wrongTargets{0};
+        QueryData<Entity, TreeRelation&, Entity> query{world, {}};
+        auto function = [&](Entity /*from*/, TreeRelation& relation, Entity to) {
+            if (to != root)
+            {
+                wrongTargets.fetch_add(1);
+            }
+            sum.fetch_add(relation.value);
+        };
+        query.view().parEach(&pool, 16, function);
+        REQUIRE(wrongTargets.load() == 0);
+        REQUIRE(sum.load() == 99 * 100 / 2);
+    }
 }
@@ -201,6 +201,38 @@ TEST_CASE("ecs::QueryTerm")
         REQUIRE(otherTerms[3].entity.target == 1);
     }
 
+    SUBCASE("resolve changed and added terms with optional arguments")
+    {
+        // Equivalent to having Query<Opt<IntegerComponent&>, Opt<ParentComponent&>>, with the manual terms
+        // Changed(Integer), Added(Parent)
+        std::vector<QueryTerm> otherTerms = {
+            QueryTerm::makeOptComponent(integerComponent, -1),
+            QueryTerm::makeOptComponent(parentComponent, -1),
+        };
+        auto result = QueryTerm::resolve(types,
+                                         {
+                                             QueryTerm::makeChangedComponent(integerComponent, -1),
+                                             QueryTerm::makeAddedComponent(parentComponent, -1),
+                                         },
+                                         otherTerms);
+        REQUIRE(result.size() == 2);
+
+        // The terms must remain required, or else the filter would ignore them.
+        REQUIRE(result[0].isComponent(types));
+        REQUIRE(result[0].component.changed);
+        REQUIRE_FALSE(result[0].component.optional);
+
+        REQUIRE(result[1].isComponent(types));
+        REQUIRE(result[1].component.added);
+        REQUIRE_FALSE(result[1].component.optional);
+
+        REQUIRE(otherTerms.size() == 2);
+        REQUIRE_FALSE(otherTerms[0].component.optional);
+        REQUIRE(otherTerms[0].component.changed);
+        REQUIRE_FALSE(otherTerms[1].component.optional);
+        REQUIRE(otherTerms[1].component.added);
+    }
+
     SUBCASE("resolve with relations but without base terms")
     {
         // Equivalent to having Query<Entity, EmptyRelation&, Entity, EmptyRelation& Entity> with no manual terms.
@@ -1,20 +1,25 @@
 /// @file
 /// @brief Covers the SystemInfo and SystemWrapper classes.
 
+#include <atomic>
+
 #include <doctest/doctest.h>
 
 #include <cubos/core/ecs/command_buffer.hpp>
 #include <cubos/core/ecs/system/system.hpp>
 #include <cubos/core/reflection/external/primitives.hpp>
+#include <cubos/core/thread/pool.hpp>
 
 #include "utils.hpp"
 
 using cubos::core::ecs::CommandBuffer;
 using cubos::core::ecs::Commands;
 using cubos::core::ecs::Entity;
+using cubos::core::ecs::Parallel;
 using cubos::core::ecs::Query;
 using cubos::core::ecs::System;
 using cubos::core::ecs::World;
+using cubos::core::thread::ThreadPool;
 
 /// Utility used to run a system function with the given world.
 template <typename T>
@@ -111,5 +116,24 @@ TEST_CASE("ecs::System")
                 CHECK(comp);
             });
         }
+
+        SUBCASE("split work with parallel")
+        {
+            ThreadPool pool{2};
+            for (auto* systemPool : {static_cast<ThreadPool*>(nullptr), &pool})
+            {
+                std::atomic<int> calls[4]{};
+                auto system = System<void>::make(world, [&](Parallel parallel) {
+                    parallel.forEach(4, [&](std::size_t i) { calls[i].fetch_add(1); });
+                });
+                CHECK(system.access().dataTypes.empty());
+                system.run({.cmdBuffer = cmdBuf, .pool = systemPool});
+
+                for (const auto& count : calls)
+                {
+                    CHECK(count.load() == 1);
+                }
+            }
+        }
     }
 }
@@ -1,15 +1,28 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <unordered_set>
+
 #include <doctest/doctest.h>
 
 #include <cubos/core/ecs/command_buffer.hpp>
+#include <cubos/core/ecs/entity/hash.hpp>
+#include <cubos/core/ecs/reflection.hpp>
+#include <cubos/core/ecs/system/arguments/commands.hpp>
+#include <cubos/core/ecs/system/arguments/query.hpp>
 #include <cubos/core/ecs/system/schedule.hpp>
 #include <cubos/core/memory/opt.hpp>
 #include <cubos/core/reflection/external/map.hpp>
 #include <cubos/core/reflection/external/primitives.hpp>
 #include <cubos/core/reflection/external/vector.hpp>
+#include <cubos/core/thread/pool.hpp>
 
+#include "../utils.hpp"
 #include "utils.hpp"
 
 using cubos::core::memory::Opt;
+using cubos::core::thread::ThreadPool;
 
 static Schedule::NodeId validate(Opt<Schedule::NodeId> nodeId)
 {
@@ -17,6 +30,35 @@ static Schedule::NodeId validate(Opt<Schedule::NodeId> nodeId)
     return nodeId.value();
 }
 
+/// @brief Resource which may only be accessed from the main thread, and which stores the thread it was accessed from.
+struct MainThreadResource
+{
+    CUBOS_REFLECT;
+
+    std::thread::id thread;
+};
+
+CUBOS_REFLECT_IMPL(MainThreadResource)
+{
+    return TypeBuilder<MainThreadResource>("MainThreadResource").mainThread().build();
+}
+
+/// @brief Waits until the given counter reaches the given value, or until a second passes.
+/// @return Whether the counter reached the value.
+static bool waitFor(const std::atomic<int>& counter, int value)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (counter.load() < value)
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
 TEST_CASE("ecs::Schedule")
 {
     // Prepare world and context.
@@ -408,9 +450,132 @@ TEST_CASE("ecs::Schedule")
         REQUIRE(world.resource<std::vector<int>>() == expected);
     }
 
+    // Running the schedule on a thread pool should produce the same results, as all of the systems and conditions
+    // above access the same resources, and thus can never run concurrently.
+    ThreadPool pool{2};
+    for (int i = 0; i < 3; ++i)
+    {
+        world.insertResource(std::vector<int>{});
+        world.insertResource(std::map<int, int>{});
+        schedule.run(registry, context, pool);
+
+        INFO("Iteration: ", i);
+        INFO("Result: ", orderToString(world.resource<std::vector<int>>()));
+        INFO("Expected: ", orderToString(expected));
+        REQUIRE(world.resource<std::vector<int>>() == expected);
+    }
+
     // After clearing the schedule, no nodes should run.
     world.insertResource(std::vector<int>{});
     schedule.clear();
     schedule.run(registry, context);
     CHECK(world.resource<std::vector<int>>().empty());
 }
+
+TEST_CASE("ecs::Schedule on a thread pool")
+{
+    World world{};
+    CommandBuffer cmdBuffer{world};
+    SystemContext context{.cmdBuffer = cmdBuffer};
+    world.registerResource<int>();
+    world.registerResource<float>();
+    world.registerResource<MainThreadResource>();
+    world.registerComponent<IntegerComponent>();
+    world.insertResource(0);
+    world.insertResource(0.0F);
+    world.insertResource(MainThreadResource{});
+
+    SystemRegistry registry{};
+    Schedule schedule{};
+    ThreadPool pool{2};
+
+    SUBCASE("systems which don't conflict run concurrently")
+    {
+        // Each system only finishes once both have started, which can only happen if they run at the same time.
+        std::atomic<int> started{0};
+        bool bothStarted[2]{false, false};
+        validate(schedule.system(registry.add("a", makeSystem(world, [&](int&) {
+            started += 1;
+            bothStarted[0] = waitFor(started, 2);
+        }))));
+        validate(schedule.system(registry.add("b", makeSystem(world, [&](float&) {
+            started += 1;
+            bothStarted[1] = waitFor(started, 2);
+        }))));
+
+        schedule.run(registry, context, pool);
+        CHECK(bothStarted[0]);
+        CHECK(bothStarted[1]);
+    }
+
+    SUBCASE("systems which conflict never run at the same time")
+    {
+        std::atomic<int> running{0};
+        std::atomic<int> maxRunning{0};
+        for (int i = 0; i < 4; ++i)
+        {
+            validate(schedule.system(registry.add("writer", makeSystem(world, [&](int& value) {
+                maxRunning = std::max(maxRunning.load(), running += 1);
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                value += 1;
+                running -= 1;
+            }))));
+        }
+
+        schedule.run(registry, context, pool);
+        CHECK(maxRunning == 1);
+        CHECK(world.resource<int>() == 4);
+    }
+
+    SUBCASE("systems which access main thread resources run on the calling thread")
+    {
+        // Keep the pool busy with another system, so that the main thread system would be picked up by it otherwise.
+        std::atomic<int> started{0};
+        validate(schedule.system(registry.add("busy", makeSystem(world, [&](float&) {
+            started += 1;
+            waitFor(started, 2);
+        }))));
+        validate(schedule.system(registry.add("main", makeSystem(world, [&](MainThreadResource& resource) {
+            started += 1;
+            resource.thread = std::this_thread::get_id();
+        }))));
+
+        schedule.run(registry, context, pool);
+        CHECK(world.resource<MainThreadResource>().thread == std::this_thread::get_id());
+    }
+
+    SUBCASE("entities can be created concurrently with systems which read the world")
+    {
+        // Both creators run concurrently with each other and with the reader, which keeps querying the world.
+        for (int i = 0; i < 2; ++i)
+        {
+            validate(schedule.system(registry.add("creator", makeSystem(world, [](Commands cmds) {
+                for (int j = 0; j < 1000; ++j)
+                {
+                    cmds.create().add(IntegerComponent{j});
+                }
+            }))));
+        }
+        validate(schedule.system(
+            registry.add("reader", makeSystem(world, [](Query<const IntegerComponent&> query, float& count) {
+                for (int j = 0; j < 100; ++j)
+                {
+                    count = static_cast<float>(query.count());
+                }
+            }))));
+
+        for (int i = 0; i < 3; ++i)
+        {
+            schedule.run(registry, context, pool);
+        }
+
+        QueryData<Entity, const IntegerComponent&> query{world, {}};
+        std::unordered_set<Entity, EntityHash> entities{};
+        for (auto [entity, value] : query.view())
+        {
+            CHECK(world.isAlive(entity));
+            entities.insert(entity);
+        }
+        CHECK(entities.size() == 6000);
+    }
+}
@@ -156,4 +156,93 @@ TEST_CASE("ecs::DenseTable")
         REQUIRE(flags[0]);
         REQUIRE(flags[1]);
     }
-}
\ No newline at end of file
+
+    SUBCASE("move between tables with columns added out of order")
+    {
+        int values[3] = {1, 2, 3};
+
+        DenseTable table1{};
+        table1.addColumn({.inner = 2}, reflect<int>());
+        table1.addColumn({.inner = 0}, reflect<int>());
+        table1.addColumn({.inner = 1}, reflect<int>());
+
+        DenseTable table2{};
+        table2.addColumn({.inner = 2}, reflect<int>());
+        table2.addColumn({.inner = 1}, reflect<int>());
+
+        // Use entity indices far apart from each other.
+        table1.pushBack(5);
+        table1.pushBack(100000);
+        for (uint64_t column = 0; column < 3; ++column)
+        {
+            table1.column({.inner = column}).pushCopy(&values[column]);
+            table1.column({.inner = column}).pushCopy(&values[column]);
+        }
+
+        REQUIRE(table1.row(5) == 0);
+        REQUIRE(table1.row(100000) == 1);
+
+        table1.swapMove(5, table2);
+
+        REQUIRE(table1.size() == 1);
+        REQUIRE(table1.row(100000) == 0);
+        REQUIRE(table2.size() == 1);
+        REQUIRE(table2.row(5) == 0);
+        REQUIRE_FALSE(table2.contains({.inner = 0}));
+        REQUIRE(*static_cast<int*>(table2.column({.inner = 1}).at(0)) == 2);
+        REQUIRE(*static_cast<int*>(table2.column({.inner = 2}).at(0)) == 3);
+
+        table1.swapMove(100000, table2);
+
+        REQUIRE(table1.size() == 0);
+        REQUIRE(table2.size() == 2);
+        REQUIRE(table2.row(100000) == 1);
+    }
+
+    SUBCASE("columns of data types and rows after shrinking")
+    {
+        auto intColumn = ColumnId::make({.inner = 3});
+        auto floatColumn = ColumnId::make({.inner = 1});
+
+        DenseTable table{};
+        table.addColumn(intColumn, reflect<int>());
+        table.addColumn(floatColumn, reflect<float>());
+        REQUIRE(table.contains(intColumn));
+        REQUIRE(table.contains(floatColumn));
+        REQUIRE_FALSE(table.contains(ColumnId::make({.inner = 2})));
+        REQUIRE_FALSE(table.contains(ColumnId::make({.inner = 100})));
+
+        // Fill rows over many pages, then remove all of them, leaving the table empty.
+        for (uint32_t index = 0; index < 5000; index += 7)
+        {
+            int intValue = static_cast<int>(index);
+            auto floatValue = static_cast<float>(index);
+            table.pushBack(index);
+            table.column(intColumn).pushCopy(&intValue);
+            table.column(floatColumn).pushCopy(&floatValue);
+        }
+
+        for (uint32_t index = 0; index < 5000; index += 7)
+        {
+            table.swapErase(index);
+        }
+        REQUIRE(table.size() == 0);
+
+        // The table must keep working after its pages were freed.
+        int value = 42;
+        float floatValue = 4.2F;
+        table.pushBack(4000);
+        table.column(intColumn).pushCopy(&value);
+        table.column(floatColumn).pushCopy(&floatValue);
+        table.pushBack(3);
+        table.column(intColumn).pushCopy(&value);
+        table.column(floatColumn).pushCopy(&floatValue);
+        REQUIRE(table.row(4000) == 0);
+        REQUIRE(table.row(3) == 1);
+        REQUIRE(*static_cast<int*>(table.column(intColumn).at(1)) == 42);
+
+        table.swapErase(4000);
+        REQUIRE(table.row(3) == 0);
+        REQUIRE(table.entity(0) == 3);
+    }
+}
@@ -1,8 +1,10 @@
 #include <cstdlib>
+#include <vector>
 
 #include <doctest/doctest.h>
 
 #include <cubos/core/ecs/world.hpp>
+#include <cubos/core/memory/any_value.hpp>
 #include <cubos/core/reflection/external/primitives.hpp>
 #include <cubos/core/reflection/type.hpp>
 
@@ -12,6 +14,7 @@ using cubos::core::ecs::ArchetypeId;
 using cubos::core::ecs::Entity;
 using cubos::core::ecs::SparseRelationTableId;
 using cubos::core::ecs::World;
+using cubos::core::memory::AnyValue;
 using cubos::core::reflection::reflect;
 
 // NOLINTBEGIN(readability-function-size)
@@ -86,6 +89,38 @@ TEST_CASE("ecs::World")
         CHECK(destroyed);
     }
 
+    SUBCASE("add multiple components at once")
+    {
+        bool destroyed = false;
+
+        // Create an entity which already has an integer component.
+        auto foo = world.create();
+        world.components(foo).add(IntegerComponent{1});
+
+        // Add a batch which overwrites the integer, repeats the parent and adds a detect destructor component.
+        std::vector<AnyValue> components{};
+        components.push_back(AnyValue::customConstruct<IntegerComponent>(IntegerComponent{2}));
+        components.push_back(AnyValue::customConstruct<ParentComponent>(ParentComponent{}));
+        components.push_back(
+            AnyValue::customConstruct<DetectDestructorComponent>(DetectDestructorComponent{{&destroyed}}));
+        components.push_back(AnyValue::customConstruct<ParentComponent>(ParentComponent{}));
+        world.components(foo).addMany(components);
+
+        CHECK(world.components(foo).has<IntegerComponent>());
+        CHECK(world.components(foo).has<ParentComponent>());
+        CHECK(world.components(foo).has<DetectDestructorComponent>());
+        CHECK(world.components(foo).get<IntegerComponent>().value == 2);
+        CHECK_FALSE(destroyed);
+
+        // An entity with the same components added one by one must end up in the same archetype.
+        auto bar = world.create();
+        world.components(bar).add(DetectDestructorComponent{}).add(ParentComponent{}).add(IntegerComponent{3});
+        CHECK(world.archetype(foo) == world.archetype(bar));
+
+        world.destroy(foo);
+        CHECK(destroyed);
+    }
+
     SUBCASE("components are correctly destructed when their entity is destroyed")
     {
         bool destroyed = false;
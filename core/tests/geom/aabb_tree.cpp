@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include <cubos/core/geom/aabb_tree.hpp>
+
+using cubos::core::geom::AABB;
+using cubos::core::geom::AABBTree;
+using cubos::core::geom::Frustum;
+
+/// @brief Creates a box with the given center and half size.
+static AABB makeBox(const glm::vec3& center, float halfSize)
+{
+    AABB aabb{};
+    aabb.min(center - halfSize);
+    aabb.max(center + halfSize);
+    return aabb;
+}
+
+/// @brief Sorts the given values, so that they can be compared regardless of query order.
+static std::vector<std::size_t> sorted(std::vector<std::size_t> values)
+{
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+TEST_CASE("geom::AABBTree")
+{
+    AABBTree tree{0.1F};
+
+    SUBCASE("empty tree finds nothing")
+    {
+        std::vector<std::size_t> values{};
+        tree.query(makeBox({0.0F, 0.0F, 0.0F}, 100.0F), values);
+        tree.query({0.0F, 0.0F, 0.0F}, 100.0F, values);
+        CHECK(values.empty());
+        CHECK(tree.size() == 0);
+        CHECK(tree.height() == 0);
+    }
+
+    SUBCASE("queries find the overlapping leaves")
+    {
+        // Place boxes along the X axis, 10 units apart.
+        std::vector<std::size_t> proxies{};
+        for (std::size_t i = 0; i < 64; ++i)
+        {
+            proxies.push_back(tree.insert(makeBox({static_cast<float>(i) * 10.0F, 0.0F, 0.0F}, 1.0F), i));
+        }
+        CHECK(tree.size() == 64);
+
+        // The tree must be balanced.
+        CHECK(tree.height() <= 12);
+
+        std::vector<std::size_t> values{};
+        tree.query(makeBox({25.0F, 0.0F, 0.0F}, 6.0F), values);
+        CHECK(sorted(values) == std::vector<std::size_t>{2, 3});
+
+        values.clear();
+        tree.query({100.0F, 0.0F, 0.0F}, 2.0F, values);
+        CHECK(sorted(values) == std::vector<std::size_t>{10});
+
+        // Frustum which contains the slab 45 <= x <= 75.
+        Frustum frustum{
+            .top = {.normal = {0.0F, -1.0F, 0.0F}, .d = 10.0F},
+            .right = {.normal = {-1.0F, 0.0F, 0.0F}, .d = 75.0F},
+            .bottom = {.normal = {0.0F, 1.0F, 0.0F}, .d = 10.0F},
+            .left = {.normal = {1.0F, 0.0F, 0.0F}, .d = -45.0F},
+            .near = {.normal = {0.0F, 0.0F, 1.0F}, .d = 10.0F},
+            .far = {.normal = {0.0F, 0.0F, -1.0F}, .d = 10.0F},
+        };
+        values.clear();
+        tree.query(frustum, values);
+        CHECK(sorted(values) == std::vector<std::size_t>{5, 6, 7});
+
+        SUBCASE("removed leaves aren't found")
+        {
+            tree.remove(proxies[6]);
+            values.clear();
+            tree.query(frustum, values);
+            CHECK(sorted(values) == std::vector<std::size_t>{5, 7});
+            CHECK(tree.size() == 63);
+        }
+
+        SUBCASE("moved leaves are found in their new place")
+        {
+            CHECK(tree.move(proxies[0], makeBox({60.0F, 5.0F, 0.0F}, 1.0F)));
+            values.clear();
+            tree.query(frustum, values);
+            CHECK(sorted(values) == std::vector<std::size_t>{0, 5, 6, 7});
+        }
+    }
+
+    SUBCASE("small moves don't change the tree")
+    {
+        auto proxy = tree.insert(makeBox({0.0F, 0.0F, 0.0F}, 1.0F), 42);
+        CHECK_FALSE(tree.move(proxy, makeBox({0.05F, 0.0F, 0.0F}, 1.0F)));
+        CHECK(tree.move(proxy, makeBox({0.5F, 0.0F, 0.0F}, 1.0F)));
+        CHECK(tree.value(proxy) == 42);
+
+        tree.value(proxy, 7);
+        CHECK(tree.value(proxy) == 7);
+    }
+}
@@ -0,0 +1,68 @@
+#include <doctest/doctest.h>
+
+#include <cubos/core/gl/null_render_device.hpp>
+#include <cubos/core/io/window.hpp>
+
+using cubos::core::gl::NullRenderDevice;
+using cubos::core::gl::Stage;
+using cubos::core::gl::Usage;
+
+TEST_CASE("gl::NullRenderDevice")
+{
+    NullRenderDevice rd{};
+
+    SUBCASE("counts draw calls and vertices")
+    {
+        rd.drawTriangles(0, 6);
+        rd.drawTrianglesIndexedInstanced(0, 36, 10);
+        CHECK(rd.counters().drawCalls == 2);
+        CHECK(rd.counters().vertices == 6 + 36 * 10);
+        CHECK(rd.counters().instances == 11);
+    }
+
+    SUBCASE("counts uploaded buffer bytes")
+    {
+        char data[64] = {};
+        auto vb = rd.createVertexBuffer(sizeof(data), data, Usage::Dynamic);
+        rd.createConstantBuffer(128, nullptr, Usage::Dynamic);
+        vb->fill(data, 16, 32, false);
+        CHECK(rd.counters().bufferBytes == 64 + 32);
+        CHECK(rd.counters().resourcesCreated == 2);
+    }
+
+    SUBCASE("accepts any binding point and counts state changes")
+    {
+        auto vs = rd.createShaderStage(Stage::Vertex, "");
+        auto ps = rd.createShaderStage(Stage::Pixel, "");
+        auto pipeline = rd.createShaderPipeline(vs, ps);
+        REQUIRE(pipeline != nullptr);
+        CHECK(vs->getType() == Stage::Vertex);
+
+        rd.setShaderPipeline(pipeline);
+        auto bp = pipeline->getBindingPoint("anything");
+        REQUIRE(bp != nullptr);
+        bp->setConstant(1.0F);
+        CHECK(rd.counters().stateChanges == 2);
+    }
+
+    SUBCASE("counters can be reset")
+    {
+        rd.drawLines(0, 2);
+        rd.resetCounters();
+        CHECK(rd.counters().drawCalls == 0);
+        CHECK(rd.counters().vertices == 0);
+    }
+}
+
+TEST_CASE("io::openHeadlessWindow")
+{
+    auto window = cubos::core::io::openHeadlessWindow({320, 240});
+    REQUIRE(window != nullptr);
+    CHECK(window->framebufferSize() == glm::uvec2{320, 240});
+    CHECK_FALSE(window->shouldClose());
+    CHECK_FALSE(window->pollEvent().has_value());
+
+    auto& rd = dynamic_cast<NullRenderDevice&>(window->renderDevice());
+    rd.clearColor(0.0F, 0.0F, 0.0F, 1.0F);
+    CHECK(rd.counters().clears == 1);
+}
@@ -0,0 +1,122 @@
+#include <array>
+#include <atomic>
+
+#include <doctest/doctest.h>
+
+#include <cubos/core/thread/pool.hpp>
+
+#include "../utils.hpp"
+
+using cubos::core::thread::TaskGroup;
+using cubos::core::thread::ThreadPool;
+
+/// @brief Recursively sums the numbers in [begin, end), forking a task for each half.
+static int sum(ThreadPool& pool, int begin, int end)
+{
+    if (end - begin <= 4)
+    {
+        int result = 0;
+        for (int i = begin; i < end; ++i)
+        {
+            result += i;
+        }
+        return result;
+    }
+
+    int middle = begin + (end - begin) / 2;
+    int left = 0;
+    TaskGroup group{pool};
+    group.run([&]() { left = sum(pool, begin, middle); });
+    int right = sum(pool, middle, end);
+    group.wait();
+    return left + right;
+}
+
+/// @brief Checks that the pool behaves correctly with the given number of threads.
+static void testPool(std::size_t threadCount)
+{
+    ThreadPool pool{threadCount};
+    REQUIRE(pool.threadCount() == threadCount);
+
+    // All tasks run before wait returns.
+    {
+        std::atomic<int> counter{0};
+        for (int i = 0; i < 1000; ++i)
+        {
+            pool.addTask([&counter]() { counter.fetch_add(1); });
+        }
+        pool.wait();
+        REQUIRE(counter.load() == 1000);
+
+        // Every task is executed either by a worker or by the waiting thread.
+        std::size_t executed = 0;
+        for (std::size_t i = 0; i < pool.threadCount(); ++i)
+        {
+            auto stats = pool.stats(i);
+            CHECK(stats.stolen <= stats.executed);
+            executed += stats.executed;
+        }
+        CHECK(executed <= 1000);
+    }
+
+    // Tasks with large captures.
+    {
+        std::array<int, 64> values{};
+        values.fill(1);
+        std::atomic<int> counter{0};
+        pool.addTask([&counter, values]() {
+            for (int value : values)
+            {
+                counter.fetch_add(value);
+            }
+        });
+        pool.wait();
+        REQUIRE(counter.load() == 64);
+    }
+
+    // Captures are destroyed after running.
+    {
+        bool destroyed = false;
+        pool.addTask([detect = DetectDestructor{&destroyed}]() {});
+        pool.wait();
+        REQUIRE(destroyed);
+    }
+
+    // Nested task groups.
+    {
+        int result = 0;
+        pool.addTask([&]() { result = sum(pool, 0, 1000); });
+        pool.wait();
+        REQUIRE(result == 999 * 1000 / 2);
+    }
+
+    // Task groups are waited independently.
+    {
+        std::atomic<int> counter{0};
+        TaskGroup group{pool};
+        for (int i = 0; i < 100; ++i)
+        {
+            group.run([&counter]() { counter.fetch_add(1); });
+        }
+        group.wait();
+        REQUIRE(counter.load() == 100);
+    }
+}
+
+TEST_CASE("thread::ThreadPool")
+{
+    SUBCASE("without threads")
+    {
+        testPool(0);
+    }
+
+    SUBCASE("with a single thread")
+    {
+        testPool(1);
+    }
+
+    SUBCASE("with multiple threads")
+    {
+        testPool(4);
+    }
+}
@@ -14,16 +14,19 @@ uniform PerScene
     mat4 viewProj;
 };
 
-uniform PerMesh
-{
-    mat4 model;
-    uint picker;
-};
+// Each instance takes 4 texels of a row: the first 3 rows of its model matrix and its picker identifier.
+uniform highp sampler2D instances;
+uniform int instanceOffset;
 
 uniform sampler2D palette;
 
 void main(void)
 {
+    int instance = instanceOffset + gl_InstanceID;
+    ivec2 texel = ivec2((instance % 256) * 4, instance / 256);
+    mat4 model = transpose(mat4(texelFetch(instances, texel, 0), texelFetch(instances, texel + ivec2(1, 0), 0),
+                                texelFetch(instances, texel + ivec2(2, 0), 0), vec4(0.0, 0.0, 0.0, 1.0)));
+
     vec4 worldPosition = model * vec4(position, 1.0);
     fragPosition = vec3(worldPosition);
     gl_Position = viewProj * worldPosition;
@@ -41,7 +44,9 @@ void main(void)
     fragAlbedo = texelFetch(palette, ivec2(mod(float(material), 256.0), material / 256u), 0).rgb;
 
     #ifdef RENDER_PICKER
-    fragPicker.r = (picker >> 16U);
-    fragPicker.g = (picker & 65535U);
+    // The identifier is split into two 16 bit halves, which floats represent exactly.
+    vec2 picker = texelFetch(instances, texel + ivec2(3, 0), 0).rg;
+    fragPicker.r = uint(picker.r);
+    fragPicker.g = uint(picker.g);
     #endif
 }
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 #include <glm/vec3.hpp>
@@ -123,10 +124,16 @@ namespace cubos::engine
     };
 
     /// @brief Represents a contact interface between two bodies.
+    ///
+    /// Its points are identified across steps by their feature ids, which lets the impulses accumulated on them be
+    /// reused to warm start the solver.
     struct CUBOS_ENGINE_API ContactManifold
     {
         CUBOS_REFLECT;
 
+        /// @brief Maximum number of contact points kept on a manifold.
+        static constexpr std::size_t MaxPoints = 4;
+
         glm::vec3 normal;                     ///< A contact normal shared by all contacts in this manifold,
                                               ///< expressed in the local space of the first entity.
         std::vector<ContactPointData> points; ///< Contact points of this manifold.
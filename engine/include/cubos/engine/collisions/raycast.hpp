@@ -4,12 +4,17 @@
 
 #pragma once
 
+#include <cstdint>
+#include <span>
 #include <utility>
+#include <vector>
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/vec3.hpp>
 
+#include <cubos/core/ecs/system/arguments/parallel.hpp>
 #include <cubos/core/ecs/system/fetcher.hpp>
+#include <cubos/core/geom/aabb.hpp>
 #include <cubos/core/geom/box.hpp>
 
 #include <cubos/engine/collisions/collider_aabb.hpp>
@@ -37,6 +42,10 @@ namespace cubos::engine
     ///     });
     /// @endcode
     ///
+    /// The first ray fired collects the colliders and builds a bounding volume hierarchy over their world bounds,
+    /// which is then shared by every ray fired through the same argument. Thus, when firing many rays, prefer doing
+    /// so from a single system call, ideally through @ref fireMany.
+    ///
     /// @ingroup collisions-plugin
     class CUBOS_ENGINE_API Raycast
     {
@@ -46,6 +55,15 @@ namespace cubos::engine
         {
             Entity entity;   ///< Entity that was hit.
             glm::vec3 point; ///< Point of intersection.
+
+            /// @brief Normal of the voxel face which was hit, in world space. Only set for voxel colliders.
+            glm::vec3 normal{0.0F};
+
+            /// @brief Position of the voxel which was hit in its grid. Only set for voxel colliders.
+            glm::ivec3 voxel{0};
+
+            /// @brief Material index of the voxel which was hit. Only set for voxel colliders.
+            uint16_t material{0};
         };
 
         /// @brief Describes the ray used in a raycast query.
@@ -54,32 +72,110 @@ namespace cubos::engine
             glm::vec3 origin;           ///< Origin of the ray.
             glm::vec3 direction;        ///< Direction of the ray.
             uint32_t mask = 0xFFFFFFFF; ///< Mask of collision layers to consider. By default, considers all layers.
+            Entity ignored{};           ///< Entity to ignore, such as the one firing the ray. By default, none.
         };
 
         /// @brief Constructs.
         /// @param boxes Query for entities with box colliders.
         /// @param capsules Query for entities with capsule colliders.
-        Raycast(
-            Query<Entity, const LocalToWorld&, const BoxCollisionShape&, const CollisionLayers&> boxes,
-            Query<Entity, const LocalToWorld&, const CapsuleCollisionShape&, const Position&, const CollisionLayers&>
-                capsules,
-            Query<Entity, const LocalToWorld&, const VoxelCollisionShape&, const ColliderAABB&, const CollisionLayers&>
-                voxels)
+        /// @param voxels Query for entities with voxel colliders.
+        /// @param parallel Used to fire many rays concurrently.
+        Raycast(Query<Entity, const LocalToWorld&, const BoxCollisionShape&, const ColliderAABB&,
+                      const CollisionLayers&>
+                    boxes,
+                Query<Entity, const LocalToWorld&, const CapsuleCollisionShape&, const Position&, const ColliderAABB&,
+                      const CollisionLayers&>
+                    capsules,
+                Query<Entity, const LocalToWorld&, const VoxelCollisionShape&, const ColliderAABB&,
+                      const CollisionLayers&>
+                    voxels,
+                core::ecs::Parallel parallel = nullptr)
             : mBoxes{std::move(boxes)}
             , mCapsules{std::move(capsules)}
-            , mVoxels{std::move(voxels)} {};
+            , mVoxels{std::move(voxels)}
+            , mParallel{parallel} {};
 
         /// @brief Fires a ray and returns the first hit.
         /// @param ray Ray to fire.
         /// @return Hit if a hit was found, otherwise nullopt.
         Opt<Hit> fire(Ray ray);
 
+        /// @brief Fires a ray against a single collider.
+        ///
+        /// Doesn't build the hierarchy over every collider, and thus is much cheaper than @ref fire(Ray) when the
+        /// colliders which may be hit are already known, for example, from the broad phase.
+        ///
+        /// @param ray Ray to fire.
+        /// @param entity Entity of the collider.
+        /// @return Hit if the collider was hit, otherwise nullopt.
+        Opt<Hit> fire(Ray ray, Entity entity);
+
+        /// @brief Fires many rays and returns the first hit of each, processing them concurrently.
+        /// @param rays Rays to fire.
+        /// @return Hit of each ray, in the same order as the rays, or nullopt if it didn't hit anything.
+        std::vector<Opt<Hit>> fireMany(std::span<const Ray> rays);
+
     private:
-        Query<Entity, const LocalToWorld&, const BoxCollisionShape&, const CollisionLayers&> mBoxes;
-        Query<Entity, const LocalToWorld&, const CapsuleCollisionShape&, const Position&, const CollisionLayers&>
+        /// @brief Collider which may be hit by rays. Only the pointer to its shape type is set.
+        struct Target
+        {
+            Entity entity;                                 ///< Entity of the collider.
+            uint32_t layers;                               ///< Collision layers of the collider.
+            glm::mat4 worldToLocal;                        ///< Inverse of the transform of the collider.
+            glm::vec3 position;                            ///< Position of the entity, used by capsules.
+            const BoxCollisionShape* box{nullptr};         ///< Box shape.
+            const CapsuleCollisionShape* capsule{nullptr}; ///< Capsule shape.
+            const VoxelCollisionShape* voxel{nullptr};     ///< Voxel shape.
+        };
+
+        /// @brief Node of the bounding volume hierarchy over the targets.
+        struct Node
+        {
+            /// @brief Value of @ref target for nodes which aren't leaves.
+            static constexpr uint32_t NoTarget = UINT32_MAX;
+
+            core::geom::AABB aabb; ///< World bounds of the node.
+            uint32_t children[2];  ///< Indices of the child nodes, if the node isn't a leaf.
+            uint32_t target;       ///< Index of the target of the leaf, or @ref NoTarget.
+        };
+
+        /// @brief Collects the targets and builds the hierarchy over them, if that wasn't done yet.
+        void build();
+
+        /// @brief Recursively builds a node of the hierarchy.
+        /// @param bounds World bounds of each target.
+        /// @param indices Indices of the targets, reordered while building.
+        /// @param begin First index covered by the node.
+        /// @param end Index after the last index covered by the node.
+        /// @return Index of the node.
+        uint32_t buildNode(const std::vector<core::geom::AABB>& bounds, std::vector<uint32_t>& indices,
+                           std::size_t begin, std::size_t end);
+
+        /// @brief Intersects a ray with a target.
+        /// @param target Target.
+        /// @param ray Ray to fire, with a normalized direction.
+        /// @param maxScalar World distance after which voxel shapes may stop looking for hits.
+        /// @param[out] hit Hit, whose entity and voxel data are set. Its point is left for the caller to set.
+        /// @return World distance along the ray to the hit, or a negative value if the target was missed.
+        static float intersect(const Target& target, const Ray& ray, float maxScalar, Hit& hit);
+
+        /// @brief Finds the first hit of a ray, once the hierarchy has been built.
+        /// @param ray Ray to fire.
+        /// @return Hit if a hit was found, otherwise nullopt.
+        Opt<Hit> trace(Ray ray) const;
+
+        Query<Entity, const LocalToWorld&, const BoxCollisionShape&, const ColliderAABB&, const CollisionLayers&>
+            mBoxes;
+        Query<Entity, const LocalToWorld&, const CapsuleCollisionShape&, const Position&, const ColliderAABB&,
+              const CollisionLayers&>
             mCapsules;
         Query<Entity, const LocalToWorld&, const VoxelCollisionShape&, const ColliderAABB&, const CollisionLayers&>
             mVoxels;
+        core::ecs::Parallel mParallel;
+
+        bool mBuilt{false};           ///< Whether the hierarchy has been built.
+        std::vector<Target> mTargets; ///< Colliders which may be hit.
+        std::vector<Node> mNodes;     ///< Nodes of the hierarchy. The first node is the root.
     };
 } // namespace cubos::engine
 
@@ -92,10 +188,11 @@ namespace cubos::core::ecs
         static inline constexpr bool ConsumesOptions = false;
 
         SystemFetcher<Query<Entity, const cubos::engine::LocalToWorld&, const cubos::engine::BoxCollisionShape&,
-                            const cubos::engine::CollisionLayers&>>
+                            const cubos::engine::ColliderAABB&, const cubos::engine::CollisionLayers&>>
             boxes;
         SystemFetcher<Query<Entity, const cubos::engine::LocalToWorld&, const cubos::engine::CapsuleCollisionShape&,
-                            const cubos::engine::Position&, const cubos::engine::CollisionLayers&>>
+                            const cubos::engine::Position&, const cubos::engine::ColliderAABB&,
+                            const cubos::engine::CollisionLayers&>>
             capsules;
         SystemFetcher<Query<Entity, const cubos::engine::LocalToWorld&, const cubos::engine::VoxelCollisionShape&,
                             const cubos::engine::ColliderAABB&, const cubos::engine::CollisionLayers&>>
@@ -121,6 +218,7 @@ namespace cubos::core::ecs
                 boxes.fetch(ctx),
                 capsules.fetch(ctx),
                 voxels.fetch(ctx),
+                ctx.pool,
             };
         }
     };
@@ -4,8 +4,15 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include <glm/glm.hpp>
 
+#include <cubos/core/geom/aabb.hpp>
 #include <cubos/core/geom/box.hpp>
 #include <cubos/core/reflection/reflect.hpp>
 
@@ -19,6 +26,12 @@ namespace cubos::engine
     /// Collider component.
     ///
     /// Assumes the VoxelGrid to be centered in the entity space.
+    ///
+    /// The boxes which compose the shape are organized in a bounding volume hierarchy, so that only boxes which may
+    /// overlap with something else need to be tested by the narrow phase. Both are stored in a @ref Decomposition,
+    /// which is shared by all shapes created from the same voxel grid. The decomposition may also keep the voxels of
+    /// the grid themselves, which allows casting rays against the exact voxels through @ref raycast.
+    ///
     /// @ingroup collisions-plugin
     class CUBOS_ENGINE_API VoxelCollisionShape
     {
@@ -35,6 +48,55 @@ namespace cubos::engine
             uint32_t boxId;
         };
 
+        /// @brief Node of the bounding volume hierarchy over the boxes of the shape.
+        /// @ingroup collisions-plugin
+        struct TreeNode
+        {
+            /// @brief Value of @ref box for nodes which aren't leaves.
+            static constexpr uint32_t NoBox = UINT32_MAX;
+
+            cubos::core::geom::AABB aabb; ///< Bounds of the node in the local space of the shape.
+            uint32_t children[2];         ///< Indices of the child nodes, if the node isn't a leaf.
+            uint32_t box;                 ///< Index of the box of the leaf, or @ref NoBox.
+        };
+
+        /// @brief Boxes which compose a shape, along with the bounding volume hierarchy over them.
+        ///
+        /// Never modified once it is assigned to a shape, as it may be shared between many shapes.
+        ///
+        /// @ingroup collisions-plugin
+        struct CUBOS_ENGINE_API Decomposition
+        {
+            /// @brief Number of voxels per side of each brick in @ref bricks.
+            static constexpr int BrickSize = 4;
+
+            std::vector<BoxShiftPair> boxes; ///< Boxes composing the shape.
+            std::vector<TreeNode> tree;      ///< Nodes of the hierarchy over @ref boxes. The first node is the root.
+            cubos::core::geom::AABB aabb;    ///< Bounds of the voxels of the grid, centered on the origin.
+
+            glm::ivec3 gridSize{0};       ///< Size of the grid, or zero if its voxels weren't stored.
+            std::vector<uint16_t> voxels; ///< Material of each voxel, indexed as in @ref VoxelGrid.
+            glm::ivec3 brickCount{0};     ///< Number of bricks along each axis.
+            std::vector<uint8_t> bricks;  ///< Whether each brick of the grid has any non-empty voxel.
+
+            /// @brief Builds the bounding volume hierarchy over the current boxes.
+            void buildTree();
+
+            /// @brief Stores the voxels of a grid, along with which bricks of the grid are empty.
+            /// @param grid Grid the boxes were built from.
+            void storeVoxels(const VoxelGrid& grid);
+        };
+
+        /// @brief Result of casting a ray against the voxels of a shape.
+        /// @ingroup collisions-plugin
+        struct VoxelHit
+        {
+            float distance;    ///< Distance along the ray to the hit, in local space.
+            glm::ivec3 voxel;  ///< Position of the hit voxel in the grid.
+            glm::vec3 normal;  ///< Normal of the face of the voxel which was hit, in local space.
+            uint16_t material; ///< Material index of the hit voxel.
+        };
+
         /// @brief Entities voxel grid.
         Asset<VoxelGrid> grid;
 
@@ -58,7 +120,7 @@ namespace cubos::engine
         VoxelCollisionShape(VoxelCollisionShape&& other) noexcept
         {
             this->grid = std::move(other.grid);
-            this->mBoxes = std::move(other.mBoxes);
+            this->mDecomposition = std::move(other.mDecomposition);
         }
 
         /// @brief Copy constructor.
@@ -66,7 +128,7 @@ namespace cubos::engine
         VoxelCollisionShape(const VoxelCollisionShape& shape)
         {
             this->grid = shape.grid;
-            this->mBoxes = shape.mBoxes;
+            this->mDecomposition = shape.mDecomposition;
         }
 
         /// @brief Sets the grid.
@@ -77,25 +139,65 @@ namespace cubos::engine
         }
 
         /// @brief Inserts a new @ref BoxShiftPair to the list of the class.
+        ///
+        /// As the decomposition may be shared, this copies it and rebuilds its hierarchy. Prefer building a whole
+        /// @ref Decomposition and setting it with @ref setDecomposition.
+        ///
         /// @param box Box to insert.
         /// @param shift Shift vector of the box.
-        void insertBox(const cubos::core::geom::Box& box, const glm::vec3& shift, uint32_t boxId)
+        void insertBox(const cubos::core::geom::Box& box, const glm::vec3& shift, uint32_t boxId);
+
+        /// @brief Getter for the list of @ref BoxShiftPair of the class.
+        const std::vector<BoxShiftPair>& getBoxes() const;
+
+        /// @brief Getter for the nodes of the bounding volume hierarchy. The first node is the root.
+        /// @return Nodes, or an empty vector if the shape has no boxes.
+        const std::vector<TreeNode>& getTree() const;
+
+        /// @brief Gets the decomposition of the shape.
+        /// @return Decomposition, or null if it hasn't been set.
+        const std::shared_ptr<const Decomposition>& getDecomposition() const
         {
-            BoxShiftPair pair;
-            pair.box = box;
-            pair.shift = shift;
-            pair.boxId = boxId;
-            this->mBoxes.push_back(pair);
+            return this->mDecomposition;
         }
 
-        /// @brief Getter for the list of @ref BoxShiftPair of the class.
-        const std::vector<BoxShiftPair>& getBoxes() const
+        /// @brief Sets the decomposition of the shape.
+        /// @param decomposition Decomposition, which must not be modified afterwards.
+        void setDecomposition(std::shared_ptr<const Decomposition> decomposition)
         {
-            return this->mBoxes;
+            this->mDecomposition = std::move(decomposition);
         }
 
+        /// @brief Finds the boxes of the shape which may overlap with the given bounds.
+        ///
+        /// @param aabb Bounds in the local space of the shape.
+        /// @param[out] boxes Indices of the boxes.
+        void findBoxes(const cubos::core::geom::AABB& aabb, std::vector<std::size_t>& boxes) const;
+
+        /// @brief Finds the pairs of boxes of this shape and another shape which may overlap, by descending through
+        /// both hierarchies at the same time.
+        ///
+        /// @param other Other shape.
+        /// @param otherToThis Transform from the local space of the other shape to the local space of this one.
+        /// @param[out] pairs Indices of the boxes of this shape and of the other shape, respectively.
+        void findBoxPairs(const VoxelCollisionShape& other, const glm::mat4& otherToThis,
+                          std::vector<std::pair<std::size_t, std::size_t>>& pairs) const;
+
+        /// @brief Casts a ray against the voxels of the shape, stepping through the cells of the grid it crosses and
+        /// skipping whole bricks which are empty.
+        ///
+        /// Does nothing if the voxels of the grid weren't stored in the decomposition of the shape. Rays which start
+        /// inside a voxel hit it at distance zero.
+        ///
+        /// @param origin Origin of the ray, in the local space of the shape.
+        /// @param direction Normalized direction of the ray, in the local space of the shape.
+        /// @param maxDistance Distance after which hits are ignored.
+        /// @param[out] hit Closest hit, if any.
+        /// @return Whether a voxel was hit.
+        bool raycast(glm::vec3 origin, const glm::vec3& direction, float maxDistance, VoxelHit& hit) const;
+
     private:
-        /// @brief List of pairs composing the shape.
-        std::vector<BoxShiftPair> mBoxes; ///< List of boxes.
+        /// @brief Boxes composing the shape and their hierarchy, possibly shared with other shapes.
+        std::shared_ptr<const Decomposition> mDecomposition;
     };
 } // namespace cubos::engine
@@ -0,0 +1,32 @@
+/// @file
+/// @brief Component @ref cubos::engine::ContinuousCollision.
+/// @ingroup physics-plugin
+
+#pragma once
+
+#include <cubos/core/reflection/reflect.hpp>
+
+#include <cubos/engine/api.hpp>
+
+namespace cubos::engine
+{
+    /// @brief Component which enables continuous collision detection for a body, so that it doesn't tunnel through
+    /// thin colliders when it moves fast.
+    ///
+    /// After the substeps of each fixed step, if the body moved farther than its own size, a ray is cast from its
+    /// center along its motion, against the colliders the broad phase finds in the swept bounds of the body. If
+    /// something is hit before the body reaches its new position, the motion is clamped so that the body ends up just
+    /// inside what it hit, its velocity along the motion is reduced by as much, and the contact is resolved on the
+    /// next step.
+    ///
+    /// As a single ray is cast, this is best suited for small bodies, such as projectiles.
+    ///
+    /// @ingroup physics-plugin
+    struct CUBOS_ENGINE_API ContinuousCollision
+    {
+        CUBOS_REFLECT;
+
+        /// @brief How far the body is allowed to move into what it hit, so that the contact is detected.
+        float margin = 0.05F;
+    };
+} // namespace cubos::engine
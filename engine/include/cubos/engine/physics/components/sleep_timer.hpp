@@ -0,0 +1,24 @@
+/// @file
+/// @brief Component @ref cubos::engine::SleepTimer.
+/// @ingroup physics-plugin
+
+#pragma once
+
+#include <cubos/core/reflection/reflect.hpp>
+
+#include <cubos/engine/api.hpp>
+
+namespace cubos::engine
+{
+    /// @brief Component which holds for how long a body has been at rest.
+    ///
+    /// Bodies without this component never fall asleep.
+    ///
+    /// @ingroup physics-plugin
+    struct CUBOS_ENGINE_API SleepTimer
+    {
+        CUBOS_REFLECT;
+
+        float time = 0.0F; ///< Time since the velocities of the body fell below the sleep thresholds, in seconds.
+    };
+} // namespace cubos::engine
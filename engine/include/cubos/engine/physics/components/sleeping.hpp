@@ -0,0 +1,24 @@
+/// @file
+/// @brief Component @ref cubos::engine::Sleeping.
+/// @ingroup physics-plugin
+
+#pragma once
+
+#include <cubos/core/reflection/reflect.hpp>
+
+#include <cubos/engine/api.hpp>
+
+namespace cubos::engine
+{
+    /// @brief Component which marks a body which has been at rest for a while, and is thus skipped by the solver.
+    ///
+    /// Added automatically once the body's @ref SleepTimer runs out. Removed when a force or impulse is applied to
+    /// the body, when it touches a moving body, or when the bodies it is colliding with change, for example, because
+    /// the body supporting it was despawned. Can be removed manually to wake the body up.
+    ///
+    /// @ingroup physics-plugin
+    struct CUBOS_ENGINE_API Sleeping
+    {
+        CUBOS_REFLECT;
+    };
+} // namespace cubos::engine
@@ -15,11 +15,14 @@
 #include <cubos/engine/physics/components/angular_impulse.hpp>
 #include <cubos/engine/physics/components/angular_velocity.hpp>
 #include <cubos/engine/physics/components/center_of_mass.hpp>
+#include <cubos/engine/physics/components/continuous_collision.hpp>
 #include <cubos/engine/physics/components/force.hpp>
 #include <cubos/engine/physics/components/impulse.hpp>
 #include <cubos/engine/physics/components/inertia.hpp>
 #include <cubos/engine/physics/components/mass.hpp>
 #include <cubos/engine/physics/components/physics_material.hpp>
+#include <cubos/engine/physics/components/sleep_timer.hpp>
+#include <cubos/engine/physics/components/sleeping.hpp>
 #include <cubos/engine/physics/components/torque.hpp>
 #include <cubos/engine/physics/components/velocity.hpp>
 #include <cubos/engine/physics/physics_bundle.hpp>
@@ -53,6 +56,9 @@ namespace cubos::engine
     /// - @ref CenterOfMass - holds the center of mass of an object.
     /// - @ref AccumulatedCorrection - holds the corrections accumulated from the constraints solving.
     /// - @ref PhysicsMaterial - holds the friction and bounciness properties of the particle.
+    /// - @ref SleepTimer - holds for how long a body has been at rest.
+    /// - @ref Sleeping - marks a body at rest, which is skipped by the solver until it is woken up.
+    /// - @ref ContinuousCollision - enables continuous collision detection for fast bodies.
     ///
     /// ## Dependencies
     /// - @ref physics-gravity-plugin
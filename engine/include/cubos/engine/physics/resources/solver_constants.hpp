@@ -53,6 +53,22 @@ namespace cubos::engine
 
         /// @brief Coefficient for how much of the impulse of the previous frame will be used for warm-starting.
         float warmStartCoefficient = 1.0F;
+
+        /// @brief Linear speed below which a body is considered to be at rest.
+        float sleepLinearSpeed = 0.05F;
+
+        /// @brief Angular speed below which a body is considered to be at rest.
+        float sleepAngularSpeed = 0.05F;
+
+        /// @brief Time a body must stay at rest before falling asleep, in seconds.
+        float sleepTime = 0.5F;
+
+        /// @brief Whether bodies and constraints are solved in an order which only depends on their entities.
+        ///
+        /// By default, they're solved in the order the ECS iterates over them, which may change with the order in
+        /// which entities and components were added. Enabling this sorts them by entity on every step, so that the
+        /// same inputs always produce the exact same results, which is needed for lockstep networking and replays.
+        bool deterministic = false;
     };
 
 } // namespace cubos::engine
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cubos/engine/physics/solver/solver_bodies.hpp>
 #include <cubos/engine/prelude.hpp>
 
 namespace cubos::engine
@@ -15,11 +16,21 @@ namespace cubos::engine
     extern Tag physicsPrepareSolveTag;
     extern Tag physicsIntegrateVelocityTag;
     extern Tag physicsSolveConstraintTag;
+
+    /// @brief Systems with this tag solve user defined constraints, on each substep.
+    ///
+    /// Must read and write the velocities of the bodies through @ref SolverBodies, not their components.
     extern Tag physicsSolveUserConstraintTag;
+
     extern Tag physicsSolveContactTag;
     extern Tag physicsIntegratePositionTag;
     extern Tag physicsSolveRelaxConstraintTag;
+
+    /// @brief Systems with this tag relax user defined constraints, on each substep.
+    ///
+    /// Must read and write the velocities of the bodies through @ref SolverBodies, not their components.
     extern Tag physicsSolveRelaxUserConstraintTag;
+
     extern Tag physicsSolveRelaxContactTag;
     extern Tag physicsFinalizePositionTag;
 
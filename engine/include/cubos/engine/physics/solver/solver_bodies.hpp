@@ -0,0 +1,140 @@
+/// @file
+/// @brief Resource @ref cubos::engine::SolverBodies.
+/// @ingroup physics-solver-plugin
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cubos/core/ecs/entity/entity.hpp>
+#include <cubos/core/ecs/entity/hash.hpp>
+#include <cubos/core/ecs/system/arguments/parallel.hpp>
+#include <cubos/core/reflection/reflect.hpp>
+
+#include <cubos/engine/api.hpp>
+
+namespace cubos::engine
+{
+    /// @brief Resource which holds the state of the bodies being solved during a fixed step, as a structure of
+    /// arrays indexed by a compact body identifier.
+    ///
+    /// Gathered from the components of the bodies once before the substeps, so that the integration and constraint
+    /// systems don't have to go through the ECS on every substep, and scattered back to the components once they end.
+    ///
+    /// Dynamic bodies come first, followed by the static and sleeping bodies referenced by constraints, which the
+    /// solver never changes.
+    ///
+    /// While the substeps run, the @ref Velocity, @ref AngularVelocity and @ref AccumulatedCorrection components of
+    /// the bodies are stale, and any writes to them are overwritten once the substeps end. Thus, systems tagged with
+    /// @ref physicsSolveUserConstraintTag or @ref physicsSolveRelaxUserConstraintTag must read and write the state of
+    /// the bodies here instead, for example:
+    ///
+    /// @code{.cpp}
+    ///     cubos.system("solve my constraint")
+    ///         .tagged(physicsSolveUserConstraintTag)
+    ///         .call([](Query<Entity, const MyConstraint&> query, SolverBodies& bodies) {
+    ///             for (auto [entity, constraint] : query)
+    ///             {
+    ///                 auto it = bodies.ids.find(entity);
+    ///                 if (it != bodies.ids.end() && !bodies.isStatic(it->second))
+    ///                 {
+    ///                     bodies.velocities[it->second] += ...;
+    ///                 }
+    ///             }
+    ///         });
+    /// @endcode
+    ///
+    /// @ingroup physics-solver-plugin
+    struct CUBOS_ENGINE_API SolverBodies
+    {
+        CUBOS_REFLECT;
+
+        std::vector<core::ecs::Entity> entities;  ///< Entity of each body.
+        std::vector<float> inverseMasses;         ///< Inverse mass of each body, zero for static bodies.
+        std::vector<glm::mat3> inverseInertias;   ///< Local inverse inertia of each body, zero for static bodies.
+        std::vector<glm::vec3> forces;            ///< Force applied on each body during the step.
+        std::vector<glm::vec3> torques;           ///< Torque applied on each body during the step.
+        std::vector<glm::quat> rotations;         ///< Rotation of each body.
+        std::vector<glm::vec3> corrections;       ///< Position correction accumulated by each body.
+        std::vector<glm::vec3> velocities;        ///< Linear velocity of each body.
+        std::vector<glm::vec3> angularVelocities; ///< Angular velocity of each body.
+
+        /// @brief Number of dynamic bodies, which come before any static body.
+        std::size_t dynamicCount{0};
+
+        /// @brief Maps entities to their body identifier.
+        std::unordered_map<core::ecs::Entity, uint32_t, core::ecs::EntityHash> ids;
+
+        /// @brief Removes all bodies.
+        void clear();
+
+        /// @brief Adds a dynamic body. Must be called before any static body is added.
+        /// @param entity Entity.
+        /// @param inverseMass Inverse mass.
+        /// @param inverseInertia Local inverse inertia.
+        /// @param force Force applied during the step.
+        /// @param torque Torque applied during the step.
+        /// @param rotation Rotation.
+        /// @param correction Accumulated position correction.
+        /// @param velocity Linear velocity.
+        /// @param angularVelocity Angular velocity.
+        /// @return Body identifier.
+        uint32_t addDynamic(core::ecs::Entity entity, float inverseMass, const glm::mat3& inverseInertia,
+                            const glm::vec3& force, const glm::vec3& torque, const glm::quat& rotation,
+                            const glm::vec3& correction, const glm::vec3& velocity, const glm::vec3& angularVelocity);
+
+        /// @brief Gets the identifier of a body, adding it as a static body if it wasn't added yet.
+        /// @param entity Entity.
+        /// @param rotation Rotation.
+        /// @param correction Accumulated position correction.
+        /// @param velocity Linear velocity.
+        /// @param angularVelocity Angular velocity.
+        /// @return Body identifier.
+        uint32_t findOrAddStatic(core::ecs::Entity entity, const glm::quat& rotation, const glm::vec3& correction,
+                                 const glm::vec3& velocity, const glm::vec3& angularVelocity);
+
+        /// @brief Sorts the dynamic bodies by their entities, so that their identifiers don't depend on the order in
+        /// which they were added. Must be called before any static body is added.
+        void sortDynamic();
+
+        /// @brief Packs the index and generation of an entity into a single key, which orders entities.
+        /// @param entity Entity.
+        /// @return Key.
+        static uint64_t key(core::ecs::Entity entity)
+        {
+            return (static_cast<uint64_t>(entity.index) << 32) | static_cast<uint64_t>(entity.generation);
+        }
+
+        /// @brief Checks whether a body is never changed by the solver.
+        /// @param id Body identifier.
+        /// @return Whether the body is static.
+        bool isStatic(uint32_t id) const
+        {
+            return id >= dynamicCount;
+        }
+
+        /// @brief Calls the given function for each dynamic body, processing chunks of bodies concurrently.
+        /// @tparam F Function type.
+        /// @param parallel Used to split the work into tasks.
+        /// @param function Function, which receives the identifier of a body.
+        template <typename F>
+        void forEachDynamic(core::ecs::Parallel& parallel, F function) const
+        {
+            constexpr std::size_t ChunkSize = 1024;
+            parallel.forEach((dynamicCount + ChunkSize - 1) / ChunkSize, [&](std::size_t chunk) {
+                auto end = std::min(dynamicCount, (chunk + 1) * ChunkSize);
+                for (auto id = chunk * ChunkSize; id < end; ++id)
+                {
+                    function(static_cast<uint32_t>(id));
+                }
+            });
+        }
+    };
+} // namespace cubos::engine
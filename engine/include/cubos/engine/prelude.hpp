@@ -30,10 +30,16 @@ namespace cubos::engine
     /// @copydoc cubos::core::ecs::Arguments
     using Arguments = core::ecs::Arguments;
 
+    /// @copydoc cubos::core::ecs::SystemThreads
+    using SystemThreads = core::ecs::SystemThreads;
+
     /// @copydoc cubos::core::ecs::Query
     template <typename... ComponentTypes>
     using Query = core::ecs::Query<ComponentTypes...>;
 
+    /// @copydoc cubos::core::ecs::Parallel
+    using Parallel = core::ecs::Parallel;
+
     /// @copydoc cubos::core::ecs::Entity
     using Entity = core::ecs::Entity;
 
@@ -0,0 +1,39 @@
+/// @dir
+/// @brief @ref render-culling-plugin plugin directory.
+
+/// @file
+/// @brief Plugin entry point.
+/// @ingroup render-culling-plugin
+
+#pragma once
+
+#include <cubos/engine/api.hpp>
+#include <cubos/engine/prelude.hpp>
+
+namespace cubos::engine
+{
+    /// @defgroup render-culling-plugin Culling
+    /// @ingroup render-plugins
+    /// @brief Finds, once per frame, the render meshes seen by each active camera.
+    ///
+    /// Keeps the @ref VisibleRenderMeshes resource up to date, which is used by every pass which draws render meshes,
+    /// and holds a spatial index of the render meshes which can also be queried by gameplay code. Only the render
+    /// meshes whose transform, mesh or grid changed since the last frame are updated.
+    ///
+    /// ## Resources
+    /// - @ref VisibleRenderMeshes - render meshes, their spatial index and the ones seen by each camera.
+    ///
+    /// ## Dependencies
+    /// - @ref transform-plugin
+    /// - @ref render-camera-plugin
+    /// - @ref render-mesh-plugin
+    /// - @ref render-voxels-plugin
+
+    /// @brief Render meshes are culled against the camera frustums.
+    CUBOS_ENGINE_API extern Tag cullRenderMeshesTag;
+
+    /// @brief Plugin entry function.
+    /// @param cubos @b Cubos main class.
+    /// @ingroup render-culling-plugin
+    CUBOS_ENGINE_API void renderCullingPlugin(Cubos& cubos);
+} // namespace cubos::engine
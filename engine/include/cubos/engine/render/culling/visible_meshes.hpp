@@ -0,0 +1,114 @@
+/// @file
+/// @brief Resource @ref cubos::engine::VisibleRenderMeshes.
+/// @ingroup render-culling-plugin
+
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+
+#include <cubos/core/ecs/entity/entity.hpp>
+#include <cubos/core/ecs/entity/hash.hpp>
+#include <cubos/core/geom/aabb.hpp>
+#include <cubos/core/geom/aabb_tree.hpp>
+#include <cubos/core/geom/frustum.hpp>
+#include <cubos/core/reflection/reflect.hpp>
+
+#include <cubos/engine/api.hpp>
+#include <cubos/engine/render/mesh/pool.hpp>
+
+namespace cubos::engine
+{
+    /// @brief Resource which holds the render meshes, a spatial index of their world-space bounds, and which of them
+    /// are seen by each active camera.
+    ///
+    /// Kept up to date by the @ref render-culling-plugin, so that passes which draw render meshes don't have to
+    /// recompute their transforms and bounds. Passes with views of their own, such as shadow maps, can cull the same
+    /// bounds with @ref cull, and gameplay code can find meshes near a point or inside a box with @ref query.
+    ///
+    /// Meshes are kept across frames, and only the ones which changed are updated. The index only changes where
+    /// meshes moved out of their previous bounds, so queries don't need to go through every mesh.
+    ///
+    /// @ingroup render-culling-plugin
+    class CUBOS_ENGINE_API VisibleRenderMeshes
+    {
+    public:
+        CUBOS_REFLECT;
+
+        /// @brief Render mesh to be drawn.
+        struct Mesh
+        {
+            core::ecs::Entity entity;               ///< Entity with the mesh.
+            RenderMeshPool::BucketId firstBucketId; ///< First bucket of the mesh in the pool.
+            glm::mat4 model;                        ///< Model matrix, with the grid and mesh offsets applied.
+        };
+
+        /// @brief Adds a mesh, or updates it if its entity was already added, moving it in the spatial index if
+        /// needed.
+        /// @param mesh Mesh.
+        /// @param bounds World-space bounds of the mesh.
+        void update(const Mesh& mesh, const core::geom::AABB& bounds);
+
+        /// @brief Removes the mesh of the given entity, if it was added. May change the indices of other meshes.
+        /// @param entity Entity.
+        void remove(core::ecs::Entity entity);
+
+        /// @brief Forgets the meshes seen by each camera.
+        void clearCameras();
+
+        /// @brief Gets all meshes, in no particular order.
+        /// @return Meshes.
+        const std::vector<Mesh>& meshes() const;
+
+        /// @brief Finds the meshes which are at least partially inside the given frustum.
+        /// @param frustum World-space frustum.
+        /// @param[out] visible Indices of the visible meshes on @ref meshes().
+        void cull(const core::geom::Frustum& frustum, std::vector<std::size_t>& visible) const;
+
+        /// @brief Finds the meshes which are at least partially inside the view volume of the given matrix.
+        /// @param viewProj View-projection matrix.
+        /// @param[out] visible Indices of the visible meshes on @ref meshes().
+        void cull(const glm::mat4& viewProj, std::vector<std::size_t>& visible) const;
+
+        /// @brief Finds the meshes which overlap the given box.
+        /// @param aabb World-space box.
+        /// @param[out] found Indices of the meshes found on @ref meshes().
+        void query(const core::geom::AABB& aabb, std::vector<std::size_t>& found) const;
+
+        /// @brief Finds the meshes which overlap the given sphere.
+        /// @param center World-space center of the sphere.
+        /// @param radius Radius of the sphere.
+        /// @param[out] found Indices of the meshes found on @ref meshes().
+        void query(const glm::vec3& center, float radius, std::vector<std::size_t>& found) const;
+
+        /// @brief Finds and stores the meshes seen by the given camera.
+        /// @param camera Camera entity.
+        /// @param frustum World-space frustum of the camera.
+        void cullCamera(core::ecs::Entity camera, const core::geom::Frustum& frustum);
+
+        /// @brief Gets the meshes seen by the given camera.
+        /// @param camera Camera entity.
+        /// @return Indices of the visible meshes on @ref meshes(), or an empty list if the camera wasn't culled.
+        const std::vector<std::size_t>& camera(core::ecs::Entity camera) const;
+
+    private:
+        /// @brief Location of a mesh.
+        struct Proxy
+        {
+            std::size_t leaf;  ///< Leaf of the mesh in the spatial index.
+            std::size_t index; ///< Index of the mesh on @ref mMeshes.
+        };
+
+        std::vector<Mesh> mMeshes;  ///< Meshes, in no particular order.
+        core::geom::AABBTree mTree; ///< Spatial index of the meshes, whose leaves hold indices on @ref mMeshes.
+
+        /// @brief Location of each mesh entity.
+        std::unordered_map<core::ecs::Entity, Proxy, core::ecs::EntityHash> mProxies;
+
+        /// @brief Meshes seen by each camera.
+        std::unordered_map<core::ecs::Entity, std::vector<std::size_t>, core::ecs::EntityHash> mCameras;
+    };
+} // namespace cubos::engine
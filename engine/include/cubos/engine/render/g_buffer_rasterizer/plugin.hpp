@@ -27,6 +27,7 @@ namespace cubos::engine
     /// - @ref render-mesh-plugin
     /// - @ref render-voxels-plugin
     /// - @ref camera-plugin
+    /// - @ref render-culling-plugin
 
     /// @brief Rasterizes @ref RenderMesh components to the GBuffer textures.
     /// @ingroup render-g-buffer-plugin
@@ -18,7 +18,8 @@ namespace cubos::engine
     ///
     /// ## Settings
     /// - `renderMeshPool.bucketCount` - number of buckets in the mesh pool (default: `1024`).
-    /// - `renderMeshPool.bucketSize` - maximum face count per bucket (default: `1024`).
+    /// - `renderMeshPool.bucketSize` - maximum vertex count per bucket, four per face, up to `65536` (default:
+    ///   `4096`).
     ///
     /// ## Dependencies
     /// - @ref settings-plugin
@@ -18,6 +18,10 @@ namespace cubos::engine
     /// Internally, creates a single large vertex buffer, which is divided into buckets.
     /// Allocated meshes must fit within a single bucket. If they don't, they should be split among multiple buckets.
     ///
+    /// Meshes are made of quads, so that each quad only needs four vertices. Every bucket is drawn with the same small
+    /// index buffer, which covers a single bucket. Since the render device has no base vertex draws, each bucket is
+    /// drawn through its own vertex array, whose elements start at the bucket (see @ref createVertexArrays).
+    ///
     /// @ingroup render-mesh-plugin
     class CUBOS_ENGINE_API RenderMeshPool
     {
@@ -41,7 +45,8 @@ namespace cubos::engine
         /// @brief Constructs.
         /// @param renderDevice Render device.
         /// @param bucketCount Bucket count.
-        /// @param bucketSize Bucket size (in vertices).
+        /// @param bucketSize Bucket size (in vertices), multiple of @ref RenderMeshVertex::VerticesPerQuad and at most
+        /// 65536.
         RenderMeshPool(core::gl::RenderDevice& renderDevice, std::size_t bucketCount, std::size_t bucketSize);
 
         /// @brief Forbid copy constructor.
@@ -65,12 +70,30 @@ namespace cubos::engine
         /// @brief Gets the vertex buffer of the pool.
         core::gl::VertexBuffer vertexBuffer() const;
 
+        /// @brief Gets the index buffer used to draw the quads of any bucket.
+        ///
+        /// Must be set after each vertex array returned by @ref createVertexArrays is bound, as vertex arrays keep
+        /// their own index buffer binding.
+        ///
+        /// @return Index buffer.
+        core::gl::IndexBuffer indexBuffer() const;
+
+        /// @brief Creates a vertex array for each bucket, with the pool's vertex buffer and the given elements offset
+        /// to the start of the bucket.
+        /// @param renderDevice Render device.
+        /// @param desc Vertex array description, whose elements read from the pool's vertex buffer.
+        /// @param bufferIndex Index of the pool's vertex buffer in the description.
+        /// @return Vertex arrays, indexed by @ref BucketId::inner, or empty on failure.
+        std::vector<core::gl::VertexArray> createVertexArrays(core::gl::RenderDevice& renderDevice,
+                                                              core::gl::VertexArrayDesc desc,
+                                                              std::size_t bufferIndex) const;
+
         /// @brief Creates a new bucket, and copies the given vertices into it.
         ///
         /// If the mesh does not fit within a single bucket, then buckets are created and linked as needed.
         ///
         /// @param vertices Pointer to the vertices.
-        /// @param count Number of vertices.
+        /// @param count Number of vertices, which must be a multiple of @ref RenderMeshVertex::VerticesPerQuad.
         /// @return Bucket identifier, or @ref BucketId::Invalid on failure.
         BucketId allocate(const RenderMeshVertex* vertices, std::size_t count);
 
@@ -83,6 +106,11 @@ namespace cubos::engine
         /// @return Bucket size.
         std::size_t vertexCount(BucketId bucketId) const;
 
+        /// @brief Gets the number of indices which must be drawn to draw the given bucket, starting at the first.
+        /// @param bucketId Bucket identifier.
+        /// @return Index count.
+        std::size_t indexCount(BucketId bucketId) const;
+
         /// @brief Gets the bucket linked to the given bucket.
         /// @param bucketId Bucket identifier.
         /// @return Bucket identifier, or @ref BucketId::Invalid if there's none.
@@ -91,7 +119,7 @@ namespace cubos::engine
     private:
         struct BucketInfo
         {
-            /// @brief Number of faces stored in the bucket.
+            /// @brief Number of vertices stored in the bucket.
             std::size_t size{0};
 
             /// @brief Next bucket in the chain.
@@ -101,6 +129,7 @@ namespace cubos::engine
         std::size_t mBucketCount;
         std::size_t mBucketSize;
         core::gl::VertexBuffer mVertexBuffer;
+        core::gl::IndexBuffer mIndexBuffer;
 
         std::vector<BucketInfo> mBuckets;
         std::queue<BucketId> mFreeBuckets;
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 #include <glm/vec2.hpp>
@@ -44,7 +45,19 @@ namespace cubos::engine
         static bool addVertexElements(const char* position, const char* normal, const char* material,
                                       std::size_t bufferIndex, core::gl::VertexArrayDesc& desc);
 
+        /// @brief Number of vertices in each quad of a generated mesh.
+        static constexpr std::size_t VerticesPerQuad = 4;
+
+        /// @brief Number of indices in each quad of a generated mesh, which is drawn as two triangles.
+        static constexpr std::size_t IndicesPerQuad = 6;
+
+        /// @brief Indices of the vertices of each of the two triangles of a quad, relative to its first vertex.
+        static constexpr glm::uint32 QuadIndices[IndicesPerQuad] = {0, 1, 2, 2, 3, 0};
+
         /// @brief Generates a vertex mesh for the given voxel grid.
+        ///
+        /// Each face is a quad made of @ref VerticesPerQuad vertices, which must be drawn with @ref QuadIndices.
+        ///
         /// @param grid Voxel grid.
         /// @param[out] vertices Vertices generated from the voxel grid.
         static void generate(const VoxelGrid& grid, std::vector<RenderMeshVertex>& vertices);
@@ -25,6 +25,7 @@ namespace cubos::engine
     /// - @ref render-shadow-casters-plugin
     /// - @ref render-mesh-plugin
     /// - @ref render-voxels-plugin
+    /// - @ref render-culling-plugin
 
     /// @brief Plugin entry function.
     /// @param cubos @b Cubos main class.
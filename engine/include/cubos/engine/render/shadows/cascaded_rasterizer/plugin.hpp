@@ -25,6 +25,7 @@ namespace cubos::engine
     /// - @ref render-shadow-casters-plugin
     /// - @ref render-mesh-plugin
     /// - @ref render-voxels-plugin
+    /// - @ref render-culling-plugin
     /// - @ref render-camera-plugin
     /// - @ref render-g-buffer-plugin
 
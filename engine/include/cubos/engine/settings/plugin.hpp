@@ -25,6 +25,7 @@ namespace cubos::engine
     ///
     /// ## Settings
     /// - `settings.path` - path of the settings file (default: `./settings.json`).
+    /// - `systems.threadCount` - number of threads used to run the main systems (default: `1`).
     ///
     /// ## Resources
     /// - @ref Settings - holds the settings.
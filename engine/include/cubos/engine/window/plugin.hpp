@@ -25,6 +25,8 @@ namespace cubos::engine
     /// - `window.width` - the window's width (default: `800`).
     /// - `window.height` - the window's height (default: `600`).
     /// - `window.vSync` - whether vertical synchronization is enabled (default: `true`).
+    /// - `window.headless` - whether to open a @ref core::io::openHeadlessWindow "headless window" instead, which
+    ///   needs no display and doesn't render anything (default: `false`).
     ///
     /// ## Events
     /// - @ref core::io::WindowEvent - event polled from the window.
@@ -18,7 +18,6 @@
 CUBOS_DEFINE_TAG(cubos::engine::collisionsAABBUpdateTag);
 CUBOS_DEFINE_TAG(cubos::engine::collisionsBroadMarkersTag);
 CUBOS_DEFINE_TAG(cubos::engine::collisionsBroadSweepTag);
-CUBOS_DEFINE_TAG(cubos::engine::collisionsBroadCleanTag);
 CUBOS_DEFINE_TAG(cubos::engine::collisionsBroadTag);
 
 void cubos::engine::broadPhaseCollisionsPlugin(Cubos& cubos)
@@ -34,7 +33,6 @@ void cubos::engine::broadPhaseCollisionsPlugin(Cubos& cubos)
     cubos.tag(collisionsAABBUpdateTag).tagged(fixedStepTag);
     cubos.tag(collisionsBroadMarkersTag).tagged(fixedStepTag);
     cubos.tag(collisionsBroadSweepTag).tagged(fixedStepTag);
-    cubos.tag(collisionsBroadCleanTag).tagged(fixedStepTag);
     cubos.tag(collisionsBroadTag).tagged(fixedStepTag);
 
     cubos.observer("add new Colliders to SweepAndPrune")
@@ -59,133 +57,50 @@ void cubos::engine::broadPhaseCollisionsPlugin(Cubos& cubos)
         .tagged(collisionsAABBUpdateTag)
         .after(transformUpdateTag)
         .call([](Query<const LocalToWorld&, ColliderAABB&> query) {
-            for (auto [localToWorld, colliderAABB] : query)
-            {
+            query.parEach([](const LocalToWorld& localToWorld, ColliderAABB& colliderAABB) {
                 colliderAABB.worldAABB = core::geom::AABB::fromOBB(colliderAABB.localAABB.box(), localToWorld.mat);
-            };
+            });
         });
 
     cubos.system("update sweep and prune markers")
         .tagged(collisionsBroadMarkersTag)
         .after(collisionsAABBUpdateTag)
-        .call([](Query<const ColliderAABB&> query, BroadPhaseSweepAndPrune& sweepAndPrune) {
-            // TODO: This is parallelizable.
-            for (glm::length_t axis = 0; axis < 3; axis++)
+        .call([](Query<Entity, const ColliderAABB&, Opt<const CollisionLayers&>, Opt<const CollisionMask&>> query,
+                 BroadPhaseSweepAndPrune& sweepAndPrune) {
+            // Cache the bounds first, so that the markers can be sorted without accessing the query. Colliders without
+            // layers or a mask never collide with anything.
+            for (auto [entity, colliderAABB, layers, mask] : query)
             {
-                // TODO: Should use insert sort to leverage spatial coherence.
-                std::sort(sweepAndPrune.markersPerAxis[axis].begin(), sweepAndPrune.markersPerAxis[axis].end(),
-                          [axis, &query](const BroadPhaseSweepAndPrune::SweepMarker& a,
-                                         const BroadPhaseSweepAndPrune::SweepMarker& b) {
-                              auto aMatch = query.at(a.entity);
-                              auto bMatch = query.at(b.entity);
-                              if (aMatch && bMatch)
-                              {
-                                  auto [aColliderAABB] = *aMatch;
-                                  auto [bColliderAABB] = *bMatch;
-                                  auto aPos = a.isMin ? aColliderAABB.worldAABB.min() : aColliderAABB.worldAABB.max();
-                                  auto bPos = b.isMin ? bColliderAABB.worldAABB.min() : bColliderAABB.worldAABB.max();
-                                  return aPos[axis] < bPos[axis];
-                              }
-                              return true;
-                          });
+                sweepAndPrune.updateBounds(entity, colliderAABB.worldAABB, layers ? layers->value : 0U,
+                                           mask ? mask->value : 0U);
             }
+
+            sweepAndPrune.updateMarkers();
         });
 
     cubos.system("collisions sweep")
         .tagged(collisionsBroadSweepTag)
         .after(collisionsBroadMarkersTag)
-        .call([](BroadPhaseSweepAndPrune& sweepAndPrune) {
-            // TODO: This is parallelizable.
-            for (glm::length_t axis = 0; axis < 3; axis++)
-            {
-                sweepAndPrune.activePerAxis[axis].clear();
-                sweepAndPrune.sweepOverlapMaps[axis].clear();
-
-                for (auto& marker : sweepAndPrune.markersPerAxis[axis])
-                {
-                    if (marker.isMin)
-                    {
-                        for (const auto& other : sweepAndPrune.activePerAxis[axis])
-                        {
-                            sweepAndPrune.sweepOverlapMaps[axis][marker.entity].push_back(other);
-                        }
-
-                        sweepAndPrune.activePerAxis[axis].insert(marker.entity);
-                    }
-                    else
-                    {
-                        sweepAndPrune.activePerAxis[axis].erase(marker.entity);
-                    }
-                }
-            }
-        });
+        .call([](BroadPhaseSweepAndPrune& sweepAndPrune) { sweepAndPrune.sweep(); });
 
-    cubos.system("clean PotentiallyCollidingWith relations")
-        .tagged(collisionsBroadCleanTag)
-        .before(collisionsBroadTag)
-        .call([](Commands cmds, Query<Entity, PotentiallyCollidingWith&, Entity> query) {
-            for (auto [entity, collidingWith, other] : query)
+    // Only pairs which started or stopped overlapping are touched, as stable pairs keep their relations.
+    // A pair may be both removed and added in the same step, e.g. when a ColliderAABB is removed and re-added, so the
+    // relations are removed first, to make sure they're related again afterwards.
+    cubos.system("update PotentiallyCollidingWith relations")
+        .tagged(collisionsBroadTag)
+        .after(collisionsBroadSweepTag)
+        .call([](Commands cmds, BroadPhaseSweepAndPrune& sweepAndPrune) {
+            for (const auto& pair : sweepAndPrune.removedPairs)
             {
-                cmds.unrelate<PotentiallyCollidingWith>(entity, other);
+                cmds.unrelate<PotentiallyCollidingWith>(pair.first, pair.second);
             }
-        });
 
-    cubos.system("create PotentiallyCollidingWith relations")
-        .tagged(collisionsBroadTag)
-        .after(collisionsBroadSweepTag)
-        .call([](Commands cmds, Query<const ColliderAABB&, const CollisionLayers&, const CollisionMask&> query,
-                 const BroadPhaseSweepAndPrune& sweepAndPrune) {
-            for (glm::length_t axis = 0; axis < 3; axis++)
+            for (const auto& pair : sweepAndPrune.addedPairs)
             {
-                for (const auto& [entity, overlaps] : sweepAndPrune.sweepOverlapMaps[axis])
-                {
-                    auto match = query.at(entity);
-                    if (!match)
-                    {
-                        continue;
-                    }
-                    auto [colliderAABB, layers, mask] = *match;
-
-                    for (const auto& other : overlaps)
-                    {
-                        auto otherMatch = query.at(other);
-                        if (!otherMatch)
-                        {
-                            continue;
-                        }
-                        auto [otherCollider, otherLayers, otherMask] = *otherMatch;
-
-                        if (((layers.value & otherMask.value) == 0U) && ((otherLayers.value & mask.value) == 0U))
-                        {
-                            continue;
-                        }
-
-                        switch (axis)
-                        {
-                        case 0: // X
-                            if (colliderAABB.worldAABB.overlapsY(otherCollider.worldAABB) &&
-                                colliderAABB.worldAABB.overlapsZ(otherCollider.worldAABB))
-                            {
-                                cmds.relate(entity, other, PotentiallyCollidingWith{});
-                            }
-                            break;
-                        case 1: // Y
-                            if (colliderAABB.worldAABB.overlapsX(otherCollider.worldAABB) &&
-                                colliderAABB.worldAABB.overlapsZ(otherCollider.worldAABB))
-                            {
-                                cmds.relate(entity, other, PotentiallyCollidingWith{});
-                            }
-                            break;
-                        case 2: // Z
-                            if (colliderAABB.worldAABB.overlapsX(otherCollider.worldAABB) &&
-                                colliderAABB.worldAABB.overlapsY(otherCollider.worldAABB))
-                            {
-                                cmds.relate(entity, other, PotentiallyCollidingWith{});
-                            }
-                            break;
-                        }
-                    }
-                }
+                cmds.relate(pair.first, pair.second, PotentiallyCollidingWith{});
             }
+
+            sweepAndPrune.addedPairs.clear();
+            sweepAndPrune.removedPairs.clear();
         });
 }
@@ -32,8 +32,6 @@ namespace cubos::engine
 
     extern Tag collisionsBroadSweepTag;
 
-    extern Tag collisionsBroadCleanTag;
-
     extern Tag collisionsBroadTag;
 
     /// @brief Plugin entry function.
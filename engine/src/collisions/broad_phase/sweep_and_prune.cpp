@@ -11,29 +11,264 @@ CUBOS_REFLECT_IMPL(BroadPhaseSweepAndPrune)
     return core::ecs::TypeBuilder<BroadPhaseSweepAndPrune>("cubos::engine::BroadPhaseSweepAndPrune").build();
 }
 
+/// @brief Checks whether a marker must come before another one on their axis.
+///
+/// On ties, min markers come first, so that touching bounds are still reported as overlapping.
+///
+/// @param a Marker.
+/// @param b Other marker.
+/// @return Whether @p a must come before @p b.
+static bool isBefore(const BroadPhaseSweepAndPrune::SweepMarker& a, const BroadPhaseSweepAndPrune::SweepMarker& b)
+{
+    return a.value < b.value || (a.value == b.value && a.isMin && !b.isMin);
+}
+
+/// @brief Checks whether a pair must come before another one in a sorted pair list.
+/// @param a Pair.
+/// @param b Other pair.
+/// @return Whether @p a must come before @p b.
+static bool isPairBefore(const BroadPhaseSweepAndPrune::Pair& a, const BroadPhaseSweepAndPrune::Pair& b)
+{
+    return a.key() < b.key();
+}
+
 void BroadPhaseSweepAndPrune::addEntity(Entity entity)
 {
-    for (auto& markers : markersPerAxis)
+    std::size_t slot;
+    if (freeSlots.empty())
+    {
+        slot = bounds.size();
+        bounds.emplace_back();
+        layers.push_back(0);
+        masks.push_back(0);
+    }
+    else
     {
-        markers.push_back({entity, true});
-        markers.push_back({entity, false});
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        layers[slot] = 0;
+        masks[slot] = 0;
     }
+    slots[entity] = slot;
+
+    // The markers are inserted with no meaningful coordinate, and only take their place on the next update.
+    markers.push_back({entity, slot, true, 0.0F});
+    markers.push_back({entity, slot, false, 0.0F});
+    unsortedMarkers += 2;
 }
 
 void BroadPhaseSweepAndPrune::removeEntity(Entity entity)
 {
-    for (auto& markers : markersPerAxis)
+    auto it = slots.find(entity);
+    if (it == slots.end())
     {
-        markers.erase(std::remove_if(markers.begin(), markers.end(),
-                                     [entity](const SweepMarker& m) { return m.entity == entity; }),
-                      markers.end());
+        return;
     }
+
+    freeSlots.push_back(it->second);
+    slots.erase(it);
+
+    // The pairs of the entity are forgotten right away, as its index may be reused by a new entity.
+    std::erase_if(pairs, [&](const Pair& pair) {
+        if (pair.first == entity || pair.second == entity)
+        {
+            removedPairs.push_back(pair);
+            return true;
+        }
+        return false;
+    });
+
+    // Removing preserves the order of the remaining markers, and thus they are kept sorted.
+    std::erase_if(markers, [entity](const SweepMarker& m) { return m.entity == entity; });
 }
 
 void BroadPhaseSweepAndPrune::clearEntities()
 {
-    for (auto& markers : markersPerAxis)
+    markers.clear();
+    unsortedMarkers = 0;
+    bounds.clear();
+    layers.clear();
+    masks.clear();
+    slots.clear();
+    freeSlots.clear();
+
+    removedPairs.insert(removedPairs.end(), pairs.begin(), pairs.end());
+    pairs.clear();
+}
+
+void BroadPhaseSweepAndPrune::updateBounds(Entity entity, const core::geom::AABB& aabb, uint32_t layers,
+                                           uint32_t mask)
+{
+    if (auto it = slots.find(entity); it != slots.end())
+    {
+        bounds[it->second] = aabb;
+        this->layers[it->second] = layers;
+        masks[it->second] = mask;
+    }
+}
+
+void BroadPhaseSweepAndPrune::updateMarkers()
+{
+    // Sweeping along the axis where the bounds are most spread out leaves the fewest candidates to test. Only that
+    // axis is kept sorted, as the others would never be swept.
+    glm::vec3 sum{0.0F};
+    glm::vec3 sumSquared{0.0F};
+    for (const auto& marker : markers)
+    {
+        if (marker.isMin)
+        {
+            auto center = bounds[marker.slot].center();
+            sum += center;
+            sumSquared += center * center;
+        }
+    }
+    auto spread = sumSquared - sum * sum / static_cast<float>(std::max<std::size_t>(slots.size(), 1));
+    glm::length_t best = 0;
+    for (glm::length_t other = 1; other < 3; ++other)
+    {
+        if (spread[other] > spread[best])
+        {
+            best = other;
+        }
+    }
+
+    // Switching axes makes the previous order meaningless, so only do it when the new axis is clearly better.
+    bool switched = false;
+    if (spread[best] > spread[axis] * 1.5F)
+    {
+        axis = best;
+        switched = true;
+    }
+
+    for (auto& marker : markers)
+    {
+        const auto& aabb = bounds[marker.slot];
+        marker.value = marker.isMin ? aabb.min()[axis] : aabb.max()[axis];
+    }
+
+    // Insertion sort degrades to quadratic time if many markers are out of place, which happens when lots of new
+    // entities were added at once, or when the axis changes.
+    if (switched || unsortedMarkers * 8 > markers.size())
+    {
+        std::sort(markers.begin(), markers.end(), isBefore);
+    }
+    else
+    {
+        for (std::size_t i = 1; i < markers.size(); ++i)
+        {
+            auto marker = markers[i];
+            auto j = i;
+            for (; j > 0 && isBefore(marker, markers[j - 1]); --j)
+            {
+                markers[j] = markers[j - 1];
+            }
+            markers[j] = marker;
+        }
+    }
+
+    unsortedMarkers = 0;
+}
+
+void BroadPhaseSweepAndPrune::sweep()
+{
+    mActive.clear();
+    mActivePositions.resize(bounds.size());
+    mSweptPairs.clear();
+
+    for (const auto& marker : markers)
+    {
+        if (!marker.isMin)
+        {
+            // Swap the marker with the last active one, so that it can be removed in constant time.
+            auto position = mActivePositions[marker.slot];
+            mActive[position] = mActive.back();
+            mActivePositions[mActive[position].slot] = position;
+            mActive.pop_back();
+            continue;
+        }
+
+        const auto& aabb = bounds[marker.slot];
+        for (const auto& other : mActive)
+        {
+            if ((layers[marker.slot] & masks[other.slot]) == 0U && (layers[other.slot] & masks[marker.slot]) == 0U)
+            {
+                continue;
+            }
+
+            const auto& otherAABB = bounds[other.slot];
+            if (aabb.overlapsX(otherAABB) && aabb.overlapsY(otherAABB) && aabb.overlapsZ(otherAABB))
+            {
+                if (marker.entity.index < other.entity.index)
+                {
+                    mSweptPairs.push_back({marker.entity, other.entity});
+                }
+                else
+                {
+                    mSweptPairs.push_back({other.entity, marker.entity});
+                }
+            }
+        }
+
+        mActivePositions[marker.slot] = mActive.size();
+        mActive.push_back(marker);
+    }
+
+    // Both pair lists are sorted, and thus they can be compared by walking through them at the same time.
+    std::sort(mSweptPairs.begin(), mSweptPairs.end(), isPairBefore);
+    auto previous = pairs.begin();
+    for (const auto& pair : mSweptPairs)
+    {
+        for (; previous != pairs.end() && previous->key() < pair.key(); ++previous)
+        {
+            removedPairs.push_back(*previous);
+        }
+
+        if (previous != pairs.end() && previous->key() == pair.key())
+        {
+            ++previous;
+        }
+        else
+        {
+            addedPairs.push_back(pair);
+        }
+    }
+    removedPairs.insert(removedPairs.end(), previous, pairs.end());
+
+    std::swap(pairs, mSweptPairs);
+}
+
+void BroadPhaseSweepAndPrune::overlapping(const core::geom::AABB& aabb, uint32_t mask,
+                                          std::vector<Entity>& entities) const
+{
+    entities.clear();
+
+    // Entities whose min marker comes after the end of the bounds, or whose max marker comes before their start,
+    // can't overlap them. Thus, either walk the min markers up to the end, or the max markers from the start.
+    auto first = markers.begin();
+    auto last = markers.end();
+    bool minMarkers = true;
+    if (unsortedMarkers == 0)
+    {
+        auto end =
+            std::partition_point(first, last, [&](const SweepMarker& m) { return m.value <= aabb.max()[axis]; });
+        auto begin =
+            std::partition_point(first, last, [&](const SweepMarker& m) { return m.value < aabb.min()[axis]; });
+        if (end - markers.begin() > markers.end() - begin)
+        {
+            first = begin;
+            minMarkers = false;
+        }
+        else
+        {
+            last = end;
+        }
+    }
+
+    for (auto it = first; it != last; ++it)
     {
-        markers.clear();
+        if (it->isMin == minMarkers && (layers[it->slot] & mask) != 0U && bounds[it->slot].overlaps(aabb))
+        {
+            entities.push_back(it->entity);
+        }
     }
 }
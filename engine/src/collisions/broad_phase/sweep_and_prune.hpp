@@ -4,18 +4,23 @@
 
 #pragma once
 
+#include <cstdint>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 #include <cubos/core/ecs/entity/entity.hpp>
 #include <cubos/core/ecs/entity/hash.hpp>
+#include <cubos/core/geom/aabb.hpp>
 
 #include <cubos/engine/prelude.hpp>
 
 namespace cubos::engine
 {
     /// @brief Resource which stores sweep and prune data.
+    ///
+    /// Besides the sorted markers, it also keeps the set of pairs found on the previous sweep, so that only the pairs
+    /// which started or stopped overlapping need to be reported.
+    ///
     /// @ingroup broad-phase-collisions-plugin
     struct BroadPhaseSweepAndPrune
     {
@@ -24,31 +29,107 @@ namespace cubos::engine
         /// @brief Marker used for sweep and prune.
         struct SweepMarker
         {
-            Entity entity; ///< Entity referenced by the marker.
-            bool isMin;    ///< Whether the marker is a min or max marker.
+            Entity entity;    ///< Entity referenced by the marker.
+            std::size_t slot; ///< Slot of the entity in @ref bounds.
+            bool isMin;       ///< Whether the marker is a min or max marker.
+            float value;      ///< Coordinate of the marker on its axis, as of the last update.
         };
 
-        /// @brief List of ordered sweep markers for each axis. Stores the index of the marker in mMarkers.
-        std::vector<SweepMarker> markersPerAxis[3];
+        /// @brief Pair of entities whose bounds overlap.
+        struct Pair
+        {
+            Entity first;  ///< Entity with the lowest index.
+            Entity second; ///< Entity with the highest index.
 
-        /// @brief Maps of overlapping entities for each axis calculated by sweep and prune.
-        ///
-        /// For each each map, the key is an entity and the value is a list of entities that
-        /// overlap with the key. Symmetrical pairs are not stored.
-        std::unordered_map<Entity, std::vector<Entity>, cubos::core::ecs::EntityHash> sweepOverlapMaps[3];
+            /// @brief Packs the indices of both entities into a single key, which orders pairs.
+            /// @return Key.
+            uint64_t key() const
+            {
+                return (static_cast<uint64_t>(first.index) << 32) | static_cast<uint64_t>(second.index);
+            }
+        };
+
+        /// @brief Sweep markers of the tracked entities, ordered along @ref axis.
+        std::vector<SweepMarker> markers;
+
+        /// @brief Axis along which the markers are currently sorted and swept.
+        glm::length_t axis{0};
+
+        /// @brief Number of markers added since the last update, which are still unsorted.
+        std::size_t unsortedMarkers{0};
+
+        /// @brief World bounds of the tracked entities, indexed by their slot.
+        std::vector<core::geom::AABB> bounds;
+
+        /// @brief Collision layers of the tracked entities, indexed by their slot.
+        std::vector<uint32_t> layers;
+
+        /// @brief Collision masks of the tracked entities, indexed by their slot.
+        std::vector<uint32_t> masks;
+
+        /// @brief Maps tracked entities to their slot in @ref bounds.
+        std::unordered_map<Entity, std::size_t, cubos::core::ecs::EntityHash> slots;
+
+        /// @brief Slots in @ref bounds which were freed by removed entities.
+        std::vector<std::size_t> freeSlots;
+
+        /// @brief Overlapping pairs found on the last sweep, sorted by their key.
+        std::vector<Pair> pairs;
 
-        /// @brief Set of active entities during sweep for each axis.
-        std::unordered_set<Entity, cubos::core::ecs::EntityHash> activePerAxis[3];
+        /// @brief Pairs which started overlapping and haven't been reported yet.
+        std::vector<Pair> addedPairs;
+
+        /// @brief Pairs which stopped overlapping and haven't been reported yet.
+        std::vector<Pair> removedPairs;
 
         /// @brief Adds an entity to the list of entities tracked by sweep and prune.
         /// @param entity Entity to add.
         void addEntity(Entity entity);
 
         /// @brief Removes an entity from the list of entities tracked by sweep and prune.
+        ///
+        /// Its pairs are immediately forgotten and reported as removed.
+        ///
         /// @param entity Entity to remove.
         void removeEntity(Entity entity);
 
         /// @brief Clears the list of entities tracked by sweep and prune.
         void clearEntities();
+
+        /// @brief Updates the bounds and filtering information of a tracked entity. Does nothing if the entity isn't
+        /// tracked.
+        /// @param entity Entity.
+        /// @param aabb New world bounds of the entity.
+        /// @param layers Collision layers of the entity.
+        /// @param mask Collision mask of the entity.
+        void updateBounds(Entity entity, const core::geom::AABB& aabb, uint32_t layers, uint32_t mask);
+
+        /// @brief Picks the axis along which the bounds are most spread out, refreshes the coordinates of the markers
+        /// along it from @ref bounds, and sorts them again.
+        ///
+        /// As objects move little between steps, the markers are usually almost sorted already, and thus insertion
+        /// sort is used, unless the axis changed or many markers were added since the last update.
+        void updateMarkers();
+
+        /// @brief Sweeps through the sorted markers, and compares the overlapping pairs with the ones found
+        /// previously.
+        ///
+        /// Pairs which weren't overlapping before are appended to @ref addedPairs, and pairs which no longer overlap
+        /// are appended to @ref removedPairs.
+        void sweep();
+
+        /// @brief Finds the tracked entities whose bounds overlap the given bounds, as of the last update.
+        ///
+        /// Only the markers on the side of the bounds along @ref axis with the fewest markers are visited.
+        ///
+        /// @param aabb Bounds.
+        /// @param mask Collision mask, which the layers of the entities must match.
+        /// @param[out] entities Overlapping entities. Cleared before being filled.
+        void overlapping(const core::geom::AABB& aabb, uint32_t mask, std::vector<Entity>& entities) const;
+
+    private:
+        std::vector<SweepMarker> mActive;          ///< Min markers of the entities active during the sweep.
+        std::vector<std::size_t> mActivePositions; ///< Position in @ref mActive of each active slot.
+        std::vector<Pair> mSweptPairs;             ///< Pairs found by the sweep, before being compared.
     };
 } // namespace cubos::engine
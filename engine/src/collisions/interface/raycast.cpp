@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+
 #include <cubos/engine/collisions/raycast.hpp>
 
 static float intersects(cubos::engine::Raycast::Ray ray, cubos::core::geom::AABB aabb)
@@ -135,91 +140,361 @@ static float intersects(cubos::engine::Raycast::Ray ray, const glm::mat4& worldT
     return -1.0F;
 };
 
-cubos::engine::Opt<cubos::engine::Raycast::Hit> cubos::engine::Raycast::fire(Ray ray)
+/// @brief Tests a ray against a box of a voxel shape, keeping the closest intersection found.
+/// @param localRay Ray in the local space of the shape.
+/// @param boxShiftPair Box.
+/// @param closest Closest intersection found until now, or a negative value if none was found.
+/// @return Closest intersection, or a negative value if none was found.
+static float closestBox(const cubos::engine::Raycast::Ray& localRay,
+                        const cubos::engine::VoxelCollisionShape::BoxShiftPair& boxShiftPair, float closest)
+{
+    // Transform the ray into the box's space.
+    auto boxRay = localRay;
+    boxRay.origin += boxShiftPair.shift;
+
+    float scalar = intersects(boxRay, boxShiftPair.box);
+    if (scalar >= 0.0F && (closest < 0.0F || scalar < closest))
+    {
+        return scalar;
+    }
+    return closest;
+}
+
+/// @brief Gets the distance along a ray at which it enters an AABB.
+/// @param origin Origin of the ray.
+/// @param invDirection Inverse of the normalized direction of the ray.
+/// @param aabb AABB.
+/// @return Distance, zero if the origin is inside the AABB, or a negative value if the ray misses it.
+static float entryDistance(const glm::vec3& origin, const glm::vec3& invDirection, const cubos::core::geom::AABB& aabb)
+{
+    glm::vec3 t1 = (aabb.min() - origin) * invDirection;
+    glm::vec3 t2 = (aabb.max() - origin) * invDirection;
+    glm::vec3 tNear = glm::min(t1, t2);
+    glm::vec3 tFar = glm::max(t1, t2);
+
+    float tMin = std::max(std::max(tNear.x, tNear.y), tNear.z);
+    float tMax = std::min(std::min(tFar.x, tFar.y), tFar.z);
+
+    if (tMax < 0.0F || tMin > tMax)
+    {
+        return -1.0F;
+    }
+
+    return std::max(tMin, 0.0F);
+}
+
+void cubos::engine::Raycast::build()
+{
+    if (mBuilt)
+    {
+        return;
+    }
+    mBuilt = true;
+
+    // Compute the bounds from the current transforms, as the ones stored in the colliders are only updated on fixed
+    // steps.
+    std::vector<core::geom::AABB> bounds;
+    for (auto [entity, localToWorld, shape, colliderAABB, layers] : mBoxes)
+    {
+        mTargets.push_back(
+            {.entity = entity, .layers = layers.value, .worldToLocal = localToWorld.inverse(), .box = &shape});
+        bounds.push_back(core::geom::AABB::fromOBB(colliderAABB.localAABB.box(), localToWorld.mat));
+    }
+
+    for (auto [entity, localToWorld, shape, position, colliderAABB, layers] : mCapsules)
+    {
+        mTargets.push_back({.entity = entity,
+                            .layers = layers.value,
+                            .worldToLocal = localToWorld.inverse(),
+                            .position = position.vec,
+                            .capsule = &shape});
+        bounds.push_back(core::geom::AABB::fromOBB(colliderAABB.localAABB.box(), localToWorld.mat));
+    }
+
+    for (auto [entity, localToWorld, shape, colliderAABB, layers] : mVoxels)
+    {
+        mTargets.push_back(
+            {.entity = entity, .layers = layers.value, .worldToLocal = localToWorld.inverse(), .voxel = &shape});
+        bounds.push_back(core::geom::AABB::fromOBB(colliderAABB.localAABB.box(), localToWorld.mat));
+    }
+
+    if (mTargets.empty())
+    {
+        return;
+    }
+
+    std::vector<uint32_t> indices(mTargets.size());
+    std::iota(indices.begin(), indices.end(), 0U);
+    mNodes.reserve(2 * mTargets.size() - 1);
+    this->buildNode(bounds, indices, 0, indices.size());
+}
+
+uint32_t cubos::engine::Raycast::buildNode(const std::vector<core::geom::AABB>& bounds, std::vector<uint32_t>& indices,
+                                           std::size_t begin, std::size_t end)
+{
+    auto aabb = bounds[indices[begin]];
+    for (auto i = begin + 1; i < end; ++i)
+    {
+        aabb.min(glm::min(aabb.min(), bounds[indices[i]].min()));
+        aabb.max(glm::max(aabb.max(), bounds[indices[i]].max()));
+    }
+
+    auto index = static_cast<uint32_t>(mNodes.size());
+    mNodes.push_back({.aabb = aabb, .children = {0, 0}, .target = Node::NoTarget});
+    if (end - begin == 1)
+    {
+        mNodes[index].target = indices[begin];
+        return index;
+    }
+
+    // Split the targets in half along the longest axis of the node.
+    auto size = aabb.max() - aabb.min();
+    glm::length_t axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+    auto middle = begin + (end - begin) / 2;
+    std::nth_element(indices.begin() + static_cast<std::ptrdiff_t>(begin),
+                     indices.begin() + static_cast<std::ptrdiff_t>(middle),
+                     indices.begin() + static_cast<std::ptrdiff_t>(end),
+                     [&](uint32_t a, uint32_t b) { return bounds[a].center()[axis] < bounds[b].center()[axis]; });
+
+    auto left = this->buildNode(bounds, indices, begin, middle);
+    auto right = this->buildNode(bounds, indices, middle, end);
+    mNodes[index].children[0] = left;
+    mNodes[index].children[1] = right;
+    return index;
+}
+
+/// @brief Tests a ray against the boxes of a voxel shape, skipping the branches of its hierarchy the ray misses.
+/// @param shape Voxel shape.
+/// @param localRay Ray in the local space of the shape.
+/// @param maxScalar Distance after which boxes are ignored.
+/// @return Closest intersection, or a negative value if none was found.
+static float closestShapeBox(const cubos::engine::VoxelCollisionShape& shape,
+                             const cubos::engine::Raycast::Ray& localRay, float maxScalar)
+{
+    float scalar = -1.0F;
+    const auto& boxes = shape.getBoxes();
+    const auto& tree = shape.getTree();
+    glm::vec3 localInvDirection = 1.0F / localRay.direction;
+    std::vector<uint32_t> boxStack;
+    if (!tree.empty())
+    {
+        boxStack.push_back(0);
+    }
+
+    while (!boxStack.empty())
+    {
+        const auto& boxNode = tree[boxStack.back()];
+        boxStack.pop_back();
+
+        float boxDistance = entryDistance(localRay.origin, localInvDirection, boxNode.aabb);
+        if (boxDistance < 0.0F || boxDistance > maxScalar)
+        {
+            continue;
+        }
+
+        if (boxNode.box != cubos::engine::VoxelCollisionShape::TreeNode::NoBox)
+        {
+            scalar = closestBox(localRay, boxes[boxNode.box], scalar);
+            continue;
+        }
+
+        boxStack.push_back(boxNode.children[0]);
+        boxStack.push_back(boxNode.children[1]);
+    }
+
+    if (tree.empty())
+    {
+        // Shapes whose hierarchy wasn't built must test every box.
+        for (const auto& boxShiftPair : boxes)
+        {
+            scalar = closestBox(localRay, boxShiftPair, scalar);
+        }
+    }
+
+    return scalar;
+}
+
+cubos::engine::Opt<cubos::engine::Raycast::Hit> cubos::engine::Raycast::trace(Ray ray) const
 {
     Opt<Hit> hitMax;
     float minScalar = std::numeric_limits<float>::infinity();
 
+    if (mNodes.empty())
+    {
+        return hitMax;
+    }
+
     // normalize the ray
     ray.direction = glm::normalize(ray.direction);
+    glm::vec3 invDirection = 1.0F / ray.direction;
+
+    // As the hierarchy is balanced, its depth is at most 32, which bounds the size of the stack.
+    std::array<std::pair<uint32_t, float>, 64> stack;
+    std::size_t stackSize = 0;
+    float rootDistance = entryDistance(ray.origin, invDirection, mNodes[0].aabb);
+    if (rootDistance >= 0.0F)
+    {
+        stack[stackSize++] = {0, rootDistance};
+    }
 
-    for (auto [entity, localToWorld, shape, layers] : mBoxes)
+    while (stackSize > 0)
     {
-        if ((ray.mask & layers.value) == 0U)
+        auto [index, distance] = stack[--stackSize];
+        if (distance > minScalar)
         {
+            // A closer hit was found since the node was pushed.
             continue;
         }
 
-        auto worldToLocal = localToWorld.inverse();
-        Ray localRay = {glm::vec3(worldToLocal * glm::vec4(ray.origin, 1.0F)),
-                        glm::normalize(glm::vec3(worldToLocal * glm::vec4(ray.direction, 0.0F)))};
-        float scalar = intersects(localRay, shape.box);
-
-        if (scalar <= minScalar && scalar >= 0.0F)
+        const auto& node = mNodes[index];
+        if (node.target == Node::NoTarget)
         {
-            Hit hit;
-            hit.entity = entity;
-            hit.point = glm::vec3(ray.origin + scalar * ray.direction);
-            hitMax.replace(hit);
-            minScalar = scalar;
+            // Push the farthest child first, so that the closest one is visited first.
+            float distance0 = entryDistance(ray.origin, invDirection, mNodes[node.children[0]].aabb);
+            float distance1 = entryDistance(ray.origin, invDirection, mNodes[node.children[1]].aabb);
+            std::pair<uint32_t, float> near{node.children[0], distance0};
+            std::pair<uint32_t, float> far{node.children[1], distance1};
+            if (distance1 >= 0.0F && (distance0 < 0.0F || distance1 < distance0))
+            {
+                std::swap(near, far);
+            }
+
+            if (far.second >= 0.0F && far.second <= minScalar)
+            {
+                stack[stackSize++] = far;
+            }
+
+            if (near.second >= 0.0F && near.second <= minScalar)
+            {
+                stack[stackSize++] = near;
+            }
+
+            continue;
         }
-    }
 
-    for (auto [entity, localToWorld, shape, position, layers] : mCapsules)
-    {
-        if ((ray.mask & layers.value) == 0U)
+        const auto& target = mTargets[node.target];
+        if ((ray.mask & target.layers) == 0U || target.entity == ray.ignored)
         {
             continue;
         }
 
-        auto worldToLocal = localToWorld.inverse();
-        Ray localRay = {glm::vec3(worldToLocal * glm::vec4(ray.origin, 1.0F)),
-                        glm::normalize(glm::vec3(worldToLocal * glm::vec4(ray.direction, 0.0F)))};
-        float scalar = intersects(localRay, worldToLocal, shape.capsule, position);
+        Hit hit;
+        float scalar = intersect(target, ray, minScalar, hit);
         if (scalar <= minScalar && scalar >= 0.0F)
         {
-            Hit hit;
-            hit.entity = entity;
             hit.point = glm::vec3(ray.origin + scalar * ray.direction);
             hitMax.replace(hit);
             minScalar = scalar;
         }
     }
 
-    for (auto [entity, localToWorld, shape, aabb, layers] : mVoxels)
+    return hitMax;
+}
+
+float cubos::engine::Raycast::intersect(const Target& target, const Ray& ray, float maxScalar, Hit& hit)
+{
+    // Distances along the local ray are scaled by how much the transform stretches the ray's direction, and must be
+    // converted back to world distances before being compared with hits on other targets.
+    glm::vec3 localDirection = glm::vec3(target.worldToLocal * glm::vec4(ray.direction, 0.0F));
+    float localScale = glm::length(localDirection);
+    Ray localRay = {glm::vec3(target.worldToLocal * glm::vec4(ray.origin, 1.0F)), localDirection / localScale};
+    maxScalar *= localScale;
+
+    float scalar = -1.0F;
+    hit.entity = target.entity;
+    if (target.box != nullptr)
     {
-        if ((ray.mask & layers.value) == 0U)
+        scalar = intersects(localRay, target.box->box);
+    }
+    else if (target.capsule != nullptr)
+    {
+        scalar = intersects(localRay, target.worldToLocal, target.capsule->capsule, Position{target.position});
+    }
+    else if (const auto& decomposition = target.voxel->getDecomposition();
+             decomposition != nullptr && !decomposition->voxels.empty())
+    {
+        // Step through the voxels themselves, so that the exact voxel which was hit is known.
+        VoxelCollisionShape::VoxelHit voxelHit;
+        if (target.voxel->raycast(localRay.origin, localRay.direction, maxScalar, voxelHit))
         {
-            continue;
+            scalar = voxelHit.distance;
+            hit.normal = glm::normalize(glm::transpose(glm::mat3(target.worldToLocal)) * voxelHit.normal);
+            hit.voxel = voxelHit.voxel;
+            hit.material = voxelHit.material;
         }
+    }
+    else
+    {
+        scalar = closestShapeBox(*target.voxel, localRay, maxScalar);
+    }
 
-        // Test first against the AABB
-        if (intersects(ray, aabb.worldAABB) < 0.0F)
-        {
-            continue;
-        }
+    return scalar < 0.0F ? scalar : scalar / localScale;
+}
 
-        // Check if it hits with any of the boxes.
-        auto worldToLocal = localToWorld.inverse();
-        for (const auto& boxShiftPair : shape.getBoxes())
-        {
-            // Transform the ray into the box's space.
-            Ray localRay = {glm::vec3(worldToLocal * glm::vec4(ray.origin, 1.0F)),
-                            glm::normalize(glm::vec3(worldToLocal * glm::vec4(ray.direction, 0.0F)))};
-            localRay.origin += boxShiftPair.shift;
-
-            // Check if the ray intersects with the box.
-            float scalar = intersects(localRay, boxShiftPair.box);
-            if (scalar <= minScalar && scalar >= 0.0F)
-            {
-                Hit hit;
-                hit.entity = entity;
-                hit.point = glm::vec3(ray.origin + scalar * ray.direction);
-                hitMax.replace(hit);
-                minScalar = scalar;
-            }
-        }
+cubos::engine::Opt<cubos::engine::Raycast::Hit> cubos::engine::Raycast::fire(Ray ray)
+{
+    this->build();
+    return this->trace(ray);
+}
+
+cubos::engine::Opt<cubos::engine::Raycast::Hit> cubos::engine::Raycast::fire(Ray ray, Entity entity)
+{
+    Target target{};
+    if (auto match = mBoxes.at(entity))
+    {
+        auto [ent, localToWorld, shape, colliderAABB, layers] = *match;
+        target = {.entity = ent, .layers = layers.value, .worldToLocal = localToWorld.inverse(), .box = &shape};
+    }
+    else if (auto match = mCapsules.at(entity))
+    {
+        auto [ent, localToWorld, shape, position, colliderAABB, layers] = *match;
+        target = {.entity = ent,
+                  .layers = layers.value,
+                  .worldToLocal = localToWorld.inverse(),
+                  .position = position.vec,
+                  .capsule = &shape};
+    }
+    else if (auto match = mVoxels.at(entity))
+    {
+        auto [ent, localToWorld, shape, colliderAABB, layers] = *match;
+        target = {.entity = ent, .layers = layers.value, .worldToLocal = localToWorld.inverse(), .voxel = &shape};
+    }
+    else
+    {
+        return {};
     }
 
-    return hitMax;
-};
+    Opt<Hit> result;
+    if ((ray.mask & target.layers) == 0U || target.entity == ray.ignored)
+    {
+        return result;
+    }
+
+    ray.direction = glm::normalize(ray.direction);
+    Hit hit;
+    float scalar = intersect(target, ray, std::numeric_limits<float>::infinity(), hit);
+    if (scalar >= 0.0F)
+    {
+        hit.point = glm::vec3(ray.origin + scalar * ray.direction);
+        result.replace(hit);
+    }
+    return result;
+}
+
+std::vector<cubos::engine::Opt<cubos::engine::Raycast::Hit>> cubos::engine::Raycast::fireMany(
+    std::span<const Ray> rays)
+{
+    this->build();
+
+    // Rays are processed in chunks, as tracing a single ray is too little work for a task.
+    constexpr std::size_t ChunkSize = 64;
+    std::vector<Opt<Hit>> hits(rays.size());
+    mParallel.forEach((rays.size() + ChunkSize - 1) / ChunkSize, [&](std::size_t chunk) {
+        auto end = std::min(rays.size(), (chunk + 1) * ChunkSize);
+        for (auto i = chunk * ChunkSize; i < end; ++i)
+        {
+            hits[i] = this->trace(rays[i]);
+        }
+    });
+    return hits;
+}
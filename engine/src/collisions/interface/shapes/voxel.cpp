@@ -1,9 +1,362 @@
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
 #include <cubos/core/ecs/reflection.hpp>
 
 #include <cubos/engine/collisions/shapes/voxel.hpp>
 
+using cubos::core::geom::AABB;
+using cubos::engine::VoxelCollisionShape;
+
 CUBOS_REFLECT_IMPL(cubos::engine::VoxelCollisionShape)
 {
     return core::ecs::TypeBuilder<VoxelCollisionShape>("cubos::engine::VoxelCollisionShape")
         .wrap(&VoxelCollisionShape::grid);
 }
+
+/// @brief Gets the bounds of a box in the local space of its shape.
+/// @param box Box.
+/// @return Bounds.
+static AABB boxBounds(const VoxelCollisionShape::BoxShiftPair& box)
+{
+    // Boxes are placed at the opposite of their shift.
+    AABB aabb{};
+    aabb.min(-box.shift - box.box.halfSize);
+    aabb.max(-box.shift + box.box.halfSize);
+    return aabb;
+}
+
+/// @brief Gets the bounds of a transformed AABB.
+/// @param aabb Bounds.
+/// @param transform Transform.
+/// @return Transformed bounds.
+static AABB transformBounds(const AABB& aabb, const glm::mat4& transform)
+{
+    // Equivalent to multiplying the transform by a translation to the center of the AABB.
+    auto centered = transform;
+    centered[3] = transform * glm::vec4{aabb.center(), 1.0F};
+    return AABB::fromOBB(aabb.box(), centered);
+}
+
+/// @brief Gets the volume of an AABB.
+/// @param aabb Bounds.
+/// @return Volume.
+static float volume(const AABB& aabb)
+{
+    auto size = aabb.max() - aabb.min();
+    return size.x * size.y * size.z;
+}
+
+/// @brief Recursively builds a node of a bounding volume hierarchy.
+/// @param nodes Nodes of the hierarchy.
+/// @param boxes Boxes of the shape.
+/// @param indices Indices of the boxes, reordered while building.
+/// @param begin First index covered by the node.
+/// @param end Index after the last index covered by the node.
+/// @return Index of the node.
+static uint32_t buildNode(std::vector<VoxelCollisionShape::TreeNode>& nodes,
+                         const std::vector<VoxelCollisionShape::BoxShiftPair>& boxes, std::vector<uint32_t>& indices,
+                         std::size_t begin, std::size_t end)
+{
+    auto aabb = boxBounds(boxes[indices[begin]]);
+    for (auto i = begin + 1; i < end; ++i)
+    {
+        auto other = boxBounds(boxes[indices[i]]);
+        aabb.min(glm::min(aabb.min(), other.min()));
+        aabb.max(glm::max(aabb.max(), other.max()));
+    }
+
+    auto index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back({.aabb = aabb, .children = {0, 0}, .box = VoxelCollisionShape::TreeNode::NoBox});
+    if (end - begin == 1)
+    {
+        nodes[index].box = indices[begin];
+        return index;
+    }
+
+    // Split the boxes in half along the longest axis of the node.
+    auto size = aabb.max() - aabb.min();
+    glm::length_t axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+    auto middle = begin + (end - begin) / 2;
+    std::nth_element(indices.begin() + static_cast<std::ptrdiff_t>(begin),
+                     indices.begin() + static_cast<std::ptrdiff_t>(middle),
+                     indices.begin() + static_cast<std::ptrdiff_t>(end),
+                     [&](uint32_t a, uint32_t b) { return -boxes[a].shift[axis] < -boxes[b].shift[axis]; });
+
+    auto left = buildNode(nodes, boxes, indices, begin, middle);
+    auto right = buildNode(nodes, boxes, indices, middle, end);
+    nodes[index].children[0] = left;
+    nodes[index].children[1] = right;
+    return index;
+}
+
+void VoxelCollisionShape::Decomposition::buildTree()
+{
+    tree.clear();
+    if (boxes.empty())
+    {
+        return;
+    }
+
+    std::vector<uint32_t> indices(boxes.size());
+    std::iota(indices.begin(), indices.end(), 0U);
+    tree.reserve(2 * boxes.size() - 1);
+    buildNode(tree, boxes, indices, 0, indices.size());
+}
+
+void VoxelCollisionShape::Decomposition::storeVoxels(const VoxelGrid& grid)
+{
+    gridSize = glm::ivec3(grid.size());
+    brickCount = (gridSize + BrickSize - 1) / BrickSize;
+    voxels.assign(static_cast<std::size_t>(gridSize.x * gridSize.y * gridSize.z), 0);
+    bricks.assign(static_cast<std::size_t>(brickCount.x * brickCount.y * brickCount.z), 0);
+
+    for (int z = 0; z < gridSize.z; ++z)
+    {
+        for (int y = 0; y < gridSize.y; ++y)
+        {
+            for (int x = 0; x < gridSize.x; ++x)
+            {
+                auto material = grid.get({x, y, z});
+                if (material == 0)
+                {
+                    continue;
+                }
+
+                auto brick = glm::ivec3{x, y, z} / BrickSize;
+                voxels[static_cast<std::size_t>(x + gridSize.x * (y + gridSize.y * z))] = material;
+                bricks[static_cast<std::size_t>(brick.x + brickCount.x * (brick.y + brickCount.y * brick.z))] = 1;
+            }
+        }
+    }
+}
+
+void VoxelCollisionShape::insertBox(const cubos::core::geom::Box& box, const glm::vec3& shift, uint32_t boxId)
+{
+    auto decomposition = mDecomposition == nullptr ? std::make_shared<Decomposition>()
+                                                   : std::make_shared<Decomposition>(*mDecomposition);
+    decomposition->boxes.push_back(BoxShiftPair{box, shift, boxId});
+    decomposition->buildTree();
+    mDecomposition = std::move(decomposition);
+}
+
+const std::vector<VoxelCollisionShape::BoxShiftPair>& VoxelCollisionShape::getBoxes() const
+{
+    static const std::vector<BoxShiftPair> Empty{};
+    return mDecomposition == nullptr ? Empty : mDecomposition->boxes;
+}
+
+const std::vector<VoxelCollisionShape::TreeNode>& VoxelCollisionShape::getTree() const
+{
+    static const std::vector<TreeNode> Empty{};
+    return mDecomposition == nullptr ? Empty : mDecomposition->tree;
+}
+
+void VoxelCollisionShape::findBoxes(const AABB& aabb, std::vector<std::size_t>& boxes) const
+{
+    boxes.clear();
+    const auto& tree = this->getTree();
+    if (tree.empty())
+    {
+        return;
+    }
+
+    std::vector<uint32_t> stack{0};
+    while (!stack.empty())
+    {
+        const auto& node = tree[stack.back()];
+        stack.pop_back();
+
+        if (!node.aabb.overlaps(aabb))
+        {
+            continue;
+        }
+
+        if (node.box != TreeNode::NoBox)
+        {
+            boxes.push_back(node.box);
+        }
+        else
+        {
+            stack.push_back(node.children[0]);
+            stack.push_back(node.children[1]);
+        }
+    }
+}
+
+void VoxelCollisionShape::findBoxPairs(const VoxelCollisionShape& other, const glm::mat4& otherToThis,
+                                       std::vector<std::pair<std::size_t, std::size_t>>& pairs) const
+{
+    pairs.clear();
+    const auto& tree = this->getTree();
+    const auto& otherTree = other.getTree();
+    if (tree.empty() || otherTree.empty())
+    {
+        return;
+    }
+
+    std::vector<std::pair<uint32_t, uint32_t>> stack{{0, 0}};
+    while (!stack.empty())
+    {
+        auto [index, otherIndex] = stack.back();
+        stack.pop_back();
+
+        const auto& node = tree[index];
+        const auto& otherNode = otherTree[otherIndex];
+        auto otherAABB = transformBounds(otherNode.aabb, otherToThis);
+        if (!node.aabb.overlaps(otherAABB))
+        {
+            continue;
+        }
+
+        bool isLeaf = node.box != TreeNode::NoBox;
+        bool isOtherLeaf = otherNode.box != TreeNode::NoBox;
+        if (isLeaf && isOtherLeaf)
+        {
+            pairs.emplace_back(node.box, otherNode.box);
+        }
+        else if (isOtherLeaf || (!isLeaf && volume(node.aabb) >= volume(otherAABB)))
+        {
+            // Descend into the larger node, as splitting it prunes more pairs.
+            stack.emplace_back(node.children[0], otherIndex);
+            stack.emplace_back(node.children[1], otherIndex);
+        }
+        else
+        {
+            stack.emplace_back(index, otherNode.children[0]);
+            stack.emplace_back(index, otherNode.children[1]);
+        }
+    }
+}
+
+bool VoxelCollisionShape::raycast(glm::vec3 origin, const glm::vec3& direction, float maxDistance, VoxelHit& hit) const
+{
+    if (mDecomposition == nullptr || mDecomposition->voxels.empty())
+    {
+        return false;
+    }
+
+    const auto& decomposition = *mDecomposition;
+    const auto gridSize = decomposition.gridSize;
+    const auto brickCount = decomposition.brickCount;
+    constexpr int BrickSize = Decomposition::BrickSize;
+
+    // Move the ray to grid space, where the voxel at (x, y, z) covers [x, x + 1] along the x axis, and so on.
+    origin += glm::vec3(gridSize) / 2.0F;
+
+    // Clip the ray against the bounds of the grid.
+    glm::vec3 invDirection = 1.0F / direction;
+    glm::vec3 t1 = -origin * invDirection;
+    glm::vec3 t2 = (glm::vec3(gridSize) - origin) * invDirection;
+    glm::vec3 tNear = glm::min(t1, t2);
+    float t = glm::max(glm::max(tNear.x, tNear.y), tNear.z);
+    glm::vec3 tFar = glm::max(t1, t2);
+    float tLeave = glm::min(glm::min(tFar.x, tFar.y), tFar.z);
+    if (tLeave < 0.0F || t > tLeave || t > maxDistance)
+    {
+        return false;
+    }
+
+    // Axis of the last face crossed by the ray. If it starts inside the grid, pick the axis it moves the most along.
+    glm::length_t axis = 0;
+    glm::vec3 entry = t >= 0.0F ? tNear : glm::abs(direction);
+    for (glm::length_t i = 1; i < 3; ++i)
+    {
+        if (entry[i] > entry[axis])
+        {
+            axis = i;
+        }
+    }
+    t = glm::max(t, 0.0F);
+
+    // Set up the traversal, as described by Amanatides and Woo.
+    glm::ivec3 cell = glm::clamp(glm::ivec3(glm::floor(origin + direction * t)), glm::ivec3(0), gridSize - 1);
+    glm::ivec3 step{0};
+    glm::vec3 tMax{std::numeric_limits<float>::infinity()};
+    glm::vec3 tDelta = glm::abs(invDirection);
+    for (glm::length_t i = 0; i < 3; ++i)
+    {
+        if (direction[i] > 0.0F)
+        {
+            step[i] = 1;
+            tMax[i] = (static_cast<float>(cell[i] + 1) - origin[i]) * invDirection[i];
+        }
+        else if (direction[i] < 0.0F)
+        {
+            step[i] = -1;
+            tMax[i] = (static_cast<float>(cell[i]) - origin[i]) * invDirection[i];
+        }
+    }
+
+    while (t <= maxDistance)
+    {
+        auto brick = cell / BrickSize;
+        auto brickIndex = static_cast<std::size_t>(brick.x + brickCount.x * (brick.y + brickCount.y * brick.z));
+        if (decomposition.bricks[brickIndex] == 0)
+        {
+            // Skip the whole brick at once: find the axis through which the ray leaves it first, and advance every
+            // axis by the number of cells it crosses until then.
+            auto brickMin = brick * BrickSize;
+            auto brickMax = glm::min(brickMin + BrickSize, gridSize);
+            glm::ivec3 crossings{0};
+            glm::vec3 tExit{std::numeric_limits<float>::infinity()};
+            for (glm::length_t i = 0; i < 3; ++i)
+            {
+                crossings[i] = step[i] > 0 ? brickMax[i] - cell[i] : (step[i] < 0 ? cell[i] - brickMin[i] + 1 : 0);
+                if (crossings[i] > 0)
+                {
+                    tExit[i] = tMax[i] + static_cast<float>(crossings[i] - 1) * tDelta[i];
+                }
+            }
+
+            axis = tExit.x < tExit.y ? (tExit.x < tExit.z ? 0 : 2) : (tExit.y < tExit.z ? 1 : 2);
+            t = tExit[axis];
+            for (glm::length_t i = 0; i < 3; ++i)
+            {
+                if (step[i] == 0)
+                {
+                    // The ray never crosses this axis, and its infinite tMax and tDelta must be left untouched.
+                    continue;
+                }
+
+                int count = crossings[i];
+                if (i != axis)
+                {
+                    // Other axes may only be crossed before the ray leaves the brick.
+                    count = tMax[i] <= t ? static_cast<int>((t - tMax[i]) / tDelta[i]) + 1 : 0;
+                    count = glm::min(count, crossings[i] - 1);
+                }
+
+                cell[i] += step[i] * count;
+                tMax[i] += static_cast<float>(count) * tDelta[i];
+            }
+        }
+        else
+        {
+            auto index = static_cast<std::size_t>(cell.x + gridSize.x * (cell.y + gridSize.y * cell.z));
+            if (decomposition.voxels[index] != 0)
+            {
+                hit.distance = t;
+                hit.voxel = cell;
+                hit.normal = glm::vec3{0.0F};
+                hit.normal[axis] = direction[axis] > 0.0F ? -1.0F : 1.0F;
+                hit.material = decomposition.voxels[index];
+                return true;
+            }
+
+            // Step into the next cell.
+            axis = tMax.x < tMax.y ? (tMax.x < tMax.z ? 0 : 2) : (tMax.y < tMax.z ? 1 : 2);
+            t = tMax[axis];
+            cell[axis] += step[axis];
+            tMax[axis] += tDelta[axis];
+        }
+
+        if (glm::any(glm::lessThan(cell, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(cell, gridSize)))
+        {
+            return false;
+        }
+    }
+
+    return false;
+}
@@ -1,5 +1,7 @@
 #include "plugin.hpp"
 #include <algorithm>
+#include <limits>
+#include <vector>
 
 #include <glm/glm.hpp>
 
@@ -30,6 +32,93 @@ using cubos::engine::ContactFeatureId;
 using cubos::engine::ContactPointData;
 using cubos::engine::LocalToWorld;
 
+/// @brief Reduces the contact points of a manifold to at most @ref ContactManifold::MaxPoints points.
+///
+/// Keeps the deepest point, the point furthest from it, the point which forms the largest triangle with those two,
+/// and the point which extends that triangle the most, which together cover most of the contact area.
+/// @param points Contact points.
+/// @param normal Normal of the manifold.
+static void reduceContactPoints(std::vector<ContactPointData>& points, const glm::vec3& normal)
+{
+    if (points.size() <= cubos::engine::ContactManifold::MaxPoints)
+    {
+        return;
+    }
+
+    auto depth = [&](std::size_t i) { return glm::abs(glm::dot(points[i].globalOn1 - points[i].globalOn2, normal)); };
+    auto position = [&](std::size_t i) { return points[i].globalOn2; };
+    auto signedArea = [&](std::size_t i, std::size_t j, std::size_t k) {
+        return glm::dot(glm::cross(position(j) - position(i), position(k) - position(i)), normal);
+    };
+
+    // Deepest point.
+    std::size_t a = 0;
+    for (std::size_t i = 1; i < points.size(); ++i)
+    {
+        if (depth(i) > depth(a))
+        {
+            a = i;
+        }
+    }
+
+    // Point furthest from the deepest point.
+    std::size_t b = a;
+    float bestDistance = -1.0F;
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        float distance = glm::distance(position(a), position(i));
+        if (i != a && distance > bestDistance)
+        {
+            b = i;
+            bestDistance = distance;
+        }
+    }
+
+    // Point which forms the largest triangle with the previous two.
+    std::size_t c = a;
+    float bestArea = -1.0F;
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        float area = glm::abs(signedArea(a, b, i));
+        if (i != a && i != b && area > bestArea)
+        {
+            c = i;
+            bestArea = area;
+        }
+    }
+
+    // Make sure the triangle is counter-clockwise around the normal, so that points outside it have negative area.
+    if (signedArea(a, b, c) < 0.0F)
+    {
+        std::swap(b, c);
+    }
+
+    // Point furthest outside of the triangle, which adds the most area to it.
+    std::size_t d = a;
+    float bestOutside = 0.0F;
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        if (i == a || i == b || i == c)
+        {
+            continue;
+        }
+
+        float outside = -std::min({signedArea(a, b, i), signedArea(b, c, i), signedArea(c, a, i)});
+        if (outside > bestOutside)
+        {
+            d = i;
+            bestOutside = outside;
+        }
+    }
+
+    std::vector<ContactPointData> reduced{points[a], points[b], points[c]};
+    if (d != a)
+    {
+        reduced.push_back(points[d]);
+    }
+    points = std::move(reduced);
+}
+
 std::vector<ContactPointData> computeContactPoints(const cubos::core::geom::Box* matchedShape1,
                                                    const LocalToWorld* matchedLocalToWorld1,
                                                    const glm::mat4* shiftedLocalToWorldMat1,
@@ -121,26 +210,81 @@ std::vector<ContactPointData> computeContactPoints(const cubos::core::geom::Box*
             points.push_back(contact);
         }
     }
+
+    reduceContactPoints(points, intersectionInfo.normal);
     return points;
 }
 
-static void matchContactPoints(std::vector<ContactPointData>& newPoints, std::vector<ContactPointData>& oldPoints)
+/// @brief Carries the impulses accumulated by the contact points of the previous step over to the new contact points,
+/// so that the solver can be warm started with them.
+///
+/// Points are matched by the features of the shapes which generated them. Clipping may produce more than one point
+/// with the same features, in which case the closest old point is chosen. Each old point is matched at most once.
+/// @param newPoints Contact points found on this step.
+/// @param oldPoints Contact points of the previous step.
+static void matchContactPoints(std::vector<ContactPointData>& newPoints, const std::vector<ContactPointData>& oldPoints)
 {
-    for (auto newPoint : newPoints)
+    std::vector<bool> matched(oldPoints.size(), false);
+    for (auto& newPoint : newPoints)
     {
-        for (auto oldPoint : oldPoints)
+        std::size_t best = oldPoints.size();
+        float bestDistance = std::numeric_limits<float>::infinity();
+        for (std::size_t i = 0; i < oldPoints.size(); ++i)
         {
-            if ((newPoint.fid1 == oldPoint.fid1) && (newPoint.fid2 == oldPoint.fid2))
+            const auto& oldPoint = oldPoints[i];
+            if (matched[i] || !(newPoint.fid1 == oldPoint.fid1) || !(newPoint.fid2 == oldPoint.fid2))
+            {
+                continue;
+            }
+
+            float distance = glm::distance(newPoint.localOn1, oldPoint.localOn1);
+            if (distance < bestDistance)
             {
-                newPoint.normalImpulse = oldPoint.normalImpulse;
-                newPoint.frictionImpulse1 = oldPoint.frictionImpulse1;
-                newPoint.frictionImpulse2 = oldPoint.frictionImpulse2;
-                break;
+                best = i;
+                bestDistance = distance;
             }
         }
+
+        if (best != oldPoints.size())
+        {
+            matched[best] = true;
+            newPoint.normalImpulse = oldPoints[best].normalImpulse;
+            newPoint.frictionImpulse1 = oldPoints[best].frictionImpulse1;
+            newPoint.frictionImpulse2 = oldPoints[best].frictionImpulse2;
+        }
     }
 }
 
+/// @brief Marks the entities matched by a query as moved.
+///
+/// Pairs of entities which were colliding and which neither moved nor changed shape keep the contacts found
+/// previously, without being tested again. This is what makes sleeping bodies resting on static or other sleeping
+/// bodies cheap.
+///
+/// @param query Query which only matches entities whose transform or shape changed since the system last ran.
+/// @param moved Whether each entity moved, indexed by entity index.
+static void markMoved(cubos::engine::Query<Entity>& query, std::vector<bool>& moved)
+{
+    for (auto [entity] : query)
+    {
+        if (entity.index >= moved.size())
+        {
+            moved.resize(entity.index + 1, false);
+        }
+        moved[entity.index] = true;
+    }
+}
+
+/// @brief Checks whether any of two entities moved, according to @ref markMoved.
+/// @param moved Whether each entity moved, indexed by entity index.
+/// @param ent1 Entity.
+/// @param ent2 Other entity.
+/// @return Whether either of the entities moved.
+static bool anyMoved(const std::vector<bool>& moved, Entity ent1, Entity ent2)
+{
+    return (ent1.index < moved.size() && moved[ent1.index]) || (ent2.index < moved.size() && moved[ent2.index]);
+}
+
 void cubos::engine::narrowPhaseCollisionsPlugin(Cubos& cubos)
 {
     cubos.depends(transformPlugin);
@@ -176,24 +320,32 @@ void cubos::engine::narrowPhaseCollisionsPlugin(Cubos& cubos)
     cubos.system("find colliding pairs")
         .tagged(collisionsNarrowTag)
         .after(collisionsBroadTag)
-        .call([](Commands cmds,
+        .anyChanged<LocalToWorld>()
+        .anyChanged<BoxCollisionShape>()
+        .call([](Commands cmds, Query<Entity> movedQuery,
                  Query<Entity, const LocalToWorld&, const BoxCollisionShape&, const PotentiallyCollidingWith&, Entity,
                        const LocalToWorld&, const BoxCollisionShape&>
                      nQuery,
                  Query<Entity, const LocalToWorld&, const BoxCollisionShape&, CollidingWith&, Entity,
                        const LocalToWorld&, const BoxCollisionShape&>
                      yQuery) {
+            std::vector<bool> moved;
+            markMoved(movedQuery, moved);
+
             for (auto [ent1, localToWorld1, boxShape1, potentiallyCollidingWith, ent2, localToWorld2, boxShape2] :
                  nQuery)
             {
+                auto match = yQuery.pin(0, ent1).pin(1, ent2).first();
+                if (match && !anyMoved(moved, ent1, ent2))
+                {
+                    continue;
+                }
 
                 cubos::core::geom::Intersection intersectionInfo{};
 
                 bool intersects = cubos::core::geom::intersects(boxShape1.box, localToWorld1.mat, boxShape2.box,
                                                                 localToWorld2.mat, intersectionInfo);
 
-                auto match = yQuery.pin(0, ent1).pin(1, ent2).first();
-
                 // Make sure that shape1 corresponds to the entity refered to in collidingWith
                 const cubos::core::geom::Box* matchedShape1 = &boxShape1.box;
                 const cubos::core::geom::Box* matchedShape2 = &boxShape2.box;
@@ -259,23 +411,51 @@ void cubos::engine::narrowPhaseCollisionsPlugin(Cubos& cubos)
     cubos.system("find colliding voxel-box pairs")
         .tagged(collisionsNarrowTag)
         .after(collisionsBroadTag)
-        .call([](Commands cmds,
+        .changed<LocalToWorld>()
+        .other()
+        .changed<VoxelCollisionShape>()
+        .call([](Commands cmds, Query<Entity> movedQuery, Query<Entity> reshapedQuery,
                  Query<Entity, const LocalToWorld&, const BoxCollisionShape&, PotentiallyCollidingWith&, Entity,
                        const LocalToWorld&, const VoxelCollisionShape&>
                      nQuery,
                  Query<Entity, const LocalToWorld&, const BoxCollisionShape&, CollidingWith&, Entity,
                        const LocalToWorld&, const VoxelCollisionShape&>
                      yQuery) {
+            std::vector<bool> moved;
+            markMoved(movedQuery, moved);
+            markMoved(reshapedQuery, moved);
+
+            std::vector<std::size_t> candidates;
             for (auto [ent1, localToWorld1, boxShape, potentiallyCollidingWith, ent2, localToWorld2, voxelShape] :
                  nQuery)
             {
                 cubos::core::geom::Intersection intersectionInfo{};
                 auto match = yQuery.pin(0, ent1).pin(1, ent2).first();
+                if (match && !anyMoved(moved, ent1, ent2))
+                {
+                    continue;
+                }
                 std::vector<ContactManifold> newManifolds;
                 bool anyIntersects = false;
 
-                for (const auto box : voxelShape.getBoxes())
+                // Only the boxes of the voxel shape whose bounds overlap the box shape need to be tested.
+                auto boxToVoxel = glm::inverse(localToWorld2.mat) * localToWorld1.mat;
+                voxelShape.findBoxes(cubos::core::geom::AABB::fromOBB(boxShape.box, boxToVoxel), candidates);
+
+                if (match)
+                {
+                    // Boxes which weren't found can't be intersecting anymore.
+                    std::erase_if(std::get<3>(*match).manifolds, [&](const ContactManifold& manifold) {
+                        return std::none_of(candidates.begin(), candidates.end(), [&](std::size_t index) {
+                            return voxelShape.getBoxes()[index].boxId == manifold.boxId2;
+                        });
+                    });
+                }
+
+                for (auto index : candidates)
                 {
+                    const auto& box = voxelShape.getBoxes()[index];
+
                     // Get the current position from the localToWorld matrix
                     glm::mat4 shiftedLocalToWorldMat = localToWorld2.mat; // Store the matrix
                     // Create a translation matrix for the shift
@@ -358,126 +538,153 @@ void cubos::engine::narrowPhaseCollisionsPlugin(Cubos& cubos)
     cubos.system("find colliding voxel-voxel pairs")
         .tagged(collisionsNarrowTag)
         .after(collisionsBroadTag)
-        .call([](Commands cmds,
+        .changed<LocalToWorld>()
+        .other()
+        .changed<VoxelCollisionShape>()
+        .call([](Commands cmds, Query<Entity> movedQuery, Query<Entity> reshapedQuery,
                  Query<Entity, const LocalToWorld&, const VoxelCollisionShape&, PotentiallyCollidingWith&, Entity,
                        const LocalToWorld&, const VoxelCollisionShape&>
                      nQuery,
                  Query<Entity, const LocalToWorld&, const VoxelCollisionShape&, CollidingWith&, Entity,
                        const LocalToWorld&, const VoxelCollisionShape&>
                      yQuery) {
+            std::vector<bool> moved;
+            markMoved(movedQuery, moved);
+            markMoved(reshapedQuery, moved);
+
+            std::vector<std::pair<std::size_t, std::size_t>> candidates;
             for (auto [ent1, localToWorld1, voxelShape1, potentiallyCollidingWith, ent2, localToWorld2, voxelShape2] :
                  nQuery)
             {
                 cubos::core::geom::Intersection intersectionInfo{};
 
                 auto match = yQuery.pin(0, ent1).pin(1, ent2).first();
+                if (match && !anyMoved(moved, ent1, ent2))
+                {
+                    continue;
+                }
 
                 std::vector<ContactManifold> newManifolds;
                 bool anyIntersects = false;
 
-                for (const auto box1 : voxelShape1.getBoxes())
+                // Only pairs of boxes whose bounds overlap need to be tested.
+                auto secondToFirst = glm::inverse(localToWorld1.mat) * localToWorld2.mat;
+                voxelShape1.findBoxPairs(voxelShape2, secondToFirst, candidates);
+
+                if (match)
+                {
+                    // Pairs of boxes which weren't found can't be intersecting anymore.
+                    std::erase_if(std::get<3>(*match).manifolds, [&](const ContactManifold& manifold) {
+                        return std::none_of(candidates.begin(), candidates.end(), [&](const auto& candidate) {
+                            return voxelShape1.getBoxes()[candidate.first].boxId == manifold.boxId1 &&
+                                   voxelShape2.getBoxes()[candidate.second].boxId == manifold.boxId2;
+                        });
+                    });
+                }
+
+                for (auto [index1, index2] : candidates)
                 {
+                    const auto& box1 = voxelShape1.getBoxes()[index1];
+                    const auto& box2 = voxelShape2.getBoxes()[index2];
+
                     // Get the current position from the localToWorld matrix
                     glm::mat4 shiftedLocalToWorldMat1 = localToWorld1.mat; // Store the matrix
                     // Create a translation matrix for the shift
                     glm::mat4 shiftMatrix1 = glm::translate(glm::mat4(1.0F), -box1.shift);
                     shiftedLocalToWorldMat1 = shiftedLocalToWorldMat1 * shiftMatrix1;
 
-                    for (const auto box2 : voxelShape2.getBoxes())
+                    // Get the current position from the localToWorld matrix
+                    glm::mat4 shiftedLocalToWorldMat2 = localToWorld2.mat; // Store the matrix
+                    // Create a translation matrix for the shift
+                    glm::mat4 shiftMatrix2 = glm::translate(glm::mat4(1.0F), -box2.shift);
+                    shiftedLocalToWorldMat2 = shiftedLocalToWorldMat2 * shiftMatrix2;
+
+                    bool intersects = cubos::core::geom::intersects(box1.box, shiftedLocalToWorldMat1, box2.box,
+                                                                    shiftedLocalToWorldMat2, intersectionInfo);
+
+                    // If penetration not bigger than 0 continue
+                    // if (intersects && intersectionInfo.penetration < 0)
+                    //{
+                    //    continue;
+                    //}
+                    if (intersects)
                     {
-                        // Get the current position from the localToWorld matrix
-                        glm::mat4 shiftedLocalToWorldMat2 = localToWorld2.mat; // Store the matrix
-                        // Create a translation matrix for the shift
-                        glm::mat4 shiftMatrix2 = glm::translate(glm::mat4(1.0F), -box2.shift);
-                        shiftedLocalToWorldMat2 = shiftedLocalToWorldMat2 * shiftMatrix2;
-
-                        bool intersects = cubos::core::geom::intersects(box1.box, shiftedLocalToWorldMat1, box2.box,
-                                                                        shiftedLocalToWorldMat2, intersectionInfo);
-
-                        // If penetration not bigger than 0 continue
-                        // if (intersects && intersectionInfo.penetration < 0)
-                        //{
-                        //    continue;
-                        //}
-                        if (intersects)
-                        {
-                            anyIntersects = true;
-                        }
+                        anyIntersects = true;
+                    }
 
-                        // Make sure that shape1 corresponds to the entity refered to in collidingWith
-                        const cubos::core::geom::Box* matchedShape1 = &box1.box;
-                        const cubos::core::geom::Box* matchedShape2 = &box2.box;
-                        const LocalToWorld* matchedLocalToWorld1 = &localToWorld1;
-                        const LocalToWorld* matchedLocalToWorld2 = &localToWorld2;
-                        const glm::mat4* matchedShiftedLocalToWorld1 = &shiftedLocalToWorldMat1;
-                        const glm::mat4* matchedShiftedLocalToWorld2 = &shiftedLocalToWorldMat2;
+                    // Make sure that shape1 corresponds to the entity refered to in collidingWith
+                    const cubos::core::geom::Box* matchedShape1 = &box1.box;
+                    const cubos::core::geom::Box* matchedShape2 = &box2.box;
+                    const LocalToWorld* matchedLocalToWorld1 = &localToWorld1;
+                    const LocalToWorld* matchedLocalToWorld2 = &localToWorld2;
+                    const glm::mat4* matchedShiftedLocalToWorld1 = &shiftedLocalToWorldMat1;
+                    const glm::mat4* matchedShiftedLocalToWorld2 = &shiftedLocalToWorldMat2;
 
-                        // If CollidingWith present in previous frame update it
-                        if (match)
-                        {
-                            auto [ent1, localToWorld1, voxelShape1, collidingWith, ent2, localToWorld2, voxelShape2] =
-                                *match;
+                    // If CollidingWith present in previous frame update it
+                    if (match)
+                    {
+                        auto [ent1, localToWorld1, voxelShape1, collidingWith, ent2, localToWorld2, voxelShape2] =
+                            *match;
 
-                            if (!intersects || (intersects && intersectionInfo.penetration < 0))
-                            {
-                                auto it = std::remove_if(collidingWith.manifolds.begin(), collidingWith.manifolds.end(),
-                                                         [&](const auto& manifold) {
-                                                             return manifold.boxId2 == box2.boxId &&
-                                                                    manifold.boxId1 == box1.boxId;
-                                                         });
-                                collidingWith.manifolds.erase(it, collidingWith.manifolds.end());
-                                continue;
-                            }
+                        if (!intersects || (intersects && intersectionInfo.penetration < 0))
+                        {
+                            auto it = std::remove_if(collidingWith.manifolds.begin(), collidingWith.manifolds.end(),
+                                                     [&](const auto& manifold) {
+                                                         return manifold.boxId2 == box2.boxId &&
+                                                                manifold.boxId1 == box1.boxId;
+                                                     });
+                            collidingWith.manifolds.erase(it, collidingWith.manifolds.end());
+                            continue;
+                        }
 
-                            if (ent1 != collidingWith.entity)
-                            {
-                                std::swap(matchedShape1, matchedShape2);
-                                std::swap(matchedLocalToWorld1, matchedLocalToWorld2);
-                                std::swap(shiftedLocalToWorldMat1, shiftedLocalToWorldMat2);
-                                intersectionInfo.normal *= -1;
-                            }
+                        if (ent1 != collidingWith.entity)
+                        {
+                            std::swap(matchedShape1, matchedShape2);
+                            std::swap(matchedLocalToWorld1, matchedLocalToWorld2);
+                            std::swap(shiftedLocalToWorldMat1, shiftedLocalToWorldMat2);
+                            intersectionInfo.normal *= -1;
+                        }
 
-                            auto points =
-                                computeContactPoints(matchedShape1, matchedLocalToWorld1, matchedShiftedLocalToWorld1,
-                                                     matchedShape2, matchedLocalToWorld2, matchedShiftedLocalToWorld2,
-                                                     intersectionInfo, collidingWith.entity);
+                        auto points =
+                            computeContactPoints(matchedShape1, matchedLocalToWorld1, matchedShiftedLocalToWorld1,
+                                                 matchedShape2, matchedLocalToWorld2, matchedShiftedLocalToWorld2,
+                                                 intersectionInfo, collidingWith.entity);
 
-                            bool existed = false;
-                            for (auto& manifold : collidingWith.manifolds)
-                            {
-                                if (manifold.boxId1 == box1.boxId && manifold.boxId2 == box2.boxId)
-                                {
-                                    manifold.normal = intersectionInfo.normal;
-                                    matchContactPoints(points, manifold.points);
-                                    manifold.points = points;
-                                    existed = true;
-                                    break;
-                                }
-                            }
-                            if (!existed)
+                        bool existed = false;
+                        for (auto& manifold : collidingWith.manifolds)
+                        {
+                            if (manifold.boxId1 == box1.boxId && manifold.boxId2 == box2.boxId)
                             {
-                                collidingWith.manifolds.push_back(ContactManifold{.normal = intersectionInfo.normal,
-                                                                                  .points = points,
-                                                                                  .boxId1 = box1.boxId,
-                                                                                  .boxId2 = box2.boxId});
+                                manifold.normal = intersectionInfo.normal;
+                                matchContactPoints(points, manifold.points);
+                                manifold.points = points;
+                                existed = true;
+                                break;
                             }
                         }
-                        else
+                        if (!existed)
                         {
-                            if (!intersects)
-                            {
-                                continue;
-                            }
-
-                            auto points = computeContactPoints(
-                                matchedShape1, matchedLocalToWorld1, matchedShiftedLocalToWorld1, matchedShape2,
-                                matchedLocalToWorld2, matchedShiftedLocalToWorld2, intersectionInfo, ent1);
-                            newManifolds.push_back(ContactManifold{.normal = intersectionInfo.normal,
-                                                                   .points = points,
-                                                                   .boxId1 = box1.boxId,
-                                                                   .boxId2 = box2.boxId});
+                            collidingWith.manifolds.push_back(ContactManifold{.normal = intersectionInfo.normal,
+                                                                              .points = points,
+                                                                              .boxId1 = box1.boxId,
+                                                                              .boxId2 = box2.boxId});
                         }
                     }
+                    else
+                    {
+                        if (!intersects)
+                        {
+                            continue;
+                        }
+
+                        auto points = computeContactPoints(
+                            matchedShape1, matchedLocalToWorld1, matchedShiftedLocalToWorld1, matchedShape2,
+                            matchedLocalToWorld2, matchedShiftedLocalToWorld2, intersectionInfo, ent1);
+                        newManifolds.push_back(ContactManifold{.normal = intersectionInfo.normal,
+                                                               .points = points,
+                                                               .boxId1 = box1.boxId,
+                                                               .boxId2 = box2.boxId});
+                    }
                 }
                 if (!match && anyIntersects)
                 {
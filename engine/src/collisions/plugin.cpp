@@ -1,7 +1,10 @@
 #include "interface/plugin.hpp"
 #include <cstdint>
+#include <memory>
+#include <unordered_map>
 
 #include <cubos/core/reflection/external/glm.hpp>
+#include <cubos/core/reflection/external/uuid.hpp>
 
 #include <cubos/engine/assets/plugin.hpp>
 #include <cubos/engine/collisions/plugin.hpp>
@@ -18,6 +21,26 @@ CUBOS_DEFINE_TAG(cubos::engine::collisionsTag);
 
 using namespace std;
 
+namespace
+{
+    /// @brief Resource which caches the decompositions of voxel grids into boxes, so that shapes created from the
+    /// same grid share a single decomposition.
+    ///
+    /// Entries hold neither their grid nor their decomposition alive, and are erased once no shape uses them.
+    struct VoxelDecompositionCache
+    {
+        CUBOS_ANONYMOUS_REFLECT(VoxelDecompositionCache);
+
+        struct Entry
+        {
+            cubos::engine::Asset<cubos::engine::VoxelGrid> asset{}; ///< Weak handle, with the version decomposed.
+            weak_ptr<const cubos::engine::VoxelCollisionShape::Decomposition> decomposition{};
+        };
+
+        unordered_map<uuids::uuid, Entry> entries;
+    };
+} // namespace
+
 inline void voxelGridToAABB(const cubos::engine::VoxelGrid& grid, cubos::core::geom::AABB& aabb)
 {
     glm::ivec3 size = grid.size();
@@ -192,6 +215,8 @@ void cubos::engine::collisionsPlugin(Cubos& cubos)
     cubos.plugin(broadPhaseCollisionsPlugin);
     cubos.plugin(narrowPhaseCollisionsPlugin);
 
+    cubos.resource<VoxelDecompositionCache>();
+
     cubos.tag(collisionsTag).addTo(collisionsBroadTag).addTo(collisionsNarrowTag).addTo(collisionsManifoldTag);
 
     auto initializeBoxColliders = [](Commands cmds, Query<Entity, const BoxCollisionShape&> query) {
@@ -215,30 +240,58 @@ void cubos::engine::collisionsPlugin(Cubos& cubos)
 
     cubos.observer("setup Capsule Colliders").onAdd<CapsuleCollisionShape>().call(initializeCapsuleColliders);
 
-    auto initializeVoxelColliders = [](Commands cmds, const Assets& assets, Query<Entity, VoxelCollisionShape&> query) {
+    auto initializeVoxelColliders = [](Commands cmds, const Assets& assets, VoxelDecompositionCache& cache,
+                                       Query<Entity, VoxelCollisionShape&> query) {
+        // Forget the grids which are no longer used by any shape.
+        std::erase_if(cache.entries, [](const auto& entry) { return entry.second.decomposition.expired(); });
+
         for (auto [entity, shape] : query)
         {
-            // load the voxel grid
-            const VoxelGrid& grid = assets.read(shape.grid).get();
-            // set the local AABB
-            auto colliderAABB = ColliderAABB{.margin = 0.04F};
-            voxelGridToAABB(grid, colliderAABB.localAABB);
-            cmds.add(entity, colliderAABB);
+            // The asset handle might not yet have a valid ID, and since we need getId, we load it first.
+            shape.grid = assets.load(shape.grid);
+            auto& entry = cache.entries[shape.grid.getId().value()];
 
-            glm::uvec3 size = grid.size();
-            glm::vec3 center = glm::vec3(size) / 2.0F;
-            auto boxCoords = greedy3dMeshing(grid);
-            uint32_t boxId = 1;
-
-            for (auto corners : boxCoords)
+            // Reuse the decomposition of the grid if it is still alive and the grid hasn't changed since it was built.
+            auto decomposition = entry.decomposition.lock();
+            if (decomposition == nullptr || entry.asset.isNull() || assets.update(entry.asset))
             {
-                cubos::core::geom::Box box;
-                auto boxCenter = glm::vec3(glm::ivec3(corners.first + corners.second) + glm::ivec3(1, 1, 1)) / 2.0F;
-                glm::vec3 shift = center - boxCenter;
-                box.halfSize = glm::vec3(glm::ivec3(corners.second - corners.first) + glm::ivec3(1, 1, 1)) / 2.0F;
-                shape.insertBox(box, shift, boxId);
-                boxId++;
+                // Only a weak handle is kept, so that the cache doesn't keep the grid loaded on its own.
+                entry.asset = shape.grid;
+                entry.asset.makeWeak();
+                assets.update(entry.asset); // Make sure the stored handle is up-to-date.
+
+                // load the voxel grid
+                const VoxelGrid& grid = assets.read(shape.grid).get();
+                auto newDecomposition = make_shared<VoxelCollisionShape::Decomposition>();
+                voxelGridToAABB(grid, newDecomposition->aabb);
+
+                glm::uvec3 size = grid.size();
+                glm::vec3 center = glm::vec3(size) / 2.0F;
+                auto boxCoords = greedy3dMeshing(grid);
+                uint32_t boxId = 1;
+
+                for (auto corners : boxCoords)
+                {
+                    cubos::core::geom::Box box;
+                    auto boxCenter =
+                        glm::vec3(glm::ivec3(corners.first + corners.second) + glm::ivec3(1, 1, 1)) / 2.0F;
+                    glm::vec3 shift = center - boxCenter;
+                    box.halfSize = glm::vec3(glm::ivec3(corners.second - corners.first) + glm::ivec3(1, 1, 1)) / 2.0F;
+                    newDecomposition->boxes.push_back({box, shift, boxId});
+                    boxId++;
+                }
+
+                newDecomposition->buildTree();
+                newDecomposition->storeVoxels(grid);
+                decomposition = std::move(newDecomposition);
+                entry.decomposition = decomposition;
             }
+
+            shape.setDecomposition(decomposition);
+
+            // set the local AABB
+            auto colliderAABB = ColliderAABB{.localAABB = decomposition->aabb, .margin = 0.04F};
+            cmds.add(entity, colliderAABB);
         }
     };
 
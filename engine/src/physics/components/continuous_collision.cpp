@@ -0,0 +1,12 @@
+#include <cubos/core/ecs/reflection.hpp>
+#include <cubos/core/reflection/external/primitives.hpp>
+#include <cubos/core/reflection/type.hpp>
+
+#include <cubos/engine/physics/components/continuous_collision.hpp>
+
+CUBOS_REFLECT_IMPL(cubos::engine::ContinuousCollision)
+{
+    return cubos::core::ecs::TypeBuilder<ContinuousCollision>("cubos::engine::ContinuousCollision")
+        .withField("margin", &ContinuousCollision::margin)
+        .build();
+}
@@ -0,0 +1,12 @@
+#include <cubos/core/ecs/reflection.hpp>
+#include <cubos/core/reflection/external/primitives.hpp>
+#include <cubos/core/reflection/type.hpp>
+
+#include <cubos/engine/physics/components/sleep_timer.hpp>
+
+CUBOS_REFLECT_IMPL(cubos::engine::SleepTimer)
+{
+    return cubos::core::ecs::TypeBuilder<SleepTimer>("cubos::engine::SleepTimer")
+        .withField("time", &SleepTimer::time)
+        .build();
+}
@@ -0,0 +1,9 @@
+#include <cubos/core/ecs/reflection.hpp>
+#include <cubos/core/reflection/type.hpp>
+
+#include <cubos/engine/physics/components/sleeping.hpp>
+
+CUBOS_REFLECT_IMPL(cubos::engine::Sleeping)
+{
+    return cubos::core::ecs::TypeBuilder<Sleeping>("cubos::engine::Sleeping").build();
+}
@@ -18,6 +18,7 @@ void cubos::engine::gravityPlugin(Cubos& cubos)
 
     cubos.system("apply gravity")
         .tagged(physicsApplyForcesTag)
+        .without<Sleeping>()
         .call([](Query<Velocity&, Force&, const Mass&> query, const Gravity& gravity) {
             for (auto [velocity, force, mass] : query)
             {
@@ -48,6 +48,10 @@ CUBOS_REFLECT_IMPL(SolverConstants)
         .withField("minRestitution", &SolverConstants::minRestitution)
         .withField("minNormalSpeed", &SolverConstants::minNormalSpeed)
         .withField("minNormalImpulse", &SolverConstants::minNormalImpulse)
+        .withField("sleepLinearSpeed", &SolverConstants::sleepLinearSpeed)
+        .withField("sleepAngularSpeed", &SolverConstants::sleepAngularSpeed)
+        .withField("sleepTime", &SolverConstants::sleepTime)
+        .withField("deterministic", &SolverConstants::deterministic)
         .build();
 }
 
@@ -78,6 +82,9 @@ void cubos::engine::physicsPlugin(Cubos& cubos)
     cubos.component<AccumulatedCorrection>();
     cubos.component<PhysicsMaterial>();
     cubos.component<PhysicsBundle>();
+    cubos.component<Sleeping>();
+    cubos.component<SleepTimer>();
+    cubos.component<ContinuousCollision>();
 
     cubos.observer("unpack PhysicsBundle's")
         .onAdd<PhysicsBundle>()
@@ -120,6 +127,7 @@ void cubos::engine::physicsPlugin(Cubos& cubos)
                 cmds.add(ent, angularImpulse);
                 cmds.add(ent, AccumulatedCorrection{});
                 cmds.add(ent, bundle.material);
+                cmds.add(ent, SleepTimer{});
             }
         });
 
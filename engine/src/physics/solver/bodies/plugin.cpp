@@ -0,0 +1,86 @@
+#include "plugin.hpp"
+
+#include <cubos/engine/fixed_step/plugin.hpp>
+#include <cubos/engine/physics/plugin.hpp>
+#include <cubos/engine/physics/solver/plugin.hpp>
+#include <cubos/engine/transform/plugin.hpp>
+
+#include "../../fixed_substep/plugin.hpp"
+
+using namespace cubos::engine;
+
+CUBOS_DEFINE_TAG(cubos::engine::physicsGatherBodiesTag);
+CUBOS_DEFINE_TAG(cubos::engine::physicsScatterBodiesTag);
+
+void cubos::engine::physicsSolverBodiesPlugin(Cubos& cubos)
+{
+    cubos.depends(fixedStepPlugin);
+    cubos.depends(transformPlugin);
+    cubos.depends(physicsPlugin);
+    cubos.depends(physicsSolverPlugin);
+
+    cubos.resource<SolverBodies>();
+
+    cubos.tag(physicsGatherBodiesTag).after(physicsPrepareSolveTag).before(fixedSubstepTag).tagged(fixedStepTag);
+    cubos.tag(physicsScatterBodiesTag).after(fixedSubstepTag).before(physicsFinalizePositionTag).tagged(fixedStepTag);
+
+    cubos.system("gather dynamic bodies")
+        .tagged(physicsGatherBodiesTag)
+        .without<Sleeping>()
+        .call([](Query<Entity, const Mass&, const Inertia&, Opt<const Force&>, Opt<const Torque&>, const Rotation&,
+                       const AccumulatedCorrection&, const Velocity&, const AngularVelocity&>
+                     query,
+                 SolverBodies& bodies, const SolverConstants& solverConstants) {
+            // Constraints add the static bodies they reference later, as only those need to be known.
+            bodies.clear();
+            for (auto [entity, mass, inertia, force, torque, rotation, correction, velocity, angVelocity] : query)
+            {
+                if (mass.inverseMass <= solverConstants.minInvMass)
+                {
+                    continue;
+                }
+
+                glm::vec3 forceVec{0.0F};
+                glm::vec3 torqueVec{0.0F};
+                if (force)
+                {
+                    forceVec += force->vec();
+                    torqueVec += force->torque();
+                }
+
+                if (torque)
+                {
+                    torqueVec += torque->vec();
+                }
+
+                bodies.addDynamic(entity, mass.inverseMass, inertia.inverseInertia, forceVec, torqueVec, rotation.quat,
+                                  correction.position, velocity.vec, angVelocity.vec);
+            }
+
+            if (solverConstants.deterministic)
+            {
+                bodies.sortDynamic();
+            }
+        });
+
+    cubos.system("scatter dynamic bodies")
+        .tagged(physicsScatterBodiesTag)
+        .without<Sleeping>()
+        .call([](Query<Entity, Rotation&, AccumulatedCorrection&, Velocity&, AngularVelocity&> query,
+                 const SolverBodies& bodies) {
+            for (auto [entity, rotation, correction, velocity, angVelocity] : query)
+            {
+                auto it = bodies.ids.find(entity);
+                if (it == bodies.ids.end() || bodies.isStatic(it->second))
+                {
+                    continue;
+                }
+
+                auto id = it->second;
+                rotation.quat = bodies.rotations[id];
+                correction.position = bodies.corrections[id];
+                velocity.vec = bodies.velocities[id];
+                angVelocity.vec = bodies.angularVelocities[id];
+            }
+        });
+}
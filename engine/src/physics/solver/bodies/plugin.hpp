@@ -0,0 +1,25 @@
+/// @file
+/// @brief Solver bodies plugin.
+/// @ingroup physics-solver-plugin
+
+#pragma once
+
+#include <cubos/engine/physics/solver/solver_bodies.hpp>
+#include <cubos/engine/prelude.hpp>
+
+namespace cubos::engine
+{
+    /// @ingroup physics-solver-plugin
+    /// @brief Gathers the bodies into @ref SolverBodies before the substeps, and scatters them back afterwards.
+
+    /// @brief Systems with this tag gather the state of the bodies and constraints before the substeps.
+    extern Tag physicsGatherBodiesTag;
+
+    /// @brief Systems with this tag write the state of the bodies and constraints back to their components.
+    extern Tag physicsScatterBodiesTag;
+
+    /// @brief Plugin entry function.
+    /// @param cubos @b Cubos main class
+    /// @ingroup physics-solver-plugin
+    void physicsSolverBodiesPlugin(Cubos& cubos);
+} // namespace cubos::engine
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <numeric>
+
+#include <cubos/core/ecs/reflection.hpp>
+#include <cubos/core/tel/logging.hpp>
+
+#include <cubos/engine/physics/solver/solver_bodies.hpp>
+
+using namespace cubos::engine;
+
+CUBOS_REFLECT_IMPL(SolverBodies)
+{
+    return core::ecs::TypeBuilder<SolverBodies>("cubos::engine::SolverBodies").build();
+}
+
+void SolverBodies::clear()
+{
+    entities.clear();
+    inverseMasses.clear();
+    inverseInertias.clear();
+    forces.clear();
+    torques.clear();
+    rotations.clear();
+    corrections.clear();
+    velocities.clear();
+    angularVelocities.clear();
+    dynamicCount = 0;
+    ids.clear();
+}
+
+uint32_t SolverBodies::addDynamic(core::ecs::Entity entity, float inverseMass, const glm::mat3& inverseInertia,
+                                  const glm::vec3& force, const glm::vec3& torque, const glm::quat& rotation,
+                                  const glm::vec3& correction, const glm::vec3& velocity,
+                                  const glm::vec3& angularVelocity)
+{
+    CUBOS_ASSERT(entities.size() == dynamicCount, "Dynamic bodies must be added before static bodies");
+    CUBOS_ASSERT(!ids.contains(entity), "Body was already added");
+
+    auto id = static_cast<uint32_t>(entities.size());
+    ids.emplace(entity, id);
+    entities.push_back(entity);
+    inverseMasses.push_back(inverseMass);
+    inverseInertias.push_back(inverseInertia);
+    forces.push_back(force);
+    torques.push_back(torque);
+    rotations.push_back(rotation);
+    corrections.push_back(correction);
+    velocities.push_back(velocity);
+    angularVelocities.push_back(angularVelocity);
+    dynamicCount += 1;
+    return id;
+}
+
+uint32_t SolverBodies::findOrAddStatic(core::ecs::Entity entity, const glm::quat& rotation,
+                                       const glm::vec3& correction, const glm::vec3& velocity,
+                                       const glm::vec3& angularVelocity)
+{
+    auto [it, inserted] = ids.emplace(entity, static_cast<uint32_t>(entities.size()));
+    if (!inserted)
+    {
+        return it->second;
+    }
+
+    entities.push_back(entity);
+    inverseMasses.push_back(0.0F);
+    inverseInertias.emplace_back(0.0F);
+    forces.emplace_back(0.0F);
+    torques.emplace_back(0.0F);
+    rotations.push_back(rotation);
+    corrections.push_back(correction);
+    velocities.push_back(velocity);
+    angularVelocities.push_back(angularVelocity);
+    return it->second;
+}
+
+/// @brief Reorders the first elements of a vector according to the given permutation.
+/// @tparam T Element type.
+/// @param values Values.
+/// @param order Index of the value which goes into each position.
+template <typename T>
+static void permute(std::vector<T>& values, const std::vector<uint32_t>& order)
+{
+    std::vector<T> permuted;
+    permuted.reserve(order.size());
+    for (auto index : order)
+    {
+        permuted.push_back(values[index]);
+    }
+    std::copy(permuted.begin(), permuted.end(), values.begin());
+}
+
+void SolverBodies::sortDynamic()
+{
+    CUBOS_ASSERT(entities.size() == dynamicCount, "Dynamic bodies must be sorted before static bodies are added");
+
+    std::vector<uint32_t> order(dynamicCount);
+    std::iota(order.begin(), order.end(), 0U);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return key(entities[a]) < key(entities[b]); });
+
+    permute(entities, order);
+    permute(inverseMasses, order);
+    permute(inverseInertias, order);
+    permute(forces, order);
+    permute(torques, order);
+    permute(rotations, order);
+    permute(corrections, order);
+    permute(velocities, order);
+    permute(angularVelocities, order);
+
+    for (uint32_t id = 0; id < dynamicCount; ++id)
+    {
+        ids[entities[id]] = id;
+    }
+}
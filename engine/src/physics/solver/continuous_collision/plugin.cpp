@@ -0,0 +1,95 @@
+#include "plugin.hpp"
+#include <limits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <cubos/engine/collisions/collider_aabb.hpp>
+#include <cubos/engine/collisions/collision_mask.hpp>
+#include <cubos/engine/collisions/plugin.hpp>
+#include <cubos/engine/collisions/raycast.hpp>
+#include <cubos/engine/fixed_step/plugin.hpp>
+#include <cubos/engine/physics/plugin.hpp>
+#include <cubos/engine/physics/solver/plugin.hpp>
+
+#include "../../../collisions/broad_phase/sweep_and_prune.hpp"
+#include "../bodies/plugin.hpp"
+
+using namespace cubos::engine;
+
+CUBOS_DEFINE_TAG(cubos::engine::physicsContinuousCollisionTag);
+
+void cubos::engine::physicsContinuousCollisionPlugin(Cubos& cubos)
+{
+    cubos.depends(fixedStepPlugin);
+    cubos.depends(collisionsPlugin);
+    cubos.depends(physicsPlugin);
+    cubos.depends(physicsSolverPlugin);
+
+    cubos.tag(physicsContinuousCollisionTag)
+        .after(physicsScatterBodiesTag)
+        .before(physicsFinalizePositionTag)
+        .tagged(fixedStepTag);
+
+    cubos.system("clamp motion of fast bodies")
+        .tagged(physicsContinuousCollisionTag)
+        .without<Sleeping>()
+        .call([](Query<Entity, const ContinuousCollision&, const ColliderAABB&, Opt<const CollisionMask&>,
+                       AccumulatedCorrection&, Velocity&>
+                     query,
+                 const BroadPhaseSweepAndPrune& sweepAndPrune, Raycast raycast) {
+            std::vector<Entity> candidates;
+            for (auto [entity, continuousCollision, colliderAABB, mask, correction, velocity] : query)
+            {
+                // Bodies without a mask never collide with anything.
+                float distance = glm::length(correction.position);
+                if (!mask || distance == 0.0F)
+                {
+                    continue;
+                }
+
+                // The collider AABB was updated at the start of the step, before the body moved.
+                const auto& aabb = colliderAABB.worldAABB;
+                glm::vec3 direction = correction.position / distance;
+                float extent = glm::dot(glm::abs(direction), (aabb.max() - aabb.min()) / 2.0F);
+                if (distance <= extent)
+                {
+                    // Slow enough for the discrete narrow phase to catch anything in the way.
+                    continue;
+                }
+
+                // Only colliders overlapping the bounds swept by the body may be in the way. The broad phase already
+                // knows the bounds of every collider, so ask it instead of building a hierarchy over all of them.
+                core::geom::AABB swept{};
+                swept.min(glm::min(aabb.min(), aabb.min() + correction.position));
+                swept.max(glm::max(aabb.max(), aabb.max() + correction.position));
+                sweepAndPrune.overlapping(swept, mask->value, candidates);
+
+                auto origin = aabb.center();
+                float closest = std::numeric_limits<float>::infinity();
+                for (auto candidate : candidates)
+                {
+                    auto hit = raycast.fire(
+                        {.origin = origin, .direction = direction, .mask = mask->value, .ignored = entity}, candidate);
+                    if (hit)
+                    {
+                        closest = glm::min(closest, glm::distance(origin, hit->point));
+                    }
+                }
+
+                float allowed = closest - extent + continuousCollision.margin;
+                if (allowed < distance)
+                {
+                    // Slow the body down along its motion by as much, or it would tunnel on the next step, before the
+                    // contact is resolved.
+                    float ratio = glm::max(allowed, 0.0F) / distance;
+                    float speed = glm::dot(velocity.vec, direction);
+                    if (speed > 0.0F)
+                    {
+                        velocity.vec -= direction * speed * (1.0F - ratio);
+                    }
+                    correction.position = direction * glm::max(allowed, 0.0F);
+                }
+            }
+        });
+}
@@ -0,0 +1,22 @@
+/// @file
+/// @brief Continuous collision plugin.
+/// @ingroup physics-solver-plugin
+
+#pragma once
+
+#include <cubos/engine/prelude.hpp>
+
+namespace cubos::engine
+{
+    /// @ingroup physics-solver-plugin
+    /// @brief Clamps the motion of fast bodies with @ref ContinuousCollision so that they don't tunnel through thin
+    /// colliders.
+
+    /// @brief Systems with this tag clamp the motion of bodies after the substeps, before their positions are updated.
+    extern Tag physicsContinuousCollisionTag;
+
+    /// @brief Plugin entry function.
+    /// @param cubos @b Cubos main class
+    /// @ingroup physics-solver-plugin
+    void physicsContinuousCollisionPlugin(Cubos& cubos);
+} // namespace cubos::engine
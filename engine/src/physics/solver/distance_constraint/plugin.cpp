@@ -1,5 +1,9 @@
 #include "plugin.hpp"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include <glm/glm.hpp>
 
 #include <cubos/engine/fixed_step/plugin.hpp>
@@ -8,6 +12,8 @@
 #include <cubos/engine/transform/plugin.hpp>
 
 #include "../../fixed_substep/plugin.hpp"
+#include "../bodies/plugin.hpp"
+#include "../islands.hpp"
 
 using namespace cubos::engine;
 
@@ -15,125 +21,173 @@ CUBOS_DEFINE_TAG(cubos::engine::distanceConstraintWarmStartTag);
 CUBOS_DEFINE_TAG(cubos::engine::distanceConstraintSolveTag);
 CUBOS_DEFINE_TAG(cubos::engine::distanceConstraintCleanTag);
 
-static void solveDistanceConstraint(
-    Query<Entity, const Mass&, const Inertia&, const Rotation&, AccumulatedCorrection&, Velocity&, AngularVelocity&,
-          DistanceConstraint&, Entity, const Mass&, const Inertia&, const Rotation&, AccumulatedCorrection&, Velocity&,
-          AngularVelocity&>
-        query,
-    const SolverConstants& solverConstants, const FixedDeltaTime& dt, const Substeps& substeps, const bool useBias)
+namespace
+{
+    /// @brief Distance constraint between a pair of bodies.
+    struct SolverDistance
+    {
+        uint32_t body1;                ///< Identifier of the first body in @ref SolverBodies.
+        uint32_t body2;                ///< Identifier of the second body in @ref SolverBodies.
+        Entity entity1;                ///< First entity, as matched by the relation query.
+        Entity entity2;                ///< Second entity, as matched by the relation query.
+        DistanceConstraint constraint; ///< Constraint between the bodies.
+    };
+
+    /// @brief Resource which holds the distance constraints being solved during a fixed step.
+    ///
+    /// Copied from the @ref DistanceConstraint relations once before the substeps, and written back once they end,
+    /// so that the islands only have to be found once per step.
+    struct SolverDistances
+    {
+        CUBOS_ANONYMOUS_REFLECT(SolverDistances);
+
+        std::vector<SolverDistance> distances;
+        ConstraintIslands islands;
+    };
+} // namespace
+
+/// @brief Applies an impulse to the dynamic bodies of a constraint.
+///
+/// Static bodies may be shared by constraints in different islands, and thus must not be written to while solving.
+///
+/// @param bodies Solver bodies.
+/// @param distance Constraint.
+/// @param r1 Anchor of the first body, relative to its center of mass.
+/// @param r2 Anchor of the second body, relative to its center of mass.
+/// @param p Impulse, applied positively to the second body and negatively to the first.
+static void applyImpulse(SolverBodies& bodies, const SolverDistance& distance, const glm::vec3& r1,
+                         const glm::vec3& r2, const glm::vec3& p)
 {
-    float subDeltaTime = dt.value / (float)substeps.value;
-    for (auto [ent1, mass1, inertia1, rotation1, correction1, velocity1, angVelocity1, constraint, ent2, mass2,
-               inertia2, rotation2, correction2, velocity2, angVelocity2] : query)
+    if (!bodies.isStatic(distance.body1))
     {
-        glm::vec3 r1 = rotation1.quat * constraint.localAnchor1;
-        glm::vec3 r2 = rotation2.quat * constraint.localAnchor2;
+        bodies.velocities[distance.body1] -= bodies.inverseMasses[distance.body1] * p;
+        bodies.angularVelocities[distance.body1] -= bodies.inverseInertias[distance.body1] * glm::cross(r1, p);
+    }
+
+    if (!bodies.isStatic(distance.body2))
+    {
+        bodies.velocities[distance.body2] += bodies.inverseMasses[distance.body2] * p;
+        bodies.angularVelocities[distance.body2] += bodies.inverseInertias[distance.body2] * glm::cross(r2, p);
+    }
+}
+
+static void solveDistanceConstraint(SolverBodies& bodies, SolverDistance& distance,
+                                    const SolverConstants& solverConstants, float subDeltaTime, const bool useBias)
+{
+    auto& constraint = distance.constraint;
+    const auto& velocity1 = bodies.velocities[distance.body1];
+    const auto& velocity2 = bodies.velocities[distance.body2];
+    const auto& angVelocity1 = bodies.angularVelocities[distance.body1];
+    const auto& angVelocity2 = bodies.angularVelocities[distance.body2];
 
-        glm::vec3 ds = correction2.position - correction1.position + r2 - r1;
-        glm::vec3 separation = constraint.deltaCenter + ds;
+    glm::vec3 r1 = bodies.rotations[distance.body1] * constraint.localAnchor1;
+    glm::vec3 r2 = bodies.rotations[distance.body2] * constraint.localAnchor2;
 
-        float length = glm::length(separation);
-        glm::vec3 axis = glm::normalize(separation);
+    glm::vec3 ds = bodies.corrections[distance.body2] - bodies.corrections[distance.body1] + r2 - r1;
+    glm::vec3 separation = constraint.deltaCenter + ds;
 
-        glm::vec3 vr =
-            (velocity2.vec + glm::cross(angVelocity2.vec, r2)) - (velocity1.vec + glm::cross(angVelocity1.vec, r1));
-        float cdot = glm::dot(vr, axis);
+    float length = glm::length(separation);
+    glm::vec3 axis = glm::normalize(separation);
 
-        if (constraint.isRigid)
+    glm::vec3 vr = (velocity2 + glm::cross(angVelocity2, r2)) - (velocity1 + glm::cross(angVelocity1, r1));
+    float cdot = glm::dot(vr, axis);
+
+    if (constraint.isRigid)
+    {
+        float c = length - constraint.fixedDistance;
+
+        /// TODO: check correctness of bias
+        float bias = 0.0F;
+        float massScale = 1.0F;
+        float impulseScale = 0.0F;
+        if (useBias)
         {
-            float c = length - constraint.fixedDistance;
+            bias = glm::max(constraint.biasCoefficient * c, solverConstants.maxBias);
+            massScale = constraint.massCoefficient;
+            impulseScale = constraint.impulseCoefficient;
+        }
+
+        float impulse = -massScale * constraint.axialMass * (cdot + bias) - impulseScale * constraint.impulse;
+        constraint.impulse += impulse;
+
+        applyImpulse(bodies, distance, r1, r2, impulse * axis);
+    }
+    else
+    {
+        if (constraint.minDistance > 0.0F)
+        {
+            float c = length - constraint.minDistance;
 
-            /// TODO: check correctness of bias
             float bias = 0.0F;
-            float massScale = 1.0F;
-            float impulseScale = 0.0F;
-            if (useBias)
+            float massCoeff = 1.0F;
+            float impulseCoeff = 0.0F;
+            if (c > 0.0F)
+            {
+                // speculative
+                bias = c * (1.0F / subDeltaTime);
+            }
+            else if (useBias)
             {
                 bias = glm::max(constraint.biasCoefficient * c, solverConstants.maxBias);
-                massScale = constraint.massCoefficient;
-                impulseScale = constraint.impulseCoefficient;
+                massCoeff = constraint.massCoefficient;
+                impulseCoeff = constraint.impulseCoefficient;
             }
+            float impulse = -massCoeff * constraint.axialMass * (cdot + bias) - impulseCoeff * constraint.lowerImpulse;
+            float newImpulse = std::max(0.0F, constraint.lowerImpulse + impulse);
+            impulse = newImpulse - constraint.lowerImpulse;
+            constraint.lowerImpulse = newImpulse;
 
-            float impulse = -massScale * constraint.axialMass * (cdot + bias) - impulseScale * constraint.impulse;
-            constraint.impulse += impulse;
-
-            glm::vec3 p = impulse * axis;
-            velocity1.vec -= mass1.inverseMass * p;
-            velocity2.vec += mass2.inverseMass * p;
-            angVelocity1.vec -= inertia1.inverseInertia * glm::cross(r1, p);
-            angVelocity2.vec += inertia2.inverseInertia * glm::cross(r2, p);
+            applyImpulse(bodies, distance, r1, r2, impulse * axis);
         }
-        else
+
+        if (constraint.maxDistance > 0.0F)
         {
-            if (constraint.minDistance > 0.0F)
-            {
-                float c = length - constraint.minDistance;
+            float c = constraint.maxDistance - length;
 
-                float bias = 0.0F;
-                float massCoeff = 1.0F;
-                float impulseCoeff = 0.0F;
-                if (c > 0.0F)
-                {
-                    // speculative
-                    bias = c * (1.0F / subDeltaTime);
-                }
-                else if (useBias)
-                {
-                    bias = glm::max(constraint.biasCoefficient * c, solverConstants.maxBias);
-                    massCoeff = constraint.massCoefficient;
-                    impulseCoeff = constraint.impulseCoefficient;
-                }
-                float impulse =
-                    -massCoeff * constraint.axialMass * (cdot + bias) - impulseCoeff * constraint.lowerImpulse;
-                float newImpulse = std::max(0.0F, constraint.lowerImpulse + impulse);
-                impulse = newImpulse - constraint.lowerImpulse;
-                constraint.lowerImpulse = newImpulse;
-
-                glm::vec3 p = impulse * axis;
-                velocity1.vec -= mass1.inverseMass * p;
-                velocity2.vec += mass2.inverseMass * p;
-                angVelocity1.vec -= inertia1.inverseInertia * glm::cross(r1, p);
-                angVelocity2.vec += inertia2.inverseInertia * glm::cross(r2, p);
-            }
+            glm::vec3 vr = (velocity1 + glm::cross(angVelocity1, r1)) - (velocity2 + glm::cross(angVelocity2, r2));
+            float cdot = glm::dot(vr, axis);
 
-            if (constraint.maxDistance > 0.0F)
+            float bias = 0.0F;
+            float massCoeff = 1.0F;
+            float impulseCoeff = 0.0F;
+            if (c > 0.0F)
             {
-                float c = constraint.maxDistance - length;
-
-                glm::vec3 vr = (velocity1.vec + glm::cross(angVelocity1.vec, r1)) -
-                               (velocity2.vec + glm::cross(angVelocity2.vec, r2));
-                float cdot = glm::dot(vr, axis);
-
-                float bias = 0.0F;
-                float massCoeff = 1.0F;
-                float impulseCoeff = 0.0F;
-                if (c > 0.0F)
-                {
-                    // speculative
-                    bias = c * (1.0F / subDeltaTime);
-                }
-                else if (useBias)
-                {
-                    bias = glm::max(constraint.biasCoefficient * c, solverConstants.maxBias);
-                    massCoeff = constraint.massCoefficient;
-                    impulseCoeff = constraint.impulseCoefficient;
-                }
-                float impulse =
-                    -massCoeff * constraint.axialMass * (cdot + bias) - impulseCoeff * constraint.upperImpulse;
-                float newImpulse = std::max(0.0F, constraint.upperImpulse + impulse);
-                impulse = newImpulse - constraint.upperImpulse;
-                constraint.upperImpulse = newImpulse;
-
-                glm::vec3 p = -impulse * axis;
-                velocity1.vec -= mass1.inverseMass * p;
-                velocity2.vec += mass2.inverseMass * p;
-                angVelocity1.vec -= inertia1.inverseInertia * glm::cross(r1, p);
-                angVelocity2.vec += inertia2.inverseInertia * glm::cross(r2, p);
+                // speculative
+                bias = c * (1.0F / subDeltaTime);
             }
+            else if (useBias)
+            {
+                bias = glm::max(constraint.biasCoefficient * c, solverConstants.maxBias);
+                massCoeff = constraint.massCoefficient;
+                impulseCoeff = constraint.impulseCoefficient;
+            }
+            float impulse = -massCoeff * constraint.axialMass * (cdot + bias) - impulseCoeff * constraint.upperImpulse;
+            float newImpulse = std::max(0.0F, constraint.upperImpulse + impulse);
+            impulse = newImpulse - constraint.upperImpulse;
+            constraint.upperImpulse = newImpulse;
+
+            applyImpulse(bodies, distance, r1, r2, -impulse * axis);
         }
     }
 }
 
+static void warmStartDistanceConstraint(SolverBodies& bodies, const SolverDistance& distance)
+{
+    const auto& constraint = distance.constraint;
+
+    glm::vec3 r1 = bodies.rotations[distance.body1] * constraint.localAnchor1;
+    glm::vec3 r2 = bodies.rotations[distance.body2] * constraint.localAnchor2;
+
+    glm::vec3 ds = bodies.corrections[distance.body2] - bodies.corrections[distance.body1] + r2 - r1;
+    glm::vec3 separation = constraint.deltaCenter + ds;
+
+    glm::vec3 axis = glm::normalize(separation);
+
+    float axialImpulse = constraint.impulse + constraint.lowerImpulse - constraint.upperImpulse;
+
+    applyImpulse(bodies, distance, r1, r2, axialImpulse * axis);
+}
+
 void cubos::engine::distanceConstraintPlugin(Cubos& cubos)
 {
     cubos.depends(fixedStepPlugin);
@@ -147,37 +201,108 @@ void cubos::engine::distanceConstraintPlugin(Cubos& cubos)
     cubos.tag(distanceConstraintSolveTag);
     cubos.tag(distanceConstraintCleanTag);
 
+    cubos.resource<SolverDistances>();
+
+    cubos.system("gather distance constraints")
+        .after(physicsGatherBodiesTag)
+        .before(fixedSubstepTag)
+        .tagged(fixedStepTag)
+        .call([](Query<Entity, const Rotation&, const AccumulatedCorrection&, const Velocity&,
+                       const AngularVelocity&, Opt<const Sleeping&>, const DistanceConstraint&, Entity,
+                       const Rotation&, const AccumulatedCorrection&, const Velocity&, const AngularVelocity&,
+                       Opt<const Sleeping&>>
+                     query,
+                 SolverBodies& bodies, const SolverConstants& solverConstants, SolverDistances& distances) {
+            distances.distances.clear();
+            distances.islands.clear();
+            for (auto [ent1, rotation1, correction1, velocity1, angVelocity1, sleeping1, constraint, ent2, rotation2,
+                       correction2, velocity2, angVelocity2, sleeping2] : query)
+            {
+                if (sleeping1 && sleeping2)
+                {
+                    continue;
+                }
+
+                // Bodies which weren't gathered as dynamic are static or asleep, and are added as static bodies.
+                auto body1 = bodies.findOrAddStatic(ent1, rotation1.quat, correction1.position, velocity1.vec,
+                                                    angVelocity1.vec);
+                auto body2 = bodies.findOrAddStatic(ent2, rotation2.quat, correction2.position, velocity2.vec,
+                                                    angVelocity2.vec);
+                if (bodies.isStatic(body1) && bodies.isStatic(body2))
+                {
+                    continue;
+                }
+
+                distances.distances.push_back(SolverDistance{
+                    .body1 = body1, .body2 = body2, .entity1 = ent1, .entity2 = ent2, .constraint = constraint});
+            }
+
+            // Query order depends on the order in which the relations were created, which isn't deterministic.
+            if (solverConstants.deterministic)
+            {
+                std::sort(distances.distances.begin(), distances.distances.end(), [](const auto& a, const auto& b) {
+                    return std::pair{SolverBodies::key(a.entity1), SolverBodies::key(a.entity2)} <
+                           std::pair{SolverBodies::key(b.entity1), SolverBodies::key(b.entity2)};
+                });
+            }
+
+            for (const auto& distance : distances.distances)
+            {
+                distances.islands.add(bodies.isStatic(distance.body1) ? ConstraintIslands::Static : distance.body1,
+                                      bodies.isStatic(distance.body2) ? ConstraintIslands::Static : distance.body2);
+            }
+            distances.islands.build();
+        });
+
     cubos.system("solve distance constraints bias")
         .tagged(distanceConstraintSolveTag)
         .tagged(physicsSolveConstraintTag)
-        .call([](Query<Entity, const Mass&, const Inertia&, const Rotation&, AccumulatedCorrection&, Velocity&,
-                       AngularVelocity&, DistanceConstraint&, Entity, const Mass&, const Inertia&, const Rotation&,
-                       AccumulatedCorrection&, Velocity&, AngularVelocity&>
-                     query,
-                 const SolverConstants& solverConstants, const FixedDeltaTime& dt,
-                 const Substeps& substeps) { solveDistanceConstraint(query, solverConstants, dt, substeps, true); });
+        .call([](SolverBodies& bodies, SolverDistances& distances, const SolverConstants& solverConstants,
+                 const FixedDeltaTime& dt, const Substeps& substeps, Parallel parallel) {
+            float subDeltaTime = dt.value / (float)substeps.value;
+            distances.islands.forEach(parallel, [&](std::size_t i) {
+                solveDistanceConstraint(bodies, distances.distances[i], solverConstants, subDeltaTime, true);
+            });
+        });
 
     cubos.system("solve distance constraints no bias")
         .tagged(physicsSolveRelaxConstraintTag)
-        .call([](Query<Entity, const Mass&, const Inertia&, const Rotation&, AccumulatedCorrection&, Velocity&,
-                       AngularVelocity&, DistanceConstraint&, Entity, const Mass&, const Inertia&, const Rotation&,
-                       AccumulatedCorrection&, Velocity&, AngularVelocity&>
-                     query,
-                 const SolverConstants& solverConstants, const FixedDeltaTime& dt,
-                 const Substeps& substeps) { solveDistanceConstraint(query, solverConstants, dt, substeps, false); });
+        .call([](SolverBodies& bodies, SolverDistances& distances, const SolverConstants& solverConstants,
+                 const FixedDeltaTime& dt, const Substeps& substeps, Parallel parallel) {
+            float subDeltaTime = dt.value / (float)substeps.value;
+            distances.islands.forEach(parallel, [&](std::size_t i) {
+                solveDistanceConstraint(bodies, distances.distances[i], solverConstants, subDeltaTime, false);
+            });
+        });
+
+    cubos.system("scatter distance constraints")
+        .tagged(physicsScatterBodiesTag)
+        .call([](Query<Entity, DistanceConstraint&, Entity> query, const SolverDistances& distances) {
+            for (const auto& distance : distances.distances)
+            {
+                if (auto match = query.at(distance.entity1, distance.entity2))
+                {
+                    auto [ent1, constraint, ent2] = *match;
+                    constraint.impulse = distance.constraint.impulse;
+                    constraint.lowerImpulse = distance.constraint.lowerImpulse;
+                    constraint.upperImpulse = distance.constraint.upperImpulse;
+                }
+            }
+        });
 
     cubos.system("prepare constraints")
         .tagged(physicsPrepareSolveTag)
         .call([](Query<Entity, const Mass&, const Inertia&, const CenterOfMass&, const LocalToWorld&, const Rotation&,
-                       const Velocity&, const AngularVelocity&, const PhysicsMaterial&, DistanceConstraint&, Entity,
-                       const Mass&, const Inertia&, const CenterOfMass&, const LocalToWorld&, const Rotation&,
-                       const Velocity&, const AngularVelocity&, const PhysicsMaterial&>
+                       const Velocity&, const AngularVelocity&, const PhysicsMaterial&, Opt<const Sleeping&>,
+                       DistanceConstraint&, Entity, const Mass&, const Inertia&, const CenterOfMass&,
+                       const LocalToWorld&, const Rotation&, const Velocity&, const AngularVelocity&,
+                       const PhysicsMaterial&, Opt<const Sleeping&>>
                      query,
                  const FixedDeltaTime& fixedDeltaTime, const Substeps& substeps,
                  const SolverConstants& solverConstants) {
             for (auto [ent1, mass1, inertia1, centerOfMass1, localToWorld1, rotation1, correction1, velocity1,
-                       angVelocity1, constraint, ent2, mass2, inertia2, centerOfMass2, localToWorld2, rotation2,
-                       correction2, velocity2, angVelocity2] : query)
+                       angVelocity1, sleeping1, constraint, ent2, mass2, inertia2, centerOfMass2, localToWorld2,
+                       rotation2, correction2, velocity2, angVelocity2, sleeping2] : query)
             {
 
                 float subDeltaTime = fixedDeltaTime.value / (float)substeps.value;
@@ -192,8 +317,14 @@ void cubos::engine::distanceConstraintPlugin(Cubos& cubos)
                 glm::vec3 cross1 = glm::cross(r1, axis);
                 glm::vec3 cross2 = glm::cross(r2, axis);
 
-                float k = (mass1.inverseMass + mass2.inverseMass) + glm::dot(inertia1.inverseInertia * cross1, cross1) +
-                          glm::dot(inertia2.inverseInertia * cross2, cross2);
+                // Sleeping bodies are treated as static by the solver, and thus don't take any of the impulses.
+                float inverseMass1 = sleeping1 ? 0.0F : mass1.inverseMass;
+                float inverseMass2 = sleeping2 ? 0.0F : mass2.inverseMass;
+                glm::mat3 inverseInertia1 = sleeping1 ? glm::mat3(0.0F) : inertia1.inverseInertia;
+                glm::mat3 inverseInertia2 = sleeping2 ? glm::mat3(0.0F) : inertia2.inverseInertia;
+
+                float k = (inverseMass1 + inverseMass2) + glm::dot(inverseInertia1 * cross1, cross1) +
+                          glm::dot(inverseInertia2 * cross2, cross2);
 
                 constraint.axialMass = (k > solverConstants.minKNormal) ? 1 / k : solverConstants.minKNormal;
                 constraint.impulse = 0.0F;
@@ -220,29 +351,8 @@ void cubos::engine::distanceConstraintPlugin(Cubos& cubos)
         .after(physicsPrepareSolveTag)
         .before(distanceConstraintSolveTag)
         .tagged(fixedSubstepTag)
-        .call([](Query<Entity, const Mass&, const Inertia&, const Rotation&, AccumulatedCorrection&, Velocity&,
-                       AngularVelocity&, DistanceConstraint&, Entity, const Mass&, const Inertia&, const Rotation&,
-                       AccumulatedCorrection&, Velocity&, AngularVelocity&>
-                     query) {
-            for (auto [ent1, mass1, inertia1, rotation1, correction1, velocity1, angVelocity1, constraint, ent2, mass2,
-                       inertia2, rotation2, correction2, velocity2, angVelocity2] : query)
-            {
-                glm::vec3 r1 = rotation1.quat * constraint.localAnchor1;
-                glm::vec3 r2 = rotation2.quat * constraint.localAnchor2;
-
-                glm::vec3 ds = correction2.position - correction1.position + r2 - r1;
-                glm::vec3 separation = constraint.deltaCenter + ds;
-
-                glm::vec3 axis = glm::normalize(separation);
-
-                float axialImpulse = constraint.impulse + constraint.lowerImpulse - constraint.upperImpulse;
-
-                glm::vec3 p = axialImpulse * axis;
-
-                velocity1.vec -= mass1.inverseMass * p;
-                velocity2.vec += mass2.inverseMass * p;
-                angVelocity1.vec -= inertia1.inverseInertia * glm::cross(r1, p);
-                angVelocity2.vec += inertia2.inverseInertia * glm::cross(r2, p);
-            }
+        .call([](SolverBodies& bodies, SolverDistances& distances, Parallel parallel) {
+            distances.islands.forEach(
+                parallel, [&](std::size_t i) { warmStartDistanceConstraint(bodies, distances.distances[i]); });
         });
 }
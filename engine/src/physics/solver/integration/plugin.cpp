@@ -9,6 +9,7 @@
 #include <cubos/engine/transform/plugin.hpp>
 
 #include "../../fixed_substep/plugin.hpp"
+#include "../bodies/plugin.hpp"
 
 using namespace cubos::engine;
 
@@ -22,7 +23,7 @@ void cubos::engine::physicsIntegrationPlugin(Cubos& cubos)
     cubos.depends(physicsPlugin);
     cubos.depends(physicsSolverPlugin);
 
-    cubos.tag(physicsApplyImpulsesTag);
+    cubos.tag(physicsApplyImpulsesTag).before(physicsGatherBodiesTag);
     cubos.tag(physicsClearForcesTag).after(physicsFinalizePositionTag).tagged(fixedStepTag);
 
     cubos.system("apply impulses")
@@ -30,6 +31,7 @@ void cubos::engine::physicsIntegrationPlugin(Cubos& cubos)
         .after(physicsApplyForcesTag)
         .before(physicsIntegrateVelocityTag)
         .tagged(fixedStepTag)
+        .without<Sleeping>()
         .call([](Query<Velocity&, const Impulse&, const Mass&> query) {
             for (auto [velocity, impulse, mass] : query)
             {
@@ -42,6 +44,7 @@ void cubos::engine::physicsIntegrationPlugin(Cubos& cubos)
         .after(physicsApplyForcesTag)
         .before(physicsIntegrateVelocityTag)
         .tagged(fixedStepTag)
+        .without<Sleeping>()
         .call([](Query<AngularVelocity&, const AngularImpulse&, const Inertia&, const Rotation&> query) {
             for (auto [angVelocity, angImpulse, inertia, rotation] : query)
             {
@@ -51,81 +54,70 @@ void cubos::engine::physicsIntegrationPlugin(Cubos& cubos)
 
     cubos.system("integrate velocity")
         .tagged(physicsIntegrateVelocityTag)
-        .call([](Query<Velocity&, AngularVelocity&, const Force&, const Torque&, const Mass&, const Inertia&,
-                       const Rotation&>
-                     query,
-                 const Damping& damping, const FixedDeltaTime& fixedDeltaTime, const Substeps& substeps,
-                 const SolverConstants& solverConstants) {
+        .call([](SolverBodies& bodies, const Damping& damping, const FixedDeltaTime& fixedDeltaTime,
+                 const Substeps& substeps, const SolverConstants& solverConstants, Parallel parallel) {
             float subDeltaTime = fixedDeltaTime.value / (float)substeps.value;
 
-            for (auto [velocity, angVelocity, force, torque, mass, inertia, rotation] : query)
-            {
+            bodies.forEachDynamic(parallel, [&](uint32_t id) {
                 // Linear velocity
-                if (mass.inverseMass <= solverConstants.minInvMass)
-                {
-                    continue;
-                }
+                auto& velocity = bodies.velocities[id];
+                auto& angVelocity = bodies.angularVelocities[id];
 
                 // Apply damping
-                velocity.vec *= glm::pow(damping.value, subDeltaTime);
+                velocity *= glm::pow(damping.value, subDeltaTime);
 
                 // Apply external forces
-                glm::vec3 deltaLinearVelocity = force.vec() * mass.inverseMass * subDeltaTime;
+                glm::vec3 deltaLinearVelocity = bodies.forces[id] * bodies.inverseMasses[id] * subDeltaTime;
 
-                velocity.vec += deltaLinearVelocity;
+                velocity += deltaLinearVelocity;
 
                 // Angular velocity
-                if (inertia.inverseInertia == solverConstants.minInvInertia)
+                if (bodies.inverseInertias[id] == solverConstants.minInvInertia)
                 {
-                    continue;
+                    return;
                 }
 
                 // Apply damping
-                angVelocity.vec *= glm::pow(damping.value, subDeltaTime);
+                angVelocity *= glm::pow(damping.value, subDeltaTime);
 
                 // Rotate inertia tensor
-                glm::mat3 rotatedInverseInertia = inertia.rotatedInverseInertia(rotation.quat);
+                auto rotationMat = glm::mat3(bodies.rotations[id]);
+                glm::mat3 rotatedInverseInertia =
+                    rotationMat * bodies.inverseInertias[id] * glm::transpose(rotationMat);
 
                 // Apply external torque
-                glm::vec3 deltaAngularVelocity = rotatedInverseInertia * (force.torque() + torque.vec()) * subDeltaTime;
+                glm::vec3 deltaAngularVelocity = rotatedInverseInertia * bodies.torques[id] * subDeltaTime;
 
-                angVelocity.vec += deltaAngularVelocity;
-            }
+                angVelocity += deltaAngularVelocity;
+            });
         });
 
     cubos.system("integrate delta position")
         .tagged(physicsIntegratePositionTag)
-        .call([](Query<AccumulatedCorrection&, Rotation&, const Velocity&, const AngularVelocity&, const Mass&,
-                       const Inertia&>
-                     query,
-                 const FixedDeltaTime& fixedDeltaTime, const Substeps& substeps,
-                 const SolverConstants& solverConstants) {
+        .call([](SolverBodies& bodies, const FixedDeltaTime& fixedDeltaTime, const Substeps& substeps,
+                 const SolverConstants& solverConstants, Parallel parallel) {
             float subDeltaTime = fixedDeltaTime.value / (float)substeps.value;
 
-            for (auto [correction, rotation, velocity, angVelocity, mass, inertia] : query)
-            {
+            bodies.forEachDynamic(parallel, [&](uint32_t id) {
                 // Position
-                if (mass.inverseMass <= solverConstants.minInvMass)
-                {
-                    continue;
-                }
-
-                correction.position += velocity.vec * subDeltaTime;
+                bodies.corrections[id] += bodies.velocities[id] * subDeltaTime;
 
                 // Rotation
-                if (inertia.inverseInertia == solverConstants.minInvInertia)
+                if (bodies.inverseInertias[id] == solverConstants.minInvInertia)
                 {
-                    continue;
+                    return;
                 }
 
-                rotation.quat =
-                    glm::normalize(rotation.quat +
-                                   (glm::quat(glm::vec4(angVelocity.vec * subDeltaTime * 0.5F, 0.0F)) * rotation.quat));
-            }
+                auto& rotation = bodies.rotations[id];
+                const auto& angVelocity = bodies.angularVelocities[id];
+                glm::quat deltaRotation = glm::quat(glm::vec4(angVelocity * subDeltaTime * 0.5F, 0.0F)) * rotation;
+                rotation = glm::normalize(rotation + deltaRotation);
+            });
         });
 
     cubos.system("finalize position")
         .tagged(physicsFinalizePositionTag)
+        .without<Sleeping>()
         .call([](Query<Position&, AccumulatedCorrection&, const Mass&> query, const SolverConstants& solverConstants) {
             for (auto [position, correction, mass] : query)
             {
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <numeric>
+
+#include "islands.hpp"
+
+using cubos::engine::ConstraintIslands;
+
+/// @brief Marks roots which weren't assigned an island yet.
+static constexpr uint32_t NoIsland = UINT32_MAX;
+
+void ConstraintIslands::clear()
+{
+    mConstraints.clear();
+    mOrder.clear();
+    mOffsets.clear();
+    mBatches.assign(1, 0);
+}
+
+void ConstraintIslands::add(uint32_t body1, uint32_t body2)
+{
+    mConstraints.emplace_back(body1, body2);
+}
+
+void ConstraintIslands::build()
+{
+    // Start with each body in its own set.
+    uint32_t slotCount = 0;
+    for (auto [body1, body2] : mConstraints)
+    {
+        slotCount = std::max(slotCount, body1 == Static ? 0 : body1 + 1);
+        slotCount = std::max(slotCount, body2 == Static ? 0 : body2 + 1);
+    }
+    mParents.resize(slotCount);
+    std::iota(mParents.begin(), mParents.end(), 0U);
+
+    // Merge the sets of the dynamic bodies connected by each constraint.
+    for (auto [body1, body2] : mConstraints)
+    {
+        if (body1 != Static && body2 != Static)
+        {
+            auto root1 = this->find(body1);
+            auto root2 = this->find(body2);
+            mParents[std::max(root1, root2)] = std::min(root1, root2);
+        }
+    }
+
+    // Number islands by the order of their first constraint, and count the constraints of each.
+    std::vector<uint32_t> islands(mConstraints.size());
+    mIslandOfRoot.assign(slotCount, NoIsland);
+    mOffsets.clear();
+    for (std::size_t i = 0; i < mConstraints.size(); ++i)
+    {
+        auto [body1, body2] = mConstraints[i];
+        if (body1 == Static && body2 == Static)
+        {
+            // Constraints between static bodies don't change anything, but they're still visited.
+            islands[i] = static_cast<uint32_t>(mOffsets.size());
+            mOffsets.push_back(1);
+            continue;
+        }
+
+        auto root = this->find(body1 == Static ? body2 : body1);
+        if (mIslandOfRoot[root] == NoIsland)
+        {
+            mIslandOfRoot[root] = static_cast<uint32_t>(mOffsets.size());
+            mOffsets.push_back(0);
+        }
+        islands[i] = mIslandOfRoot[root];
+        mOffsets[islands[i]] += 1;
+    }
+
+    // Turn the counts into offsets and place the constraints of each island contiguously, keeping their order.
+    std::exclusive_scan(mOffsets.begin(), mOffsets.end(), mOffsets.begin(), std::size_t{0});
+    mOffsets.push_back(mConstraints.size());
+    mOrder.resize(mConstraints.size());
+    std::vector<std::size_t> next(mOffsets.begin(), mOffsets.end() - 1);
+    for (std::size_t i = 0; i < mConstraints.size(); ++i)
+    {
+        mOrder[next[islands[i]]++] = i;
+    }
+
+    // Group consecutive islands into batches of similar size.
+    auto batchSize = std::max(MinBatchSize, mConstraints.size() / MaxBatchCount);
+    mBatches.assign(1, 0);
+    for (std::size_t island = 0; island < this->count(); ++island)
+    {
+        if (mOffsets[island + 1] - mOffsets[mBatches.back()] >= batchSize)
+        {
+            mBatches.push_back(island + 1);
+        }
+    }
+
+    if (mBatches.back() != this->count())
+    {
+        mBatches.push_back(this->count());
+    }
+}
+
+std::size_t ConstraintIslands::count() const
+{
+    return mOffsets.empty() ? 0 : mOffsets.size() - 1;
+}
+
+std::size_t ConstraintIslands::batchCount() const
+{
+    return mBatches.size() - 1;
+}
+
+std::span<const std::size_t> ConstraintIslands::island(std::size_t island) const
+{
+    return std::span<const std::size_t>{mOrder}.subspan(mOffsets[island], mOffsets[island + 1] - mOffsets[island]);
+}
+
+uint32_t ConstraintIslands::find(uint32_t body)
+{
+    while (mParents[body] != body)
+    {
+        mParents[body] = mParents[mParents[body]];
+        body = mParents[body];
+    }
+    return body;
+}
@@ -0,0 +1,97 @@
+/// @file
+/// @brief Class @ref cubos::engine::ConstraintIslands.
+/// @ingroup physics-solver-plugin
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <cubos/engine/prelude.hpp>
+
+namespace cubos::engine
+{
+    /// @brief Groups constraints into islands, which are sets of constraints connected through the bodies they act
+    /// on.
+    ///
+    /// Static bodies don't connect islands, as their velocities are never changed by the solver. Thus, constraints in
+    /// different islands never touch the same dynamic body, and can be solved concurrently. Within each island,
+    /// constraints keep the order in which they were added, so the result is the same as solving them sequentially.
+    ///
+    /// @ingroup physics-solver-plugin
+    class ConstraintIslands
+    {
+    public:
+        /// @brief Identifies a static body, which doesn't connect islands.
+        static constexpr uint32_t Static = UINT32_MAX;
+
+        /// @brief Constraints solved by a task are never fewer than this, unless there aren't enough constraints.
+        static constexpr std::size_t MinBatchSize = 64;
+
+        /// @brief Maximum number of tasks the constraints are split into.
+        static constexpr std::size_t MaxBatchCount = 256;
+
+        /// @brief Forgets all constraints added until now.
+        void clear();
+
+        /// @brief Adds a constraint between two bodies.
+        /// @param body1 Identifier of the first body, or @ref Static.
+        /// @param body2 Identifier of the second body, or @ref Static.
+        void add(uint32_t body1, uint32_t body2);
+
+        /// @brief Groups the constraints added since the last call to @ref clear into islands.
+        void build();
+
+        /// @brief Gets the number of islands found by the last call to @ref build.
+        /// @return Number of islands.
+        std::size_t count() const;
+
+        /// @brief Gets the constraints of an island.
+        /// @param island Island index.
+        /// @return Indices of the constraints, in the order they were added.
+        std::span<const std::size_t> island(std::size_t island) const;
+
+        /// @brief Gets the number of batches the islands found by the last call to @ref build were grouped into.
+        /// @return Number of batches, which is the number of tasks used by @ref forEach.
+        std::size_t batchCount() const;
+
+        /// @brief Calls the given function for each constraint, solving different islands concurrently.
+        ///
+        /// Small islands are batched together, so that each task has enough work to offset its overhead.
+        ///
+        /// @tparam F Function type.
+        /// @param parallel Used to split the work into tasks.
+        /// @param function Function, which receives the index of a constraint.
+        template <typename F>
+        void forEach(Parallel& parallel, F function) const
+        {
+            parallel.forEach(mBatches.size() - 1, [&](std::size_t batch) {
+                for (auto island = mBatches[batch]; island < mBatches[batch + 1]; ++island)
+                {
+                    for (auto constraint : this->island(island))
+                    {
+                        function(constraint);
+                    }
+                }
+            });
+        }
+
+    private:
+        /// @brief Finds the root of the set of a body, compressing the path to it.
+        /// @param body Body slot.
+        /// @return Root slot.
+        uint32_t find(uint32_t body);
+
+        std::vector<std::pair<uint32_t, uint32_t>> mConstraints; ///< Bodies of each constraint.
+        std::vector<uint32_t> mParents;                          ///< Union-find parent of each body.
+        std::vector<uint32_t> mIslandOfRoot;                     ///< Island of each root, used while building.
+        std::vector<std::size_t> mOrder;                         ///< Constraints sorted by island.
+        std::vector<std::size_t> mOffsets;                       ///< Offset of each island in @ref mOrder.
+
+        /// @brief First island of each batch, followed by the number of islands.
+        std::vector<std::size_t> mBatches{0};
+    };
+} // namespace cubos::engine
@@ -1,5 +1,9 @@
 #include "plugin.hpp"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include <glm/glm.hpp>
 
 #include <cubos/engine/collisions/colliding_with.hpp>
@@ -11,6 +15,8 @@
 #include <cubos/engine/transform/plugin.hpp>
 
 #include "../../fixed_substep/plugin.hpp"
+#include "../bodies/plugin.hpp"
+#include "../islands.hpp"
 
 using namespace cubos::engine;
 
@@ -79,144 +85,265 @@ static float mixValues(float value1, float value2, PhysicsMaterial::MixProperty
     }
 }
 
-static void solvePenetrationConstraint(
-    Query<Entity, const Mass&, const Inertia&, const Rotation&, AccumulatedCorrection&, Velocity&, AngularVelocity&,
-          PenetrationConstraints&, Entity, const Mass&, const Inertia&, const Rotation&, AccumulatedCorrection&,
-          Velocity&, AngularVelocity&>
-        query,
-    const FixedDeltaTime& fixedDeltaTime, const Substeps& substeps, const SolverConstants& solverConstants,
-    const bool useBias)
+namespace
+{
+    /// @brief Penetration constraints between a pair of bodies, ordered so that the normals of the constraints are
+    /// relative to the first body.
+    struct SolverContact
+    {
+        uint32_t body1;                                    ///< Identifier of the first body in @ref SolverBodies.
+        uint32_t body2;                                    ///< Identifier of the second body in @ref SolverBodies.
+        Entity entity1;                                    ///< First entity, as matched by the relation query.
+        Entity entity2;                                    ///< Second entity, as matched by the relation query.
+        std::vector<PenetrationConstraint> penConstraints; ///< Constraints between the bodies.
+    };
+
+    /// @brief Resource which holds the penetration constraints being solved during a fixed step.
+    ///
+    /// Copied from the @ref PenetrationConstraints relations once before the substeps, and written back once they
+    /// end, so that the islands only have to be found once per step.
+    struct SolverContacts
+    {
+        CUBOS_ANONYMOUS_REFLECT(SolverContacts);
+
+        std::vector<SolverContact> contacts;
+        ConstraintIslands islands;
+    };
+} // namespace
+
+/// @brief Writes back the velocities of the dynamic bodies of a contact.
+///
+/// Static bodies may be shared by contacts in different islands, and thus must not be written to while solving.
+///
+/// @param bodies Solver bodies.
+/// @param contact Contact.
+/// @param v1 Linear velocity of the first body.
+/// @param w1 Angular velocity of the first body.
+/// @param v2 Linear velocity of the second body.
+/// @param w2 Angular velocity of the second body.
+static void storeVelocities(SolverBodies& bodies, const SolverContact& contact, const glm::vec3& v1,
+                            const glm::vec3& w1, const glm::vec3& v2, const glm::vec3& w2)
+{
+    if (!bodies.isStatic(contact.body1))
+    {
+        bodies.velocities[contact.body1] = v1;
+        bodies.angularVelocities[contact.body1] = w1;
+    }
+
+    if (!bodies.isStatic(contact.body2))
+    {
+        bodies.velocities[contact.body2] = v2;
+        bodies.angularVelocities[contact.body2] = w2;
+    }
+}
+
+static void warmStartPenetrationConstraint(SolverBodies& bodies, SolverContact& contact,
+                                           const SolverConstants& solverConstants)
 {
-    float subDeltaTime = fixedDeltaTime.value / (float)substeps.value;
+    float invMass1 = bodies.inverseMasses[contact.body1];
+    float invMass2 = bodies.inverseMasses[contact.body2];
+    const glm::mat3& invInertia1 = bodies.inverseInertias[contact.body1];
+    const glm::mat3& invInertia2 = bodies.inverseInertias[contact.body2];
 
-    for (auto [ent1, mass1, inertia1, rotation1, correction1, velocity1, angVelocity1, constraints, ent2, mass2,
-               inertia2, rotation2, correction2, velocity2, angVelocity2] : query)
+    glm::vec3 v1 = bodies.velocities[contact.body1];
+    glm::vec3 v2 = bodies.velocities[contact.body2];
+
+    glm::vec3 w1 = bodies.angularVelocities[contact.body1];
+    glm::vec3 w2 = bodies.angularVelocities[contact.body2];
+
+    glm::vec3 tangent1;
+    glm::vec3 tangent2;
+
+    for (auto& constraint : contact.penConstraints)
     {
-        const Mass* matchedMass1 = &mass1;
-        const Mass* matchedMass2 = &mass2;
-        const Inertia* matchedInertia1 = &inertia1;
-        const Inertia* matchedInertia2 = &inertia2;
-        const Rotation* matchedRotation1 = &rotation1;
-        const Rotation* matchedRotation2 = &rotation2;
-        const AccumulatedCorrection* matchedCorrection1 = &correction1;
-        const AccumulatedCorrection* matchedCorrection2 = &correction2;
-        Velocity* matchedVelocity1 = &velocity1;
-        Velocity* matchedVelocity2 = &velocity2;
-        AngularVelocity* matchedAngVelocity1 = &angVelocity1;
-        AngularVelocity* matchedAngVelocity2 = &angVelocity2;
-
-        if (ent1 != constraints.entity)
+        getTangents(v1, v2, constraint.normal, tangent1, tangent2, solverConstants);
+
+        for (PenetrationConstraintPointData& contactPoint : constraint.points)
         {
-            std::swap(matchedMass1, matchedMass2);
-            std::swap(matchedInertia1, matchedInertia2);
-            std::swap(matchedRotation1, matchedRotation2);
-            std::swap(matchedCorrection1, matchedCorrection2);
-            std::swap(matchedVelocity1, matchedVelocity2);
-            std::swap(matchedAngVelocity1, matchedAngVelocity2);
-        }
+            glm::vec3 r1 = contactPoint.fixedAnchor1;
+            glm::vec3 r2 = contactPoint.fixedAnchor2;
+
+            glm::vec3 p = solverConstants.warmStartCoefficient * (contactPoint.normalImpulse * constraint.normal) +
+                          (contactPoint.frictionImpulse1 * tangent1) + (contactPoint.frictionImpulse2 * tangent2);
 
-        glm::vec3 v1 = matchedVelocity1->vec;
-        glm::vec3 v2 = matchedVelocity2->vec;
+            v1 -= p * invMass1;
+            w1 -= invInertia1 * glm::cross(r1, p);
+            v2 += p * invMass2;
+            w2 += invInertia2 * glm::cross(r2, p);
+        }
+    }
 
-        glm::vec3 w1 = matchedAngVelocity1->vec;
-        glm::vec3 w2 = matchedAngVelocity2->vec;
+    storeVelocities(bodies, contact, v1, w1, v2, w2);
+}
 
-        for (auto& constraint : constraints.penConstraints)
+static void solvePenetrationConstraint(SolverBodies& bodies, SolverContact& contact, float subDeltaTime,
+                                       const SolverConstants& solverConstants, const bool useBias)
+{
+    float invMass1 = bodies.inverseMasses[contact.body1];
+    float invMass2 = bodies.inverseMasses[contact.body2];
+    const glm::mat3& invInertia1 = bodies.inverseInertias[contact.body1];
+    const glm::mat3& invInertia2 = bodies.inverseInertias[contact.body2];
+    const glm::quat& rotation1 = bodies.rotations[contact.body1];
+    const glm::quat& rotation2 = bodies.rotations[contact.body2];
+    const glm::vec3& correction1 = bodies.corrections[contact.body1];
+    const glm::vec3& correction2 = bodies.corrections[contact.body2];
+
+    glm::vec3 v1 = bodies.velocities[contact.body1];
+    glm::vec3 v2 = bodies.velocities[contact.body2];
+
+    glm::vec3 w1 = bodies.angularVelocities[contact.body1];
+    glm::vec3 w2 = bodies.angularVelocities[contact.body2];
+
+    for (auto& constraint : contact.penConstraints)
+    {
+        // Separate bodies
+        for (PenetrationConstraintPointData& contactPoint : constraint.points)
         {
-            // Separate bodies
-            for (PenetrationConstraintPointData& contactPoint : constraint.points)
+            glm::vec3 r1 = rotation1 * contactPoint.localAnchor1;
+            glm::vec3 r2 = rotation2 * contactPoint.localAnchor2;
+
+            glm::vec3 deltaSeparation = correction2 + r2 - correction1 - r1;
+
+            float separation = glm::dot(deltaSeparation, constraint.normal) + contactPoint.initialSeparation;
+
+            /// TODO: check correctness of bias
+            float bias = 0.0F;
+            float massScale = 1.0F;
+            float impulseScale = 0.0F;
+            if (separation > 0.0F)
+            {
+                bias = separation * (1.0F / subDeltaTime);
+            }
+            else if (useBias)
             {
-                glm::vec3 r1 = matchedRotation1->quat * contactPoint.localAnchor1;
-                glm::vec3 r2 = matchedRotation2->quat * contactPoint.localAnchor2;
+                bias = glm::max(constraint.biasCoefficient * separation, solverConstants.maxBias);
+                massScale = constraint.massCoefficient;
+                impulseScale = constraint.impulseCoefficient;
+            }
 
-                glm::vec3 deltaSeparation = matchedCorrection2->position + r2 - matchedCorrection1->position - r1;
+            // Relative velocity at contact
+            glm::vec3 vr1 = v1 + glm::cross(w1, r1);
+            glm::vec3 vr2 = v2 + glm::cross(w2, r2);
+            glm::vec3 vr = vr2 - vr1;
 
-                float separation = glm::dot(deltaSeparation, constraint.normal) + contactPoint.initialSeparation;
+            float vn = glm::dot(vr, constraint.normal);
 
-                /// TODO: check correctness of bias
-                float bias = 0.0F;
-                float massScale = 1.0F;
-                float impulseScale = 0.0F;
-                if (separation > 0.0F)
-                {
-                    bias = separation * (1.0F / subDeltaTime);
-                }
-                else if (useBias)
-                {
-                    bias = glm::max(constraint.biasCoefficient * separation, solverConstants.maxBias);
-                    massScale = constraint.massCoefficient;
-                    impulseScale = constraint.impulseCoefficient;
-                }
+            // Compute normal impulse
+            float impulse =
+                -contactPoint.normalMass * massScale * (vn + bias) - impulseScale * contactPoint.normalImpulse;
+
+            // Clamp the accumulated impulse
+            float newImpulse = glm::max(contactPoint.normalImpulse + impulse, 0.0F);
+            impulse = newImpulse - contactPoint.normalImpulse;
+            contactPoint.normalImpulse = newImpulse;
 
-                // Relative velocity at contact
-                glm::vec3 vr1 = v1 + glm::cross(w1, r1);
-                glm::vec3 vr2 = v2 + glm::cross(w2, r2);
-                glm::vec3 vr = vr2 - vr1;
+            glm::vec3 p = impulse * constraint.normal;
 
-                float vn = glm::dot(vr, constraint.normal);
+            v1 -= p * invMass1;
+            w1 -= invInertia1 * glm::cross(r1, p);
+            v2 += p * invMass2;
+            w2 += invInertia2 * glm::cross(r2, p);
+        }
 
-                // Compute normal impulse
-                float impulse =
-                    -contactPoint.normalMass * massScale * (vn + bias) - impulseScale * contactPoint.normalImpulse;
+        glm::vec3 tangent1;
+        glm::vec3 tangent2;
+        getTangents(v1, v2, constraint.normal, tangent1, tangent2, solverConstants);
 
-                // Clamp the accumulated impulse
-                float newImpulse = glm::max(contactPoint.normalImpulse + impulse, 0.0F);
-                impulse = newImpulse - contactPoint.normalImpulse;
-                contactPoint.normalImpulse = newImpulse;
+        // Friction
+        for (PenetrationConstraintPointData& contactPoint : constraint.points)
+        {
+            glm::vec3 r1 = contactPoint.fixedAnchor1;
+            glm::vec3 r2 = contactPoint.fixedAnchor2;
+
+            // Relative velocity at contact
+            glm::vec3 vr1 = v1 + glm::cross(w1, r1);
+            glm::vec3 vr2 = v2 + glm::cross(w2, r2);
+            glm::vec3 vr = vr2 - vr1;
+
+            float vn1 = glm::dot(vr, tangent1);
+            float vn2 = glm::dot(vr, tangent2);
+
+            // Compute friction force
+            float impulse1 = -contactPoint.frictionMass1 * vn1;
+            float impulse2 = -contactPoint.frictionMass2 * vn2;
+
+            // Clamp the accumulated force
+            float maxFriction = constraint.friction * contactPoint.normalImpulse;
+            float newImpulse1 = glm::clamp(contactPoint.frictionImpulse1 + impulse1, -maxFriction, maxFriction);
+            float newImpulse2 = glm::clamp(contactPoint.frictionImpulse2 + impulse2, -maxFriction, maxFriction);
+            impulse1 = newImpulse1 - contactPoint.frictionImpulse1;
+            impulse2 = newImpulse2 - contactPoint.frictionImpulse2;
+            contactPoint.frictionImpulse1 = newImpulse1;
+            contactPoint.frictionImpulse2 = newImpulse2;
+
+            // Apply contact impulse
+            glm::vec3 p = impulse1 * tangent1 + impulse2 * tangent2;
+
+            v1 -= p * invMass1;
+            w1 -= invInertia1 * glm::cross(r1, p);
+            v2 += p * invMass2;
+            w2 += invInertia2 * glm::cross(r2, p);
+        }
+    }
 
-                glm::vec3 p = impulse * constraint.normal;
+    storeVelocities(bodies, contact, v1, w1, v2, w2);
+}
 
-                v1 -= p * matchedMass1->inverseMass;
-                w1 -= matchedInertia1->inverseInertia * glm::cross(r1, p);
-                v2 += p * matchedMass2->inverseMass;
-                w2 += matchedInertia2->inverseInertia * glm::cross(r2, p);
-            }
+static void addRestitution(SolverBodies& bodies, const SolverContact& contact, const SolverConstants& solverConstants)
+{
+    float invMass1 = bodies.inverseMasses[contact.body1];
+    float invMass2 = bodies.inverseMasses[contact.body2];
+    const glm::mat3& invInertia1 = bodies.inverseInertias[contact.body1];
+    const glm::mat3& invInertia2 = bodies.inverseInertias[contact.body2];
+
+    glm::vec3 v1 = bodies.velocities[contact.body1];
+    glm::vec3 v2 = bodies.velocities[contact.body2];
+    glm::vec3 w1 = bodies.angularVelocities[contact.body1];
+    glm::vec3 w2 = bodies.angularVelocities[contact.body2];
 
-            glm::vec3 tangent1;
-            glm::vec3 tangent2;
-            getTangents(v1, v2, constraint.normal, tangent1, tangent2, solverConstants);
+    for (const auto& constraint : contact.penConstraints)
+    {
+        if (constraint.restitution == solverConstants.minRestitution)
+        {
+            continue;
+        }
 
-            // Friction
-            for (PenetrationConstraintPointData& contactPoint : constraint.points)
+        for (auto point : constraint.points)
+        {
+            if (point.normalSpeed > solverConstants.minNormalSpeed ||
+                point.normalImpulse == solverConstants.minNormalImpulse)
             {
-                glm::vec3 r1 = contactPoint.fixedAnchor1;
-                glm::vec3 r2 = contactPoint.fixedAnchor2;
-
-                // Relative velocity at contact
-                glm::vec3 vr1 = v1 + glm::cross(w1, r1);
-                glm::vec3 vr2 = v2 + glm::cross(w2, r2);
-                glm::vec3 vr = vr2 - vr1;
-
-                float vn1 = glm::dot(vr, tangent1);
-                float vn2 = glm::dot(vr, tangent2);
-
-                // Compute friction force
-                float impulse1 = -contactPoint.frictionMass1 * vn1;
-                float impulse2 = -contactPoint.frictionMass2 * vn2;
-
-                // Clamp the accumulated force
-                float maxFriction = constraint.friction * contactPoint.normalImpulse;
-                float newImpulse1 = glm::clamp(contactPoint.frictionImpulse1 + impulse1, -maxFriction, maxFriction);
-                float newImpulse2 = glm::clamp(contactPoint.frictionImpulse2 + impulse2, -maxFriction, maxFriction);
-                impulse1 = newImpulse1 - contactPoint.frictionImpulse1;
-                impulse2 = newImpulse2 - contactPoint.frictionImpulse2;
-                contactPoint.frictionImpulse1 = newImpulse1;
-                contactPoint.frictionImpulse2 = newImpulse2;
-
-                // Apply contact impulse
-                glm::vec3 p = impulse1 * tangent1 + impulse2 * tangent2;
-
-                v1 -= p * matchedMass1->inverseMass;
-                w1 -= matchedInertia1->inverseInertia * glm::cross(r1, p);
-                v2 += p * matchedMass2->inverseMass;
-                w2 += matchedInertia2->inverseInertia * glm::cross(r2, p);
+                continue;
             }
+
+            glm::vec3 r1 = point.fixedAnchor1;
+            glm::vec3 r2 = point.fixedAnchor2;
+
+            // Relative velocity at contact
+            glm::vec3 vr1 = v1 + glm::cross(w1, r1);
+            glm::vec3 vr2 = v2 + glm::cross(w2, r2);
+            glm::vec3 vr = vr2 - vr1;
+
+            float vn = glm::dot(vr, constraint.normal);
+
+            // compute normal impulse
+            float impulse = -point.normalMass * (vn + constraint.restitution * point.normalSpeed);
+
+            // Clamp the accumulated impulse
+            float newImpulse = glm::max(point.normalImpulse + impulse, 0.0F);
+            impulse = newImpulse - point.normalImpulse;
+            point.normalImpulse = newImpulse;
+
+            // Apply impulse
+            glm::vec3 p = constraint.normal * impulse;
+            v1 -= p * invMass1;
+            w1 -= invInertia1 * glm::cross(r1, p);
+            v2 += p * invMass2;
+            w2 += invInertia2 * glm::cross(r2, p);
         }
-        matchedVelocity1->vec = v1;
-        matchedAngVelocity1->vec = w1;
-        matchedVelocity2->vec = v2;
-        matchedAngVelocity2->vec = w2;
     }
+
+    storeVelocities(bodies, contact, v1, w1, v2, w2);
 }
 
 void cubos::engine::penetrationConstraintPlugin(Cubos& cubos)
@@ -236,185 +363,121 @@ void cubos::engine::penetrationConstraintPlugin(Cubos& cubos)
     cubos.tag(penetrationConstraintRestitutionTag);
     cubos.tag(penetrationConstraintCleanTag);
 
-    cubos.system("warm start")
-        .tagged(penetrationConstraintWarmStartTag)
-        .after(addPenetrationConstraintTag)
-        .before(penetrationConstraintSolveTag)
-        .tagged(fixedSubstepTag)
-        .call([](Query<Entity, const Mass&, const Inertia&, const Rotation&, AccumulatedCorrection&, Velocity&,
-                       AngularVelocity&, PenetrationConstraints&, Entity, const Mass&, const Inertia&, const Rotation&,
-                       AccumulatedCorrection&, Velocity&, AngularVelocity&>
+    cubos.resource<SolverContacts>();
+
+    cubos.system("gather penetration constraints")
+        .after(physicsGatherBodiesTag)
+        .before(fixedSubstepTag)
+        .tagged(fixedStepTag)
+        .call([](Query<Entity, const Rotation&, const AccumulatedCorrection&, const Velocity&,
+                       const AngularVelocity&, Opt<const Sleeping&>, const PenetrationConstraints&, Entity,
+                       const Rotation&, const AccumulatedCorrection&, const Velocity&, const AngularVelocity&,
+                       Opt<const Sleeping&>>
                      query,
-                 const SolverConstants& solverConstants) {
-            for (auto [ent1, mass1, inertia1, rotation1, correction1, velocity1, angVelocity1, constraints, ent2, mass2,
-                       inertia2, rotation2, correction2, velocity2, angVelocity2] : query)
+                 SolverBodies& bodies, const SolverConstants& solverConstants, SolverContacts& contacts) {
+            contacts.contacts.clear();
+            contacts.islands.clear();
+            for (auto [ent1, rotation1, correction1, velocity1, angVelocity1, sleeping1, constraints, ent2, rotation2,
+                       correction2, velocity2, angVelocity2, sleeping2] : query)
             {
-                const Mass* matchedMass1 = &mass1;
-                const Mass* matchedMass2 = &mass2;
-                const Inertia* matchedInertia1 = &inertia1;
-                const Inertia* matchedInertia2 = &inertia2;
-                const Rotation* matchedRotation1 = &rotation1;
-                const Rotation* matchedRotation2 = &rotation2;
-                const AccumulatedCorrection* matchedCorrection1 = &correction1;
-                const AccumulatedCorrection* matchedCorrection2 = &correction2;
-                Velocity* matchedVelocity1 = &velocity1;
-                Velocity* matchedVelocity2 = &velocity2;
-                AngularVelocity* matchedAngVelocity1 = &angVelocity1;
-                AngularVelocity* matchedAngVelocity2 = &angVelocity2;
-
-                if (ent1 != constraints.entity)
+                if (sleeping1 && sleeping2)
                 {
-                    std::swap(matchedMass1, matchedMass2);
-                    std::swap(matchedInertia1, matchedInertia2);
-                    std::swap(matchedRotation1, matchedRotation2);
-                    std::swap(matchedCorrection1, matchedCorrection2);
-                    std::swap(matchedVelocity1, matchedVelocity2);
-                    std::swap(matchedAngVelocity1, matchedAngVelocity2);
+                    continue;
                 }
 
-                glm::vec3 v1 = matchedVelocity1->vec;
-                glm::vec3 v2 = matchedVelocity2->vec;
-
-                glm::vec3 w1 = matchedAngVelocity1->vec;
-                glm::vec3 w2 = matchedAngVelocity2->vec;
-
-                glm::vec3 tangent1;
-                glm::vec3 tangent2;
-
-                for (auto& constraint : constraints.penConstraints)
+                // Bodies which weren't gathered as dynamic are static or asleep, and are added as static bodies.
+                auto body1 = bodies.findOrAddStatic(ent1, rotation1.quat, correction1.position, velocity1.vec,
+                                                    angVelocity1.vec);
+                auto body2 = bodies.findOrAddStatic(ent2, rotation2.quat, correction2.position, velocity2.vec,
+                                                    angVelocity2.vec);
+                if (bodies.isStatic(body1) && bodies.isStatic(body2))
                 {
-                    getTangents(v1, v2, constraint.normal, tangent1, tangent2, solverConstants);
+                    continue;
+                }
 
-                    for (PenetrationConstraintPointData& contactPoint : constraint.points)
-                    {
-                        glm::vec3 r1 = contactPoint.fixedAnchor1;
-                        glm::vec3 r2 = contactPoint.fixedAnchor2;
+                if (ent1 != constraints.entity)
+                {
+                    std::swap(body1, body2);
+                }
 
-                        glm::vec3 p =
-                            solverConstants.warmStartCoefficient * (contactPoint.normalImpulse * constraint.normal) +
-                            (contactPoint.frictionImpulse1 * tangent1) + (contactPoint.frictionImpulse2 * tangent2);
+                contacts.contacts.push_back(SolverContact{.body1 = body1,
+                                                          .body2 = body2,
+                                                          .entity1 = ent1,
+                                                          .entity2 = ent2,
+                                                          .penConstraints = constraints.penConstraints});
+            }
 
-                        v1 -= p * matchedMass1->inverseMass;
-                        w1 -= matchedInertia1->inverseInertia * glm::cross(r1, p);
-                        v2 += p * matchedMass2->inverseMass;
-                        w2 += matchedInertia2->inverseInertia * glm::cross(r2, p);
-                    }
+            // Query order depends on the order in which the relations were created, which isn't deterministic.
+            if (solverConstants.deterministic)
+            {
+                std::sort(contacts.contacts.begin(), contacts.contacts.end(), [](const auto& a, const auto& b) {
+                    return std::pair{SolverBodies::key(a.entity1), SolverBodies::key(a.entity2)} <
+                           std::pair{SolverBodies::key(b.entity1), SolverBodies::key(b.entity2)};
+                });
+            }
 
-                    matchedVelocity1->vec = v1;
-                    matchedAngVelocity1->vec = w1;
-                    matchedVelocity2->vec = v2;
-                    matchedAngVelocity2->vec = w2;
-                }
+            for (const auto& contact : contacts.contacts)
+            {
+                contacts.islands.add(bodies.isStatic(contact.body1) ? ConstraintIslands::Static : contact.body1,
+                                     bodies.isStatic(contact.body2) ? ConstraintIslands::Static : contact.body2);
             }
+            contacts.islands.build();
+        });
+
+    cubos.system("warm start")
+        .tagged(penetrationConstraintWarmStartTag)
+        .after(addPenetrationConstraintTag)
+        .before(penetrationConstraintSolveTag)
+        .tagged(fixedSubstepTag)
+        .call([](SolverBodies& bodies, SolverContacts& contacts, const SolverConstants& solverConstants,
+                 Parallel parallel) {
+            contacts.islands.forEach(parallel, [&](std::size_t i) {
+                warmStartPenetrationConstraint(bodies, contacts.contacts[i], solverConstants);
+            });
         });
 
     cubos.system("solve contacts bias")
         .tagged(penetrationConstraintSolveTag)
         .tagged(physicsSolveContactTag)
-        .call([](Query<Entity, const Mass&, const Inertia&, const Rotation&, AccumulatedCorrection&, Velocity&,
-                       AngularVelocity&, PenetrationConstraints&, Entity, const Mass&, const Inertia&, const Rotation&,
-                       AccumulatedCorrection&, Velocity&, AngularVelocity&>
-                     query,
-                 const FixedDeltaTime& fixedDeltaTime, const Substeps& substeps,
-                 const SolverConstants& solverConstants) {
-            solvePenetrationConstraint(query, fixedDeltaTime, substeps, solverConstants, true);
+        .call([](SolverBodies& bodies, SolverContacts& contacts, const FixedDeltaTime& fixedDeltaTime,
+                 const Substeps& substeps, const SolverConstants& solverConstants, Parallel parallel) {
+            float subDeltaTime = fixedDeltaTime.value / (float)substeps.value;
+            contacts.islands.forEach(parallel, [&](std::size_t i) {
+                solvePenetrationConstraint(bodies, contacts.contacts[i], subDeltaTime, solverConstants, true);
+            });
         });
 
     cubos.system("solve contacts no bias")
         .tagged(penetrationConstraintSolveRelaxTag)
         .tagged(physicsSolveRelaxContactTag)
-        .call([](Query<Entity, const Mass&, const Inertia&, const Rotation&, AccumulatedCorrection&, Velocity&,
-                       AngularVelocity&, PenetrationConstraints&, Entity, const Mass&, const Inertia&, const Rotation&,
-                       AccumulatedCorrection&, Velocity&, AngularVelocity&>
-                     query,
-                 const FixedDeltaTime& fixedDeltaTime, const Substeps& substeps,
-                 const SolverConstants& solverConstants) {
-            solvePenetrationConstraint(query, fixedDeltaTime, substeps, solverConstants, false);
+        .call([](SolverBodies& bodies, SolverContacts& contacts, const FixedDeltaTime& fixedDeltaTime,
+                 const Substeps& substeps, const SolverConstants& solverConstants, Parallel parallel) {
+            float subDeltaTime = fixedDeltaTime.value / (float)substeps.value;
+            contacts.islands.forEach(parallel, [&](std::size_t i) {
+                solvePenetrationConstraint(bodies, contacts.contacts[i], subDeltaTime, solverConstants, false);
+            });
         });
 
     cubos.system("add restitution")
         .tagged(penetrationConstraintRestitutionTag)
         .after(penetrationConstraintSolveRelaxTag)
-        .before(physicsFinalizePositionTag)
+        .before(physicsScatterBodiesTag)
         .tagged(fixedStepTag)
-        .call([](Query<Entity, const Mass&, const Inertia&, AccumulatedCorrection&, Velocity&, AngularVelocity&,
-                       PenetrationConstraints&, Entity, const Mass&, const Inertia&, AccumulatedCorrection&, Velocity&,
-                       AngularVelocity&>
-                     query,
-                 const SolverConstants& solverConstants) {
-            for (auto [ent1, mass1, inertia1, correction1, velocity1, angVelocity1, constraints, ent2, mass2, inertia2,
-                       correction2, velocity2, angVelocity2] : query)
+        .call([](SolverBodies& bodies, SolverContacts& contacts, const SolverConstants& solverConstants,
+                 Parallel parallel) {
+            contacts.islands.forEach(
+                parallel, [&](std::size_t i) { addRestitution(bodies, contacts.contacts[i], solverConstants); });
+        });
+
+    cubos.system("scatter penetration constraints")
+        .tagged(physicsScatterBodiesTag)
+        .call([](Query<Entity, PenetrationConstraints&, Entity> query, SolverContacts& contacts) {
+            for (auto& contact : contacts.contacts)
             {
-                for (const auto& constraint : constraints.penConstraints)
+                if (auto match = query.at(contact.entity1, contact.entity2))
                 {
-                    if (constraint.restitution == solverConstants.minRestitution)
-                    {
-                        continue;
-                    }
-
-                    const Mass* matchedMass1 = &mass1;
-                    const Mass* matchedMass2 = &mass2;
-                    const Inertia* matchedInertia1 = &inertia1;
-                    const Inertia* matchedInertia2 = &inertia2;
-                    const AccumulatedCorrection* matchedCorrection1 = &correction1;
-                    const AccumulatedCorrection* matchedCorrection2 = &correction2;
-                    Velocity* matchedVelocity1 = &velocity1;
-                    Velocity* matchedVelocity2 = &velocity2;
-                    AngularVelocity* matchedAngVelocity1 = &angVelocity1;
-                    AngularVelocity* matchedAngVelocity2 = &angVelocity2;
-
-                    if (ent1 != constraints.entity)
-                    {
-                        std::swap(matchedMass1, matchedMass2);
-                        std::swap(matchedInertia1, matchedInertia2);
-                        std::swap(matchedCorrection1, matchedCorrection2);
-                        std::swap(matchedVelocity1, matchedVelocity2);
-                        std::swap(matchedAngVelocity1, matchedAngVelocity2);
-                    }
-
-                    glm::vec3 v1 = matchedVelocity1->vec;
-                    glm::vec3 v2 = matchedVelocity2->vec;
-                    glm::vec3 w1 = matchedAngVelocity1->vec;
-                    glm::vec3 w2 = matchedAngVelocity2->vec;
-
-                    for (auto point : constraint.points)
-                    {
-                        if (point.normalSpeed > solverConstants.minNormalSpeed ||
-                            point.normalImpulse == solverConstants.minNormalImpulse)
-                        {
-                            continue;
-                        }
-
-                        glm::vec3 r1 = point.fixedAnchor1;
-                        glm::vec3 r2 = point.fixedAnchor2;
-
-                        // Relative velocity at contact
-                        glm::vec3 vr1 = v1 + glm::cross(w1, r1);
-                        glm::vec3 vr2 = v2 + glm::cross(w2, r2);
-                        glm::vec3 vr = vr2 - vr1;
-
-                        float vn = glm::dot(vr, constraint.normal);
-
-                        // compute normal impulse
-                        float impulse = -point.normalMass * (vn + constraint.restitution * point.normalSpeed);
-
-                        // Clamp the accumulated impulse
-                        float newImpulse = glm::max(point.normalImpulse + impulse, 0.0F);
-                        impulse = newImpulse - point.normalImpulse;
-                        point.normalImpulse = newImpulse;
-
-                        // Apply impulse
-                        glm::vec3 p = constraint.normal * impulse;
-                        v1 -= p * matchedMass1->inverseMass;
-                        w1 -= matchedInertia1->inverseInertia * glm::cross(r1, p);
-                        v2 += p * matchedMass2->inverseMass;
-                        w2 += matchedInertia2->inverseInertia * glm::cross(r2, p);
-                    }
-
-                    matchedVelocity1->vec = v1;
-                    matchedAngVelocity1->vec = w1;
-                    matchedVelocity2->vec = v2;
-                    matchedAngVelocity2->vec = w2;
+                    auto [ent1, constraints, ent2] = *match;
+                    constraints.penConstraints = std::move(contact.penConstraints);
                 }
             }
         });
@@ -424,18 +487,18 @@ void cubos::engine::penetrationConstraintPlugin(Cubos& cubos)
         .tagged(physicsPrepareSolveTag)
         .call([](Commands cmds,
                  Query<Entity, const Mass&, const Inertia&, const CenterOfMass&, const Rotation&, const Velocity&,
-                       const AngularVelocity&, const PhysicsMaterial&, const CollidingWith&, Entity, const Mass&,
-                       const Inertia&, const CenterOfMass&, const Rotation&, const Velocity&, const AngularVelocity&,
-                       const PhysicsMaterial&>
+                       const AngularVelocity&, const PhysicsMaterial&, Opt<const Sleeping&>, const CollidingWith&,
+                       Entity, const Mass&, const Inertia&, const CenterOfMass&, const Rotation&, const Velocity&,
+                       const AngularVelocity&, const PhysicsMaterial&, Opt<const Sleeping&>>
                      query,
                  const FixedDeltaTime& fixedDeltaTime, const Substeps& substeps,
                  const SolverConstants& solverConstants) {
             float subDeltaTime = fixedDeltaTime.value / (float)substeps.value;
             float contactHertz = glm::min(solverConstants.minContactHertz, 0.25F * (1.0F / subDeltaTime));
 
-            for (auto [ent1, mass1, inertia1, centerOfMass1, rotation1, velocity1, angVelocity1, material1,
+            for (auto [ent1, mass1, inertia1, centerOfMass1, rotation1, velocity1, angVelocity1, material1, sleeping1,
                        collidingWith, ent2, mass2, inertia2, centerOfMass2, rotation2, velocity2, angVelocity2,
-                       material2] : query)
+                       material2, sleeping2] : query)
             {
                 const Mass* matchedMass1 = &mass1;
                 const Mass* matchedMass2 = &mass2;
@@ -451,6 +514,8 @@ void cubos::engine::penetrationConstraintPlugin(Cubos& cubos)
                 const AngularVelocity* matchedAngVelocity2 = &angVelocity2;
                 const PhysicsMaterial* matchedMaterial1 = &material1;
                 const PhysicsMaterial* matchedMaterial2 = &material2;
+                bool matchedSleeping1 = sleeping1.contains();
+                bool matchedSleeping2 = sleeping2.contains();
 
                 if (ent1 != collidingWith.entity)
                 {
@@ -461,8 +526,15 @@ void cubos::engine::penetrationConstraintPlugin(Cubos& cubos)
                     std::swap(matchedVelocity1, matchedVelocity2);
                     std::swap(matchedAngVelocity1, matchedAngVelocity2);
                     std::swap(matchedMaterial1, matchedMaterial2);
+                    std::swap(matchedSleeping1, matchedSleeping2);
                 }
 
+                // Sleeping bodies are treated as static by the solver, and thus don't take any of the impulses.
+                float inverseMass1 = matchedSleeping1 ? 0.0F : matchedMass1->inverseMass;
+                float inverseMass2 = matchedSleeping2 ? 0.0F : matchedMass2->inverseMass;
+                glm::mat3 inverseInertia1 = matchedSleeping1 ? glm::mat3(0.0F) : matchedInertia1->inverseInertia;
+                glm::mat3 inverseInertia2 = matchedSleeping2 ? glm::mat3(0.0F) : matchedInertia2->inverseInertia;
+
                 std::vector<PenetrationConstraint> penConstraints;
                 for (const auto& manifold : collidingWith.manifolds)
                 {
@@ -501,9 +573,8 @@ void cubos::engine::penetrationConstraintPlugin(Cubos& cubos)
                         // normal mass
                         glm::vec3 rn1 = glm::cross(r1, manifold.normal);
                         glm::vec3 rn2 = glm::cross(r2, manifold.normal);
-                        float kNormal = mass1.inverseMass + mass2.inverseMass +
-                                        glm::dot(matchedInertia1->inverseInertia * rn1, rn1) +
-                                        glm::dot(matchedInertia2->inverseInertia * rn2, rn2);
+                        float kNormal = inverseMass1 + inverseMass2 + glm::dot(inverseInertia1 * rn1, rn1) +
+                                        glm::dot(inverseInertia2 * rn2, rn2);
                         pointData.normalMass = kNormal > solverConstants.minKNormal ? 1.0F / kNormal : 0.0F;
 
                         // friction mass
@@ -513,15 +584,15 @@ void cubos::engine::penetrationConstraintPlugin(Cubos& cubos)
                         glm::vec3 rt22 = glm::cross(r2, tangent2);
 
                         // Multiply by the inverse inertia early to reuse the values
-                        glm::vec3 i1Rt11 = matchedInertia1->inverseInertia * rt11;
-                        glm::vec3 i2Rt12 = matchedInertia2->inverseInertia * rt12;
-                        glm::vec3 i1Rt21 = matchedInertia1->inverseInertia * rt21;
-                        glm::vec3 i2Rt22 = matchedInertia2->inverseInertia * rt22;
+                        glm::vec3 i1Rt11 = inverseInertia1 * rt11;
+                        glm::vec3 i2Rt12 = inverseInertia2 * rt12;
+                        glm::vec3 i1Rt21 = inverseInertia1 * rt21;
+                        glm::vec3 i2Rt22 = inverseInertia2 * rt22;
 
                         float kFriction1 =
-                            mass1.inverseMass + mass2.inverseMass + glm::dot(i1Rt11, rt11) + glm::dot(i2Rt12, rt12);
+                            inverseMass1 + inverseMass2 + glm::dot(i1Rt11, rt11) + glm::dot(i2Rt12, rt12);
                         float kFriction2 =
-                            mass1.inverseMass + mass2.inverseMass + glm::dot(i1Rt21, rt21) + glm::dot(i2Rt22, rt22);
+                            inverseMass1 + inverseMass2 + glm::dot(i1Rt21, rt21) + glm::dot(i2Rt22, rt22);
 
                         /// TODO: these could be an array in the point
                         pointData.frictionMass1 = kFriction1 > solverConstants.minKFriction ? 1.0F / kFriction1 : 0.0F;
@@ -5,8 +5,11 @@
 #include <cubos/engine/physics/solver/plugin.hpp>
 
 #include "../fixed_substep/plugin.hpp"
+#include "bodies/plugin.hpp"
+#include "continuous_collision/plugin.hpp"
 #include "distance_constraint/plugin.hpp"
 #include "integration/plugin.hpp"
+#include "sleep/plugin.hpp"
 
 
 CUBOS_DEFINE_TAG(cubos::engine::physicsPrepareSolveTag);
@@ -53,7 +56,10 @@ void cubos::engine::physicsSolverPlugin(Cubos& cubos)
 
     cubos.tag(physicsFinalizePositionTag).after(physicsSolveRelaxContactTag).tagged(fixedStepTag);
 
+    cubos.plugin(physicsSolverBodiesPlugin);
     cubos.plugin(physicsIntegrationPlugin);
     cubos.plugin(penetrationConstraintPlugin);
     cubos.plugin(distanceConstraintPlugin);
+    cubos.plugin(physicsContinuousCollisionPlugin);
+    cubos.plugin(physicsSleepPlugin);
 }
@@ -0,0 +1,208 @@
+#include "plugin.hpp"
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+#include <cubos/core/ecs/entity/hash.hpp>
+#include <cubos/core/reflection/reflect.hpp>
+
+#include <cubos/engine/collisions/colliding_with.hpp>
+#include <cubos/engine/collisions/plugin.hpp>
+#include <cubos/engine/fixed_step/plugin.hpp>
+#include <cubos/engine/physics/constraints/distance_constraint.hpp>
+#include <cubos/engine/physics/plugin.hpp>
+#include <cubos/engine/physics/solver/plugin.hpp>
+
+#include "../integration/plugin.hpp"
+
+using cubos::core::ecs::EntityHash;
+
+using namespace cubos::engine;
+
+CUBOS_DEFINE_TAG(cubos::engine::physicsWakeTag);
+
+namespace
+{
+    /// @brief Summary of the bodies a sleeping body is colliding with, which changes when any of them changes.
+    struct Contacts
+    {
+        std::size_t count{0}; ///< Number of contacts.
+        std::size_t hash{0};  ///< Sum of the hashes of the other bodies, independent of their order.
+    };
+
+    /// @brief Contacts of the sleeping bodies on the last step.
+    struct SleepingContacts
+    {
+        CUBOS_ANONYMOUS_REFLECT(SleepingContacts);
+
+        std::unordered_map<Entity, Contacts, EntityHash> previous; ///< Contacts found on the last step.
+        std::unordered_map<Entity, Contacts, EntityHash> current;  ///< Contacts found on this step.
+    };
+} // namespace
+
+/// @brief Checks whether a body is awake and moving, and thus should wake up the sleeping bodies it touches.
+/// @param sleeping Whether the body is sleeping.
+/// @param timer Sleep timer of the body, if any.
+/// @param mass Mass of the body.
+/// @param solverConstants Solver constants.
+/// @return Whether the body is moving.
+static bool isMoving(bool sleeping, Opt<const SleepTimer&> timer, const Mass& mass,
+                     const SolverConstants& solverConstants)
+{
+    if (sleeping || mass.inverseMass <= solverConstants.minInvMass)
+    {
+        return false;
+    }
+
+    // Bodies which can't sleep are always considered to be moving.
+    return !timer || timer->time == 0.0F;
+}
+
+void cubos::engine::physicsSleepPlugin(Cubos& cubos)
+{
+    cubos.depends(fixedStepPlugin);
+    cubos.depends(collisionsPlugin);
+    cubos.depends(physicsPlugin);
+    cubos.depends(physicsSolverPlugin);
+
+    cubos.resource<SleepingContacts>();
+
+    cubos.tag(physicsWakeTag)
+        .after(physicsApplyForcesTag)
+        .before(physicsApplyImpulsesTag)
+        .before(physicsPrepareSolveTag)
+        .tagged(physicsPrepareTag);
+
+    cubos.observer("reset SleepTimer when a body wakes up")
+        .onRemove<Sleeping>()
+        .call([](Query<SleepTimer&> query) {
+            for (auto [timer] : query)
+            {
+                timer.time = 0.0F;
+            }
+        });
+
+    cubos.system("wake bodies with applied forces")
+        .tagged(physicsWakeTag)
+        .with<Sleeping>()
+        .call([](Commands cmds,
+                 Query<Entity, const Force&, const Torque&, const Impulse&, const AngularImpulse&> query) {
+            for (auto [entity, force, torque, impulse, angImpulse] : query)
+            {
+                if (force.vec() != glm::vec3(0.0F) || force.torque() != glm::vec3(0.0F) ||
+                    torque.vec() != glm::vec3(0.0F) || impulse.vec() != glm::vec3(0.0F) ||
+                    impulse.angularImpulse() != glm::vec3(0.0F) || angImpulse.vec() != glm::vec3(0.0F))
+                {
+                    cmds.remove<Sleeping>(entity);
+                }
+            }
+        });
+
+    cubos.system("wake bodies touched by moving bodies")
+        .tagged(physicsWakeTag)
+        .call([](Commands cmds,
+                 Query<Entity, const Mass&, Opt<const SleepTimer&>, Opt<const Sleeping&>, const CollidingWith&,
+                       Entity, const Mass&, Opt<const SleepTimer&>, Opt<const Sleeping&>>
+                     collisions,
+                 Query<Entity, const Mass&, Opt<const SleepTimer&>, Opt<const Sleeping&>, const DistanceConstraint&,
+                       Entity, const Mass&, Opt<const SleepTimer&>, Opt<const Sleeping&>>
+                     constraints,
+                 const SolverConstants& solverConstants) {
+            auto wake = [&](Entity ent1, const Mass& mass1, Opt<const SleepTimer&> timer1, bool sleeping1, Entity ent2,
+                            const Mass& mass2, Opt<const SleepTimer&> timer2, bool sleeping2) {
+                if (sleeping1 && isMoving(sleeping2, timer2, mass2, solverConstants))
+                {
+                    cmds.remove<Sleeping>(ent1);
+                }
+
+                if (sleeping2 && isMoving(sleeping1, timer1, mass1, solverConstants))
+                {
+                    cmds.remove<Sleeping>(ent2);
+                }
+            };
+
+            for (auto [ent1, mass1, timer1, sleeping1, collidingWith, ent2, mass2, timer2, sleeping2] : collisions)
+            {
+                wake(ent1, mass1, timer1, sleeping1, ent2, mass2, timer2, sleeping2);
+            }
+
+            for (auto [ent1, mass1, timer1, sleeping1, constraint, ent2, mass2, timer2, sleeping2] : constraints)
+            {
+                wake(ent1, mass1, timer1, sleeping1, ent2, mass2, timer2, sleeping2);
+            }
+        });
+
+    // Sleeping bodies never move, and thus they only lose contacts when whatever supports them is removed, moved away
+    // or despawned. Then, they must wake up, or they would be left floating in the air.
+    cubos.system("wake bodies whose contacts changed")
+        .tagged(physicsWakeTag)
+        .call([](Commands cmds, SleepingContacts& contacts, Query<Entity, const Sleeping&> sleeping,
+                 Query<Entity, Opt<const Sleeping&>, const CollidingWith&, Entity, Opt<const Sleeping&>> collisions) {
+            contacts.current.clear();
+            for (auto [entity, sleepingTag] : sleeping)
+            {
+                contacts.current.emplace(entity, Contacts{});
+            }
+
+            auto add = [&](Entity entity, Entity other) {
+                auto& entry = contacts.current[entity];
+                entry.count += 1;
+                entry.hash += EntityHash{}(other);
+            };
+
+            for (auto [ent1, sleeping1, collidingWith, ent2, sleeping2] : collisions)
+            {
+                if (sleeping1)
+                {
+                    add(ent1, ent2);
+                }
+
+                if (sleeping2)
+                {
+                    add(ent2, ent1);
+                }
+            }
+
+            for (const auto& [entity, entry] : contacts.current)
+            {
+                // Bodies which only fell asleep on the last step don't have previous contacts to compare to yet.
+                auto it = contacts.previous.find(entity);
+                if (it != contacts.previous.end() && (it->second.count != entry.count || it->second.hash != entry.hash))
+                {
+                    cmds.remove<Sleeping>(entity);
+                }
+            }
+
+            std::swap(contacts.previous, contacts.current);
+        });
+
+    cubos.system("put resting bodies to sleep")
+        .after(physicsFinalizePositionTag)
+        .tagged(fixedStepTag)
+        .without<Sleeping>()
+        .call([](Commands cmds, Query<Entity, SleepTimer&, Velocity&, AngularVelocity&, const Mass&> query,
+                 const FixedDeltaTime& fixedDeltaTime, const SolverConstants& solverConstants) {
+            for (auto [entity, timer, velocity, angVelocity, mass] : query)
+            {
+                if (mass.inverseMass <= solverConstants.minInvMass)
+                {
+                    continue;
+                }
+
+                if (glm::length(velocity.vec) > solverConstants.sleepLinearSpeed ||
+                    glm::length(angVelocity.vec) > solverConstants.sleepAngularSpeed)
+                {
+                    timer.time = 0.0F;
+                    continue;
+                }
+
+                timer.time += fixedDeltaTime.value;
+                if (timer.time >= solverConstants.sleepTime)
+                {
+                    velocity.vec = glm::vec3(0.0F);
+                    angVelocity.vec = glm::vec3(0.0F);
+                    cmds.add(entity, Sleeping{});
+                }
+            }
+        });
+}
@@ -0,0 +1,21 @@
+/// @file
+/// @brief Sleep plugin.
+/// @ingroup physics-solver-plugin
+
+#pragma once
+
+#include <cubos/engine/prelude.hpp>
+
+namespace cubos::engine
+{
+    /// @ingroup physics-solver-plugin
+    /// @brief Puts bodies which have been at rest for a while to sleep, and wakes them up when they're disturbed.
+
+    /// @brief Systems with this tag wake up sleeping bodies before forces, impulses and constraints are applied.
+    extern Tag physicsWakeTag;
+
+    /// @brief Plugin entry function.
+    /// @param cubos @b Cubos main class
+    /// @ingroup physics-solver-plugin
+    void physicsSleepPlugin(Cubos& cubos);
+} // namespace cubos::engine
@@ -0,0 +1,70 @@
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cubos/core/geom/aabb.hpp>
+
+#include <cubos/engine/render/camera/camera.hpp>
+#include <cubos/engine/render/camera/plugin.hpp>
+#include <cubos/engine/render/culling/plugin.hpp>
+#include <cubos/engine/render/culling/visible_meshes.hpp>
+#include <cubos/engine/render/mesh/mesh.hpp>
+#include <cubos/engine/render/mesh/plugin.hpp>
+#include <cubos/engine/render/voxels/grid.hpp>
+#include <cubos/engine/render/voxels/plugin.hpp>
+#include <cubos/engine/transform/local_to_world.hpp>
+#include <cubos/engine/transform/plugin.hpp>
+
+using cubos::core::geom::AABB;
+
+CUBOS_DEFINE_TAG(cubos::engine::cullRenderMeshesTag);
+
+void cubos::engine::renderCullingPlugin(Cubos& cubos)
+{
+    cubos.depends(transformPlugin);
+    cubos.depends(cameraPlugin);
+    cubos.depends(renderMeshPlugin);
+    cubos.depends(renderVoxelsPlugin);
+
+    cubos.resource<VisibleRenderMeshes>();
+
+    cubos.tag(cullRenderMeshesTag).after(transformUpdateTag);
+
+    // Meshes are removed from the resource as soon as they stop being meshes, so that it never refers to entities
+    // which no longer exist.
+    auto removeMesh = [](Query<Entity> query, VisibleRenderMeshes& visible) {
+        for (auto [ent] : query)
+        {
+            visible.remove(ent);
+        }
+    };
+    cubos.observer("remove culled mesh without RenderMesh").onRemove<RenderMesh>().call(removeMesh);
+    cubos.observer("remove culled mesh without RenderVoxelGrid").onRemove<RenderVoxelGrid>().call(removeMesh);
+    cubos.observer("remove culled mesh without LocalToWorld").onRemove<LocalToWorld>().call(removeMesh);
+
+    cubos.system("cull render meshes")
+        .tagged(cullRenderMeshesTag)
+        .anyChanged<LocalToWorld>()
+        .anyChanged<RenderMesh>()
+        .anyChanged<RenderVoxelGrid>()
+        .call([](Query<Entity, const LocalToWorld&, const RenderMesh&, const RenderVoxelGrid&> changedMeshes,
+                 Query<Entity, const Camera&> cameras, VisibleRenderMeshes& visible) {
+            // Only meshes which were added, moved or rebuilt since the last frame have their transforms and bounds
+            // recomputed, for every pass to use, and are updated in the spatial index.
+            for (auto [ent, localToWorld, mesh, grid] : changedMeshes)
+            {
+                auto transform = localToWorld.mat * glm::translate(glm::mat4(1.0F), grid.offset);
+                visible.update({.entity = ent,
+                                .firstBucketId = mesh.firstBucketId,
+                                .model = transform * glm::translate(glm::mat4(1.0F), mesh.baseOffset)},
+                               AABB::fromOBB(mesh.boundingBox, transform));
+            }
+
+            visible.clearCameras();
+            for (auto [ent, camera] : cameras)
+            {
+                if (camera.active)
+                {
+                    visible.cullCamera(ent, camera.frustum);
+                }
+            }
+        });
+}
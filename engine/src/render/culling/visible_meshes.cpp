@@ -0,0 +1,119 @@
+#include <cubos/core/ecs/reflection.hpp>
+
+#include <cubos/engine/render/culling/visible_meshes.hpp>
+
+using cubos::core::ecs::Entity;
+using cubos::core::geom::AABB;
+using cubos::core::geom::Frustum;
+using cubos::core::geom::Plane;
+using cubos::engine::VisibleRenderMeshes;
+
+CUBOS_REFLECT_IMPL(VisibleRenderMeshes)
+{
+    return core::ecs::TypeBuilder<VisibleRenderMeshes>("cubos::engine::VisibleRenderMeshes").build();
+}
+
+/// @brief Extracts a plane of the view volume of a view-projection matrix.
+/// @param viewProj View-projection matrix.
+/// @param row Clip space axis the plane bounds.
+/// @param sign 1 for the plane on the negative side of the axis, -1 for the plane on the positive side.
+/// @return World-space plane, facing the inside of the view volume.
+static Plane extractPlane(const glm::mat4& viewProj, int row, float sign)
+{
+    glm::vec4 coefficients{};
+    for (int i = 0; i < 4; ++i)
+    {
+        coefficients[i] = viewProj[i][3] + sign * viewProj[i][row];
+    }
+    return {.normal = glm::vec3(coefficients), .d = coefficients.w};
+}
+
+void VisibleRenderMeshes::update(const Mesh& mesh, const AABB& bounds)
+{
+    auto it = mProxies.find(mesh.entity);
+    if (it == mProxies.end())
+    {
+        auto index = mMeshes.size();
+        mMeshes.push_back(mesh);
+        mProxies.emplace(mesh.entity, Proxy{.leaf = mTree.insert(bounds, index), .index = index});
+        return;
+    }
+
+    // Meshes which stayed inside their previous bounds don't change the tree at all.
+    mMeshes[it->second.index] = mesh;
+    mTree.move(it->second.leaf, bounds);
+}
+
+void VisibleRenderMeshes::remove(Entity entity)
+{
+    auto it = mProxies.find(entity);
+    if (it == mProxies.end())
+    {
+        return;
+    }
+
+    // Move the last mesh into the place of the removed one, so that the others keep their indices.
+    auto index = it->second.index;
+    mTree.remove(it->second.leaf);
+    mProxies.erase(it);
+    if (index != mMeshes.size() - 1)
+    {
+        mMeshes[index] = mMeshes.back();
+        auto& moved = mProxies.at(mMeshes[index].entity);
+        moved.index = index;
+        mTree.value(moved.leaf, index);
+    }
+    mMeshes.pop_back();
+}
+
+void VisibleRenderMeshes::clearCameras()
+{
+    mCameras.clear();
+}
+
+const std::vector<VisibleRenderMeshes::Mesh>& VisibleRenderMeshes::meshes() const
+{
+    return mMeshes;
+}
+
+void VisibleRenderMeshes::cull(const Frustum& frustum, std::vector<std::size_t>& visible) const
+{
+    visible.clear();
+    mTree.query(frustum, visible);
+}
+
+void VisibleRenderMeshes::cull(const glm::mat4& viewProj, std::vector<std::size_t>& visible) const
+{
+    this->cull(Frustum{.top = extractPlane(viewProj, 1, -1.0F),
+                       .right = extractPlane(viewProj, 0, -1.0F),
+                       .bottom = extractPlane(viewProj, 1, 1.0F),
+                       .left = extractPlane(viewProj, 0, 1.0F),
+                       .near = extractPlane(viewProj, 2, 1.0F),
+                       .far = extractPlane(viewProj, 2, -1.0F)},
+               visible);
+}
+
+void VisibleRenderMeshes::query(const AABB& aabb, std::vector<std::size_t>& found) const
+{
+    found.clear();
+    mTree.query(aabb, found);
+}
+
+void VisibleRenderMeshes::query(const glm::vec3& center, float radius, std::vector<std::size_t>& found) const
+{
+    found.clear();
+    mTree.query(center, radius, found);
+}
+
+void VisibleRenderMeshes::cullCamera(Entity camera, const Frustum& frustum)
+{
+    this->cull(frustum, mCameras[camera]);
+}
+
+const std::vector<std::size_t>& VisibleRenderMeshes::camera(Entity camera) const
+{
+    static const std::vector<std::size_t> None{};
+
+    auto it = mCameras.find(camera);
+    return it == mCameras.end() ? None : it->second;
+}
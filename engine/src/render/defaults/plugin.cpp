@@ -1,5 +1,6 @@
 #include <cubos/engine/render/bloom/plugin.hpp>
 #include <cubos/engine/render/camera/plugin.hpp>
+#include <cubos/engine/render/culling/plugin.hpp>
 #include <cubos/engine/render/defaults/plugin.hpp>
 #include <cubos/engine/render/defaults/target.hpp>
 #include <cubos/engine/render/deferred_shading/plugin.hpp>
@@ -51,13 +52,14 @@ void cubos::engine::renderDefaultsPlugin(Cubos& cubos)
     cubos.plugin(shadowAtlasPlugin);
     cubos.plugin(cascadedShadowMapsPlugin);
 
-    cubos.plugin(gBufferRasterizerPlugin);
+    cubos.plugin(renderCullingPlugin);
     cubos.plugin(ssaoPlugin);
     cubos.plugin(toneMappingPlugin);
     cubos.plugin(bloomPlugin);
+
+    cubos.plugin(gBufferRasterizerPlugin);
     cubos.plugin(shadowAtlasRasterizerPlugin);
     cubos.plugin(cascadedShadowMapsRasterizerPlugin);
-
     cubos.plugin(deferredShadingPlugin);
 
     cubos.component<RenderTargetDefaults>();
@@ -1,4 +1,6 @@
-#include <cubos/core/geom/intersections.hpp>
+#include <algorithm>
+#include <vector>
+
 #include <cubos/core/io/window.hpp>
 #include <cubos/core/reflection/external/uuid.hpp>
 #include <cubos/core/tel/metrics.hpp>
@@ -7,13 +9,14 @@
 #include <cubos/engine/render/camera/camera.hpp>
 #include <cubos/engine/render/camera/draws_to.hpp>
 #include <cubos/engine/render/camera/plugin.hpp>
+#include <cubos/engine/render/culling/plugin.hpp>
+#include <cubos/engine/render/culling/visible_meshes.hpp>
 #include <cubos/engine/render/depth/depth.hpp>
 #include <cubos/engine/render/depth/plugin.hpp>
 #include <cubos/engine/render/g_buffer/g_buffer.hpp>
 #include <cubos/engine/render/g_buffer/plugin.hpp>
 #include <cubos/engine/render/g_buffer_rasterizer/g_buffer_rasterizer.hpp>
 #include <cubos/engine/render/g_buffer_rasterizer/plugin.hpp>
-#include <cubos/engine/render/mesh/mesh.hpp>
 #include <cubos/engine/render/mesh/plugin.hpp>
 #include <cubos/engine/render/mesh/pool.hpp>
 #include <cubos/engine/render/picker/picker.hpp>
@@ -21,14 +24,12 @@
 #include <cubos/engine/render/profiling/plugin.hpp>
 #include <cubos/engine/render/profiling/profiler.hpp>
 #include <cubos/engine/render/shader/plugin.hpp>
-#include <cubos/engine/render/voxels/grid.hpp>
 #include <cubos/engine/render/voxels/palette.hpp>
 #include <cubos/engine/render/voxels/plugin.hpp>
 #include <cubos/engine/transform/plugin.hpp>
 #include <cubos/engine/window/plugin.hpp>
 
 using namespace cubos::core::gl;
-using cubos::core::geom::Box;
 using cubos::core::io::Window;
 using cubos::engine::Asset;
 using cubos::engine::RenderMeshVertex;
@@ -44,12 +45,43 @@ namespace
         glm::mat4 viewProj;
     };
 
-    // Holds the data sent per mesh to the GPU.
-    struct PerMesh
+    // Number of instances stored on each row of the instances texture.
+    constexpr std::size_t InstancesPerRow = 256;
+
+    // Number of texels each instance takes on the instances texture.
+    constexpr std::size_t TexelsPerInstance = 4;
+
+    // Holds the data sent per mesh instance to the GPU, as texels of the instances texture.
+    struct PerInstance
+    {
+        glm::vec4 rows[3]; // First three rows of the model matrix, as the last one is always (0, 0, 0, 1).
+        glm::vec4 picker;  // High and low 16 bits of the picker identifier, in the first two components.
+    };
+
+    // Instances which share the same mesh, and thus can be drawn with a single draw call per bucket.
+    struct InstanceGroup
+    {
+        RenderMeshPool::BucketId firstBucketId;
+        int offset;
+        std::size_t count;
+    };
+
+    // Draws a camera must issue, found before anything is drawn so that the instances are uploaded only once.
+    struct CameraDraws
+    {
+        cubos::engine::Entity target;
+        glm::mat4 viewProj;
+        glm::vec2 viewportOffset;
+        glm::vec2 viewportSize;
+        std::size_t firstGroup;
+        std::size_t groupCount;
+    };
+
+    // Mesh instance seen by a camera, before being grouped by mesh.
+    struct VisibleInstance
     {
-        glm::mat4 model;
-        glm::uint32_t picker;
-        glm::uint32_t padding[3];
+        RenderMeshPool::BucketId firstBucketId;
+        PerInstance data;
     };
 
     struct State
@@ -59,19 +91,29 @@ namespace
         ShaderPipeline pipeline;
         ShaderPipeline pipelineWithPicker;
         ShaderBindingPoint perSceneBP;
-        ShaderBindingPoint perMeshBP;
+        ShaderBindingPoint instancesBP;
+        ShaderBindingPoint instanceOffsetBP;
         ShaderBindingPoint paletteBP;
         ShaderBindingPoint perSceneWithPickerBP;
-        ShaderBindingPoint perMeshWithPickerBP;
+        ShaderBindingPoint instancesWithPickerBP;
+        ShaderBindingPoint instanceOffsetWithPickerBP;
         ShaderBindingPoint paletteWithPickerBP;
 
         RasterState rasterState;
         DepthStencilState depthStencilState;
 
-        VertexArray vertexArray;
+        std::vector<VertexArray> vertexArrays;
 
         ConstantBuffer perSceneCB;
-        ConstantBuffer perMeshCB;
+
+        Texture2D instancesTexture;
+        std::size_t instancesTextureRows{0};
+
+        // Buffers reused across frames to avoid reallocating them.
+        std::vector<VisibleInstance> visible;
+        std::vector<PerInstance> instances;
+        std::vector<InstanceGroup> groups;
+        std::vector<CameraDraws> cameraDraws;
 
         Texture2D paletteTexture;
         Asset<VoxelPalette> paletteAsset{};
@@ -79,19 +121,21 @@ namespace
         PipelinedTimer timer;
 
         State(RenderDevice& renderDevice, const ShaderPipeline& pipeline, const ShaderPipeline& pipelineWithPicker,
-              VertexBuffer vertexBuffer)
+              const RenderMeshPool& pool)
             : pipeline(pipeline)
             , pipelineWithPicker(pipelineWithPicker)
         {
             perSceneBP = pipeline->getBindingPoint("PerScene");
-            perMeshBP = pipeline->getBindingPoint("PerMesh");
+            instancesBP = pipeline->getBindingPoint("instances");
+            instanceOffsetBP = pipeline->getBindingPoint("instanceOffset");
             paletteBP = pipeline->getBindingPoint("palette");
             perSceneWithPickerBP = pipelineWithPicker->getBindingPoint("PerScene");
-            perMeshWithPickerBP = pipelineWithPicker->getBindingPoint("PerMesh");
+            instancesWithPickerBP = pipelineWithPicker->getBindingPoint("instances");
+            instanceOffsetWithPickerBP = pipelineWithPicker->getBindingPoint("instanceOffset");
             paletteWithPickerBP = pipelineWithPicker->getBindingPoint("palette");
-            CUBOS_ASSERT(perSceneBP && perMeshBP && paletteBP && perSceneWithPickerBP && perMeshWithPickerBP &&
-                             paletteWithPickerBP,
-                         "PerScene, PerMesh and palette binding points must exist");
+            CUBOS_ASSERT(perSceneBP && instancesBP && instanceOffsetBP && paletteBP && perSceneWithPickerBP &&
+                             instancesWithPickerBP && instanceOffsetWithPickerBP && paletteWithPickerBP,
+                         "PerScene, instances, instanceOffset and palette binding points must exist");
 
             rasterState = renderDevice.createRasterState({
                 .cullEnabled = true,
@@ -105,12 +149,10 @@ namespace
 
             VertexArrayDesc desc{};
             CUBOS_ASSERT(RenderMeshVertex::addVertexElements("position", "normal", "material", 0, desc));
-            desc.buffers[0] = cubos::core::memory::move(vertexBuffer);
             desc.shaderPipeline = pipeline;
-            vertexArray = renderDevice.createVertexArray(desc);
+            vertexArrays = pool.createVertexArrays(renderDevice, desc, 0);
 
             perSceneCB = renderDevice.createConstantBuffer(sizeof(PerScene), nullptr, Usage::Dynamic);
-            perMeshCB = renderDevice.createConstantBuffer(sizeof(PerMesh), nullptr, Usage::Dynamic);
 
             paletteTexture = renderDevice.createTexture2D({
                 .width = 256,
@@ -124,6 +166,33 @@ namespace
     };
 } // namespace
 
+/// @brief Uploads the given instances to the instances texture, growing it if needed.
+/// @param rd Render device.
+/// @param state Rasterizer state.
+static void uploadInstances(RenderDevice& rd, State& state)
+{
+    auto rows = (state.instances.size() + InstancesPerRow - 1) / InstancesPerRow;
+    if (rows == 0)
+    {
+        return;
+    }
+
+    if (rows > state.instancesTextureRows)
+    {
+        state.instancesTextureRows = std::bit_ceil(rows);
+        state.instancesTexture = rd.createTexture2D({
+            .width = InstancesPerRow * TexelsPerInstance,
+            .height = state.instancesTextureRows,
+            .usage = Usage::Dynamic,
+            .format = TextureFormat::RGBA32Float,
+        });
+    }
+
+    // Only whole rows can be uploaded, so the last one is padded.
+    state.instances.resize(rows * InstancesPerRow);
+    state.instancesTexture->update(0, 0, InstancesPerRow * TexelsPerInstance, rows, state.instances.data());
+}
+
 void cubos::engine::gBufferRasterizerPlugin(Cubos& cubos)
 {
     static const Asset<Shader> VertexShader = AnyAsset("ae55f7c5-c2a1-432e-b0de-386079517565");
@@ -139,9 +208,11 @@ void cubos::engine::gBufferRasterizerPlugin(Cubos& cubos)
     cubos.depends(renderMeshPlugin);
     cubos.depends(renderVoxelsPlugin);
     cubos.depends(cameraPlugin);
+    cubos.depends(renderCullingPlugin);
     cubos.depends(renderProfilingPlugin);
 
     cubos.tag(rasterizeToGBufferTag)
+        .after(cullRenderMeshesTag)
         .tagged(drawToGBufferTag)
         .tagged(drawToRenderPickerTag)
         .tagged(drawToRenderDepthTag);
@@ -166,7 +237,7 @@ void cubos::engine::gBufferRasterizerPlugin(Cubos& cubos)
             auto psWithPicker = psAsset->builder().with("RENDER_PICKER").build();
 
             cmds.emplaceResource<State>(rd, rd.createShaderPipeline(vs, ps),
-                                        rd.createShaderPipeline(vsWithPicker, psWithPicker), pool.vertexBuffer());
+                                        rd.createShaderPipeline(vsWithPicker, psWithPicker), pool);
         });
 
     cubos.system("rasterize to GBuffer")
@@ -174,10 +245,9 @@ void cubos::engine::gBufferRasterizerPlugin(Cubos& cubos)
         .with<Camera>()
         .related<DrawsTo>()
         .call([](State& state, const Window& window, const RenderMeshPool& pool, const RenderPalette& palette,
-                 Assets& assets, const RenderProfiler& profiler,
-                 Query<const LocalToWorld&, Camera&, const DrawsTo&> cameras,
-                 Query<Entity, GBufferRasterizer&, GBuffer&, RenderDepth&, Opt<RenderPicker&>> targets,
-                 Query<Entity, const LocalToWorld&, const RenderMesh&, const RenderVoxelGrid&> meshes) {
+                 Assets& assets, const RenderProfiler& profiler, const VisibleRenderMeshes& visibleMeshes,
+                 Query<Entity, const LocalToWorld&, Camera&, const DrawsTo&> cameras,
+                 Query<Entity, GBufferRasterizer&, GBuffer&, RenderDepth&, Opt<RenderPicker&>> targets) {
             auto& rd = window->renderDevice();
 
             if (profiler.profilingEnabled)
@@ -210,6 +280,64 @@ void cubos::engine::gBufferRasterizerPlugin(Cubos& cubos)
                 CUBOS_INFO("Updated GBufferRasterizer's palette texture to asset {}", state.paletteAsset.getIdString());
             }
 
+            // Find the meshes seen by each active camera, and group them by mesh, so that all instances of the same
+            // mesh are drawn at once. The instances of all cameras are then uploaded together.
+            state.instances.clear();
+            state.groups.clear();
+            state.cameraDraws.clear();
+            for (auto [ent, rasterizer, gBuffer, depth, picker] : targets)
+            {
+                for (auto [cameraEnt, cameraLocalToWorld, camera, drawsTo] : cameras.pin(1, ent))
+                {
+                    // Skip inactive cameras.
+                    if (!camera.active)
+                    {
+                        continue;
+                    }
+
+                    state.visible.clear();
+                    for (auto index : visibleMeshes.camera(cameraEnt))
+                    {
+                        const auto& mesh = visibleMeshes.meshes()[index];
+                        auto model = glm::transpose(mesh.model);
+                        state.visible.push_back({
+                            .firstBucketId = mesh.firstBucketId,
+                            .data = {.rows = {model[0], model[1], model[2]},
+                                     .picker = {static_cast<float>(mesh.entity.index >> 16U),
+                                                static_cast<float>(mesh.entity.index & 0xFFFFU), 0.0F, 0.0F}},
+                        });
+                    }
+
+                    std::sort(state.visible.begin(), state.visible.end(), [](const auto& a, const auto& b) {
+                        return a.firstBucketId.inner < b.firstBucketId.inner;
+                    });
+
+                    auto firstGroup = state.groups.size();
+                    for (const auto& instance : state.visible)
+                    {
+                        if (state.groups.size() == firstGroup ||
+                            state.groups.back().firstBucketId != instance.firstBucketId)
+                        {
+                            state.groups.push_back({.firstBucketId = instance.firstBucketId,
+                                                    .offset = static_cast<int>(state.instances.size()),
+                                                    .count = 0});
+                        }
+
+                        state.groups.back().count += 1;
+                        state.instances.push_back(instance.data);
+                    }
+
+                    state.cameraDraws.push_back({.target = ent,
+                                                 .viewProj = camera.projection * glm::inverse(cameraLocalToWorld.mat),
+                                                 .viewportOffset = drawsTo.viewportOffset,
+                                                 .viewportSize = drawsTo.viewportSize,
+                                                 .firstGroup = firstGroup,
+                                                 .groupCount = state.groups.size() - firstGroup});
+                }
+            }
+
+            uploadInstances(rd, state);
+
             for (auto [ent, rasterizer, gBuffer, depth, picker] : targets)
             {
                 // Check if we need to recreate the framebuffer.
@@ -278,62 +406,57 @@ void cubos::engine::gBufferRasterizerPlugin(Cubos& cubos)
                     picker.value().cleared = true;
                 }
 
-                // Find the active cameras for this target.
-                for (auto [cameraLocalToWorld, camera, drawsTo] : cameras.pin(1, ent))
+                // Issue the draws of the cameras which draw to this target.
+                for (const auto& draws : state.cameraDraws)
                 {
-                    // Skip inactive cameras.
-                    if (!camera.active)
+                    if (draws.target != ent)
                     {
                         continue;
                     }
 
                     // Send the PerScene data to the GPU.
-                    auto view = glm::inverse(cameraLocalToWorld.mat);
-                    auto proj = camera.projection;
-                    PerScene perScene{.viewProj = proj * view};
+                    PerScene perScene{.viewProj = draws.viewProj};
                     state.perSceneCB->fill(&perScene, sizeof(perScene));
 
                     // Set the viewport.
-                    rd.setViewport(static_cast<int>(drawsTo.viewportOffset.x * float(gBuffer.size.x)),
-                                   static_cast<int>(drawsTo.viewportOffset.y * float(gBuffer.size.y)),
-                                   static_cast<int>(drawsTo.viewportSize.x * float(gBuffer.size.x)),
-                                   static_cast<int>(drawsTo.viewportSize.y * float(gBuffer.size.y)));
-                    rd.setScissor(static_cast<int>(drawsTo.viewportOffset.x * float(gBuffer.size.x)),
-                                  static_cast<int>(drawsTo.viewportOffset.y * float(gBuffer.size.y)),
-                                  static_cast<int>(drawsTo.viewportSize.x * float(gBuffer.size.x)),
-                                  static_cast<int>(drawsTo.viewportSize.y * float(gBuffer.size.y)));
-                    // Bind the shader, vertex array and uniform buffer.
+                    rd.setViewport(static_cast<int>(draws.viewportOffset.x * float(gBuffer.size.x)),
+                                   static_cast<int>(draws.viewportOffset.y * float(gBuffer.size.y)),
+                                   static_cast<int>(draws.viewportSize.x * float(gBuffer.size.x)),
+                                   static_cast<int>(draws.viewportSize.y * float(gBuffer.size.y)));
+                    rd.setScissor(static_cast<int>(draws.viewportOffset.x * float(gBuffer.size.x)),
+                                  static_cast<int>(draws.viewportOffset.y * float(gBuffer.size.y)),
+                                  static_cast<int>(draws.viewportSize.x * float(gBuffer.size.x)),
+                                  static_cast<int>(draws.viewportSize.y * float(gBuffer.size.y)));
+                    // Bind the shader, uniform buffer and textures.
                     rd.setShaderPipeline(picker.contains() ? state.pipelineWithPicker : state.pipeline);
-                    rd.setVertexArray(state.vertexArray);
+                    ShaderBindingPoint instanceOffsetBP;
                     if (picker.contains())
                     {
                         state.perSceneWithPickerBP->bind(state.perSceneCB);
-                        state.perMeshWithPickerBP->bind(state.perMeshCB);
+                        state.instancesWithPickerBP->bind(state.instancesTexture);
                         state.paletteWithPickerBP->bind(state.paletteTexture);
+                        instanceOffsetBP = state.instanceOffsetWithPickerBP;
                     }
                     else
                     {
                         state.perSceneBP->bind(state.perSceneCB);
-                        state.perMeshBP->bind(state.perMeshCB);
+                        state.instancesBP->bind(state.instancesTexture);
                         state.paletteBP->bind(state.paletteTexture);
+                        instanceOffsetBP = state.instanceOffsetBP;
                     }
 
-                    // Iterate over all mesh buckets and issue draw calls.
-                    for (auto [meshEnt, meshLocalToWorld, mesh, grid] : meshes)
+                    // Draw all instances of each mesh at once, with a draw call for each of the buckets of the mesh.
+                    for (std::size_t i = draws.firstGroup; i < draws.firstGroup + draws.groupCount; ++i)
                     {
-                        auto transformWithOffset = meshLocalToWorld.mat * glm::translate(glm::mat4(1.0F), grid.offset);
-                        auto transformForMesh = transformWithOffset * glm::translate(glm::mat4(1.0F), mesh.baseOffset);
-                        PerMesh perMesh{.model = transformForMesh, .picker = meshEnt.index, .padding = {}};
-                        state.perMeshCB->fill(&perMesh, sizeof(perMesh));
-                        auto voxelGrid = assets.read(grid.asset);
-                        if (cubos::core::geom::intersects(camera.frustum, mesh.boundingBox, transformWithOffset))
+                        const auto& group = state.groups[i];
+                        instanceOffsetBP->setConstant(group.offset);
+                        for (auto bucket = group.firstBucketId; bucket != RenderMeshPool::BucketId::Invalid;
+                             bucket = pool.next(bucket))
                         {
-                            // Iterate over the buckets of the mesh (it may be split over many of them).
-                            for (auto bucket = mesh.firstBucketId; bucket != RenderMeshPool::BucketId::Invalid;
-                                 bucket = pool.next(bucket))
-                            {
-                                rd.drawTriangles(pool.bucketSize() * bucket.inner, pool.vertexCount(bucket));
-                            }
+                            // Each bucket has its own vertex array, which keeps its own index buffer binding.
+                            rd.setVertexArray(state.vertexArrays[bucket.inner]);
+                            rd.setIndexBuffer(pool.indexBuffer());
+                            rd.drawTrianglesIndexedInstanced(0, pool.indexCount(bucket), group.count);
                         }
                     }
                 }
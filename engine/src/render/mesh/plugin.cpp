@@ -73,7 +73,7 @@ void cubos::engine::renderMeshPlugin(Cubos& cubos)
             cmds.emplaceResource<RenderMeshPool>(
                 window->renderDevice(),
                 static_cast<std::size_t>(settings.getInteger("renderMeshPool.bucketCount", 1024)),
-                static_cast<std::size_t>(settings.getInteger("renderMeshPool.bucketSize", 1024 * 6)));
+                static_cast<std::size_t>(settings.getInteger("renderMeshPool.bucketSize", 1024 * 4)));
 
             cmds.emplaceResource<State>(static_cast<std::size_t>(settings.getInteger("renderMeshPool.threadCount", 1)));
         });
@@ -1,4 +1,6 @@
+#include <cstdint>
 #include <cstring>
+#include <vector>
 
 #include <cubos/core/reflection/external/primitives.hpp>
 #include <cubos/core/reflection/traits/constructible.hpp>
@@ -7,12 +9,17 @@
 
 #include <cubos/engine/render/mesh/pool.hpp>
 
+using cubos::core::gl::IndexBuffer;
+using cubos::core::gl::IndexFormat;
 using cubos::core::gl::RenderDevice;
 using cubos::core::gl::Usage;
+using cubos::core::gl::VertexArray;
+using cubos::core::gl::VertexArrayDesc;
 using cubos::core::gl::VertexBuffer;
 using cubos::core::reflection::ConstructibleTrait;
 using cubos::core::reflection::Type;
 using cubos::engine::RenderMeshPool;
+using cubos::engine::RenderMeshVertex;
 
 const RenderMeshPool::BucketId RenderMeshPool::BucketId::Invalid{};
 
@@ -25,7 +32,10 @@ RenderMeshPool::RenderMeshPool(RenderDevice& renderDevice, std::size_t bucketCou
     : mBucketCount{bucketCount}
     , mBucketSize{bucketSize}
 {
-    CUBOS_ASSERT(bucketSize % 3 == 0, "Bucket size must be a multiple of 3 (to store whole triangles)");
+    CUBOS_ASSERT(bucketSize % RenderMeshVertex::VerticesPerQuad == 0,
+                 "Bucket size must be a multiple of {} (to store whole quads)", RenderMeshVertex::VerticesPerQuad);
+    CUBOS_ASSERT(bucketSize <= UINT16_MAX + 1, "Bucket size must be at most {} (to use 16 bit indices)",
+                 UINT16_MAX + 1);
 
     mVertexBuffer =
         renderDevice.createVertexBuffer(bucketCount * bucketSize * sizeof(RenderMeshVertex), nullptr, Usage::Dynamic);
@@ -35,6 +45,28 @@ RenderMeshPool::RenderMeshPool(RenderDevice& renderDevice, std::size_t bucketCou
         CUBOS_ERROR("Failed to create vertex buffer for render mesh pool with {} buckets, each of size {} (vertices)",
                     bucketCount, bucketSize);
     }
+    else
+    {
+        // The indices are relative to the start of each bucket, and thus the same for every bucket.
+        auto quadCount = mBucketSize / RenderMeshVertex::VerticesPerQuad;
+        std::vector<uint16_t> indices(quadCount * RenderMeshVertex::IndicesPerQuad);
+        for (std::size_t quad = 0; quad < quadCount; ++quad)
+        {
+            for (std::size_t i = 0; i < RenderMeshVertex::IndicesPerQuad; ++i)
+            {
+                indices[quad * RenderMeshVertex::IndicesPerQuad + i] =
+                    static_cast<uint16_t>(quad * RenderMeshVertex::VerticesPerQuad + RenderMeshVertex::QuadIndices[i]);
+            }
+        }
+
+        mIndexBuffer = renderDevice.createIndexBuffer(indices.size() * sizeof(uint16_t), indices.data(),
+                                                      IndexFormat::UShort, Usage::Static);
+        if (mIndexBuffer == nullptr)
+        {
+            mBucketCount = 0;
+            CUBOS_ERROR("Failed to create index buffer for render mesh pool with {} quads per bucket", quadCount);
+        }
+    }
 
     mBuckets.resize(mBucketCount);
     for (std::size_t i = 0; i < mBucketCount; ++i)
@@ -63,8 +95,43 @@ VertexBuffer RenderMeshPool::vertexBuffer() const
     return mVertexBuffer;
 }
 
+IndexBuffer RenderMeshPool::indexBuffer() const
+{
+    return mIndexBuffer;
+}
+
+std::vector<VertexArray> RenderMeshPool::createVertexArrays(RenderDevice& renderDevice, VertexArrayDesc desc,
+                                                           std::size_t bufferIndex) const
+{
+    desc.buffers[bufferIndex] = mVertexBuffer;
+
+    std::vector<VertexArray> vertexArrays(mBucketCount);
+    for (std::size_t bucket = 0; bucket < mBucketCount; ++bucket)
+    {
+        auto bucketDesc = desc;
+        for (std::size_t i = 0; i < bucketDesc.elementCount; ++i)
+        {
+            if (bucketDesc.elements[i].buffer.index == bufferIndex)
+            {
+                bucketDesc.elements[i].buffer.offset += bucket * mBucketSize * sizeof(RenderMeshVertex);
+            }
+        }
+
+        vertexArrays[bucket] = renderDevice.createVertexArray(bucketDesc);
+        if (vertexArrays[bucket] == nullptr)
+        {
+            CUBOS_ERROR("Failed to create vertex array for bucket {} of render mesh pool", bucket);
+            return {};
+        }
+    }
+
+    return vertexArrays;
+}
+
 auto RenderMeshPool::allocate(const RenderMeshVertex* vertices, std::size_t count) -> BucketId
 {
+    CUBOS_ASSERT(count % RenderMeshVertex::VerticesPerQuad == 0, "Meshes must be made of whole quads");
+
     // Check if there are enough buckets first.
     auto neededBucketCount = (count + mBucketSize - 1) / mBucketSize;
     auto freeBucketCount = this->freeBucketCount();
@@ -122,6 +189,11 @@ std::size_t RenderMeshPool::vertexCount(BucketId bucketId) const
     return mBuckets[bucketId.inner].size;
 }
 
+std::size_t RenderMeshPool::indexCount(BucketId bucketId) const
+{
+    return mBuckets[bucketId.inner].size / RenderMeshVertex::VerticesPerQuad * RenderMeshVertex::IndicesPerQuad;
+}
+
 auto RenderMeshPool::next(BucketId bucketId) const -> BucketId
 {
     return mBuckets[bucketId.inner].nextId;
@@ -161,7 +161,7 @@ void RenderMeshVertex::generate(const VoxelGrid& grid, std::vector<RenderMeshVer
                                 }
 
                                 auto vi = vertices.size();
-                                vertices.resize(vi + 6, RenderMeshVertex{
+                                vertices.resize(vi + 4, RenderMeshVertex{
                                                             .position = {},
                                                             .normal = normal,
                                                             .material = static_cast<uint32_t>(mask[n]),
@@ -170,14 +170,12 @@ void RenderMeshVertex::generate(const VoxelGrid& grid, std::vector<RenderMeshVer
                                 vertices[vi + 0].position = static_cast<glm::u8vec3>(x);
                                 vertices[vi + 1].position = static_cast<glm::u8vec3>(x) + du;
                                 vertices[vi + 2].position = static_cast<glm::u8vec3>(x) + du + dv;
-                                vertices[vi + 3].position = static_cast<glm::u8vec3>(x) + du + dv;
-                                vertices[vi + 4].position = static_cast<glm::u8vec3>(x) + dv;
-                                vertices[vi + 5].position = static_cast<glm::u8vec3>(x);
+                                vertices[vi + 3].position = static_cast<glm::u8vec3>(x) + dv;
 
+                                // Reverse the winding of back faces.
                                 if (backFace)
                                 {
-                                    std::swap(vertices[vi + 1].position, vertices[vi + 2].position);
-                                    std::swap(vertices[vi + 3].position, vertices[vi + 4].position);
+                                    std::swap(vertices[vi + 1].position, vertices[vi + 3].position);
                                 }
                             }
 
@@ -1,12 +1,15 @@
+#include <vector>
+
 #include <cubos/core/geom/utils.hpp>
 #include <cubos/core/io/window.hpp>
 #include <cubos/core/reflection/external/primitives.hpp>
 
 #include <cubos/engine/assets/plugin.hpp>
+#include <cubos/engine/render/culling/plugin.hpp>
+#include <cubos/engine/render/culling/visible_meshes.hpp>
 #include <cubos/engine/render/lights/plugin.hpp>
 #include <cubos/engine/render/lights/point.hpp>
 #include <cubos/engine/render/lights/spot.hpp>
-#include <cubos/engine/render/mesh/mesh.hpp>
 #include <cubos/engine/render/mesh/plugin.hpp>
 #include <cubos/engine/render/mesh/pool.hpp>
 #include <cubos/engine/render/mesh/vertex.hpp>
@@ -19,7 +22,6 @@
 #include <cubos/engine/render/shadows/casters/plugin.hpp>
 #include <cubos/engine/render/shadows/casters/point_caster.hpp>
 #include <cubos/engine/render/shadows/casters/spot_caster.hpp>
-#include <cubos/engine/render/voxels/grid.hpp>
 #include <cubos/engine/render/voxels/plugin.hpp>
 #include <cubos/engine/transform/local_to_world.hpp>
 #include <cubos/engine/transform/plugin.hpp>
@@ -54,12 +56,15 @@ namespace
         RasterState rasterState;
         DepthStencilState depthStencilState;
 
-        VertexArray vertexArray;
+        std::vector<VertexArray> vertexArrays;
 
         ConstantBuffer perSceneCB;
         ConstantBuffer perMeshCB;
 
-        State(RenderDevice& renderDevice, const ShaderPipeline& pipeline, VertexBuffer vertexBuffer)
+        // Reused across frames to avoid reallocating it.
+        std::vector<std::size_t> visible;
+
+        State(RenderDevice& renderDevice, const ShaderPipeline& pipeline, const RenderMeshPool& pool)
             : pipeline(pipeline)
         {
             perSceneBP = pipeline->getBindingPoint("PerScene");
@@ -85,9 +90,8 @@ namespace
                            .offset = offsetof(RenderMeshVertex, position),
                            .index = 0},
             };
-            desc.buffers[0] = cubos::core::memory::move(vertexBuffer);
             desc.shaderPipeline = pipeline;
-            vertexArray = renderDevice.createVertexArray(desc);
+            vertexArrays = pool.createVertexArrays(renderDevice, desc, 0);
 
             perSceneCB = renderDevice.createConstantBuffer(sizeof(PerScene), nullptr, Usage::Dynamic);
             perMeshCB = renderDevice.createConstantBuffer(sizeof(PerMesh), nullptr, Usage::Dynamic);
@@ -108,6 +112,7 @@ void cubos::engine::shadowAtlasRasterizerPlugin(Cubos& cubos)
     cubos.depends(renderVoxelsPlugin);
     cubos.depends(shadowCastersPlugin);
     cubos.depends(shadowAtlasPlugin);
+    cubos.depends(renderCullingPlugin);
 
     cubos.uninitResource<State>();
 
@@ -121,16 +126,17 @@ void cubos::engine::shadowAtlasRasterizerPlugin(Cubos& cubos)
             auto& rd = window->renderDevice();
             auto vs = assets.read(VertexShader)->shaderStage();
             auto ps = assets.read(PixelShader)->shaderStage();
-            cmds.emplaceResource<State>(rd, rd.createShaderPipeline(vs, ps), pool.vertexBuffer());
+            cmds.emplaceResource<State>(rd, rd.createShaderPipeline(vs, ps), pool);
         });
 
     cubos.system("rasterize to shadow atlases")
         .tagged(drawToShadowAtlasTag)
+        .after(cullRenderMeshesTag)
         .call([](State& state, const Window& window, const RenderMeshPool& pool, SpotShadowAtlas& spotAtlas,
                  PointShadowAtlas& pointAtlas, ShadowAtlasRasterizer& rasterizer,
+                 const VisibleRenderMeshes& visibleMeshes,
                  Query<const SpotShadowCaster&, const SpotLight&, const LocalToWorld&> spotLights,
-                 Query<const PointShadowCaster&, const PointLight&, const LocalToWorld&> pointLights,
-                 Query<Entity, const LocalToWorld&, const RenderMesh&, const RenderVoxelGrid&> meshes) {
+                 Query<const PointShadowCaster&, const PointLight&, const LocalToWorld&> pointLights) {
             auto& rd = window->renderDevice();
 
             // Check if we need to recreate the framebuffers.
@@ -164,11 +170,10 @@ void cubos::engine::shadowAtlasRasterizerPlugin(Cubos& cubos)
                 CUBOS_INFO("Recreated ShadowAtlasRasterizer's point atlas framebuffer");
             }
 
-            // Bind the shader pipeline, buffers vertex array, which are common to the next passes.
+            // Bind the shader pipeline and buffers, which are common to the next passes.
             rd.setShaderPipeline(state.pipeline);
             state.perSceneBP->bind(state.perSceneCB);
             state.perMeshBP->bind(state.perMeshCB);
-            rd.setVertexArray(state.vertexArray);
 
             // Bind the spot atlas framebuffer and set the viewport.
             rd.setFramebuffer(rasterizer.spotAtlasFramebuffer);
@@ -213,20 +218,23 @@ void cubos::engine::shadowAtlasRasterizerPlugin(Cubos& cubos)
                               static_cast<int>(slot->size.x * float(spotAtlas.getSize().x)),
                               static_cast<int>(slot->size.y * float(spotAtlas.getSize().y)));
 
-                // Iterate over all mesh buckets and issue draw calls.
-                for (auto [meshEnt, meshLocalToWorld, mesh, grid] : meshes)
+                // Iterate over the buckets of the meshes seen by the light and issue draw calls.
+                visibleMeshes.cull(perScene.lightViewProj, state.visible);
+                for (auto index : state.visible)
                 {
+                    const auto& mesh = visibleMeshes.meshes()[index];
+
                     // Send the PerMesh data to the GPU.
-                    PerMesh perMesh{
-                        .model = meshLocalToWorld.mat * glm::translate(glm::mat4(1.0F), grid.offset + mesh.baseOffset),
-                    };
+                    PerMesh perMesh{.model = mesh.model};
                     state.perMeshCB->fill(&perMesh, sizeof(perMesh));
 
                     // Iterate over the buckets of the mesh (it may be split over many of them).
                     for (auto bucket = mesh.firstBucketId; bucket != RenderMeshPool::BucketId::Invalid;
                          bucket = pool.next(bucket))
                     {
-                        rd.drawTriangles(pool.bucketSize() * bucket.inner, pool.vertexCount(bucket));
+                        rd.setVertexArray(state.vertexArrays[bucket.inner]);
+                        rd.setIndexBuffer(pool.indexBuffer());
+                        rd.drawTrianglesIndexed(0, pool.indexCount(bucket));
                     }
                 }
             }
@@ -275,20 +283,23 @@ void cubos::engine::shadowAtlasRasterizerPlugin(Cubos& cubos)
                     perScene.lightViewProj = proj * viewMatrices[i];
                     state.perSceneCB->fill(&perScene, sizeof(perScene));
 
-                    // Iterate over all mesh buckets and issue draw calls.
-                    for (auto [meshEnt, meshLocalToWorld, mesh, grid] : meshes)
+                    // Iterate over the buckets of the meshes seen by this face of the light and issue draw calls.
+                    visibleMeshes.cull(perScene.lightViewProj, state.visible);
+                    for (auto index : state.visible)
                     {
+                        const auto& mesh = visibleMeshes.meshes()[index];
+
                         // Send the PerMesh data to the GPU.
-                        PerMesh perMesh{
-                            .model = meshLocalToWorld.mat * glm::translate(glm::mat4(1.0F), grid.offset),
-                        };
+                        PerMesh perMesh{.model = mesh.model};
                         state.perMeshCB->fill(&perMesh, sizeof(perMesh));
 
                         // Iterate over the buckets of the mesh (it may be split over many of them).
                         for (auto bucket = mesh.firstBucketId; bucket != RenderMeshPool::BucketId::Invalid;
                              bucket = pool.next(bucket))
                         {
-                            rd.drawTriangles(pool.bucketSize() * bucket.inner, pool.vertexCount(bucket));
+                            rd.setVertexArray(state.vertexArrays[bucket.inner]);
+                            rd.setIndexBuffer(pool.indexBuffer());
+                            rd.drawTrianglesIndexed(0, pool.indexCount(bucket));
                         }
                     }
                 }
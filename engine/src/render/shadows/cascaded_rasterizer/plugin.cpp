@@ -1,3 +1,5 @@
+#include <vector>
+
 #include <cubos/core/geom/utils.hpp>
 #include <cubos/core/io/window.hpp>
 #include <cubos/core/reflection/external/primitives.hpp>
@@ -6,11 +8,12 @@
 #include <cubos/engine/render/camera/camera.hpp>
 #include <cubos/engine/render/camera/draws_to.hpp>
 #include <cubos/engine/render/camera/plugin.hpp>
+#include <cubos/engine/render/culling/plugin.hpp>
+#include <cubos/engine/render/culling/visible_meshes.hpp>
 #include <cubos/engine/render/g_buffer/g_buffer.hpp>
 #include <cubos/engine/render/g_buffer/plugin.hpp>
 #include <cubos/engine/render/lights/directional.hpp>
 #include <cubos/engine/render/lights/plugin.hpp>
-#include <cubos/engine/render/mesh/mesh.hpp>
 #include <cubos/engine/render/mesh/plugin.hpp>
 #include <cubos/engine/render/mesh/pool.hpp>
 #include <cubos/engine/render/mesh/vertex.hpp>
@@ -19,7 +22,6 @@
 #include <cubos/engine/render/shadows/cascaded_rasterizer/plugin.hpp>
 #include <cubos/engine/render/shadows/casters/directional_caster.hpp>
 #include <cubos/engine/render/shadows/casters/plugin.hpp>
-#include <cubos/engine/render/voxels/grid.hpp>
 #include <cubos/engine/render/voxels/plugin.hpp>
 #include <cubos/engine/transform/local_to_world.hpp>
 #include <cubos/engine/transform/plugin.hpp>
@@ -54,12 +56,15 @@ namespace
         RasterState rasterState;
         DepthStencilState depthStencilState;
 
-        VertexArray vertexArray;
+        std::vector<VertexArray> vertexArrays;
 
         ConstantBuffer perSceneCB;
         ConstantBuffer perMeshCB;
 
-        State(RenderDevice& renderDevice, const ShaderPipeline& pipeline, VertexBuffer vertexBuffer)
+        // Reused across frames to avoid reallocating it.
+        std::vector<std::size_t> visible;
+
+        State(RenderDevice& renderDevice, const ShaderPipeline& pipeline, const RenderMeshPool& pool)
             : pipeline(pipeline)
         {
             perSceneBP = pipeline->getBindingPoint("PerScene");
@@ -85,9 +90,8 @@ namespace
                            .offset = offsetof(RenderMeshVertex, position),
                            .index = 0},
             };
-            desc.buffers[0] = cubos::core::memory::move(vertexBuffer);
             desc.shaderPipeline = pipeline;
-            vertexArray = renderDevice.createVertexArray(desc);
+            vertexArrays = pool.createVertexArrays(renderDevice, desc, 0);
 
             perSceneCB = renderDevice.createConstantBuffer(sizeof(PerScene), nullptr, Usage::Dynamic);
             perMeshCB = renderDevice.createConstantBuffer(sizeof(PerMesh), nullptr, Usage::Dynamic);
@@ -110,6 +114,7 @@ void cubos::engine::cascadedShadowMapsRasterizerPlugin(Cubos& cubos)
     cubos.depends(cascadedShadowMapsPlugin);
     cubos.depends(cameraPlugin);
     cubos.depends(gBufferPlugin);
+    cubos.depends(renderCullingPlugin);
 
     cubos.uninitResource<State>();
 
@@ -121,16 +126,17 @@ void cubos::engine::cascadedShadowMapsRasterizerPlugin(Cubos& cubos)
             auto& rd = window->renderDevice();
             auto vs = assets.read(VertexShader)->shaderStage();
             auto ps = assets.read(PixelShader)->shaderStage();
-            cmds.emplaceResource<State>(rd, rd.createShaderPipeline(vs, ps), pool.vertexBuffer());
+            cmds.emplaceResource<State>(rd, rd.createShaderPipeline(vs, ps), pool);
         });
 
     cubos.system("rasterize to cascaded shadow maps")
         .tagged(drawToCascadedShadowMapsTag)
         .after(createGBufferTag)
+        .after(cullRenderMeshesTag)
         .call([](State& state, const Window& window, const RenderMeshPool& pool,
+                 const VisibleRenderMeshes& visibleMeshes,
                  Query<DirectionalShadowCaster&, const DirectionalLight&, const LocalToWorld&> lights,
-                 Query<Entity, const LocalToWorld&, const Camera&, const DrawsTo&, const GBuffer&> cameras,
-                 Query<Entity, const LocalToWorld&, const RenderMesh&, const RenderVoxelGrid&> meshes) {
+                 Query<Entity, const LocalToWorld&, const Camera&, const DrawsTo&, const GBuffer&> cameras) {
             auto& rd = window->renderDevice();
 
             // Set the raster and depth-stencil states.
@@ -225,27 +231,28 @@ void cubos::engine::cascadedShadowMapsRasterizerPlugin(Cubos& cubos)
                         PerScene perScene = {.lightViewProj = proj * view};
                         state.perSceneCB->fill(&perScene, sizeof(perScene));
 
-                        // Bind the shader, vertex array and uniform buffer.
+                        // Bind the shader and uniform buffers.
                         rd.setShaderPipeline(state.pipeline);
-                        rd.setVertexArray(state.vertexArray);
                         state.perSceneBP->bind(state.perSceneCB);
                         state.perMeshBP->bind(state.perMeshCB);
 
-                        // Iterate over all mesh buckets and issue draw calls.
-                        for (auto [meshEnt, meshLocalToWorld, mesh, grid] : meshes)
+                        // Iterate over the buckets of the meshes inside the cascade and issue draw calls.
+                        visibleMeshes.cull(perScene.lightViewProj, state.visible);
+                        for (auto index : state.visible)
                         {
+                            const auto& mesh = visibleMeshes.meshes()[index];
+
                             // Send the PerMesh data to the GPU.
-                            PerMesh perMesh{
-                                .model = meshLocalToWorld.mat *
-                                         glm::translate(glm::mat4(1.0F), grid.offset + mesh.baseOffset),
-                            };
+                            PerMesh perMesh{.model = mesh.model};
                             state.perMeshCB->fill(&perMesh, sizeof(perMesh));
 
                             // Iterate over the buckets of the mesh (it may be split over many of them).
                             for (auto bucket = mesh.firstBucketId; bucket != RenderMeshPool::BucketId::Invalid;
                                  bucket = pool.next(bucket))
                             {
-                                rd.drawTriangles(pool.bucketSize() * bucket.inner, pool.vertexCount(bucket));
+                                rd.setVertexArray(state.vertexArrays[bucket.inner]);
+                                rd.setIndexBuffer(pool.indexBuffer());
+                                rd.drawTrianglesIndexed(0, pool.indexCount(bucket));
                             }
                         }
                     }
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include <cubos/core/data/fs/file_system.hpp>
 #include <cubos/core/data/fs/standard_archive.hpp>
 #include <cubos/core/reflection/external/string.hpp>
@@ -74,4 +76,10 @@ void cubos::engine::settingsPlugin(Cubos& cubos)
             fileSettings.merge(argsSettings);
             settings.merge(fileSettings);
         });
+
+    cubos.startupSystem("configure SystemThreads from Settings")
+        .after(settingsTag)
+        .call([](Settings& settings, SystemThreads& threads) {
+            threads.value = static_cast<std::size_t>(std::max(1, settings.getInteger("systems.threadCount", 1)));
+        });
 }
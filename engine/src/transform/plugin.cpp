@@ -1,3 +1,5 @@
+#include <vector>
+
 #include <cubos/engine/transform/plugin.hpp>
 
 namespace cubos::engine
@@ -75,30 +77,54 @@ void cubos::engine::transformPlugin(Cubos& cubos)
     cubos.system("update LocalToParent's")
         .tagged(transformUpdateTag)
         .before(transformUpdatePropagateTag)
+        .anyChanged<Position>()
+        .anyChanged<Rotation>()
+        .anyChanged<Scale>()
+        .anyAdded<LocalToParent>()
         .call([](Query<LocalToParent&, const Position&, const Rotation&, const Scale&> query) {
-            for (auto [localToParent, position, rotation, scale] : query)
-            {
+            // Only entities whose transform changed since the last frame need their matrix recomputed.
+            query.parEach([](LocalToParent& localToParent, const Position& position, const Rotation& rotation,
+                             const Scale& scale) {
                 localToParent.mat =
                     glm::scale(glm::translate(glm::mat4(1.0F), position.vec) * glm::toMat4(rotation.quat),
                                glm::vec3(scale.factor));
-            }
+            });
         });
 
     cubos.system("update LocalToWorld's of children")
         .tagged(transformUpdateTag)
         .tagged(transformUpdatePropagateTag)
-        .with<LocalToWorld>()
+        .compareWrites<LocalToWorld>()
         .with<LocalToParent>()
         .related<ChildOf>(Traversal::Down)
         .with<LocalToWorld>()
-        .call([](Query<LocalToWorld&, const LocalToParent&, const LocalToWorld&> children,
-                 Query<LocalToWorld&, const LocalToParent&> all) {
-            for (auto [localToWorld, localToParent] : all)
+        .other()
+        .compareWrites<LocalToWorld>()
+        .call([hasParent = std::vector<bool>{}](
+                  Query<Entity, LocalToWorld&, const LocalToParent&, const LocalToWorld&> children,
+                  Query<Entity, LocalToWorld&, const LocalToParent&> all) mutable {
+            // Every LocalToWorld is fetched mutably every frame, so they're only marked as changed if their value
+            // differs. Each must only be written once, with its final value, as otherwise it would be detected as
+            // changed every frame. Thus, roots are skipped when computing children and vice versa.
+            hasParent.assign(hasParent.size(), false);
+            for (auto [entity, localToWorld, localToParent, parentLocalToWorld] : children)
+            {
+                if (entity.index >= hasParent.size())
+                {
+                    hasParent.resize(entity.index + 1, false);
+                }
+                hasParent[entity.index] = true;
+            }
+
+            for (auto [entity, localToWorld, localToParent] : all)
             {
-                localToWorld.mat = localToParent.mat;
+                if (entity.index >= hasParent.size() || !hasParent[entity.index])
+                {
+                    localToWorld.mat = localToParent.mat;
+                }
             }
 
-            for (auto [localToWorld, localToParent, parentLocalToWorld] : children)
+            for (auto [entity, localToWorld, localToParent, parentLocalToWorld] : children)
             {
                 localToWorld.mat = parentLocalToWorld.mat * localToParent.mat;
             }
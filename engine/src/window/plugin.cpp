@@ -5,6 +5,7 @@ CUBOS_DEFINE_TAG(cubos::engine::windowInitTag);
 CUBOS_DEFINE_TAG(cubos::engine::windowPollTag);
 CUBOS_DEFINE_TAG(cubos::engine::windowRenderTag);
 
+using cubos::core::io::openHeadlessWindow;
 using cubos::core::io::openWindow;
 using cubos::core::io::Window;
 using cubos::core::io::WindowEvent;
@@ -26,10 +27,15 @@ void cubos::engine::windowPlugin(Cubos& cubos)
         .tagged(windowInitTag)
         .call([](Commands cmds, ShouldQuit& quit, Settings& settings) {
             quit.value = false;
-            cmds.insertResource(
-                openWindow(settings.getString("window.title", "Cubos"),
-                           {settings.getInteger("window.width", 800), settings.getInteger("window.height", 600)},
-                           settings.getBool("window.vSync", true)));
+            glm::ivec2 size{settings.getInteger("window.width", 800), settings.getInteger("window.height", 600)};
+            if (settings.getBool("window.headless", false))
+            {
+                cmds.insertResource(openHeadlessWindow(size));
+                return;
+            }
+
+            cmds.insertResource(openWindow(settings.getString("window.title", "Cubos"), size,
+                                           settings.getBool("window.vSync", true)));
         });
 
     cubos.system("poll Window events")
@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include <cubos/engine/assets/plugin.hpp>
+#include <cubos/engine/collisions/collider_aabb.hpp>
+#include <cubos/engine/collisions/collision_layers.hpp>
+#include <cubos/engine/collisions/collision_mask.hpp>
+#include <cubos/engine/collisions/plugin.hpp>
+#include <cubos/engine/collisions/shapes/box.hpp>
+#include <cubos/engine/fixed_step/fixed_accumulated_time.hpp>
+#include <cubos/engine/fixed_step/fixed_delta_time.hpp>
+#include <cubos/engine/fixed_step/plugin.hpp>
+#include <cubos/engine/settings/plugin.hpp>
+#include <cubos/engine/transform/local_to_world.hpp>
+#include <cubos/engine/transform/plugin.hpp>
+#include <cubos/engine/transform/position.hpp>
+
+#include "../src/collisions/broad_phase/potentially_colliding_with.hpp"
+#include "../src/collisions/broad_phase/sweep_and_prune.hpp"
+
+using cubos::core::geom::AABB;
+using namespace cubos::engine;
+
+/// @brief Gets the keys of the given pairs, sorted.
+static std::vector<uint64_t> keys(const std::vector<BroadPhaseSweepAndPrune::Pair>& pairs)
+{
+    std::vector<uint64_t> keys;
+    for (const auto& pair : pairs)
+    {
+        keys.push_back(pair.key());
+    }
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+/// @brief Gets the key of the pair between the entities with the given indices.
+static uint64_t key(uint32_t first, uint32_t second)
+{
+    return BroadPhaseSweepAndPrune::Pair{{first, 0}, {second, 0}}.key();
+}
+
+/// @brief Updates the markers and sweeps, returning the added and removed pairs.
+static void step(BroadPhaseSweepAndPrune& sweepAndPrune, std::vector<uint64_t>& added, std::vector<uint64_t>& removed)
+{
+    sweepAndPrune.updateMarkers();
+    sweepAndPrune.sweep();
+    added = keys(sweepAndPrune.addedPairs);
+    removed = keys(sweepAndPrune.removedPairs);
+    sweepAndPrune.addedPairs.clear();
+    sweepAndPrune.removedPairs.clear();
+}
+
+TEST_CASE("cubos::engine::BroadPhaseSweepAndPrune")
+{
+    BroadPhaseSweepAndPrune sweepAndPrune{};
+    std::vector<uint64_t> added;
+    std::vector<uint64_t> removed;
+
+    Entity a{0, 0};
+    Entity b{1, 0};
+    Entity c{2, 0};
+
+    auto box = [](glm::vec3 center) {
+        AABB aabb{};
+        aabb.min(center - glm::vec3{0.5F});
+        aabb.max(center + glm::vec3{0.5F});
+        return aabb;
+    };
+
+    sweepAndPrune.addEntity(a);
+    sweepAndPrune.addEntity(b);
+    sweepAndPrune.addEntity(c);
+
+    SUBCASE("pairs are found regardless of the swept axis")
+    {
+        // Spread the boxes along each axis in turn, so that the markers are sorted along a different axis each time.
+        for (glm::length_t axis = 0; axis < 3; ++axis)
+        {
+            glm::vec3 offset{0.0F};
+            offset[axis] = 10.0F;
+            sweepAndPrune.updateBounds(a, box(glm::vec3{0.0F}), 1, 1);
+            sweepAndPrune.updateBounds(b, box(glm::vec3{0.0F} + offset * 0.05F), 1, 1);
+            sweepAndPrune.updateBounds(c, box(offset), 1, 1);
+            step(sweepAndPrune, added, removed);
+
+            CHECK(sweepAndPrune.axis == axis);
+            REQUIRE(sweepAndPrune.pairs.size() == 1);
+            CHECK(sweepAndPrune.pairs[0].key() == key(0, 1));
+        }
+    }
+
+    SUBCASE("only pairs which started or stopped overlapping are reported")
+    {
+        sweepAndPrune.updateBounds(a, box({0.0F, 0.0F, 0.0F}), 1, 1);
+        sweepAndPrune.updateBounds(b, box({0.9F, 0.0F, 0.0F}), 1, 1);
+        sweepAndPrune.updateBounds(c, box({5.0F, 0.0F, 0.0F}), 1, 1);
+        step(sweepAndPrune, added, removed);
+        CHECK(added == std::vector<uint64_t>{key(0, 1)});
+        CHECK(removed.empty());
+
+        // Nothing changed.
+        step(sweepAndPrune, added, removed);
+        CHECK(added.empty());
+        CHECK(removed.empty());
+
+        // The third box moves onto the second one, and the first one moves away.
+        sweepAndPrune.updateBounds(a, box({-5.0F, 0.0F, 0.0F}), 1, 1);
+        sweepAndPrune.updateBounds(c, box({1.5F, 0.0F, 0.0F}), 1, 1);
+        step(sweepAndPrune, added, removed);
+        CHECK(added == std::vector<uint64_t>{key(1, 2)});
+        CHECK(removed == std::vector<uint64_t>{key(0, 1)});
+    }
+
+    SUBCASE("touching bounds overlap")
+    {
+        sweepAndPrune.updateBounds(a, box({0.0F, 0.0F, 0.0F}), 1, 1);
+        sweepAndPrune.updateBounds(b, box({1.0F, 0.0F, 0.0F}), 1, 1);
+        sweepAndPrune.updateBounds(c, box({10.0F, 0.0F, 0.0F}), 1, 1);
+        step(sweepAndPrune, added, removed);
+        CHECK(added == std::vector<uint64_t>{key(0, 1)});
+    }
+
+    SUBCASE("pairs whose layers and masks don't match are skipped")
+    {
+        sweepAndPrune.updateBounds(a, box({0.0F, 0.0F, 0.0F}), 1, 2);
+        sweepAndPrune.updateBounds(b, box({0.2F, 0.0F, 0.0F}), 1, 2);
+        sweepAndPrune.updateBounds(c, box({0.4F, 0.0F, 0.0F}), 2, 1);
+        step(sweepAndPrune, added, removed);
+        CHECK(added == std::vector<uint64_t>{key(0, 2), key(1, 2)});
+    }
+
+    SUBCASE("removed entities have their pairs reported as removed")
+    {
+        sweepAndPrune.updateBounds(a, box({0.0F, 0.0F, 0.0F}), 1, 1);
+        sweepAndPrune.updateBounds(b, box({0.5F, 0.0F, 0.0F}), 1, 1);
+        sweepAndPrune.updateBounds(c, box({1.0F, 0.0F, 0.0F}), 1, 1);
+        step(sweepAndPrune, added, removed);
+        CHECK(added == std::vector<uint64_t>{key(0, 1), key(0, 2), key(1, 2)});
+
+        sweepAndPrune.removeEntity(b);
+        CHECK(keys(sweepAndPrune.removedPairs) == std::vector<uint64_t>{key(0, 1), key(1, 2)});
+        sweepAndPrune.removedPairs.clear();
+
+        step(sweepAndPrune, added, removed);
+        CHECK(added.empty());
+        CHECK(removed.empty());
+        CHECK(sweepAndPrune.pairs.size() == 1);
+    }
+
+    SUBCASE("re-added entities have their pairs reported as both removed and added")
+    {
+        sweepAndPrune.updateBounds(a, box({0.0F, 0.0F, 0.0F}), 1, 1);
+        sweepAndPrune.updateBounds(b, box({0.5F, 0.0F, 0.0F}), 1, 1);
+        sweepAndPrune.updateBounds(c, box({10.0F, 0.0F, 0.0F}), 1, 1);
+        step(sweepAndPrune, added, removed);
+        CHECK(added == std::vector<uint64_t>{key(0, 1)});
+
+        // Happens when the ColliderAABB of an entity is removed and added back in the same frame.
+        sweepAndPrune.removeEntity(b);
+        sweepAndPrune.addEntity(b);
+        sweepAndPrune.updateBounds(b, box({0.5F, 0.0F, 0.0F}), 1, 1);
+        sweepAndPrune.updateMarkers();
+        sweepAndPrune.sweep();
+        CHECK(keys(sweepAndPrune.removedPairs) == std::vector<uint64_t>{key(0, 1)});
+        CHECK(keys(sweepAndPrune.addedPairs) == std::vector<uint64_t>{key(0, 1)});
+        CHECK(sweepAndPrune.pairs.size() == 1);
+    }
+
+    SUBCASE("entities overlapping arbitrary bounds are found")
+    {
+        sweepAndPrune.updateBounds(a, box({0.0F, 0.0F, 0.0F}), 1, 1);
+        sweepAndPrune.updateBounds(b, box({5.0F, 0.0F, 0.0F}), 1, 1);
+        sweepAndPrune.updateBounds(c, box({10.0F, 0.0F, 0.0F}), 2, 1);
+        step(sweepAndPrune, added, removed);
+
+        auto sorted = [](std::vector<Entity> entities) {
+            std::sort(entities.begin(), entities.end(), [](Entity x, Entity y) { return x.index < y.index; });
+            return entities;
+        };
+
+        // Bounds near the start and near the end of the swept axis, so that both sides are walked.
+        std::vector<Entity> entities;
+        AABB query{};
+        query.min({-1.0F, -1.0F, -1.0F});
+        query.max({6.0F, 1.0F, 1.0F});
+        sweepAndPrune.overlapping(query, 1, entities);
+        CHECK(sorted(entities) == std::vector<Entity>{a, b});
+
+        query.min({4.0F, -1.0F, -1.0F});
+        query.max({20.0F, 1.0F, 1.0F});
+        sweepAndPrune.overlapping(query, 1 | 2, entities);
+        CHECK(sorted(entities) == std::vector<Entity>{b, c});
+
+        // Layers which don't match the mask are skipped, and so are bounds which only overlap on the swept axis.
+        sweepAndPrune.overlapping(query, 1, entities);
+        CHECK(entities == std::vector<Entity>{b});
+        query.min({4.0F, 5.0F, -1.0F});
+        query.max({20.0F, 6.0F, 1.0F});
+        sweepAndPrune.overlapping(query, 1 | 2, entities);
+        CHECK(entities.empty());
+    }
+}
+
+TEST_CASE("cubos::engine::broadPhaseCollisionsPlugin")
+{
+    Cubos cubos{};
+    cubos.plugin(settingsPlugin);
+    cubos.plugin(transformPlugin);
+    cubos.plugin(fixedStepPlugin);
+    cubos.plugin(assetsPlugin);
+    cubos.plugin(collisionsPlugin);
+
+    // Real time is ignored, and each update runs exactly one fixed step.
+    cubos.startupSystem("stop real time").call([](DeltaTime& deltaTime) { deltaTime.scale = 0.0F; });
+    cubos.system("run a single fixed step")
+        .before(fixedStepTag)
+        .call([](FixedAccumulatedTime& accumulated, const FixedDeltaTime& step) { accumulated.value = step.value; });
+
+    Entity first{};
+    Entity second{};
+    cubos.startupSystem("create overlapping boxes").call([&](Commands cmds) {
+        first = cmds.create()
+                    .add(BoxCollisionShape{})
+                    .add(CollisionLayers{})
+                    .add(CollisionMask{})
+                    .add(LocalToWorld{})
+                    .add(Position{{0.0F, 0.0F, 0.0F}})
+                    .entity();
+        second = cmds.create()
+                     .add(BoxCollisionShape{})
+                     .add(CollisionLayers{})
+                     .add(CollisionMask{})
+                     .add(LocalToWorld{})
+                     .add(Position{{0.5F, 0.0F, 0.0F}})
+                     .entity();
+    });
+
+    bool readd = false;
+    cubos.system("remove and re-add the collider of the second box")
+        .before(fixedStepTag)
+        .call([&](Commands cmds, Query<const ColliderAABB&> query) {
+            if (readd)
+            {
+                auto match = query.at(second);
+                REQUIRE(match.contains());
+                auto colliderAABB = std::get<0>(*match);
+                cmds.remove<ColliderAABB>(second);
+                cmds.add(second, colliderAABB);
+                readd = false;
+            }
+        });
+
+    auto related = [&]() { return cubos.world().related<PotentiallyCollidingWith>(first, second); };
+
+    cubos.start();
+    cubos.update();
+    REQUIRE(related());
+
+    // The pair is both removed and added in the same step, which must leave the boxes related.
+    readd = true;
+    cubos.update();
+    CHECK(related());
+    cubos.update();
+    CHECK(related());
+}
@@ -0,0 +1,105 @@
+#include <doctest/doctest.h>
+
+#include <cubos/engine/assets/plugin.hpp>
+#include <cubos/engine/collisions/collision_layers.hpp>
+#include <cubos/engine/collisions/collision_mask.hpp>
+#include <cubos/engine/collisions/plugin.hpp>
+#include <cubos/engine/collisions/shapes/box.hpp>
+#include <cubos/engine/fixed_step/fixed_accumulated_time.hpp>
+#include <cubos/engine/fixed_step/fixed_delta_time.hpp>
+#include <cubos/engine/fixed_step/plugin.hpp>
+#include <cubos/engine/physics/plugin.hpp>
+#include <cubos/engine/physics/solver/plugin.hpp>
+#include <cubos/engine/settings/plugin.hpp>
+#include <cubos/engine/transform/local_to_world.hpp>
+#include <cubos/engine/transform/plugin.hpp>
+#include <cubos/engine/transform/position.hpp>
+#include <cubos/engine/transform/rotation.hpp>
+
+using namespace cubos::engine;
+
+TEST_CASE("cubos::engine::physicsContinuousCollisionPlugin")
+{
+    Cubos cubos{};
+    cubos.plugin(settingsPlugin);
+    cubos.plugin(transformPlugin);
+    cubos.plugin(fixedStepPlugin);
+    cubos.plugin(assetsPlugin);
+    cubos.plugin(collisionsPlugin);
+    cubos.plugin(physicsPlugin);
+    cubos.plugin(physicsSolverPlugin);
+
+    // Real time is ignored, and each update runs exactly one fixed step.
+    cubos.startupSystem("stop real time").call([](DeltaTime& deltaTime) { deltaTime.scale = 0.0F; });
+    cubos.system("run a single fixed step")
+        .before(fixedStepTag)
+        .call([](FixedAccumulatedTime& accumulated, const FixedDeltaTime& step) { accumulated.value = step.value; });
+
+    bool continuous = true;
+    SUBCASE("with continuous collision, the body is stopped by the wall")
+    {
+    }
+
+    SUBCASE("without continuous collision, the body tunnels through the wall")
+    {
+        continuous = false;
+    }
+
+    // A thin static wall at z = 0, and a box moving towards it much farther than the wall's thickness every step.
+    Entity body{};
+    cubos.startupSystem("create bodies").call([continuous, &body](Commands cmds) {
+        cmds.create()
+            .add(BoxCollisionShape{cubos::core::geom::Box{.halfSize = glm::vec3{5.0F, 5.0F, 0.05F}}})
+            .add(CollisionLayers{})
+            .add(CollisionMask{})
+            .add(LocalToWorld{})
+            .add(Position{{0.0F, 0.0F, 0.0F}})
+            .add(Rotation{})
+            .add(Velocity{})
+            .add(AngularVelocity{})
+            .add(Force{})
+            .add(Torque{})
+            .add(Impulse{})
+            .add(AngularImpulse{})
+            .add(Mass{.mass = 1.0F, .inverseMass = 0.0F})
+            .add(CenterOfMass{})
+            .add(AccumulatedCorrection{})
+            .add(Inertia{.inertia = glm::mat3(0.0F), .inverseInertia = glm::mat3(0.0F), .autoUpdate = true})
+            .add(PhysicsMaterial{});
+
+        auto builder = cmds.create()
+                           .add(BoxCollisionShape{})
+                           .add(CollisionLayers{})
+                           .add(CollisionMask{})
+                           .add(LocalToWorld{})
+                           .add(Position{{0.0F, 0.0F, -3.0F}})
+                           .add(Rotation{})
+                           .add(PhysicsBundle{.velocity = {0.0F, 0.0F, 300.0F}});
+        if (continuous)
+        {
+            builder.add(ContinuousCollision{});
+        }
+        body = builder.entity();
+    });
+
+    cubos.start();
+    for (int i = 0; i < 10; ++i)
+    {
+        cubos.update();
+        if (continuous)
+        {
+            // The box may only sink into the wall by the margin, until the contact pushes it back.
+            REQUIRE(cubos.world().components(body).get<Position>().vec.z < 0.0F);
+        }
+    }
+
+    const auto& velocity = cubos.world().components(body).get<Velocity>();
+    if (continuous)
+    {
+        CHECK(velocity.vec.z < 300.0F);
+    }
+    else
+    {
+        CHECK(cubos.world().components(body).get<Position>().vec.z > 1.0F);
+    }
+}
@@ -0,0 +1,130 @@
+#include <cstring>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include <cubos/engine/assets/plugin.hpp>
+#include <cubos/engine/collisions/collision_layers.hpp>
+#include <cubos/engine/collisions/collision_mask.hpp>
+#include <cubos/engine/collisions/plugin.hpp>
+#include <cubos/engine/collisions/shapes/box.hpp>
+#include <cubos/engine/fixed_step/fixed_accumulated_time.hpp>
+#include <cubos/engine/fixed_step/fixed_delta_time.hpp>
+#include <cubos/engine/fixed_step/plugin.hpp>
+#include <cubos/engine/physics/plugin.hpp>
+#include <cubos/engine/physics/resources/solver_constants.hpp>
+#include <cubos/engine/physics/solver/plugin.hpp>
+#include <cubos/engine/settings/plugin.hpp>
+#include <cubos/engine/transform/local_to_world.hpp>
+#include <cubos/engine/transform/plugin.hpp>
+#include <cubos/engine/transform/position.hpp>
+#include <cubos/engine/transform/rotation.hpp>
+
+using namespace cubos::engine;
+
+/// @brief Final state of a body.
+struct BodyState
+{
+    glm::vec3 position;
+    glm::vec3 velocity;
+};
+
+/// @brief Drops a pile of boxes on a static floor with the deterministic solver, and returns their final states.
+///
+/// The entities are always created in the same order, so that they get the same identifiers, but their components
+/// may be added in reverse order, which changes the order in which they're stored and iterated over.
+///
+/// @param reversed Whether to add the components of the boxes in reverse order.
+/// @return Final states of the boxes, in the order they were created.
+static std::vector<BodyState> simulate(bool reversed)
+{
+    Cubos cubos{};
+    cubos.plugin(settingsPlugin);
+    cubos.plugin(transformPlugin);
+    cubos.plugin(fixedStepPlugin);
+    cubos.plugin(assetsPlugin);
+    cubos.plugin(collisionsPlugin);
+    cubos.plugin(physicsPlugin);
+    cubos.plugin(physicsSolverPlugin);
+
+    // Real time is ignored, and each update runs exactly one fixed step.
+    cubos.startupSystem("stop real time").call([](DeltaTime& deltaTime) { deltaTime.scale = 0.0F; });
+    cubos.system("run a single fixed step")
+        .before(fixedStepTag)
+        .call([](FixedAccumulatedTime& accumulated, const FixedDeltaTime& step) { accumulated.value = step.value; });
+
+    cubos.startupSystem("enable deterministic solver").call([](SolverConstants& constants) {
+        constants.deterministic = true;
+    });
+
+    std::vector<Entity> boxes;
+    cubos.startupSystem("create bodies").call([reversed, &boxes](Commands cmds) {
+        cmds.create()
+            .add(BoxCollisionShape{cubos::core::geom::Box{.halfSize = glm::vec3{5.0F, 0.5F, 5.0F}}})
+            .add(CollisionLayers{})
+            .add(CollisionMask{})
+            .add(LocalToWorld{})
+            .add(Position{{0.0F, 0.0F, 0.0F}})
+            .add(Rotation{})
+            .add(Velocity{})
+            .add(AngularVelocity{})
+            .add(Force{})
+            .add(Torque{})
+            .add(Impulse{})
+            .add(AngularImpulse{})
+            .add(Mass{.mass = 1.0F, .inverseMass = 0.0F})
+            .add(CenterOfMass{})
+            .add(AccumulatedCorrection{})
+            .add(Inertia{.inertia = glm::mat3(0.0F), .inverseInertia = glm::mat3(0.0F), .autoUpdate = true})
+            .add(PhysicsMaterial{});
+
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            boxes.push_back(cmds.create().entity());
+        }
+
+        for (std::size_t j = 0; j < 8; ++j)
+        {
+            // Boxes fall onto each other at different angles, so that there are plenty of contacts between them.
+            std::size_t i = reversed ? 7 - j : j;
+            auto fi = static_cast<float>(i);
+            glm::vec3 position{0.3F * static_cast<float>(i % 3), 1.5F + 1.1F * fi, 0.2F * static_cast<float>(i % 2)};
+            glm::quat rotation = glm::angleAxis(0.3F * fi, glm::normalize(glm::vec3{1.0F, fi, 0.5F}));
+            cmds.add(boxes[i], BoxCollisionShape{})
+                .add(boxes[i], CollisionLayers{})
+                .add(boxes[i], CollisionMask{})
+                .add(boxes[i], LocalToWorld{})
+                .add(boxes[i], Position{position})
+                .add(boxes[i], Rotation{rotation})
+                .add(boxes[i], PhysicsBundle{});
+        }
+    });
+
+    cubos.start();
+    for (int i = 0; i < 120; ++i)
+    {
+        cubos.update();
+    }
+
+    std::vector<BodyState> states;
+    for (auto box : boxes)
+    {
+        states.push_back({.position = cubos.world().components(box).get<Position>().vec,
+                          .velocity = cubos.world().components(box).get<Velocity>().vec});
+    }
+    return states;
+}
+
+TEST_CASE("cubos::engine::SolverConstants::deterministic")
+{
+    auto forward = simulate(false);
+    auto backward = simulate(true);
+    REQUIRE(forward.size() == backward.size());
+
+    // The results must be exactly the same, and not just close.
+    for (std::size_t i = 0; i < forward.size(); ++i)
+    {
+        CHECK(std::memcmp(&forward[i].position, &backward[i].position, sizeof(glm::vec3)) == 0);
+        CHECK(std::memcmp(&forward[i].velocity, &backward[i].velocity, sizeof(glm::vec3)) == 0);
+    }
+}
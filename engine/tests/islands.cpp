@@ -0,0 +1,117 @@
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include "../src/physics/solver/islands.hpp"
+
+using cubos::engine::ConstraintIslands;
+
+/// @brief Gets the constraints of an island as a vector.
+static std::vector<std::size_t> island(const ConstraintIslands& islands, std::size_t index)
+{
+    auto span = islands.island(index);
+    return {span.begin(), span.end()};
+}
+
+TEST_CASE("cubos::engine::ConstraintIslands")
+{
+    ConstraintIslands islands{};
+
+    SUBCASE("without constraints")
+    {
+        islands.build();
+        CHECK(islands.count() == 0);
+        CHECK(islands.batchCount() == 0);
+    }
+
+    SUBCASE("constraints sharing bodies are merged")
+    {
+        islands.add(0, 1); // 0
+        islands.add(2, 3); // 1
+        islands.add(4, 5); // 2
+        islands.add(1, 2); // 3, joins the first two islands.
+        islands.build();
+
+        REQUIRE(islands.count() == 2);
+        CHECK(island(islands, 0) == std::vector<std::size_t>{0, 1, 3});
+        CHECK(island(islands, 1) == std::vector<std::size_t>{2});
+    }
+
+    SUBCASE("static bodies don't join islands")
+    {
+        islands.add(0, ConstraintIslands::Static);                         // 0
+        islands.add(ConstraintIslands::Static, 1);                         // 1
+        islands.add(0, 2);                                                 // 2
+        islands.add(2, ConstraintIslands::Static);                         // 3
+        islands.add(ConstraintIslands::Static, ConstraintIslands::Static); // 4
+        islands.build();
+
+        REQUIRE(islands.count() == 3);
+        CHECK(island(islands, 0) == std::vector<std::size_t>{0, 2, 3});
+        CHECK(island(islands, 1) == std::vector<std::size_t>{1});
+        CHECK(island(islands, 2) == std::vector<std::size_t>{4});
+    }
+
+    SUBCASE("building again forgets the previous islands")
+    {
+        islands.add(0, 1);
+        islands.add(1, 2);
+        islands.build();
+        REQUIRE(islands.count() == 1);
+
+        islands.clear();
+        islands.add(0, 1);
+        islands.add(2, 3);
+        islands.build();
+        CHECK(islands.count() == 2);
+    }
+
+    SUBCASE("few constraints are solved in a single batch")
+    {
+        for (uint32_t i = 0; i < ConstraintIslands::MinBatchSize - 1; ++i)
+        {
+            islands.add(2 * i, 2 * i + 1);
+        }
+        islands.build();
+        CHECK(islands.count() == ConstraintIslands::MinBatchSize - 1);
+        CHECK(islands.batchCount() == 1);
+    }
+
+    SUBCASE("small islands are batched until reaching the minimum batch size")
+    {
+        // Ten islands of ten constraints each: the first batch takes seven of them, and the second the rest.
+        for (uint32_t i = 0; i < 10; ++i)
+        {
+            for (uint32_t j = 0; j < 10; ++j)
+            {
+                islands.add(i * 11 + j, i * 11 + j + 1);
+            }
+        }
+        islands.build();
+        CHECK(islands.count() == 10);
+        CHECK(islands.batchCount() == 2);
+    }
+
+    SUBCASE("the number of batches is capped")
+    {
+        auto count = static_cast<uint32_t>(ConstraintIslands::MinBatchSize * ConstraintIslands::MaxBatchCount * 2);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            islands.add(2 * i, 2 * i + 1);
+        }
+        islands.build();
+        CHECK(islands.count() == count);
+        CHECK(islands.batchCount() == ConstraintIslands::MaxBatchCount);
+    }
+
+    SUBCASE("a single large island is never split")
+    {
+        for (uint32_t i = 0; i < ConstraintIslands::MinBatchSize * 4; ++i)
+        {
+            islands.add(i, i + 1);
+        }
+        islands.build();
+        CHECK(islands.count() == 1);
+        CHECK(islands.batchCount() == 1);
+    }
+}
@@ -0,0 +1,153 @@
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include <cubos/engine/assets/plugin.hpp>
+#include <cubos/engine/collisions/colliding_with.hpp>
+#include <cubos/engine/collisions/collision_layers.hpp>
+#include <cubos/engine/collisions/collision_mask.hpp>
+#include <cubos/engine/collisions/contact_manifold.hpp>
+#include <cubos/engine/collisions/plugin.hpp>
+#include <cubos/engine/collisions/shapes/box.hpp>
+#include <cubos/engine/fixed_step/fixed_accumulated_time.hpp>
+#include <cubos/engine/fixed_step/fixed_delta_time.hpp>
+#include <cubos/engine/fixed_step/plugin.hpp>
+#include <cubos/engine/physics/plugin.hpp>
+#include <cubos/engine/physics/solver/plugin.hpp>
+#include <cubos/engine/settings/plugin.hpp>
+#include <cubos/engine/transform/local_to_world.hpp>
+#include <cubos/engine/transform/plugin.hpp>
+#include <cubos/engine/transform/position.hpp>
+#include <cubos/engine/transform/rotation.hpp>
+
+using namespace cubos::engine;
+
+TEST_CASE("cubos::engine::narrowPhaseCollisionsPlugin")
+{
+    Cubos cubos{};
+    cubos.plugin(settingsPlugin);
+    cubos.plugin(transformPlugin);
+    cubos.plugin(fixedStepPlugin);
+    cubos.plugin(assetsPlugin);
+    cubos.plugin(collisionsPlugin);
+    cubos.plugin(physicsPlugin);
+    cubos.plugin(physicsSolverPlugin);
+
+    // Real time is ignored, and each update runs exactly one fixed step.
+    cubos.startupSystem("stop real time").call([](DeltaTime& deltaTime) { deltaTime.scale = 0.0F; });
+    cubos.system("run a single fixed step")
+        .before(fixedStepTag)
+        .call([](FixedAccumulatedTime& accumulated, const FixedDeltaTime& step) { accumulated.value = step.value; });
+
+    // A floor of the same size as the box makes the box's rotated bottom face be clipped into an octagon, while a wider
+    // floor leaves it as a square.
+    glm::vec3 floorHalfSize{0.5F};
+    SUBCASE("on a floor of the same size")
+    {
+    }
+
+    SUBCASE("on a wide floor")
+    {
+        floorHalfSize = {5.0F, 0.5F, 5.0F};
+    }
+
+    cubos.startupSystem("create bodies").call([floorHalfSize](Commands cmds) {
+        cmds.create()
+            .add(BoxCollisionShape{cubos::core::geom::Box{.halfSize = floorHalfSize}})
+            .add(CollisionLayers{})
+            .add(CollisionMask{})
+            .add(LocalToWorld{})
+            .add(Position{{0.0F, 0.0F, 0.0F}})
+            .add(Rotation{})
+            .add(Velocity{})
+            .add(AngularVelocity{})
+            .add(Force{})
+            .add(Torque{})
+            .add(Impulse{})
+            .add(AngularImpulse{})
+            .add(Mass{.mass = 1.0F, .inverseMass = 0.0F})
+            .add(CenterOfMass{})
+            .add(AccumulatedCorrection{})
+            .add(Inertia{.inertia = glm::mat3(0.0F), .inverseInertia = glm::mat3(0.0F), .autoUpdate = true})
+            .add(PhysicsMaterial{});
+
+        // The box slightly overlaps the top of the floor, so that they're colliding.
+        cmds.create()
+            .add(BoxCollisionShape{})
+            .add(CollisionLayers{})
+            .add(CollisionMask{})
+            .add(LocalToWorld{})
+            .add(Position{{0.0F, 0.999F, 0.0F}})
+            .add(Rotation{glm::angleAxis(glm::radians(45.0F), glm::vec3{0.0F, 1.0F, 0.0F})})
+            .add(PhysicsBundle{});
+    });
+
+    // Accessing the transforms mutably marks them as changed, which forces the narrow phase to find the contacts
+    // again on every step, instead of keeping the previous ones while the box is resting.
+    cubos.system("mark boxes as moved")
+        .before(fixedStepTag)
+        .call([](Query<LocalToWorld&, const BoxCollisionShape&> query) {
+            for (auto [localToWorld, shape] : query)
+            {
+                (void)localToWorld;
+            }
+        });
+
+    auto collect = [](Query<const CollidingWith&>& query, std::vector<ContactManifold>& manifolds) {
+        manifolds.clear();
+        for (auto [collidingWith] : query)
+        {
+            manifolds.insert(manifolds.end(), collidingWith.manifolds.begin(), collidingWith.manifolds.end());
+        }
+    };
+
+    // Contacts are collected both right after the narrow phase, before the solver uses them, and after the solver
+    // stored its impulses on them.
+    std::vector<ContactManifold> found;
+    std::vector<ContactManifold> solved;
+    cubos.system("collect found contacts")
+        .tagged(fixedStepTag)
+        .after(collisionsTag)
+        .before(physicsPrepareTag)
+        .call([&](Query<const CollidingWith&> query) { collect(query, found); });
+    cubos.system("collect solved contacts")
+        .tagged(fixedStepTag)
+        .after(physicsFinalizePositionTag)
+        .call([&](Query<const CollidingWith&> query) { collect(query, solved); });
+
+    cubos.start();
+    for (int i = 0; i < 20; ++i)
+    {
+        auto previous = solved;
+        cubos.update();
+
+        REQUIRE(found.size() == 1);
+        REQUIRE_FALSE(found[0].points.empty());
+        CHECK(found[0].points.size() <= ContactManifold::MaxPoints);
+
+        if (i == 0)
+        {
+            continue;
+        }
+
+        // Every point must have been matched with a point of the previous step through their features, and thus
+        // start with the impulses the solver found for it.
+        REQUIRE(previous.size() == 1);
+        float impulse = 0.0F;
+        for (const auto& point : found[0].points)
+        {
+            bool matched = false;
+            for (const auto& oldPoint : previous[0].points)
+            {
+                matched |= point.fid1 == oldPoint.fid1 && point.fid2 == oldPoint.fid2 &&
+                           point.normalImpulse == oldPoint.normalImpulse;
+            }
+
+            CHECK(matched);
+            impulse += point.normalImpulse;
+        }
+
+        // The box is resting on the floor, so the points must carry its weight.
+        CHECK(impulse > 0.0F);
+    }
+}
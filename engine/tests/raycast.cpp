@@ -1,3 +1,7 @@
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <doctest/doctest.h>
 
 #include <cubos/core/ecs/name.hpp>
@@ -11,6 +15,7 @@
 #include <cubos/engine/transform/local_to_world.hpp>
 #include <cubos/engine/transform/plugin.hpp>
 #include <cubos/engine/transform/position.hpp>
+#include <cubos/engine/transform/scale.hpp>
 
 #include "utils.hpp"
 
@@ -92,6 +97,81 @@ TEST_CASE("cubos::engine::Raycast")
         });
     }
 
+    SUBCASE("fire many rays at once")
+    {
+        cubos.startupSystem("create resources").call([](Commands cmds) {
+            for (int i = 0; i < 8; ++i)
+            {
+                cmds.create()
+                    .add(Name{"box" + std::to_string(i)})
+                    .add(Position{{static_cast<float>(i) * 3.0F, 0.0F, 0.0F}})
+                    .add(LocalToWorld{})
+                    .add(BoxCollisionShape{})
+                    .add(CollisionLayers{});
+            }
+        });
+
+        cubos.system("raycast").after(transformUpdateTag).call([](const World& world, Raycast raycast) {
+            std::vector<Raycast::Ray> rays;
+            for (int i = 0; i < 8; ++i)
+            {
+                rays.push_back({{static_cast<float>(i) * 3.0F, 5.0F, 0.0F}, {0.0F, -1.0F, 0.0F}});
+            }
+            rays.push_back({{1.5F, 5.0F, 0.0F}, {0.0F, -1.0F, 0.0F}});
+            rays.push_back({{-5.0F, 0.0F, 0.0F}, {1.0F, 0.0F, 0.0F}});
+
+            auto hits = raycast.fireMany(rays);
+            REQUIRE(hits.size() == rays.size());
+
+            for (int i = 0; i < 8; ++i)
+            {
+                REQUIRE(hits[i].contains());
+                CHECK(world.components(hits[i]->entity).get<Name>().value == "box" + std::to_string(i));
+                CHECK_VEC3_EQ(hits[i]->point, glm::vec3{static_cast<float>(i) * 3.0F, 0.5F, 0.0F});
+            }
+
+            // Passes between the first two boxes.
+            CHECK_FALSE(hits[8].contains());
+
+            // Goes through every box, but only the closest one is hit.
+            REQUIRE(hits[9].contains());
+            CHECK(world.components(hits[9]->entity).get<Name>().value == "box0");
+            CHECK_VEC3_EQ(hits[9]->point, glm::vec3{-0.5F, 0.0F, 0.0F});
+        });
+    }
+
+    SUBCASE("scaled colliders are compared by their world distance")
+    {
+        cubos.startupSystem("create resources").call([](Commands cmds) {
+            // Closer to the ray's origin, but farther away in its own local space, due to its scale.
+            cmds.create()
+                .add(Name{"small"})
+                .add(Position{{5.0F, 0.0F, 0.0F}})
+                .add(Scale{0.5F})
+                .add(LocalToWorld{})
+                .add(BoxCollisionShape{})
+                .add(CollisionLayers{});
+
+            cmds.create()
+                .add(Name{"big"})
+                .add(Position{{6.0F, 0.0F, 0.0F}})
+                .add(LocalToWorld{})
+                .add(BoxCollisionShape{})
+                .add(CollisionLayers{});
+        });
+
+        cubos.system("raycast").after(transformUpdateTag).call([](const World& world, Raycast raycast) {
+            auto hit = raycast.fire({{0.0F, 0.0F, 0.0F}, {1.0F, 0.0F, 0.0F}});
+            REQUIRE(hit.contains());
+            CHECK(world.components(hit->entity).get<Name>().value == "small");
+            CHECK_VEC3_EQ(hit->point, glm::vec3{4.75F, 0.0F, 0.0F});
+
+            auto single = raycast.fire({{0.0F, 0.0F, 0.0F}, {1.0F, 0.0F, 0.0F}}, hit->entity);
+            REQUIRE(single.contains());
+            CHECK_VEC3_EQ(single->point, glm::vec3{4.75F, 0.0F, 0.0F});
+        });
+    }
+
     SUBCASE("hit check with a single capsule")
     {
         cubos.startupSystem("create resources").call([](Commands cmds) {
@@ -132,3 +212,65 @@ TEST_CASE("cubos::engine::Raycast")
 
     cubos.run();
 }
+
+TEST_CASE("cubos::engine::VoxelCollisionShape::raycast")
+{
+    // 8x8x8 grid with a single voxel at (5, 2, 6), far from the first brick, and another at (1, 1, 1).
+    VoxelGrid grid{{8, 8, 8}};
+    grid.set({5, 2, 6}, 3);
+    grid.set({1, 1, 1}, 7);
+
+    auto decomposition = std::make_shared<VoxelCollisionShape::Decomposition>();
+    decomposition->storeVoxels(grid);
+
+    VoxelCollisionShape shape{};
+    VoxelCollisionShape::VoxelHit hit{};
+    CHECK_FALSE(shape.raycast({0.0F, 0.0F, 0.0F}, {1.0F, 0.0F, 0.0F}, 100.0F, hit));
+    shape.setDecomposition(decomposition);
+
+    // Voxel (5, 2, 6) covers [1, 2] x [-2, -1] x [2, 3] in local space.
+    REQUIRE(shape.raycast({-10.0F, -1.5F, 2.5F}, {1.0F, 0.0F, 0.0F}, 100.0F, hit));
+    CHECK(hit.distance == doctest::Approx(11.0F));
+    CHECK(hit.voxel == glm::ivec3{5, 2, 6});
+    CHECK_VEC3_EQ(hit.normal, glm::vec3{-1.0F, 0.0F, 0.0F});
+    CHECK(hit.material == 3);
+
+    // Same ray, but too short to reach the voxel.
+    CHECK_FALSE(shape.raycast({-10.0F, -1.5F, 2.5F}, {1.0F, 0.0F, 0.0F}, 10.0F, hit));
+
+    // Coming from above, hitting the top face.
+    REQUIRE(shape.raycast({1.5F, 10.0F, 2.5F}, {0.0F, -1.0F, 0.0F}, 100.0F, hit));
+    CHECK(hit.distance == doctest::Approx(11.0F));
+    CHECK_VEC3_EQ(hit.normal, glm::vec3{0.0F, 1.0F, 0.0F});
+
+    // Diagonal ray through the other voxel, which covers [-3, -2] on every axis.
+    auto direction = glm::normalize(glm::vec3{1.0F, 1.0F, 1.0F});
+    REQUIRE(shape.raycast(glm::vec3{-4.5F}, direction, 100.0F, hit));
+    CHECK(hit.voxel == glm::ivec3{1, 1, 1});
+    CHECK(hit.material == 7);
+
+    // Along each axis, skipping an empty brick before reaching voxel (1, 1, 1). The other axes are never crossed.
+    for (glm::length_t axis = 0; axis < 3; ++axis)
+    {
+        glm::vec3 origin{-2.5F};
+        origin[axis] = 10.0F;
+        glm::vec3 axisDirection{0.0F};
+        axisDirection[axis] = -1.0F;
+        glm::vec3 normal{0.0F};
+        normal[axis] = 1.0F;
+
+        REQUIRE(shape.raycast(origin, axisDirection, 100.0F, hit));
+        CHECK(hit.distance == doctest::Approx(12.0F));
+        CHECK(hit.voxel == glm::ivec3{1, 1, 1});
+        CHECK_VEC3_EQ(hit.normal, normal);
+    }
+
+    // Along the z axis, skipping an empty brick before reaching voxel (5, 2, 6).
+    REQUIRE(shape.raycast({1.5F, -1.5F, -10.0F}, {0.0F, 0.0F, 1.0F}, 100.0F, hit));
+    CHECK(hit.distance == doctest::Approx(12.0F));
+    CHECK(hit.voxel == glm::ivec3{5, 2, 6});
+    CHECK_VEC3_EQ(hit.normal, glm::vec3{0.0F, 0.0F, -1.0F});
+
+    // Misses everything.
+    CHECK_FALSE(shape.raycast({-10.0F, 3.5F, 0.5F}, {1.0F, 0.0F, 0.0F}, 100.0F, hit));
+}
@@ -0,0 +1,220 @@
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include <cubos/core/gl/null_render_device.hpp>
+#include <cubos/core/io/window.hpp>
+
+#include <cubos/engine/assets/assets.hpp>
+#include <cubos/engine/assets/plugin.hpp>
+#include <cubos/engine/render/camera/camera.hpp>
+#include <cubos/engine/render/camera/draws_to.hpp>
+#include <cubos/engine/render/camera/perspective.hpp>
+#include <cubos/engine/render/camera/plugin.hpp>
+#include <cubos/engine/render/culling/plugin.hpp>
+#include <cubos/engine/render/culling/visible_meshes.hpp>
+#include <cubos/engine/render/depth/depth.hpp>
+#include <cubos/engine/render/depth/plugin.hpp>
+#include <cubos/engine/render/g_buffer/g_buffer.hpp>
+#include <cubos/engine/render/g_buffer/plugin.hpp>
+#include <cubos/engine/render/g_buffer_rasterizer/g_buffer_rasterizer.hpp>
+#include <cubos/engine/render/g_buffer_rasterizer/plugin.hpp>
+#include <cubos/engine/render/mesh/mesh.hpp>
+#include <cubos/engine/render/mesh/plugin.hpp>
+#include <cubos/engine/render/mesh/pool.hpp>
+#include <cubos/engine/render/mesh/vertex.hpp>
+#include <cubos/engine/render/picker/plugin.hpp>
+#include <cubos/engine/render/profiling/plugin.hpp>
+#include <cubos/engine/render/shader/plugin.hpp>
+#include <cubos/engine/render/target/plugin.hpp>
+#include <cubos/engine/render/target/target.hpp>
+#include <cubos/engine/render/voxels/grid.hpp>
+#include <cubos/engine/render/voxels/plugin.hpp>
+#include <cubos/engine/settings/plugin.hpp>
+#include <cubos/engine/transform/local_to_world.hpp>
+#include <cubos/engine/transform/plugin.hpp>
+#include <cubos/engine/transform/position.hpp>
+#include <cubos/engine/voxels/grid.hpp>
+#include <cubos/engine/window/plugin.hpp>
+
+using cubos::core::gl::NullRenderDevice;
+using cubos::core::gl::VertexArrayDesc;
+using cubos::core::io::Window;
+using namespace cubos::engine;
+
+/// @brief Creates a grid with a row of voxels, each separated from the next by an empty voxel.
+/// @param count Number of voxels.
+/// @return Voxel grid, whose mesh has six quads for each voxel.
+static VoxelGrid separatedVoxels(int count)
+{
+    VoxelGrid grid{{count * 2 - 1, 1, 1}};
+    for (int i = 0; i < count; ++i)
+    {
+        grid.set({i * 2, 0, 0}, 1);
+    }
+    return grid;
+}
+
+TEST_CASE("cubos::engine::RenderMeshPool")
+{
+    NullRenderDevice rd{};
+
+    // Each bucket holds two quads.
+    RenderMeshPool pool{rd, 4, 2 * RenderMeshVertex::VerticesPerQuad};
+    REQUIRE(pool.bucketCount() == 4);
+
+    // The vertex buffer starts empty, and only the indices of a single bucket are uploaded.
+    CHECK(rd.counters().bufferBytes == 2 * RenderMeshVertex::IndicesPerQuad * sizeof(uint16_t));
+    rd.resetCounters();
+
+    // A single voxel has six faces, each of them a quad with four vertices.
+    std::vector<RenderMeshVertex> vertices;
+    RenderMeshVertex::generate(separatedVoxels(1), vertices);
+    REQUIRE(vertices.size() == 6 * RenderMeshVertex::VerticesPerQuad);
+
+    // Six quads don't fit in a single bucket, and are thus split among three linked buckets.
+    auto firstBucketId = pool.allocate(vertices.data(), vertices.size());
+    REQUIRE(firstBucketId != RenderMeshPool::BucketId::Invalid);
+    CHECK(pool.freeBucketCount() == 1);
+    CHECK(rd.counters().bufferBytes == vertices.size() * sizeof(RenderMeshVertex));
+
+    std::size_t buckets = 0;
+    std::size_t indices = 0;
+    for (auto bucket = firstBucketId; bucket != RenderMeshPool::BucketId::Invalid; bucket = pool.next(bucket))
+    {
+        CHECK(pool.vertexCount(bucket) == 2 * RenderMeshVertex::VerticesPerQuad);
+        CHECK(pool.indexCount(bucket) == 2 * RenderMeshVertex::IndicesPerQuad);
+        buckets += 1;
+        indices += pool.indexCount(bucket);
+    }
+    CHECK(buckets == 3);
+    CHECK(indices == 6 * RenderMeshVertex::IndicesPerQuad);
+
+    // Every bucket gets its own vertex array.
+    VertexArrayDesc desc{};
+    REQUIRE(RenderMeshVertex::addVertexElements("position", "normal", "material", 0, desc));
+    rd.resetCounters();
+    CHECK(pool.createVertexArrays(rd, desc, 0).size() == pool.bucketCount());
+    CHECK(rd.counters().resourcesCreated == pool.bucketCount());
+
+    // Freed buckets are reused.
+    pool.deallocate(firstBucketId);
+    CHECK(pool.freeBucketCount() == 4);
+    vertices.resize(RenderMeshVertex::VerticesPerQuad);
+    auto single = pool.allocate(vertices.data(), vertices.size());
+    REQUIRE(single != RenderMeshPool::BucketId::Invalid);
+    CHECK(pool.next(single) == RenderMeshPool::BucketId::Invalid);
+    CHECK(pool.indexCount(single) == RenderMeshVertex::IndicesPerQuad);
+}
+
+TEST_CASE("cubos::engine::gBufferRasterizerPlugin")
+{
+    Cubos cubos{};
+    cubos.plugin(settingsPlugin);
+    cubos.plugin(windowPlugin);
+    cubos.plugin(transformPlugin);
+    cubos.plugin(assetsPlugin);
+    cubos.plugin(renderTargetPlugin);
+    cubos.plugin(renderVoxelsPlugin);
+    cubos.plugin(cameraPlugin);
+    cubos.plugin(shaderPlugin);
+    cubos.plugin(renderProfilingPlugin);
+    cubos.plugin(gBufferPlugin);
+    cubos.plugin(renderPickerPlugin);
+    cubos.plugin(renderDepthPlugin);
+    cubos.plugin(renderMeshPlugin);
+    cubos.plugin(renderCullingPlugin);
+    cubos.plugin(gBufferRasterizerPlugin);
+
+    // Rendering goes to the null render device, which only counts the work it's given.
+    cubos.startupSystem("configure headless rendering").before(settingsTag).call([](Settings& settings) {
+        settings.setBool("window.headless", true);
+        settings.setString("assets.builtin.osPath", BUILTIN_ASSETS_PATH);
+    });
+
+    // The camera looks down the negative Z axis. Three instances of the same mesh and one of another mesh are in
+    // front of it, while two other instances of the first mesh are behind it.
+    Entity camera{};
+    std::vector<Entity> meshes;
+    cubos.startupSystem("create scene").call([&](Commands cmds, Assets& assets) {
+        auto target =
+            cmds.create().add(RenderTarget{}).add(GBuffer{}).add(RenderDepth{}).add(GBufferRasterizer{}).entity();
+        camera = cmds.create()
+                     .relatedTo(target, DrawsTo{})
+                     .add(Camera{})
+                     .add(PerspectiveCamera{})
+                     .add(LocalToWorld{})
+                     .add(Position{{0.0F, 0.0F, 0.0F}})
+                     .entity();
+
+        auto first = assets.create(separatedVoxels(1));
+        auto second = assets.create(separatedVoxels(2));
+        auto spawn = [&](const Asset<VoxelGrid>& asset, glm::vec3 position) {
+            meshes.push_back(
+                cmds.create().add(RenderVoxelGrid{asset}).add(LocalToWorld{}).add(Position{position}).entity());
+        };
+
+        spawn(first, {-4.0F, 0.0F, -20.0F});
+        spawn(first, {0.0F, 0.0F, -20.0F});
+        spawn(first, {4.0F, 0.0F, -20.0F});
+        spawn(second, {0.0F, 4.0F, -20.0F});
+        spawn(first, {0.0F, 0.0F, 20.0F});
+        spawn(first, {4.0F, 0.0F, 20.0F});
+    });
+
+    // Only the work submitted by the rasterizer is counted.
+    NullRenderDevice::Counters counters{};
+    cubos.system("reset render device counters")
+        .after(cullRenderMeshesTag)
+        .before(rasterizeToGBufferTag)
+        .call([](const Window& window) { dynamic_cast<NullRenderDevice&>(window->renderDevice()).resetCounters(); });
+    cubos.system("read render device counters").after(rasterizeToGBufferTag).call([&](const Window& window) {
+        counters = dynamic_cast<NullRenderDevice&>(window->renderDevice()).counters();
+    });
+
+    // Meshing happens in the background, so we must wait until every mesh is ready.
+    cubos.start();
+    auto meshed = [&]() {
+        for (auto mesh : meshes)
+        {
+            if (!cubos.world().components(mesh).has<RenderMesh>())
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    for (int i = 0; i < 10000 && !meshed(); ++i)
+    {
+        cubos.update();
+    }
+    REQUIRE(meshed());
+
+    // Run a few more frames, so that the camera's frustum is up to date and it has seen every mesh.
+    for (int i = 0; i < 3; ++i)
+    {
+        cubos.update();
+    }
+
+    const auto& pool = cubos.world().resource<RenderMeshPool>();
+    auto bucket = [&](Entity mesh) { return cubos.world().components(mesh).get<RenderMesh>().firstBucketId; };
+
+    // Instances of the same mesh share its buckets, and each mesh fits in a single bucket.
+    CHECK(bucket(meshes[0]) == bucket(meshes[1]));
+    CHECK(bucket(meshes[0]) != bucket(meshes[3]));
+    CHECK(pool.next(bucket(meshes[0])) == RenderMeshPool::BucketId::Invalid);
+    CHECK(pool.next(bucket(meshes[3])) == RenderMeshPool::BucketId::Invalid);
+    CHECK(pool.vertexCount(bucket(meshes[0])) == 6 * RenderMeshVertex::VerticesPerQuad);
+    CHECK(pool.vertexCount(bucket(meshes[3])) == 12 * RenderMeshVertex::VerticesPerQuad);
+
+    // The meshes behind the camera are culled.
+    const auto& visible = cubos.world().resource<VisibleRenderMeshes>();
+    CHECK(visible.meshes().size() == 6);
+    CHECK(visible.camera(camera).size() == 4);
+
+    // Each mesh seen by the camera is drawn with a single instanced draw, and the culled instances aren't drawn.
+    CHECK(counters.drawCalls == 2);
+    CHECK(counters.instances == 4);
+    CHECK(counters.vertices == 3 * pool.indexCount(bucket(meshes[0])) + pool.indexCount(bucket(meshes[3])));
+    CHECK(counters.vertices == (3 * 6 + 12) * RenderMeshVertex::IndicesPerQuad);
+}
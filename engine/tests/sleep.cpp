@@ -0,0 +1,161 @@
+#include <doctest/doctest.h>
+
+#include <cubos/engine/assets/plugin.hpp>
+#include <cubos/engine/collisions/collision_layers.hpp>
+#include <cubos/engine/collisions/collision_mask.hpp>
+#include <cubos/engine/collisions/plugin.hpp>
+#include <cubos/engine/collisions/shapes/box.hpp>
+#include <cubos/engine/fixed_step/fixed_accumulated_time.hpp>
+#include <cubos/engine/fixed_step/fixed_delta_time.hpp>
+#include <cubos/engine/fixed_step/plugin.hpp>
+#include <cubos/engine/physics/components/sleeping.hpp>
+#include <cubos/engine/physics/plugin.hpp>
+#include <cubos/engine/physics/solver/plugin.hpp>
+#include <cubos/engine/settings/plugin.hpp>
+#include <cubos/engine/transform/local_to_world.hpp>
+#include <cubos/engine/transform/plugin.hpp>
+#include <cubos/engine/transform/position.hpp>
+#include <cubos/engine/transform/rotation.hpp>
+
+using namespace cubos::engine;
+
+/// @brief Runs the given number of fixed steps, one per update.
+/// @param cubos Cubos.
+/// @param steps Number of steps.
+static void step(Cubos& cubos, int steps)
+{
+    for (int i = 0; i < steps; ++i)
+    {
+        cubos.update();
+    }
+}
+
+/// @brief Runs fixed steps until the given entity falls asleep, up to a maximum number of steps.
+/// @param cubos Cubos.
+/// @param entity Entity.
+/// @return Whether the entity fell asleep.
+static bool stepUntilAsleep(Cubos& cubos, Entity entity)
+{
+    for (int i = 0; i < 300 && !cubos.world().components(entity).has<Sleeping>(); ++i)
+    {
+        cubos.update();
+    }
+    return cubos.world().components(entity).has<Sleeping>();
+}
+
+/// @brief Creates a box body, optionally resting on a static floor, and starts running.
+/// @param cubos Cubos.
+/// @param onFloor Whether to create the floor.
+/// @param floor Floor entity.
+/// @param box Box entity.
+static void setup(Cubos& cubos, bool onFloor, Entity& floor, Entity& box)
+{
+    cubos.startupSystem("create bodies").call([onFloor, &floor, &box](Commands cmds) {
+        if (onFloor)
+        {
+            floor = cmds.create()
+                        .add(BoxCollisionShape{cubos::core::geom::Box{.halfSize = glm::vec3{5.0F, 0.5F, 5.0F}}})
+                        .add(CollisionLayers{})
+                        .add(CollisionMask{})
+                        .add(LocalToWorld{})
+                        .add(Position{{0.0F, 0.0F, 0.0F}})
+                        .add(Rotation{})
+                        .add(Velocity{})
+                        .add(AngularVelocity{})
+                        .add(Force{})
+                        .add(Torque{})
+                        .add(Impulse{})
+                        .add(AngularImpulse{})
+                        .add(Mass{.mass = 1.0F, .inverseMass = 0.0F})
+                        .add(CenterOfMass{})
+                        .add(AccumulatedCorrection{})
+                        .add(Inertia{.inertia = glm::mat3(0.0F), .inverseInertia = glm::mat3(0.0F), .autoUpdate = true})
+                        .add(PhysicsMaterial{})
+                        .entity();
+        }
+
+        // The box slightly overlaps the top of the floor, so that they're colliding.
+        box = cmds.create()
+                  .add(BoxCollisionShape{})
+                  .add(CollisionLayers{})
+                  .add(CollisionMask{})
+                  .add(LocalToWorld{})
+                  .add(Position{{0.0F, 0.999F, 0.0F}})
+                  .add(Rotation{})
+                  .add(PhysicsBundle{})
+                  .entity();
+    });
+
+    cubos.start();
+}
+
+/// @brief Checks that a sleeping body stays asleep until it's disturbed.
+/// @param cubos Cubos.
+/// @param box Sleeping body.
+static void checkDisturbed(Cubos& cubos, Entity box)
+{
+    SUBCASE("stays asleep while undisturbed")
+    {
+        step(cubos, 30);
+        CHECK(cubos.world().components(box).has<Sleeping>());
+    }
+
+    SUBCASE("wakes up when an impulse is applied")
+    {
+        cubos.world().components(box).get<Impulse>().add({0.0F, 1.0F, 0.0F});
+        step(cubos, 1);
+        CHECK_FALSE(cubos.world().components(box).has<Sleeping>());
+    }
+}
+
+TEST_CASE("cubos::engine::physicsSleepPlugin")
+{
+    Cubos cubos{};
+    cubos.plugin(settingsPlugin);
+    cubos.plugin(transformPlugin);
+    cubos.plugin(fixedStepPlugin);
+    cubos.plugin(assetsPlugin);
+    cubos.plugin(collisionsPlugin);
+    cubos.plugin(physicsPlugin);
+    cubos.plugin(physicsSolverPlugin);
+
+    // Real time is ignored, and each update runs exactly one fixed step.
+    cubos.startupSystem("stop real time").call([](DeltaTime& deltaTime) { deltaTime.scale = 0.0F; });
+    cubos.system("run a single fixed step")
+        .before(fixedStepTag)
+        .call([](FixedAccumulatedTime& accumulated, const FixedDeltaTime& step) { accumulated.value = step.value; });
+
+    Entity floor{};
+    Entity box{};
+
+    SUBCASE("floating body")
+    {
+        setup(cubos, false, floor, box);
+
+        // A body which never moves falls asleep once its timer runs out, and not before.
+        const auto& constants = cubos.world().resource<SolverConstants>();
+        const auto& fixedDeltaTime = cubos.world().resource<FixedDeltaTime>();
+        auto stepsToSleep = static_cast<int>(constants.sleepTime / fixedDeltaTime.value);
+        step(cubos, stepsToSleep - 1);
+        CHECK_FALSE(cubos.world().components(box).has<Sleeping>());
+        step(cubos, 5);
+        REQUIRE(cubos.world().components(box).has<Sleeping>());
+
+        checkDisturbed(cubos, box);
+    }
+
+    SUBCASE("body resting on a static body")
+    {
+        setup(cubos, true, floor, box);
+        REQUIRE(stepUntilAsleep(cubos, box));
+
+        checkDisturbed(cubos, box);
+
+        SUBCASE("wakes up when the body supporting it is despawned")
+        {
+            cubos.world().destroy(floor);
+            step(cubos, 2);
+            CHECK_FALSE(cubos.world().components(box).has<Sleeping>());
+        }
+    }
+}
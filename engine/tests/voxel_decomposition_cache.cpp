@@ -0,0 +1,78 @@
+#include <memory>
+
+#include <doctest/doctest.h>
+
+#include <cubos/engine/assets/assets.hpp>
+#include <cubos/engine/assets/plugin.hpp>
+#include <cubos/engine/collisions/plugin.hpp>
+#include <cubos/engine/collisions/shapes/voxel.hpp>
+#include <cubos/engine/fixed_step/plugin.hpp>
+#include <cubos/engine/settings/plugin.hpp>
+#include <cubos/engine/transform/plugin.hpp>
+#include <cubos/engine/voxels/grid.hpp>
+
+using namespace cubos::engine;
+
+TEST_CASE("cubos::engine::collisionsPlugin voxel decompositions")
+{
+    Cubos cubos{};
+    cubos.plugin(settingsPlugin);
+    cubos.plugin(transformPlugin);
+    cubos.plugin(fixedStepPlugin);
+    cubos.plugin(assetsPlugin);
+    cubos.plugin(collisionsPlugin);
+    cubos.start();
+
+    auto& world = cubos.world();
+    auto& assets = world.resource<Assets>();
+
+    // Two voxels which can't be merged into a single box.
+    VoxelGrid grid{{4, 4, 4}};
+    grid.set({0, 0, 0}, 1);
+    grid.set({3, 3, 3}, 1);
+    auto handle = assets.create(std::move(grid));
+    Asset<VoxelGrid> weakHandle = handle;
+    weakHandle.makeWeak();
+
+    auto spawn = [&]() {
+        auto entity = world.create();
+        world.components(entity).add(VoxelCollisionShape{handle});
+        return entity;
+    };
+
+    auto decomposition = [&](Entity entity) {
+        return world.components(entity).get<VoxelCollisionShape>().getDecomposition();
+    };
+
+    // Shapes created from the same grid share its decomposition.
+    auto first = spawn();
+    auto second = spawn();
+    REQUIRE(decomposition(first) != nullptr);
+    CHECK(decomposition(first) == decomposition(second));
+    CHECK(decomposition(first)->boxes.size() == 2);
+
+    // Changing the grid makes new shapes decompose it again, while existing shapes keep the old decomposition.
+    assets.write(handle).get().set({1, 1, 1}, 1);
+    auto third = spawn();
+    auto fourth = spawn();
+    REQUIRE(decomposition(third) != nullptr);
+    CHECK(decomposition(third) != decomposition(first));
+    CHECK(decomposition(third) == decomposition(fourth));
+    CHECK(decomposition(third)->boxes.size() == 3);
+    CHECK(decomposition(first)->boxes.size() == 2);
+
+    // Once the last shapes are gone, the cache keeps neither the decompositions nor the grid alive.
+    std::weak_ptr<const VoxelCollisionShape::Decomposition> oldDecomposition = decomposition(first);
+    std::weak_ptr<const VoxelCollisionShape::Decomposition> newDecomposition = decomposition(third);
+    world.destroy(first);
+    world.destroy(second);
+    CHECK(oldDecomposition.expired());
+    CHECK_FALSE(newDecomposition.expired());
+    world.destroy(third);
+    world.destroy(fourth);
+    CHECK(newDecomposition.expired());
+
+    handle = Asset<VoxelGrid>{};
+    cubos.update();
+    CHECK(assets.status(weakHandle) == Assets::Status::Unloaded);
+}
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <doctest/doctest.h>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cubos/core/geom/aabb.hpp>
+
+#include <cubos/engine/collisions/shapes/voxel.hpp>
+
+using cubos::core::geom::AABB;
+using namespace cubos::engine;
+
+/// @brief Creates a shape made of random boxes.
+/// @param random Random number generator.
+/// @param count Number of boxes.
+/// @return Shape.
+static VoxelCollisionShape randomShape(std::mt19937& random, std::size_t count)
+{
+    std::uniform_real_distribution<float> position{-8.0F, 8.0F};
+    std::uniform_real_distribution<float> size{0.5F, 3.0F};
+
+    auto decomposition = std::make_shared<VoxelCollisionShape::Decomposition>();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        cubos::core::geom::Box box{.halfSize = {size(random), size(random), size(random)}};
+        glm::vec3 shift{position(random), position(random), position(random)};
+        decomposition->boxes.push_back({box, shift, static_cast<uint32_t>(i + 1)});
+    }
+    decomposition->buildTree();
+
+    VoxelCollisionShape shape{};
+    shape.setDecomposition(decomposition);
+    return shape;
+}
+
+/// @brief Gets the bounds of a box in the local space of its shape.
+/// @param box Box.
+/// @return Bounds.
+static AABB boxBounds(const VoxelCollisionShape::BoxShiftPair& box)
+{
+    // Boxes are placed at the opposite of their shift.
+    AABB aabb{};
+    aabb.min(-box.shift - box.box.halfSize);
+    aabb.max(-box.shift + box.box.halfSize);
+    return aabb;
+}
+
+/// @brief Gets the bounds of a transformed AABB, computed in the same way as the shape does.
+/// @param aabb Bounds.
+/// @param transform Transform.
+/// @return Transformed bounds.
+static AABB transformBounds(const AABB& aabb, const glm::mat4& transform)
+{
+    auto centered = transform;
+    centered[3] = transform * glm::vec4{aabb.center(), 1.0F};
+    return AABB::fromOBB(aabb.box(), centered);
+}
+
+TEST_CASE("cubos::engine::VoxelCollisionShape")
+{
+    std::mt19937 random{42};
+    auto shape = randomShape(random, 64);
+    auto other = randomShape(random, 48);
+
+    SUBCASE("findBoxes finds the same boxes as testing every box")
+    {
+        std::uniform_real_distribution<float> position{-10.0F, 10.0F};
+        std::uniform_real_distribution<float> size{0.1F, 4.0F};
+        std::vector<std::size_t> boxes;
+        for (int i = 0; i < 32; ++i)
+        {
+            glm::vec3 center{position(random), position(random), position(random)};
+            glm::vec3 halfSize{size(random), size(random), size(random)};
+            AABB aabb{};
+            aabb.min(center - halfSize);
+            aabb.max(center + halfSize);
+
+            std::vector<std::size_t> expected;
+            for (std::size_t j = 0; j < shape.getBoxes().size(); ++j)
+            {
+                if (boxBounds(shape.getBoxes()[j]).overlaps(aabb))
+                {
+                    expected.push_back(j);
+                }
+            }
+
+            shape.findBoxes(aabb, boxes);
+            std::sort(boxes.begin(), boxes.end());
+            CHECK(boxes == expected);
+        }
+    }
+
+    SUBCASE("findBoxPairs finds the same pairs as testing every pair")
+    {
+        std::uniform_real_distribution<float> position{-6.0F, 6.0F};
+        std::uniform_real_distribution<float> angle{0.0F, glm::two_pi<float>()};
+        std::uniform_real_distribution<float> axis{-1.0F, 1.0F};
+        std::vector<std::pair<std::size_t, std::size_t>> pairs;
+        std::size_t total = 0;
+        for (int i = 0; i < 32; ++i)
+        {
+            // The first transform is a pure translation, the others also rotate the other shape.
+            auto otherToThis = glm::translate(glm::mat4{1.0F}, {position(random), position(random), position(random)});
+            if (i > 0)
+            {
+                glm::vec3 rotationAxis{axis(random), axis(random), axis(random)};
+                otherToThis = glm::rotate(otherToThis, angle(random), glm::normalize(rotationAxis + 0.01F));
+            }
+
+            std::vector<std::pair<std::size_t, std::size_t>> expected;
+            for (std::size_t j = 0; j < shape.getBoxes().size(); ++j)
+            {
+                auto bounds = boxBounds(shape.getBoxes()[j]);
+                for (std::size_t k = 0; k < other.getBoxes().size(); ++k)
+                {
+                    if (bounds.overlaps(transformBounds(boxBounds(other.getBoxes()[k]), otherToThis)))
+                    {
+                        expected.emplace_back(j, k);
+                    }
+                }
+            }
+
+            shape.findBoxPairs(other, otherToThis, pairs);
+            std::sort(pairs.begin(), pairs.end());
+            CHECK(pairs == expected);
+            total += expected.size();
+        }
+
+        // Most transforms must have found pairs, or else the test wouldn't test anything.
+        CHECK(total > 32);
+    }
+
+    SUBCASE("shapes without boxes have no pairs")
+    {
+        std::vector<std::pair<std::size_t, std::size_t>> pairs{{0, 0}};
+        shape.findBoxPairs(VoxelCollisionShape{}, glm::mat4{1.0F}, pairs);
+        CHECK(pairs.empty());
+    }
+}